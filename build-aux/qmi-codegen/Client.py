@@ -563,6 +563,37 @@ class Client:
             cfile.write(string.Template(template).substitute(translations))
 
 
+    """
+    Emits the service module registered in the service registry
+    """
+    def __emit_service_module(self, hfile, cfile, message_list):
+        translations = { 'underscore'    : utils.build_underscore_name(self.name),
+                         'service'       : self.service.lower(),
+                         'service_upper' : self.service.upper(),
+                         'is_abortable'  : ('__qmi_message_' + self.service.lower() + '_is_abortable') if message_list.has_abortable() else 'NULL' }
+
+        template = (
+            '\n'
+            '#if defined (LIBQMI_GLIB_COMPILATION)\n'
+            '\n'
+            'G_GNUC_INTERNAL\n'
+            'extern const QmiServiceModule __qmi_service_${service}_module;\n'
+            '\n'
+            '#endif\n'
+            '\n')
+        hfile.write(string.Template(template).substitute(translations))
+
+        template = (
+            '\n'
+            'const QmiServiceModule __qmi_service_${service}_module = {\n'
+            '    .service         = QMI_SERVICE_${service_upper},\n'
+            '    .get_client_type = ${underscore}_get_type,\n'
+            '    .get_printable   = __qmi_message_${service}_get_printable,\n'
+            '    .get_json_info   = __qmi_message_${service}_get_json_info,\n'
+            '    .is_abortable    = ${is_abortable},\n'
+            '};\n')
+        cfile.write(string.Template(template).substitute(translations))
+
     """
     Emit the service-specific client implementation
     """
@@ -579,6 +610,7 @@ class Client:
         utils.add_separator(cfile, 'CLIENT', self.name);
         self.__emit_class(hfile, cfile, message_list)
         self.__emit_methods(hfile, cfile, message_list)
+        self.__emit_service_module(hfile, cfile, message_list)
 
 
     """
@@ -117,6 +117,44 @@ class Container:
                     else:
                         self.fields.append(Field(self.service, self.fullname, field_dictionary, common_objects_dictionary, container_type, static))
 
+            # In lazy mode, optional output fields are decoded on first access;
+            # except for the ones used as prerequisites of other fields, which
+            # are needed while parsing the message
+            if self.readonly and utils.lazy_output:
+                prerequisite_fields = []
+                for field in self.fields:
+                    for prerequisite in field.prerequisites:
+                        prerequisite_fields.append(utils.build_underscore_name(prerequisite['field']))
+                for field in self.fields:
+                    if field.mandatory or field.variable is None:
+                        continue
+                    field_underscore = utils.build_underscore_name(field.name)
+                    if any(prerequisite.startswith(field_underscore) for prerequisite in prerequisite_fields):
+                        continue
+                    field.lazy = True
+
+        self.has_lazy_fields = self.fields is not None and any(field.lazy for field in self.fields)
+
+
+    """
+    Flag all fields that can be read directly from the message as having a
+    peek accessor
+    """
+    def flag_peek(self, since, message_name, message_type, message_id):
+        if not self.readonly:
+            raise ValueError('Peek accessors are only supported in output containers')
+        if self.static or self.service == 'CTL':
+            raise ValueError('Peek accessors are only supported in public messages')
+        if self.fields is None:
+            return
+        for field in self.fields:
+            if field.supports_peek():
+                field.peek_since = since
+                # Peek accessors check that they're given the right message
+                field.peek_message = { 'name' : message_name,
+                                       'type' : message_type,
+                                       'id'   : message_id }
+
 
     """
     Emit enumeration of TLVs in the container
@@ -171,6 +209,11 @@ class Container:
             '\n'
             'struct _${camelcase} {\n'
             '    volatile gint ref_count;\n')
+        if self.has_lazy_fields:
+            template += (
+                '\n'
+                '    /* Source message of the fields decoded on first access */\n'
+                '    QmiMessage *message;\n')
         if self.compat:
             template += (
                 '\n'
@@ -187,6 +230,9 @@ class Container:
                         '\n'
                         '    /* ${field_name} */\n'
                         '    gboolean ${field_variable_name}_set;\n')
+                    if field.lazy:
+                        template += (
+                            '    gsize ${field_variable_name}_offset;\n')
                     cfile.write(string.Template(template).substitute(translations))
                     field.emit_variable_declaration(cfile)
 
@@ -292,6 +338,11 @@ class Container:
                 '        if (self->compat_context && self->compat_context_free)\n'
                 '            self->compat_context_free (self->compat_context);\n')
 
+        if self.has_lazy_fields:
+            template += (
+                '        if (self->message)\n'
+                '            qmi_message_unref (self->message);\n')
+
         if self.fields is not None:
             for field in self.fields:
                 if field.variable is not None and field.variable.needs_dispose:
@@ -381,6 +432,8 @@ class Container:
         if self.fields is not None:
             for field in self.fields:
                 field.emit_getter(auxfile, cfile)
+                if field.peek_since is not None:
+                    field.emit_peek(auxfile, cfile)
                 if not self.readonly:
                     field.emit_setter(auxfile, cfile)
 
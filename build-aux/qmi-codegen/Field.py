@@ -97,6 +97,13 @@ class Field:
         else:
             self.personal_info = False;
 
+        # Output fields decoded on first access, set by the container
+        self.lazy = False
+
+        # Version where the peek accessor was introduced, set by the container
+        self.peek_since = None
+        self.peek_message = None
+
 
     @property
     def mandatory(self):
@@ -191,7 +198,13 @@ class Field:
             '    GError **error)\n'
             '{\n'
             '    g_return_val_if_fail (self != NULL, FALSE);\n'
-            '\n'
+            '\n')
+        if self.lazy:
+            template += (
+                '    if (self->${variable_name}_offset && !${prefix_underscore}_decode_${underscore} (self, error))\n'
+                '        return FALSE;\n'
+                '\n')
+        template += (
             '    if (!self->${variable_name}_set) {\n'
             '        g_set_error (error,\n'
             '                     QMI_CORE_ERROR,\n'
@@ -207,6 +220,54 @@ class Field:
         cfile.write(string.Template(template).substitute(translations))
 
 
+    """
+    Emit the method decoding a lazy field from the source message, on first
+    access
+    """
+    def emit_lazy_decoder(self, cfile):
+        tlv_out = utils.build_underscore_name (self.fullname) + '_out'
+        translations = { 'name'              : self.name,
+                         'variable_name'     : self.variable_name,
+                         'underscore'        : utils.build_underscore_name(self.name),
+                         'prefix_camelcase'  : utils.build_camelcase_name(self.prefix),
+                         'prefix_underscore' : utils.build_underscore_name(self.prefix),
+                         'tlv_out'           : tlv_out }
+
+        template = (
+            '\n'
+            'static gboolean\n'
+            '${prefix_underscore}_decode_${underscore} (\n'
+            '    ${prefix_camelcase} *self,\n'
+            '    GError **error)\n'
+            '{\n'
+            '    QmiMessage *message = self->message;\n'
+            '    gsize offset = 0;\n'
+            '    gsize init_offset;\n'
+            '\n'
+            '    init_offset = self->${variable_name}_offset;\n'
+            '    self->${variable_name}_offset = 0;\n'
+            '\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+        self.variable.emit_buffer_read(cfile, '    ', tlv_out, 'error', 'self->' + self.variable_name)
+
+        template = (
+            '\n'
+            '    /* The remaining size of the buffer needs to be 0 if we successfully read the TLV */\n'
+            '    if ((offset = qmi_message_tlv_read_remaining_size (message, init_offset, offset)) > 0) {\n'
+            '        g_warning ("Left \'%" G_GSIZE_FORMAT "\' bytes unread when getting the \'${name}\' TLV", offset);\n'
+            '    }\n'
+            '    return TRUE;\n'
+            '\n'
+            '${tlv_out}:\n'
+            '    /* Not retried on the next access, the field is reported as not found then */\n'
+            '    g_prefix_error (error, "Couldn\'t decode the ${name} TLV: ");\n'
+            '    self->${variable_name}_set = FALSE;\n'
+            '    return FALSE;\n'
+            '}\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+
     """
     Emit the method responsible for declaring variable(s) for this TLV in the
     input/output container
@@ -226,6 +287,9 @@ class Field:
     container
     """
     def emit_getter(self, hfile, cfile):
+        if self.lazy:
+            self.emit_lazy_decoder(cfile)
+
         input_variable_name = 'value_' + utils.build_underscore_name(self.name)
         dec = self.variable.build_getter_declaration('    ', input_variable_name)
         doc = self.variable.build_getter_documentation(' * ', input_variable_name)
@@ -242,6 +306,291 @@ class Field:
             self.emit_getter_common(hfile, cfile, dec, doc, imp, since, '_gir')
 
 
+    """
+    Whether the field can be read directly from the message with a peek
+    accessor, without building the output bundle
+    """
+    def supports_peek(self):
+        if self.variable is None or not self.variable.is_fixed_layout():
+            return False
+        # Only the result check is allowed as prerequisite, as there is no
+        # bundle with the other fields to validate against
+        for prerequisite in self.prerequisites:
+            if prerequisite['field'] not in [ 'Result Error Status', 'Result Error Code' ]:
+                return False
+        return True
+
+
+    """
+    Emit the check of the result TLV prerequisites in the peek accessor, so
+    that the field is reported as not found in the same cases as the getter
+    """
+    def emit_peek_prerequisite_check(self, cfile, translations):
+        if self.prerequisites == []:
+            return
+
+        # Result TLV members, in the order they are read
+        members = [ 'Result Error Status', 'Result Error Code' ]
+        n_members = max(members.index(prerequisite['field']) for prerequisite in self.prerequisites) + 1
+
+        translations['result_tlv_id'] = utils.build_underscore_name(self.prefix + ' TLV Result').upper()
+        template = (
+            '    {\n'
+            '        gsize result_offset = 0;\n'
+            '        gsize result_init_offset;\n')
+        for member in members[:n_members]:
+            template += '        guint16 %s;\n' % utils.build_underscore_name(member)
+        template += (
+            '\n'
+            '        if ((result_init_offset = qmi_message_tlv_read_init (message, ${result_tlv_id}, NULL, error)) == 0)\n'
+            '            return FALSE;\n')
+        for member in members[:n_members]:
+            template += (
+                '        if (!qmi_message_tlv_read_guint16 (message, result_init_offset, &result_offset, QMI_ENDIAN_LITTLE, &%s, error))\n'
+                '            return FALSE;\n') % utils.build_underscore_name(member)
+        template += (
+            '\n'
+            '        /* Same prerequisites as when parsing the output bundle */\n'
+            '        if (')
+        template += ' ||\n            '.join('!(%s %s %s)' % (utils.build_underscore_name(prerequisite['field']),
+                                                                 prerequisite['operation'],
+                                                                 prerequisite['value']) for prerequisite in self.prerequisites)
+        template += (
+            ') {\n'
+            '            g_set_error (error,\n'
+            '                         QMI_CORE_ERROR,\n'
+            '                         QMI_CORE_ERROR_TLV_NOT_FOUND,\n'
+            '                         "Field \'${name}\' was not found in the message");\n'
+            '            return FALSE;\n'
+            '        }\n'
+            '    }\n'
+            '\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+
+    """
+    Emit the method reading the field directly from the message
+    """
+    def emit_peek(self, hfile, cfile):
+        input_variable_name = 'value_' + utils.build_underscore_name(self.name)
+        translations = { 'name'                : self.name,
+                         'tlv_id'              : self.id_enum_name,
+                         'underscore'          : utils.build_underscore_name(self.name),
+                         'prefix_camelcase'    : utils.build_camelcase_name(self.prefix),
+                         'prefix_underscore'   : utils.build_underscore_name(self.prefix),
+                         'variable_getter_dec' : self.variable.build_getter_declaration('    ', input_variable_name),
+                         'variable_getter_doc' : self.variable.build_getter_documentation(' * ', input_variable_name),
+                         'variable_getter_imp' : self.variable.build_getter_implementation('    ', 'peeked', input_variable_name),
+                         'variable_dec'        : self.variable.build_variable_declaration('    ', 'peeked'),
+                         'since'               : self.peek_since,
+                         'service'             : self.service,
+                         'message_name'        : self.peek_message['name'],
+                         'message_type'        : self.peek_message['type'],
+                         'message_id'          : self.peek_message['id'],
+                         'type_check'          : 'qmi_message_is_' + self.peek_message['type'] }
+
+        template = (
+            '\n'
+            '/**\n'
+            ' * ${prefix_underscore}_peek_${underscore}:\n'
+            ' * @message: a #QmiMessage.\n'
+            '${variable_getter_doc}'
+            ' * @error: Return location for error or %NULL.\n'
+            ' *\n'
+            ' * Get the \'${name}\' field directly from @message, without building a\n'
+            ' * #${prefix_camelcase}.\n'
+            ' *\n'
+            ' * Fails with %QMI_CORE_ERROR_INVALID_MESSAGE if @message is not a\n'
+            ' * ${message_name} ${message_type}.\n'
+            ' *\n'
+            ' * Returns: %TRUE if the field is found, %FALSE otherwise.\n'
+            ' *\n'
+            ' * Since: ${since}\n'
+            ' */\n'
+            'gboolean ${prefix_underscore}_peek_${underscore} (\n'
+            '    QmiMessage *message,\n'
+            '${variable_getter_dec}'
+            '    GError **error);\n')
+        hfile.write(string.Template(template).substitute(translations))
+
+        template = (
+            '\n'
+            'gboolean\n'
+            '${prefix_underscore}_peek_${underscore} (\n'
+            '    QmiMessage *message,\n'
+            '${variable_getter_dec}'
+            '    GError **error)\n'
+            '{\n'
+            '    gsize offset = 0;\n'
+            '    gsize init_offset;\n'
+            '${variable_dec}'
+            '\n'
+            '    g_return_val_if_fail (message != NULL, FALSE);\n'
+            '\n'
+            '    if (qmi_message_get_service (message) != QMI_SERVICE_${service} ||\n'
+            '        qmi_message_get_message_id (message) != ${message_id} ||\n'
+            '        !${type_check} (message)) {\n'
+            '        g_set_error (error,\n'
+            '                     QMI_CORE_ERROR,\n'
+            '                     QMI_CORE_ERROR_INVALID_MESSAGE,\n'
+            '                     "Message is not a ${message_name} ${message_type}");\n'
+            '        return FALSE;\n'
+            '    }\n'
+            '\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+        self.emit_peek_prerequisite_check(cfile, translations)
+
+        template = (
+            '    if ((init_offset = qmi_message_tlv_read_init (message, ${tlv_id}, NULL, error)) == 0)\n'
+            '        return FALSE;\n'
+            '\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+        self.variable.emit_buffer_read(cfile, '    ', None, 'error', 'peeked')
+
+        template = (
+            '\n'
+            '${variable_getter_imp}'
+            '    return TRUE;\n'
+            '}\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+
+    """
+    Build the member of the visitor struct for this field
+    """
+    def build_visitor_member(self, line_prefix):
+        translations = { 'lp'                   : line_prefix,
+                         'underscore'           : utils.build_underscore_name(self.name),
+                         'variable_visitor_dec' : self.variable.build_visitor_declaration(line_prefix + '    ', 'value_' + utils.build_underscore_name(self.name)) }
+
+        if translations['variable_visitor_dec'] is None:
+            raise RuntimeError('Field \'%s\' cannot be given to visitors' % self.fullname)
+
+        template = (
+            '${lp}void (* visit_${underscore}) (\n'
+            '${variable_visitor_dec}'
+            '${lp}    gpointer user_data);\n')
+        return string.Template(template).substitute(translations)
+
+
+    """
+    Build the documentation of the member of the visitor struct for this field
+    """
+    def build_visitor_member_documentation(self, line_prefix):
+        translations = { 'lp'         : line_prefix,
+                         'name'       : self.name,
+                         'underscore' : utils.build_underscore_name(self.name) }
+
+        template = (
+            '${lp}@visit_${underscore}: callback given the values of the \'${name}\' TLV, or %NULL to skip it.\n')
+        return string.Template(template).substitute(translations)
+
+
+    """
+    Build the condition on the values of other fields required to visit this
+    field, same as the prerequisites checked when parsing
+    """
+    def build_visitor_prerequisite_condition(self):
+        conditions = []
+        for prerequisite in self.prerequisites:
+            conditions.append('prerequisites.arg_%s %s %s' % (utils.build_underscore_name(prerequisite['field']),
+                                                              prerequisite['operation'],
+                                                              prerequisite['value']))
+        return conditions
+
+
+    """
+    Emit the code giving the field to the visitor, if found in the message.
+    Optional fields which cannot be read are skipped, same as when parsing.
+    Fields used in the prerequisites of other fields are read into the
+    'prerequisites' struct even if there is no callback for them.
+    """
+    def emit_visit(self, f, line_prefix, is_prerequisite):
+        tlv_out = utils.build_underscore_name (self.fullname) + '_out'
+        error = 'error' if self.mandatory else 'NULL'
+        value = 'prerequisites.' + self.variable_name if is_prerequisite else 'tlv.value'
+        translations = { 'name'          : self.name,
+                         'tlv_out'       : tlv_out,
+                         'tlv_id'        : self.id_enum_name,
+                         'underscore'    : utils.build_underscore_name(self.name),
+                         'lp'            : line_prefix,
+                         'error'         : error,
+                         'variable_dec'  : self.variable.build_visitor_variable_declaration(line_prefix + '        ', 'value'),
+                         'variable_args' : self.variable.build_visitor_arguments(line_prefix + ('            ' if is_prerequisite else '        '), value) }
+
+        conditions = self.build_visitor_prerequisite_condition()
+        if not is_prerequisite:
+            conditions.insert(0, 'visitor->visit_${underscore}')
+        translations['conditions'] = string.Template(' &&\n${lp}    '.join(conditions)).substitute(translations)
+
+        template = (
+            '\n'
+            '${lp}/* ${name} */\n')
+        if conditions:
+            template += (
+                '${lp}if (${conditions}) {\n')
+        else:
+            template += (
+                '${lp}{\n')
+        template += (
+            '${lp}    gsize offset = 0;\n'
+            '${lp}    gsize init_offset;\n')
+        if self.mandatory:
+            template += (
+                '${lp}    gboolean visited = FALSE;\n')
+        if not is_prerequisite:
+            template += (
+                '${lp}    struct {\n'
+                '${variable_dec}'
+                '${lp}    } tlv;\n'
+                '\n'
+                '${lp}    memset (&tlv, 0, sizeof (tlv));\n')
+        template += (
+            '\n'
+            '${lp}    if ((init_offset = qmi_message_tlv_read_init (message, ${tlv_id}, NULL, ${error})) == 0) {\n')
+        if self.mandatory:
+            template += (
+                '${lp}        g_prefix_error (${error}, "Couldn\'t get the mandatory ${name} TLV: ");\n')
+        template += (
+            '${lp}        goto ${tlv_out};\n'
+            '${lp}    }\n')
+        f.write(string.Template(template).substitute(translations))
+
+        self.variable.emit_visitor_read(f, line_prefix + '    ', tlv_out, error, value)
+
+        template = (
+            '\n')
+        if is_prerequisite:
+            template += (
+                '${lp}    if (visitor->visit_${underscore})\n'
+                '${lp}        visitor->visit_${underscore} (\n'
+                '${variable_args}'
+                '${lp}            user_data);\n')
+        else:
+            template += (
+                '${lp}    visitor->visit_${underscore} (\n'
+                '${variable_args}'
+                '${lp}        user_data);\n')
+        if self.mandatory:
+            template += (
+                '${lp}    visited = TRUE;\n')
+        template += (
+            '\n'
+            '${tlv_out}:\n')
+        if self.mandatory:
+            template += (
+                '${lp}    if (!visited)\n'
+                '${lp}        return FALSE;\n')
+        else:
+            template += (
+                '${lp}    ;\n')
+        template += (
+            '${lp}}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
     """
     Common setter logic
     """
@@ -402,6 +751,14 @@ class Field:
                          'lp'                   : line_prefix,
                          'error'                : error }
 
+        # Lazy fields only get located here, and decoded on first access
+        if self.lazy:
+            template = (
+                '${lp}if ((self->${variable_name}_offset = qmi_message_tlv_read_init (message, ${tlv_id}, NULL, NULL)) > 0)\n'
+                '${lp}    self->${variable_name}_set = TRUE;\n')
+            f.write(string.Template(template).substitute(translations))
+            return
+
         template = (
             '${lp}gsize offset = 0;\n'
             '${lp}gsize init_offset;\n'
@@ -460,6 +817,40 @@ class Field:
                          'tlv_id'     : self.id_enum_name,
                          'underscore' : utils.build_underscore_name (self.fullname) }
 
+        self.__emit_tlv_printable(f, translations)
+        self.__emit_tlv_json(f, translations)
+
+
+    """
+    Emit the method building the printable representation of the TLV
+    """
+    def __emit_tlv_printable(self, f, translations):
+        # Variables that can be described with a table of items are printed
+        # by the generic interpreter in qmi-message.c
+        if utils.table_driven_printables:
+            items = self.variable.build_printable_items('    ', None, self.personal_info)
+            if items is not None:
+                self.variable.emit_printable_helpers(f)
+                translations['items'] = items
+                template = (
+                    '\n'
+                    'static const QmiTlvPrintableItem ${underscore}_printable_items[] = {\n'
+                    '${items}'
+                    '};\n'
+                    '\n'
+                    'static gchar *\n'
+                    '${underscore}_get_printable (\n'
+                    '    QmiMessage *message,\n'
+                    '    const gchar *line_prefix)\n'
+                    '{\n'
+                    '    return qmi_message_tlv_build_printable (message,\n'
+                    '                                            ${tlv_id},\n'
+                    '                                            ${underscore}_printable_items,\n'
+                    '                                            G_N_ELEMENTS (${underscore}_printable_items));\n'
+                    '}\n')
+                f.write(string.Template(template).substitute(translations))
+                return
+
         template = (
             '\n'
             'static gchar *\n'
@@ -496,6 +887,38 @@ class Field:
         f.write(string.Template(template).substitute(translations))
 
 
+    """
+    Emit the method appending the TLV value in JSON to the caller's buffer
+    """
+    def __emit_tlv_json(self, f, translations):
+        template = (
+            '\n'
+            'static gboolean\n'
+            '${underscore}_get_json (\n'
+            '    QmiMessage *message,\n'
+            '    GString *json)\n'
+            '{\n'
+            '    gsize offset = 0;\n'
+            '    gsize init_offset;\n'
+            '    GError *error = NULL;\n'
+            '\n'
+            '    if ((init_offset = qmi_message_tlv_read_init (message, ${tlv_id}, NULL, NULL)) == 0)\n'
+            '        return FALSE;\n')
+        f.write(string.Template(template).substitute(translations))
+
+        self.variable.emit_get_json(f, '    ', self.personal_info)
+
+        template = (
+            '\n'
+            '    return TRUE;\n'
+            '\n'
+            'out:\n'
+            '    g_clear_error (&error);\n'
+            '    return FALSE;\n'
+            '}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
     """
     Add sections
     """
@@ -511,6 +934,9 @@ class Field:
         # Public methods
         template = (
             '${prefix_underscore}_get_${underscore}\n')
+        if self.peek_since is not None:
+            template += (
+                '${prefix_underscore}_peek_${underscore}\n')
         if self.variable.needs_compat_gir and self.service != 'CTL':
             template += (
                 '${prefix_underscore}_get_${underscore}_gir\n')
@@ -45,6 +45,10 @@ class FieldResult(Field):
     special TLV will have its own getter implementation, as we want to have
     proper GErrors built from the QMI result status/code.
     """
+    def supports_peek(self):
+        return False
+
+
     def emit_getter(self, hfile, cfile):
         translations = { 'variable_name'     : self.variable_name,
                          'prefix_camelcase'  : utils.build_camelcase_name(self.prefix),
@@ -169,6 +173,37 @@ class FieldResult(Field):
             '}\n')
         f.write(string.Template(template).substitute(translations))
 
+        template = (
+            '\n'
+            'static gboolean\n'
+            '${underscore}_get_json (\n'
+            '    QmiMessage *self,\n'
+            '    GString *json)\n'
+            '{\n'
+            '    gsize offset = 0;\n'
+            '    gsize init_offset;\n'
+            '    guint16 error_status;\n'
+            '    guint16 error_code;\n'
+            '    const gchar *error_code_str;\n'
+            '\n'
+            '    if ((init_offset = qmi_message_tlv_read_init (self, ${tlv_id}, NULL, NULL)) == 0)\n'
+            '        return FALSE;\n'
+            '    if (!qmi_message_tlv_read_guint16 (self, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_status, NULL))\n'
+            '        return FALSE;\n'
+            '    if (!qmi_message_tlv_read_guint16 (self, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_code, NULL))\n'
+            '        return FALSE;\n'
+            '\n'
+            '    g_string_append_printf (json, "{\\"error_status\\":\\"%s\\",\\"error_code\\":",\n'
+            '                            error_status == QMI_STATUS_SUCCESS ? "success" : "failure");\n'
+            '    error_code_str = qmi_protocol_error_get_string ((QmiProtocolError) error_code);\n'
+            '    if (error_code_str)\n'
+            '        g_string_append_printf (json, "\\"%s\\"}", error_code_str);\n'
+            '    else\n'
+            '        g_string_append_printf (json, "%u}", (guint) error_code);\n'
+            '    return TRUE;\n'
+            '}\n')
+        f.write(string.Template(template).substitute(translations))
+
 
     """
     Add sections
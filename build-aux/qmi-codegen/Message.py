@@ -36,7 +36,7 @@ class Message:
         # Validate input fields in the dictionary, and only allow those
         # explicitly expected.
         for message_key in dictionary:
-            if message_key not in [ "name", "type", "service", "id", "since", "input", "output", "vendor", "scope", "abort", "output-compat", "input-compat" ]:
+            if message_key not in [ "name", "type", "service", "id", "since", "input", "output", "vendor", "scope", "abort", "output-compat", "input-compat", "peek-since" ]:
                 raise ValueError('Invalid message field: "' + message_key + '"')
 
         # The message service, e.g. "Ctl"
@@ -89,6 +89,13 @@ class Message:
                                 self.since,
                                 self.output_compat)
 
+        # Output fields readable directly from the message, if requested
+        if 'peek-since' in dictionary:
+            self.output.flag_peek(dictionary['peek-since'],
+                                  self.name,
+                                  'response' if self.type == 'Message' else 'indication',
+                                  self.id_enum_name)
+
         self.input = None
         if self.type == 'Message':
             # Build input container (Request/Response only).
@@ -117,9 +124,26 @@ class Message:
                          'message_id' : self.id_enum_name }
 
         input_arg_template = 'gpointer unused' if self.input.fields is None else '${container} *input'
+
+        # Non-static request creators are also used by the benchmarks
+        if not self.static:
+            template = (
+                '\n'
+                '#if defined (LIBQMI_GLIB_COMPILATION)\n'
+                '\n'
+                'G_GNUC_INTERNAL\n'
+                'QmiMessage *__${underscore}_request_create (\n'
+                '    guint16 transaction_id,\n'
+                '    guint8 cid,\n'
+                '    %s,\n'
+                '    GError **error);\n'
+                '\n'
+                '#endif\n' % input_arg_template)
+            hfile.write(string.Template(template).substitute(translations))
+
         template = (
             '\n'
-            'static QmiMessage *\n'
+            '%sQmiMessage *\n'
             '__${underscore}_request_create (\n'
             '    guint16 transaction_id,\n'
             '    guint8 cid,\n'
@@ -131,7 +155,7 @@ class Message:
             '    self = qmi_message_new (QMI_SERVICE_${service},\n'
             '                            cid,\n'
             '                            transaction_id,\n'
-            '                            ${message_id});\n' % input_arg_template)
+            '                            ${message_id});\n' % ('static ' if self.static else '', input_arg_template))
         cfile.write(string.Template(template).substitute(translations))
 
         if self.input.fields:
@@ -246,6 +270,9 @@ class Message:
             '\n'
             '    self = g_slice_new0 (${container});\n'
             '    self->ref_count = 1;\n')
+        if self.output.has_lazy_fields:
+            template += (
+                '    self->message = qmi_message_ref (message);\n')
         cfile.write(string.Template(template).substitute(translations))
 
         for field in self.output.fields:
@@ -268,6 +295,141 @@ class Message:
             '}\n')
 
 
+    """
+    Emit the visitor type and the method walking a response/indication with it
+    """
+    def __emit_response_or_indication_visitor(self, hfile, cfile):
+        # If no output fields to visit, don't emit anything
+        if self.output is None or self.output.fields is None:
+            return
+
+        translations = { 'name'                 : self.name,
+                         'type'                 : 'response' if self.type == 'Message' else 'indication',
+                         'since'                : self.since if utils.version_compare('1.40',self.since) > 0 else '1.40',
+                         'container'            : utils.build_camelcase_name (self.output.fullname),
+                         'underscore'           : utils.build_underscore_name (self.fullname),
+                         'message_id'           : self.id_enum_name }
+
+        template = (
+            '\n'
+            '/**\n'
+            ' * ${container}Visitor: (skip)\n')
+        for field in self.output.fields:
+            template += field.build_visitor_member_documentation(' * ')
+        template += (
+            ' *\n'
+            ' * Callbacks given the TLVs of a ${name} ${type}, as found by\n'
+            ' * ${underscore}_${type}_visit().\n'
+            ' *\n'
+            ' * Integer values are given already decoded. Strings and arrays are\n'
+            ' * given as found in the message, without allocating memory: strings as\n'
+            ' * their raw bytes and length, which are neither validated, converted nor\n'
+            ' * NUL-terminated, and arrays as their raw items in the message format,\n'
+            ' * along with the number of items and their total length in bytes. They\n'
+            ' * point into @message, so they are only valid during the callback.\n'
+            ' *\n'
+            ' * Only available if libqmi-glib is built with `-Dmessage_visitors=true`,\n'
+            ' * see %QMI_MESSAGE_VISITORS_SUPPORTED.\n'
+            ' *\n'
+            ' * Since: ${since}\n'
+            ' */\n'
+            'typedef struct {\n')
+        for field in self.output.fields:
+            template += field.build_visitor_member('    ')
+        template += (
+            '} ${container}Visitor;\n'
+            '\n'
+            '/**\n'
+            ' * ${underscore}_${type}_visit: (skip)\n'
+            ' * @message: a #QmiMessage.\n'
+            ' * @visitor: a #${container}Visitor.\n'
+            ' * @user_data: data to pass to the callbacks in @visitor.\n'
+            ' * @error: return location for error or %NULL.\n'
+            ' *\n'
+            ' * Walks the TLVs of a #QmiMessage, giving their contents to the\n'
+            ' * callbacks in @visitor, without building a #${container}.\n'
+            ' *\n'
+            ' * Optional TLVs which are not found or cannot be read are skipped, as\n'
+            ' * are TLVs whose prerequisites are not met (e.g. TLVs only given in\n'
+            ' * successful responses). The operation fails with\n'
+            ' * %QMI_CORE_ERROR_INVALID_MESSAGE if @message is not a ${name} ${type},\n'
+            ' * or if a mandatory TLV with a callback in @visitor is not found.\n'
+            ' *\n'
+            ' * Only available if libqmi-glib is built with `-Dmessage_visitors=true`,\n'
+            ' * see %QMI_MESSAGE_VISITORS_SUPPORTED.\n'
+            ' *\n'
+            ' * Returns: %TRUE if the message was walked, %FALSE if @error is set.\n'
+            ' *\n'
+            ' * Since: ${since}\n'
+            ' */\n'
+            'gboolean ${underscore}_${type}_visit (\n'
+            '    QmiMessage *message,\n'
+            '    const ${container}Visitor *visitor,\n'
+            '    gpointer user_data,\n'
+            '    GError **error);\n')
+        hfile.write(string.Template(template).substitute(translations))
+
+        # Fields used in the prerequisites of other fields are always read
+        prerequisite_fields = []
+        for field in self.output.fields:
+            for prerequisite in field.prerequisites:
+                prerequisite_fields.append(utils.build_underscore_name(prerequisite['field']))
+        prerequisite_providers = []
+        for field in self.output.fields:
+            field_underscore = utils.build_underscore_name(field.name)
+            if any(prerequisite == field_underscore or prerequisite.startswith(field_underscore + '_') for prerequisite in prerequisite_fields):
+                prerequisite_providers.append(field)
+
+        translations['service'] = self.service
+        translations['type_check'] = 'qmi_message_is_response' if self.type == 'Message' else 'qmi_message_is_indication'
+
+        template = (
+            '\n'
+            'gboolean\n'
+            '${underscore}_${type}_visit (\n'
+            '    QmiMessage *message,\n'
+            '    const ${container}Visitor *visitor,\n'
+            '    gpointer user_data,\n'
+            '    GError **error)\n'
+            '{\n')
+        if prerequisite_providers:
+            template += (
+                '    /* Values of the fields used in prerequisites */\n'
+                '    struct {\n')
+            for field in prerequisite_providers:
+                template += field.variable.build_visitor_variable_declaration('        ', field.variable_name)
+            template += (
+                '    } prerequisites;\n'
+                '\n')
+        template += (
+            '    g_return_val_if_fail (message != NULL, FALSE);\n'
+            '    g_return_val_if_fail (visitor != NULL, FALSE);\n'
+            '\n'
+            '    if (qmi_message_get_service (message) != QMI_SERVICE_${service} ||\n'
+            '        qmi_message_get_message_id (message) != ${message_id} ||\n'
+            '        !${type_check} (message)) {\n'
+            '        g_set_error (error,\n'
+            '                     QMI_CORE_ERROR,\n'
+            '                     QMI_CORE_ERROR_INVALID_MESSAGE,\n'
+            '                     "Message is not a ${name} ${type}");\n'
+            '        return FALSE;\n'
+            '    }\n')
+        if prerequisite_providers:
+            template += (
+                '\n'
+                '    memset (&prerequisites, 0, sizeof (prerequisites));\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+        for field in self.output.fields:
+            field.emit_visit(cfile, '    ', field in prerequisite_providers)
+
+        template = (
+            '\n'
+            '    return TRUE;\n'
+            '}\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+
     """
     Emit method responsible for getting a printable representation of the whole
     request/response
@@ -431,6 +593,62 @@ class Message:
             '}\n')
         cfile.write(string.Template(template).substitute(translations))
 
+        # Emit the lookup of the JSON serializers of each TLV
+        template = (
+            '\n'
+            'static QmiTlvJsonFunc\n'
+            '${type}_${underscore}_get_tlv_json (\n'
+            '    QmiMessage *self,\n'
+            '    guint8 type,\n'
+            '    const gchar **tlv_type_str,\n'
+            '    gboolean *value_has_personal_info)\n'
+            '{\n')
+
+        if self.type == 'Message':
+            template += (
+                '    if (!qmi_message_is_response (self)) {\n'
+                '        switch (type) {\n')
+            if self.input is not None and self.input.fields is not None:
+                for field in self.input.fields:
+                    template += self.__build_tlv_json_case(field, '        ')
+            template += (
+                '        default:\n'
+                '            return NULL;\n'
+                '        }\n'
+                '    }\n'
+                '\n')
+
+        template += (
+            '    switch (type) {\n')
+        if self.output is not None and self.output.fields is not None:
+            for field in self.output.fields:
+                template += self.__build_tlv_json_case(field, '    ')
+        template += (
+            '    default:\n'
+            '        return NULL;\n'
+            '    }\n'
+            '}\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+
+    """
+    Build the case returning the JSON serializer of the given field
+    """
+    def __build_tlv_json_case(self, field, line_prefix):
+        translations = { 'lp'               : line_prefix,
+                         'underscore_field' : utils.build_underscore_name(field.fullname),
+                         'field_enum'       : field.id_enum_name,
+                         'field_name'       : field.name }
+        template = (
+            '${lp}case ${field_enum}:\n'
+            '${lp}    *tlv_type_str = "${field_name}";\n')
+        if field.variable is not None and field.variable.contains_personal_info:
+            template += (
+                '${lp}    *value_has_personal_info = TRUE;\n')
+        template += (
+            '${lp}    return ${underscore_field}_get_json;\n')
+        return string.Template(template).substitute(translations)
+
 
     """
     Emit request/response/indication handling implementation
@@ -454,6 +672,8 @@ class Message:
         self.output.emit(hfile, cfile)
         self.__emit_helpers(hfile, cfile)
         self.__emit_response_or_indication_parser(hfile, cfile)
+        if utils.message_visitors and not self.static and self.service != 'CTL':
+            self.__emit_response_or_indication_visitor(hfile, cfile)
 
     """
     Emit the sections
@@ -231,15 +231,107 @@ class MessageList:
         cfile.write(string.Template(template).substitute(translations))
 
 
+    """
+    Emit the method responsible for looking up how to serialize in JSON all
+    messages of a given service.
+    """
+    def __emit_get_json_info(self, hfile, cfile):
+        translations = { 'service'    : self.service.lower() }
+
+        template = (
+            '\n'
+            '#if defined (LIBQMI_GLIB_COMPILATION)\n'
+            '\n'
+            'G_GNUC_INTERNAL\n'
+            'void __qmi_message_${service}_get_json_info (\n'
+            '    QmiMessage *self,\n'
+            '    QmiMessageContext *context,\n'
+            '    const gchar **message_name,\n'
+            '    QmiTlvJsonLookupFunc *tlv_lookup);\n'
+            '\n'
+            '#endif\n'
+            '\n')
+        hfile.write(string.Template(template).substitute(translations))
+
+        template = (
+            '\n'
+            'void\n'
+            '__qmi_message_${service}_get_json_info (\n'
+            '    QmiMessage *self,\n'
+            '    QmiMessageContext *context,\n'
+            '    const gchar **message_name,\n'
+            '    QmiTlvJsonLookupFunc *tlv_lookup)\n'
+            '{\n'
+            '    if (qmi_message_is_indication (self)) {\n'
+            '        switch (qmi_message_get_message_id (self)) {\n')
+
+        for message in self.indication_list:
+            translations['enum_name'] = message.id_enum_name
+            translations['message_name'] = message.name
+            translations['message_underscore'] = utils.build_underscore_name (message.name)
+            inner_template = (
+                '        case ${enum_name}:\n'
+                '            *message_name = "${message_name}";\n'
+                '            *tlv_lookup = indication_${message_underscore}_get_tlv_json;\n'
+                '            return;\n')
+            template += string.Template(inner_template).substitute(translations)
+
+        template += (
+            '        default:\n'
+            '            return;\n'
+            '        }\n'
+            '    } else {\n'
+            '        guint16 vendor_id;\n'
+            '\n'
+            '        vendor_id = (context ? qmi_message_context_get_vendor_id (context) : QMI_MESSAGE_VENDOR_GENERIC);\n'
+            '        if (vendor_id == QMI_MESSAGE_VENDOR_GENERIC) {\n'
+            '            switch (qmi_message_get_message_id (self)) {\n')
+
+        for message in self.request_list:
+            if message.vendor is None:
+                translations['enum_name'] = message.id_enum_name
+                translations['message_name'] = message.name
+                translations['message_underscore'] = utils.build_underscore_name (message.name)
+                inner_template = (
+                    '            case ${enum_name}:\n'
+                    '                *message_name = "${message_name}";\n'
+                    '                *tlv_lookup = message_${message_underscore}_get_tlv_json;\n'
+                    '                return;\n')
+                template += string.Template(inner_template).substitute(translations)
+
+        template += (
+            '            default:\n'
+            '                return;\n'
+            '            }\n'
+            '        } else {\n')
+
+        for message in self.request_list:
+            if message.vendor is not None:
+                translations['enum_name'] = message.id_enum_name
+                translations['message_name'] = message.name
+                translations['message_underscore'] = utils.build_underscore_name (message.name)
+                translations['message_vendor'] = message.vendor
+                inner_template = (
+                    '            if (vendor_id == ${message_vendor} && (qmi_message_get_message_id (self) == ${enum_name})) {\n'
+                    '                *message_name = "${message_name}";\n'
+                    '                *tlv_lookup = message_${message_underscore}_get_tlv_json;\n'
+                    '                return;\n'
+                    '            }\n')
+                template += string.Template(inner_template).substitute(translations)
+
+        template += (
+            '        }\n'
+            '    }\n'
+            '}\n')
+        cfile.write(string.Template(template).substitute(translations))
+
+
     """
     Emit the method responsible for checking whether a given message is abortable
     """
     def __emit_is_abortable(self, hfile, cfile):
         # do nothing if no abortable messages in service
-        for message in self.request_list:
-            if message.abort:
-                break
-        else:
+        if not self.has_abortable():
             return
 
         translations = { 'service'    : self.service.lower() }
@@ -327,6 +419,7 @@ class MessageList:
         utils.add_separator(hfile, 'Service-specific utils', self.service);
         utils.add_separator(cfile, 'Service-specific utils', self.service);
         self.__emit_get_printable(hfile, cfile)
+        self.__emit_get_json_info(hfile, cfile)
         self.__emit_is_abortable(hfile, cfile)
 
     """
@@ -342,6 +435,15 @@ class MessageList:
         for message in self.request_list:
             message.emit_sections(sfile)
 
+    """
+    Check whether there is any abortable message in the list
+    """
+    def has_abortable(self):
+        for message in self.request_list:
+            if message.abort:
+                return True
+        return False
+
     """
     Check whether a given message exists in the list
     """
@@ -135,6 +135,16 @@ class Variable:
     def emit_buffer_read(self, f, line_prefix, tlv_out, error, variable_name):
         pass
 
+    """
+    Builds the statement run when reading the variable fails: jump to the
+    tlv_out label, or return FALSE right away if there is none.
+    """
+    @staticmethod
+    def build_read_failure(tlv_out):
+        if tlv_out is None:
+            return 'return FALSE;'
+        return 'goto %s;' % tlv_out
+
     """
     Emits the code involved in writing the variable to the raw byte stream
     from the specific private format.
@@ -148,6 +158,117 @@ class Variable:
     def emit_get_printable(self, f, line_prefix, is_personal):
         pass
 
+    """
+    Emits the code to append the contents of the given variable as a JSON value.
+    """
+    def emit_get_json(self, f, line_prefix, is_personal):
+        pass
+
+    """
+    Whether the variable has a fixed layout with no heap-allocated contents,
+    so that it can be read directly from the message into local variables.
+    """
+    def is_fixed_layout(self):
+        return False
+
+    """
+    Builds a representative raw value of the variable, as a list of bytes.
+    """
+    def build_sample(self):
+        return []
+
+    """
+    Builds the declarations of the values to build before giving a
+    representative value of the variable to its setter.
+    """
+    def build_sample_declaration(self, line_prefix, variable_name):
+        return ''
+
+    """
+    Emits the code building the values declared in build_sample_declaration().
+    """
+    def emit_sample_setup(self, f, line_prefix, variable_name):
+        pass
+
+    """
+    Builds the arguments giving a representative value of the variable to its
+    setter, in the same order as in the setter declaration.
+    """
+    def build_sample_setter_arguments(self, line_prefix, variable_name):
+        raise RuntimeError('Variable of type "%s" cannot be given to setters' % self.format)
+
+    """
+    Emits the code releasing the values built in emit_sample_setup().
+    """
+    def emit_sample_teardown(self, f, line_prefix, variable_name):
+        pass
+
+    """
+    Emits the code setting a representative value in an already zeroed array
+    element or struct member.
+    """
+    def emit_sample_value(self, f, line_prefix, variable_name):
+        pass
+
+    """
+    Emits the code releasing the value set in emit_sample_value().
+    """
+    def emit_sample_dispose(self, f, line_prefix, variable_name):
+        pass
+
+    """
+    Builds the entries describing the variable in a table-driven printable,
+    or None if the variable cannot be described that way.
+    """
+    def build_printable_items(self, line_prefix, name, is_personal):
+        return None
+
+    """
+    Emits the helper methods referenced by the table-driven printable entries
+    of the variable.
+    """
+    def emit_printable_helpers(self, f):
+        pass
+
+    """
+    Builds the parameters passing the variable to a visitor callback, or None
+    if the variable cannot be given to visitors. Values that live in the heap
+    are only valid during the callback.
+    """
+    def build_visitor_declaration(self, line_prefix, variable_name):
+        return None
+
+    """
+    Builds the arguments given to the visitor callback for this variable
+    """
+    def build_visitor_arguments(self, line_prefix, variable_name):
+        return ''
+
+    """
+    Builds the declaration of the variable read for a visitor. Visitors never
+    allocate: strings and arrays are read as pointers into the message.
+    """
+    def build_visitor_variable_declaration(self, line_prefix, variable_name):
+        return self.build_variable_declaration(line_prefix, variable_name)
+
+    """
+    Emits the code to read the variable for a visitor
+    """
+    def emit_visitor_read(self, f, line_prefix, tlv_out, error, variable_name):
+        self.emit_buffer_read(f, line_prefix, tlv_out, error, variable_name)
+
+    """
+    Emits the code to skip the variable in the message, without reading it
+    """
+    def emit_buffer_skip(self, f, line_prefix, tlv_out, error):
+        raise RuntimeError('Variable of type "%s" cannot be skipped' % self.format)
+
+    """
+    Size of the variable in the message, or None if not known in advance
+    """
+    def fixed_wire_size(self):
+        return None
+
     """
     Builds the code to include the declaration of a variable of this kind,
     used when generating input/output bundles.
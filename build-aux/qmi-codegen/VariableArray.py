@@ -19,6 +19,7 @@
 # Copyright (c) 2022 Qualcomm Innovation Center, Inc.
 #
 
+import io
 import string
 import utils
 from Variable import Variable
@@ -61,6 +62,10 @@ class VariableArray(Variable):
                                                                  '',
                                                                  self.container_type)
 
+        # Array elements are exposed in the public GArray, so they must not
+        # use inline storage
+        self.array_element.flag_public()
+
         if 'size-prefix-format' in dictionary and 'fixed-size' in dictionary:
             raise ValueError('Cannot give \'size-prefix-format\' and \'fixed-size\' in %s array at the same time' % self.name)
         elif 'size-prefix-format' in dictionary:
@@ -106,6 +111,17 @@ class VariableArray(Variable):
             self.array_element.emit_types_gir(hfile, cfile, since)
 
 
+    """
+    Arrays of plain integers are read in bulk: a single bounds check, a
+    single copy and an endianness conversion loop, instead of reading each
+    element separately
+    """
+    def supports_bulk_read(self):
+        return (self.array_element.format in [ 'guint8', 'guint16', 'guint32', 'guint64',
+                                               'gint8', 'gint16', 'gint32', 'gint64' ] and
+                self.array_element.private_format == self.array_element.public_format)
+
+
     def emit_buffer_read(self, f, line_prefix, tlv_out, error, variable_name):
         common_var_prefix = utils.build_underscore_name(self.name)
         translations = { 'lp'                          : line_prefix,
@@ -116,8 +132,10 @@ class VariableArray(Variable):
                          'common_var_prefix'           : common_var_prefix }
 
         template = (
-            '${lp}{\n'
-            '${lp}    guint ${common_var_prefix}_i;\n')
+            '${lp}{\n')
+        if not self.supports_bulk_read():
+            template += (
+                '${lp}    guint ${common_var_prefix}_i;\n')
         f.write(string.Template(template).substitute(translations))
 
         if self.fixed_size:
@@ -169,6 +187,22 @@ class VariableArray(Variable):
                 '${lp}    g_array_set_clear_func (${variable_name}, (GDestroyNotify)${array_element_clear_method});\n'
                 '\n')
 
+        if self.supports_bulk_read():
+            translations['array_element_endian'] = self.array_element.endian
+            template += (
+                '${lp}    if (!qmi_message_tlv_read_integer_array (message, init_offset, &offset,\n'
+                '${lp}                                             (guint)${common_var_prefix}_n_items,\n'
+                '${lp}                                             sizeof (${array_element_public_format}),\n'
+                '${lp}                                             ${array_element_endian},\n'
+                '${lp}                                             ${variable_name},\n'
+                '${lp}                                             ${error}))\n'
+                '${lp}        ${read_failure}\n'
+                '${lp}}\n')
+            translations['read_failure'] = self.build_read_failure(tlv_out)
+            translations['error'] = error
+            f.write(string.Template(template).substitute(translations))
+            return
+
         template += (
             '${lp}    for (${common_var_prefix}_i = 0; ${common_var_prefix}_i < ${common_var_prefix}_n_items; ${common_var_prefix}_i++) {\n'
             '${lp}        ${array_element_public_format} ${common_var_prefix}_aux;\n'
@@ -287,6 +321,167 @@ class VariableArray(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    def emit_get_json(self, f, line_prefix, is_personal):
+        common_var_prefix = utils.build_underscore_name(self.name)
+        translations = { 'lp'                : line_prefix,
+                         'common_var_prefix' : common_var_prefix }
+
+        template = (
+            '${lp}{\n'
+            '${lp}    guint ${common_var_prefix}_i;\n')
+        f.write(string.Template(template).substitute(translations))
+
+        if self.fixed_size:
+            translations['fixed_size'] = self.fixed_size
+
+            template = (
+                '${lp}    guint16 ${common_var_prefix}_n_items = ${fixed_size};\n'
+                '\n')
+            f.write(string.Template(template).substitute(translations))
+        else:
+            translations['array_size_element_format'] = self.array_size_element.public_format
+            template = (
+                '${lp}    ${array_size_element_format} ${common_var_prefix}_n_items;\n')
+
+            if self.array_sequence_element != '':
+                translations['array_sequence_element_format'] = self.array_sequence_element.public_format
+                template += (
+                    '${lp}    ${array_sequence_element_format} ${common_var_prefix}_sequence;\n')
+
+            template += (
+                '\n'
+                '${lp}    /* Read number of items in the array */\n')
+            f.write(string.Template(template).substitute(translations))
+            self.array_size_element.emit_buffer_read(f, line_prefix + '    ', 'out', '&error', common_var_prefix + '_n_items')
+
+            # The sequence number is not part of the value, just skip it
+            if self.array_sequence_element != '':
+                template = (
+                    '\n'
+                    '${lp}    /* Skip sequence */\n')
+                f.write(string.Template(template).substitute(translations))
+                self.array_sequence_element.emit_buffer_read(f, line_prefix + '    ', 'out', '&error', common_var_prefix + '_sequence')
+
+        template = (
+            '\n'
+            '${lp}    g_string_append_c (json, \'[\');\n'
+            '\n'
+            '${lp}    for (${common_var_prefix}_i = 0; ${common_var_prefix}_i < ${common_var_prefix}_n_items; ${common_var_prefix}_i++) {\n'
+            '${lp}        if (${common_var_prefix}_i > 0)\n'
+            '${lp}            g_string_append_c (json, \',\');\n')
+        f.write(string.Template(template).substitute(translations))
+
+        self.array_element.emit_get_json(f, line_prefix + '        ', self.personal_info or is_personal);
+
+        template = (
+            '${lp}    }\n'
+            '\n'
+            '${lp}    g_string_append_c (json, \']\');\n'
+            '${lp}}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def build_sample(self):
+        if self.fixed_size:
+            return self.array_element.build_sample() * int(self.fixed_size)
+
+        # Two items, after the size and sequence prefixes
+        n_items = 2
+        sample = self.array_size_element.build_sample()
+        sample[0] = n_items
+        if self.array_sequence_element != '':
+            sample += self.array_sequence_element.build_sample()
+        return sample + self.array_element.build_sample() * n_items
+
+
+    """
+    Emits the given code of the array elements in a loop over all of them,
+    if there is any
+    """
+    def __emit_sample_elements(self, f, line_prefix, variable_name, emit_element):
+        common_var_prefix = utils.build_underscore_name(self.name)
+        translations = { 'lp'                : line_prefix,
+                         'variable_name'     : variable_name,
+                         'common_var_prefix' : common_var_prefix }
+
+        elements = io.StringIO()
+        emit_element(elements,
+                     line_prefix + '        ',
+                     'g_array_index (' + variable_name + ', ' + self.array_element.public_format + ', ' + common_var_prefix + '_i)')
+        if not elements.getvalue():
+            return
+
+        template = (
+            '${lp}{\n'
+            '${lp}    guint ${common_var_prefix}_i;\n'
+            '\n'
+            '${lp}    for (${common_var_prefix}_i = 0; ${common_var_prefix}_i < ${variable_name}->len; ${common_var_prefix}_i++) {\n')
+        f.write(string.Template(template).substitute(translations))
+        f.write(elements.getvalue())
+        template = (
+            '${lp}    }\n'
+            '${lp}}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def build_sample_declaration(self, line_prefix, variable_name):
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = (
+            '${lp}GArray *${name};\n')
+        return string.Template(template).substitute(translations)
+
+
+    def emit_sample_setup(self, f, line_prefix, variable_name):
+        self.emit_sample_value(f, line_prefix, variable_name)
+
+
+    def build_sample_setter_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ''
+
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = ''
+        if self.array_sequence_element != '':
+            template += self.array_sequence_element.build_sample_setter_arguments(line_prefix, variable_name + '_sequence')
+        template += (
+            '${lp}${name},\n')
+        return string.Template(template).substitute(translations)
+
+
+    def emit_sample_teardown(self, f, line_prefix, variable_name):
+        self.emit_sample_dispose(f, line_prefix, variable_name)
+
+
+    def emit_sample_value(self, f, line_prefix, variable_name):
+        translations = { 'lp'                          : line_prefix,
+                         'variable_name'               : variable_name,
+                         'array_element_public_format' : self.array_element.public_format,
+                         # Two items, same as in the raw sample
+                         'n_items'                     : self.fixed_size if self.fixed_size else '2' }
+
+        template = (
+            '${lp}${variable_name} = g_array_sized_new (FALSE, TRUE, sizeof (${array_element_public_format}), ${n_items});\n'
+            '${lp}g_array_set_size (${variable_name}, ${n_items});\n')
+        f.write(string.Template(template).substitute(translations))
+
+        self.__emit_sample_elements(f, line_prefix, variable_name, self.array_element.emit_sample_value)
+
+
+    def emit_sample_dispose(self, f, line_prefix, variable_name):
+        translations = { 'lp'            : line_prefix,
+                         'variable_name' : variable_name }
+
+        self.__emit_sample_elements(f, line_prefix, variable_name, self.array_element.emit_sample_dispose)
+
+        template = (
+            '${lp}g_array_unref (${variable_name});\n')
+        f.write(string.Template(template).substitute(translations))
+
+
     """
     We need to include SEQUENCE + GARRAY
     """
@@ -367,6 +562,171 @@ class VariableArray(Variable):
         return string.Template(template).substitute(translations)
 
 
+    """
+    Arrays are given to visitors as found in the message: a pointer to the raw
+    items, the number of items and the size in bytes of all of them
+    """
+    def build_visitor_declaration(self, line_prefix, variable_name):
+        if not self.visible:
+            return ''
+
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = ''
+        if self.array_sequence_element != '':
+            translations['array_sequence_element_format'] = self.array_sequence_element.public_format
+            template += (
+                '${lp}${array_sequence_element_format} ${name}_sequence,\n')
+
+        template += (
+            '${lp}const guint8 *${name},\n'
+            '${lp}guint ${name}_n_items,\n'
+            '${lp}gsize ${name}_length,\n')
+        return string.Template(template).substitute(translations)
+
+
+    def build_visitor_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ''
+
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = ''
+        if self.array_sequence_element != '':
+            template += (
+                '${lp}${name}_sequence,\n')
+
+        template += (
+            '${lp}${name},\n'
+            '${lp}${name}_n_items,\n'
+            '${lp}${name}_length,\n')
+        return string.Template(template).substitute(translations)
+
+
+    def build_visitor_variable_declaration(self, line_prefix, variable_name):
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = ''
+        if self.array_sequence_element != '':
+            translations['array_sequence_element_format'] = self.array_sequence_element.public_format
+            template += (
+                '${lp}${array_sequence_element_format} ${name}_sequence;\n')
+
+        template += (
+            '${lp}const guint8 *${name};\n'
+            '${lp}guint ${name}_n_items;\n'
+            '${lp}gsize ${name}_length;\n')
+        return string.Template(template).substitute(translations)
+
+
+    def fixed_wire_size(self):
+        element_size = self.array_element.fixed_wire_size()
+        if not self.fixed_size or element_size is None:
+            return None
+        return int(self.fixed_size) * element_size
+
+
+    """
+    Emits the code going over the items of the array without decoding them,
+    giving them to the visitor in variable_name if not None
+    """
+    def __emit_visitor_items(self, f, line_prefix, tlv_out, error, variable_name):
+        common_var_prefix = utils.build_underscore_name(self.name)
+        element_size = self.array_element.fixed_wire_size()
+        translations = { 'lp'                : line_prefix,
+                         'read_failure'      : self.build_read_failure(tlv_out),
+                         'error'             : error,
+                         'variable_name'     : variable_name,
+                         'element_size'      : element_size,
+                         'common_var_prefix' : common_var_prefix }
+
+        template = (
+            '${lp}{\n')
+        if self.fixed_size:
+            translations['fixed_size'] = self.fixed_size
+            template += (
+                '${lp}    guint16 ${common_var_prefix}_n_items = ${fixed_size};\n')
+        else:
+            translations['array_size_element_format'] = self.array_size_element.public_format
+            template += (
+                '${lp}    ${array_size_element_format} ${common_var_prefix}_n_items;\n')
+            if self.array_sequence_element != '':
+                translations['array_sequence_element_format'] = self.array_sequence_element.public_format
+                template += (
+                    '${lp}    ${array_sequence_element_format} ${common_var_prefix}_sequence;\n')
+        if variable_name is not None:
+            template += (
+                '${lp}    gsize ${common_var_prefix}_start;\n')
+        if element_size is None:
+            template += (
+                '${lp}    guint ${common_var_prefix}_i;\n')
+        f.write(string.Template(template).substitute(translations))
+
+        if not self.fixed_size:
+            template = (
+                '\n'
+                '${lp}    /* Read number of items in the array */\n')
+            f.write(string.Template(template).substitute(translations))
+            self.array_size_element.emit_buffer_read(f, line_prefix + '    ', tlv_out, error, common_var_prefix + '_n_items')
+
+            if self.array_sequence_element != '':
+                template = (
+                    '\n'
+                    '${lp}    /* Read sequence in the array */\n')
+                f.write(string.Template(template).substitute(translations))
+                self.array_sequence_element.emit_buffer_read(f, line_prefix + '    ', tlv_out, error, common_var_prefix + '_sequence')
+
+        if variable_name is not None:
+            template = (
+                '\n'
+                '${lp}    /* The items are given as found in the message */\n'
+                '${lp}    if (!qmi_message_tlv_read_borrowed (message, init_offset, &offset, 0, 1, &(${variable_name}), ${error}))\n'
+                '${lp}        ${read_failure}\n'
+                '${lp}    ${common_var_prefix}_start = offset;\n')
+        else:
+            template = ''
+
+        if element_size is not None:
+            template += (
+                '\n'
+                '${lp}    if (!qmi_message_tlv_read_borrowed (message, init_offset, &offset, (guint)${common_var_prefix}_n_items, ${element_size}, NULL, ${error}))\n'
+                '${lp}        ${read_failure}\n')
+            f.write(string.Template(template).substitute(translations))
+        else:
+            template += (
+                '\n'
+                '${lp}    for (${common_var_prefix}_i = 0; ${common_var_prefix}_i < ${common_var_prefix}_n_items; ${common_var_prefix}_i++) {\n')
+            f.write(string.Template(template).substitute(translations))
+            self.array_element.emit_buffer_skip(f, line_prefix + '        ', tlv_out, error)
+            template = (
+                '${lp}    }\n')
+            f.write(string.Template(template).substitute(translations))
+
+        template = ''
+        if variable_name is not None:
+            template += (
+                '\n'
+                '${lp}    ${variable_name}_n_items = (guint)${common_var_prefix}_n_items;\n'
+                '${lp}    ${variable_name}_length = offset - ${common_var_prefix}_start;\n')
+            if self.array_sequence_element != '':
+                template += (
+                    '${lp}    ${variable_name}_sequence = ${common_var_prefix}_sequence;\n')
+        template += (
+            '${lp}}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def emit_visitor_read(self, f, line_prefix, tlv_out, error, variable_name):
+        self.__emit_visitor_items(f, line_prefix, tlv_out, error, variable_name)
+
+
+    def emit_buffer_skip(self, f, line_prefix, tlv_out, error):
+        self.__emit_visitor_items(f, line_prefix, tlv_out, error, None)
+
+
     def build_getter_declaration_gir(self, line_prefix, variable_name):
         if not self.array_element.needs_compat_gir:
             return self.build_getter_declaration(line_prefix, variable_name)
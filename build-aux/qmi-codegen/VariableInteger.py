@@ -21,6 +21,7 @@
 
 import string
 import utils
+import TypeFactory
 from Variable import Variable
 
 """
@@ -60,7 +61,7 @@ class VariableInteger(Variable):
 
     def emit_buffer_read(self, f, line_prefix, tlv_out, error, variable_name):
         translations = { 'lp'             : line_prefix,
-                         'tlv_out'        : tlv_out,
+                         'read_failure'   : self.build_read_failure(tlv_out),
                          'variable_name'  : variable_name,
                          'error'          : error,
                          'public_format'  : self.public_format,
@@ -75,27 +76,49 @@ class VariableInteger(Variable):
         if self.format == 'guint-sized':
             template = (
                 '${lp}if (!qmi_message_tlv_read_sized_guint (message, init_offset, &offset, ${len},${endian} &(${variable_name}), ${error}))\n'
-                '${lp}    goto ${tlv_out};\n')
+                '${lp}    ${read_failure}\n')
         elif self.format == 'gfloat':
             template = (
                 '${lp}if (!qmi_message_tlv_read_gfloat_endian (message, init_offset, &offset,${endian} &(${variable_name}), ${error}))\n'
-                '${lp}    goto ${tlv_out};\n')
+                '${lp}    ${read_failure}\n')
         elif self.private_format == self.public_format:
             template = (
                 '${lp}if (!qmi_message_tlv_read_${private_format} (message, init_offset, &offset,${endian} &(${variable_name}), ${error}))\n'
-                '${lp}    goto ${tlv_out};\n')
+                '${lp}    ${read_failure}\n')
         else:
             template = (
                 '${lp}{\n'
                 '${lp}    ${private_format} tmp;\n'
                 '\n'
                 '${lp}    if (!qmi_message_tlv_read_${private_format} (message, init_offset, &offset,${endian} &tmp, ${error}))\n'
-                '${lp}        goto ${tlv_out};\n'
+                '${lp}        ${read_failure}\n'
                 '${lp}    ${variable_name} = (${public_format})tmp;\n'
                 '${lp}}\n')
         f.write(string.Template(template).substitute(translations))
 
 
+    def fixed_wire_size(self):
+        if self.format == 'guint-sized':
+            return int(self.guint_sized_size)
+        if self.private_format == 'gfloat':
+            return 4
+        if self.private_format == 'gdouble':
+            return 8
+        return self.fixed_type_byte_size(self.private_format)
+
+
+    def emit_buffer_skip(self, f, line_prefix, tlv_out, error):
+        translations = { 'lp'           : line_prefix,
+                         'read_failure' : self.build_read_failure(tlv_out),
+                         'error'        : error,
+                         'size'         : self.fixed_wire_size() }
+
+        template = (
+            '${lp}if (!qmi_message_tlv_read_borrowed (message, init_offset, &offset, 1, ${size}, NULL, ${error}))\n'
+            '${lp}    ${read_failure}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
     @staticmethod
     def fixed_type_byte_size(fmt):
         if fmt == 'guint8':
@@ -158,7 +181,10 @@ class VariableInteger(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
-    def emit_get_printable(self, f, line_prefix, is_personal):
+    """
+    Builds the code reading the integer into a 'tmp' variable in a new block
+    """
+    def __build_read_tmp(self, line_prefix):
         common_format = ''
         common_cast = ''
 
@@ -214,6 +240,11 @@ class VariableInteger(Variable):
             template += (
                 '${lp}    if (!qmi_message_tlv_read_${private_format} (message, init_offset, &offset,${endian} &tmp, &error))\n'
                 '${lp}        goto out;\n')
+        return (translations, template)
+
+
+    def emit_get_printable(self, f, line_prefix, is_personal):
+        (translations, template) = self.__build_read_tmp(line_prefix)
 
         if self.personal_info or is_personal:
             translations['if_show_field'] = 'if (qmi_utils_get_show_personal_info ()) '
@@ -257,6 +288,146 @@ class VariableInteger(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    def emit_get_json(self, f, line_prefix, is_personal):
+        (translations, template) = self.__build_read_tmp(line_prefix)
+
+        if self.personal_info or is_personal:
+            translations['if_show_field'] = 'if (qmi_utils_get_show_personal_info ()) '
+        else:
+            translations['if_show_field'] = ''
+
+        template += (
+            '${lp}    ${if_show_field}{\n')
+        if self.public_format == 'gboolean':
+            template += (
+                '${lp}        g_string_append (json, tmp ? "true" : "false");\n')
+        elif self.public_format != self.private_format:
+            translations['public_type_underscore'] = utils.build_underscore_name_from_camelcase(self.public_format)
+            translations['public_type_underscore_upper'] = utils.build_underscore_name_from_camelcase(self.public_format).upper()
+            template += (
+                '#if defined  __${public_type_underscore_upper}_IS_ENUM__\n'
+                '${lp}        const gchar *tmp_str;\n'
+                '\n'
+                '${lp}        tmp_str = ${public_type_underscore}_get_string ((${public_format})tmp);\n'
+                '${lp}        if (tmp_str)\n'
+                '${lp}            g_string_append_printf (json, "\\"%s\\"", tmp_str);\n'
+                '${lp}        else\n'
+                '${lp}            g_string_append_printf (json, "${common_format}", ${common_cast}tmp);\n'
+                '#elif defined  __${public_type_underscore_upper}_IS_FLAGS__\n'
+                '${lp}        g_autofree gchar *flags_str = NULL;\n'
+                '\n'
+                '${lp}        flags_str = ${public_type_underscore}_build_string_from_mask ((${public_format})tmp);\n'
+                '${lp}        g_string_append_printf (json, "\\"%s\\"", flags_str ? flags_str : "");\n'
+                '#else\n'
+                '# error unexpected public format: ${public_format}\n'
+                '#endif\n')
+        elif self.private_format in ('gfloat', 'gdouble'):
+            # Locale-independent, and never 'nan' or 'inf' which are not valid JSON
+            template += (
+                '${lp}        gchar tmp_str[G_ASCII_DTOSTR_BUF_SIZE];\n'
+                '\n'
+                '${lp}        if (!isnan (tmp) && !isinf (tmp))\n'
+                '${lp}            g_string_append (json, g_ascii_dtostr (tmp_str, sizeof (tmp_str), (gdouble)tmp));\n'
+                '${lp}        else\n'
+                '${lp}            g_string_append (json, "null");\n')
+        else:
+            template += (
+                '${lp}        g_string_append_printf (json, "${common_format}", ${common_cast}tmp);\n')
+
+        if self.personal_info or is_personal:
+            template += (
+                '${lp}    } else {\n'
+                '${lp}        g_string_append (json, "\\"###\\"");\n')
+
+        template += (
+            '${lp}    }\n'
+            '${lp}}\n')
+
+        f.write(string.Template(template).substitute(translations))
+
+
+    def is_fixed_layout(self):
+        return True
+
+
+    def build_sample(self):
+        if self.format == 'guint-sized':
+            return [0] * int(self.guint_sized_size)
+        if self.format == 'gfloat':
+            return [0] * 4
+        if self.format == 'gdouble':
+            return [0] * 8
+        return [0] * VariableInteger.fixed_type_byte_size(self.private_format)
+
+
+    def build_sample_setter_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ''
+
+        translations = { 'lp'            : line_prefix,
+                         'public_format' : self.public_format }
+
+        template = (
+            '${lp}(${public_format}) 0,\n')
+        return string.Template(template).substitute(translations)
+
+
+    def build_printable_items(self, line_prefix, name, is_personal):
+        translations = { 'lp'       : line_prefix,
+                         'name'     : '"' + name + '"' if name else 'NULL',
+                         'format'   : self.format.upper().replace('-', '_'),
+                         'endian'   : self.endian,
+                         'personal' : 'TRUE' if (self.personal_info or is_personal) else 'FALSE',
+                         'size'     : self.guint_sized_size if self.guint_sized_size != '' else '0' }
+
+        item = '${lp}{ ${name}, QMI_TLV_PRINTABLE_FORMAT_${format}, QMI_TLV_PRINTABLE_VALUE_${value}, ${endian}, ${personal}, ${size}, 0, ${to_string} },\n'
+
+        if self.public_format == 'gboolean':
+            translations['value'] = 'BOOLEAN'
+            translations['to_string'] = 'NULL'
+            return string.Template(item).substitute(translations)
+
+        if self.public_format == self.private_format:
+            translations['value'] = 'NUMBER'
+            translations['to_string'] = 'NULL'
+            return string.Template(item).substitute(translations)
+
+        # Enums and flags are printed by a typed wrapper, see
+        # emit_printable_helpers()
+        translations['value'] = 'STRING'
+        translations['to_string'] = utils.build_underscore_name_from_camelcase(self.public_format) + '_build_printable_value'
+        return string.Template(item).substitute(translations)
+
+
+    def emit_printable_helpers(self, f):
+        if self.public_format == 'gboolean' or self.public_format == self.private_format:
+            return
+
+        if not TypeFactory.set_helpers_emitted('printable-value ' + self.public_format):
+            return
+
+        # Whether the public format is an enum or a flags type is only known
+        # by the preprocessor
+        public_type_underscore = utils.build_underscore_name_from_camelcase(self.public_format)
+        translations = { 'public_type_underscore'       : public_type_underscore,
+                         'public_type_underscore_upper' : public_type_underscore.upper(),
+                         'public_format'                : self.public_format }
+        template = (
+            '\n'
+            'static gchar *\n'
+            '${public_type_underscore}_build_printable_value (guint64 value)\n'
+            '{\n'
+            '#if defined  __${public_type_underscore_upper}_IS_ENUM__\n'
+            '    return g_strdup (${public_type_underscore}_get_string ((${public_format})value));\n'
+            '#elif defined  __${public_type_underscore_upper}_IS_FLAGS__\n'
+            '    return ${public_type_underscore}_build_string_from_mask ((${public_format})value);\n'
+            '#else\n'
+            '# error unexpected public format: ${public_format}\n'
+            '#endif\n'
+            '}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
     def build_variable_declaration(self, line_prefix, variable_name):
         translations = { 'lp'             : line_prefix,
                          'private_format' : self.private_format,
@@ -288,6 +459,34 @@ class VariableInteger(Variable):
         return string.Template(template).substitute(translations)
 
 
+    def build_visitor_declaration(self, line_prefix, variable_name):
+        if not self.visible:
+            return ""
+
+        translations = { 'lp'            : line_prefix,
+                         'public_format' : self.public_format,
+                         'name'          : variable_name }
+
+        template = (
+            '${lp}${public_format} ${name},\n')
+        return string.Template(template).substitute(translations)
+
+
+    def build_visitor_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ""
+
+        needs_cast = True if self.public_format != self.private_format else False
+        translations = { 'lp'       : line_prefix,
+                         'name'     : variable_name,
+                         'cast_ini' : '(' + self.public_format + ')(' if needs_cast else '',
+                         'cast_end' : ')' if needs_cast else '' }
+
+        template = (
+            '${lp}${cast_ini}${name}${cast_end},\n')
+        return string.Template(template).substitute(translations)
+
+
     def build_getter_documentation(self, line_prefix, variable_name):
         if not self.visible:
             return ""
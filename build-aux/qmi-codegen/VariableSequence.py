@@ -80,6 +80,26 @@ class VariableSequence(Variable):
             member['object'].emit_buffer_read(f, line_prefix, tlv_out, error, variable_name + '_' +  member['name'])
 
 
+    def emit_visitor_read(self, f, line_prefix, tlv_out, error, variable_name):
+        for member in self.members:
+            member['object'].emit_visitor_read(f, line_prefix, tlv_out, error, variable_name + '_' +  member['name'])
+
+
+    def emit_buffer_skip(self, f, line_prefix, tlv_out, error):
+        for member in self.members:
+            member['object'].emit_buffer_skip(f, line_prefix, tlv_out, error)
+
+
+    def fixed_wire_size(self):
+        size = 0
+        for member in self.members:
+            member_size = member['object'].fixed_wire_size()
+            if member_size is None:
+                return None
+            size += member_size
+        return size
+
+
     def emit_buffer_write(self, f, line_prefix, tlv_name, variable_name):
         for member in self.members:
             member['object'].emit_buffer_write(f, line_prefix, tlv_name, variable_name + '_' +  member['name'])
@@ -109,6 +129,86 @@ class VariableSequence(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    def emit_get_json(self, f, line_prefix, is_personal):
+        translations = { 'lp' : line_prefix }
+
+        template = (
+            '${lp}g_string_append_c (json, \'{\');\n')
+        f.write(string.Template(template).substitute(translations))
+
+        separator = ''
+        for member in self.members:
+            translations['variable_name'] = member['name']
+            translations['separator'] = separator
+            template = (
+                '${lp}g_string_append (json, "${separator}\\"${variable_name}\\":");\n')
+            f.write(string.Template(template).substitute(translations))
+
+            member['object'].emit_get_json(f, line_prefix, self.personal_info or is_personal)
+            separator = ','
+
+        template = (
+            '${lp}g_string_append_c (json, \'}\');\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def is_fixed_layout(self):
+        return all(member['object'].is_fixed_layout() for member in self.members)
+
+
+    def build_sample(self):
+        sample = []
+        for member in self.members:
+            sample += member['object'].build_sample()
+        return sample
+
+
+    def build_sample_declaration(self, line_prefix, variable_name):
+        built = ''
+        for member in self.members:
+            built += member['object'].build_sample_declaration(line_prefix, variable_name + '_' + member['name'])
+        return built
+
+
+    def emit_sample_setup(self, f, line_prefix, variable_name):
+        for member in self.members:
+            member['object'].emit_sample_setup(f, line_prefix, variable_name + '_' + member['name'])
+
+
+    def build_sample_setter_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ''
+
+        built = ''
+        for member in self.members:
+            built += member['object'].build_sample_setter_arguments(line_prefix, variable_name + '_' + member['name'])
+        return built
+
+
+    def emit_sample_teardown(self, f, line_prefix, variable_name):
+        for member in self.members:
+            member['object'].emit_sample_teardown(f, line_prefix, variable_name + '_' + member['name'])
+
+
+    def build_printable_items(self, line_prefix, name, is_personal):
+        # Nested sequences are not supported in table-driven printables
+        if name:
+            return None
+
+        built = ''
+        for member in self.members:
+            member_items = member['object'].build_printable_items(line_prefix, member['name'], self.personal_info or is_personal)
+            if member_items is None:
+                return None
+            built += member_items
+        return built
+
+
+    def emit_printable_helpers(self, f):
+        for member in self.members:
+            member['object'].emit_printable_helpers(f)
+
+
     def build_variable_declaration(self, line_prefix, variable_name):
         built = ''
         for member in self.members:
@@ -116,6 +216,13 @@ class VariableSequence(Variable):
         return built
 
 
+    def build_visitor_variable_declaration(self, line_prefix, variable_name):
+        built = ''
+        for member in self.members:
+            built += member['object'].build_visitor_variable_declaration(line_prefix, variable_name + '_' + member['name'])
+        return built
+
+
     def build_variable_declaration_gir(self, line_prefix, variable_name):
         built = ''
         for member in self.members:
@@ -147,6 +254,29 @@ class VariableSequence(Variable):
         return built
 
 
+    def build_visitor_declaration(self, line_prefix, variable_name):
+        if not self.visible:
+            return ""
+
+        built = ''
+        for member in self.members:
+            member_declaration = member['object'].build_visitor_declaration(line_prefix, variable_name + '_' + member['name'])
+            if member_declaration is None:
+                return None
+            built += member_declaration
+        return built
+
+
+    def build_visitor_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ""
+
+        built = ''
+        for member in self.members:
+            built += member['object'].build_visitor_arguments(line_prefix, variable_name + '_' + member['name'])
+        return built
+
+
     def build_getter_documentation(self, line_prefix, variable_name):
         if not self.visible:
             return ""
@@ -23,6 +23,12 @@ import string
 import utils
 from Variable import Variable
 
+"""
+Strings with a 'max-size' up to this value are stored inline in the bundles,
+instead of in heap
+"""
+INLINE_MAX_SIZE = 256
+
 """
 Variable type for Strings ('string' format)
 """
@@ -50,6 +56,7 @@ class VariableString(Variable):
             self.n_size_prefix_bytes = 0
             self.fixed_size = dictionary['fixed-size']
             self.max_size = ''
+            self.is_inline = False
         else:
             self.is_fixed_size = False
             self.fixed_size = '-1'
@@ -76,11 +83,16 @@ class VariableString(Variable):
                 self.length_prefix_size = 8
                 self.n_size_prefix_bytes = 1
             self.max_size = dictionary['max-size'] if 'max-size' in dictionary else ''
+            # Short enough bounded strings are stored inline, unless flagged
+            # as public afterwards
+            self.is_inline = self.max_size != '' and int(self.max_size) <= INLINE_MAX_SIZE
+            if self.is_inline:
+                self.needs_dispose = False
 
 
     def emit_buffer_read(self, f, line_prefix, tlv_out, error, variable_name):
         translations = { 'lp'            : line_prefix,
-                         'tlv_out'       : tlv_out,
+                         'read_failure'  : self.build_read_failure(tlv_out),
                          'variable_name' : variable_name,
                          'error'         : error }
 
@@ -96,20 +108,26 @@ class VariableString(Variable):
                     '${lp}if (!qmi_message_tlv_read_fixed_size_string (message, init_offset, &offset, ${fixed_size}, &${variable_name}[0], ${error})) {\n'
                     '${lp}    g_free (${variable_name});\n'
                     '${lp}    ${variable_name} = NULL;\n'
-                    '${lp}    goto ${tlv_out};\n'
+                    '${lp}    ${read_failure}\n'
                     '${lp}}\n'
                     '${lp}${variable_name}[${fixed_size}] = \'\\0\';\n')
             else:
                 template = (
                     '${lp}if (!qmi_message_tlv_read_fixed_size_string (message, init_offset, &offset, ${fixed_size}, &${variable_name}[0], ${error}))\n'
-                    '${lp}    goto ${tlv_out};\n'
+                    '${lp}    ${read_failure}\n'
                     '${lp}${variable_name}[${fixed_size}] = \'\\0\';\n')
+        elif self.is_inline:
+            translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
+            translations['max_size'] = self.max_size
+            template = (
+                '${lp}if (!qmi_message_tlv_read_string_to_buffer (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &${variable_name}[0], ${error}))\n'
+                '${lp}    ${read_failure}\n')
         else:
             translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
             translations['max_size'] = self.max_size if self.max_size != '' else '0'
             template = (
                 '${lp}if (!qmi_message_tlv_read_string (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &(${variable_name}), ${error}))\n'
-                '${lp}    goto ${tlv_out};\n')
+                '${lp}    ${read_failure}\n')
         f.write(string.Template(template).substitute(translations))
 
 
@@ -129,9 +147,10 @@ class VariableString(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
-    def emit_get_printable(self, f, line_prefix, is_personal):
-        translations = { 'lp' : line_prefix }
-
+    """
+    Builds the code reading the string into a 'tmp' variable in a new block
+    """
+    def __build_read_tmp(self, translations):
         if self.is_fixed_size:
             translations['fixed_size'] = self.fixed_size
             translations['fixed_size_plus_one'] = int(self.fixed_size) + 1
@@ -142,6 +161,17 @@ class VariableString(Variable):
                 '\n'
                 '${lp}    if (!qmi_message_tlv_read_fixed_size_string (message, init_offset, &offset, ${fixed_size}, &tmp[0], &error))\n'
                 '${lp}        goto out;\n')
+        elif self.is_inline:
+            translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
+            translations['max_size'] = self.max_size
+            translations['max_size_plus_one'] = int(self.max_size) + 1
+            template = (
+                '\n'
+                '${lp}{\n'
+                '${lp}    gchar tmp[${max_size_plus_one}] = { \'\\0\' };\n'
+                '\n'
+                '${lp}    if (!qmi_message_tlv_read_string_to_buffer (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &tmp[0], &error))\n'
+                '${lp}        goto out;\n')
         else:
             translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
             translations['max_size'] = self.max_size if self.max_size != '' else '0'
@@ -152,6 +182,12 @@ class VariableString(Variable):
                 '\n'
                 '${lp}    if (!qmi_message_tlv_read_string (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &tmp, &error))\n'
                 '${lp}        goto out;\n')
+        return template
+
+
+    def emit_get_printable(self, f, line_prefix, is_personal):
+        translations = { 'lp' : line_prefix }
+        template = self.__build_read_tmp(translations)
 
         if self.personal_info or is_personal:
             translations['if_show_field'] = 'if (qmi_utils_get_show_personal_info ()) '
@@ -174,6 +210,92 @@ class VariableString(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    def emit_get_json(self, f, line_prefix, is_personal):
+        translations = { 'lp' : line_prefix }
+        template = self.__build_read_tmp(translations)
+
+        if self.personal_info or is_personal:
+            translations['if_show_field'] = 'if (qmi_utils_get_show_personal_info ()) '
+        else:
+            translations['if_show_field'] = ''
+
+        template += (
+            '${lp}    ${if_show_field}{\n'
+            '${lp}        qmi_helpers_json_append_string (json, tmp);\n')
+
+        if self.personal_info or is_personal:
+            template += (
+                '${lp}    } else {\n'
+                '${lp}        g_string_append (json, "\\"###\\"");\n')
+
+        template += (
+            '${lp}    }\n'
+            '${lp}}\n')
+
+        f.write(string.Template(template).substitute(translations))
+
+
+    """
+    Representative contents of the string, within its size limits
+    """
+    def __build_sample_string(self):
+        if self.is_fixed_size:
+            return '0' * int(self.fixed_size)
+        if self.max_size != '':
+            return 'sample'[:int(self.max_size)]
+        return 'sample'
+
+
+    def build_sample(self):
+        sample = [ord(c) for c in self.__build_sample_string()]
+        if self.n_size_prefix_bytes == 0:
+            return sample
+        return list(len(sample).to_bytes(self.n_size_prefix_bytes, 'little')) + sample
+
+
+    def build_sample_setter_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ''
+
+        translations = { 'lp'     : line_prefix,
+                         'sample' : self.__build_sample_string() }
+
+        template = (
+            '${lp}"${sample}",\n')
+        return string.Template(template).substitute(translations)
+
+
+    def emit_sample_value(self, f, line_prefix, variable_name):
+        translations = { 'lp'            : line_prefix,
+                         'variable_name' : variable_name,
+                         'sample'        : self.__build_sample_string() }
+
+        # Struct members and array elements are never inline, and the setters
+        # copy them, so a constant string can be given
+        template = (
+            '${lp}${variable_name} = (gchar *) "${sample}";\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def build_printable_items(self, line_prefix, name, is_personal):
+        translations = { 'lp'       : line_prefix,
+                         'name'     : '"' + name + '"' if name else 'NULL',
+                         'personal' : 'TRUE' if (self.personal_info or is_personal) else 'FALSE' }
+
+        if self.is_fixed_size:
+            translations['format'] = 'FIXED_SIZE_STRING'
+            translations['size'] = self.fixed_size
+            translations['max_size'] = '0'
+        else:
+            translations['format'] = 'STRING'
+            translations['size'] = self.n_size_prefix_bytes
+            translations['max_size'] = self.max_size if self.max_size != '' else '0'
+
+        template = (
+            '${lp}{ ${name}, QMI_TLV_PRINTABLE_FORMAT_${format}, QMI_TLV_PRINTABLE_VALUE_NUMBER, QMI_ENDIAN_LITTLE, ${personal}, ${size}, ${max_size}, NULL },\n')
+        return string.Template(template).substitute(translations)
+
+
     def build_variable_declaration(self, line_prefix, variable_name):
         translations = { 'lp'   : line_prefix,
                          'name' : variable_name }
@@ -182,6 +304,10 @@ class VariableString(Variable):
             translations['fixed_size_plus_one'] = int(self.fixed_size) + 1
             template = (
                 '${lp}gchar ${name}[${fixed_size_plus_one}];\n')
+        elif self.is_inline:
+            translations['max_size_plus_one'] = int(self.max_size) + 1
+            template = (
+                '${lp}gchar ${name}[${max_size_plus_one}];\n')
         else:
             template = (
                 '${lp}gchar *${name};\n')
@@ -211,6 +337,90 @@ class VariableString(Variable):
         return string.Template(template).substitute(translations)
 
 
+    """
+    Strings are given to visitors as found in the message: neither validated,
+    converted nor NUL-terminated
+    """
+    def build_visitor_declaration(self, line_prefix, variable_name):
+        if not self.visible:
+            return ""
+
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = (
+            '${lp}const gchar *${name},\n'
+            '${lp}gsize ${name}_length,\n')
+        return string.Template(template).substitute(translations)
+
+
+    def build_visitor_arguments(self, line_prefix, variable_name):
+        if not self.visible:
+            return ""
+
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = (
+            '${lp}${name},\n'
+            '${lp}${name}_length,\n')
+        return string.Template(template).substitute(translations)
+
+
+    def build_visitor_variable_declaration(self, line_prefix, variable_name):
+        translations = { 'lp'   : line_prefix,
+                         'name' : variable_name }
+
+        template = (
+            '${lp}const gchar *${name};\n'
+            '${lp}gsize ${name}_length;\n')
+        return string.Template(template).substitute(translations)
+
+
+    def emit_visitor_read(self, f, line_prefix, tlv_out, error, variable_name):
+        translations = { 'lp'            : line_prefix,
+                         'read_failure'  : self.build_read_failure(tlv_out),
+                         'variable_name' : variable_name,
+                         'error'         : error }
+
+        if self.is_fixed_size:
+            translations['fixed_size'] = self.fixed_size
+            template = (
+                '${lp}if (!qmi_message_tlv_read_borrowed (message, init_offset, &offset, ${fixed_size}, 1, (const guint8 **)&(${variable_name}), ${error}))\n'
+                '${lp}    ${read_failure}\n'
+                '${lp}${variable_name}_length = ${fixed_size};\n')
+        else:
+            translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
+            translations['max_size'] = self.max_size if self.max_size != '' else '0'
+            template = (
+                '${lp}if (!qmi_message_tlv_read_string_borrowed (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &(${variable_name}), &(${variable_name}_length), ${error}))\n'
+                '${lp}    ${read_failure}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def emit_buffer_skip(self, f, line_prefix, tlv_out, error):
+        translations = { 'lp'           : line_prefix,
+                         'read_failure' : self.build_read_failure(tlv_out),
+                         'error'        : error }
+
+        if self.is_fixed_size:
+            translations['fixed_size'] = self.fixed_size
+            template = (
+                '${lp}if (!qmi_message_tlv_read_borrowed (message, init_offset, &offset, ${fixed_size}, 1, NULL, ${error}))\n'
+                '${lp}    ${read_failure}\n')
+        else:
+            translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
+            translations['max_size'] = self.max_size if self.max_size != '' else '0'
+            template = (
+                '${lp}if (!qmi_message_tlv_read_string_borrowed (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, NULL, NULL, ${error}))\n'
+                '${lp}    ${read_failure}\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def fixed_wire_size(self):
+        return int(self.fixed_size) if self.is_fixed_size else None
+
+
     def build_getter_documentation(self, line_prefix, variable_name):
         if not self.visible:
             return ""
@@ -302,9 +512,14 @@ class VariableString(Variable):
                     '${lp}                 "Input variable \'${from}\' must be less than ${max_size} characters long");\n'
                     '${lp}    return FALSE;\n'
                     '${lp}}\n')
-            template += (
-                '${lp}g_free (${to});\n'
-                '${lp}${to} = g_strdup (${from} ? ${from} : "");\n')
+            if self.is_inline:
+                translations['max_size_plus_one'] = int(self.max_size) + 1
+                template += (
+                    '${lp}g_strlcpy (${to}, ${from} ? ${from} : "", ${max_size_plus_one});\n')
+            else:
+                template += (
+                    '${lp}g_free (${to});\n'
+                    '${lp}${to} = g_strdup (${from} ? ${from} : "");\n')
 
         return string.Template(template).substitute(translations)
 
@@ -328,8 +543,8 @@ class VariableString(Variable):
 
 
     def build_dispose(self, line_prefix, variable_name):
-        # Fixed-size strings don't need dispose
-        if self.is_fixed_size and not self.public:
+        # Fixed-size and inline strings don't need dispose
+        if (self.is_fixed_size and not self.public) or self.is_inline:
             return ''
 
         translations = { 'lp'            : line_prefix,
@@ -361,6 +576,8 @@ class VariableString(Variable):
     def flag_public(self):
         # Call the parent method
         Variable.flag_public(self)
-        # Fixed-sized strings will need dispose if they are in the public header
-        if self.is_fixed_size:
+        # Fixed-sized and inline strings will need dispose if they are in the
+        # public header, as they're given as pointers there
+        if self.is_fixed_size or self.is_inline:
             self.needs_dispose = True
+        self.is_inline = False
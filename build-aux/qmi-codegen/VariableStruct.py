@@ -252,6 +252,21 @@ class VariableStruct(Variable):
             member['object'].emit_buffer_read(f, line_prefix, tlv_out, error, variable_name + '.' +  member['name'])
 
 
+    def emit_buffer_skip(self, f, line_prefix, tlv_out, error):
+        for member in self.members:
+            member['object'].emit_buffer_skip(f, line_prefix, tlv_out, error)
+
+
+    def fixed_wire_size(self):
+        size = 0
+        for member in self.members:
+            member_size = member['object'].fixed_wire_size()
+            if member_size is None:
+                return None
+            size += member_size
+        return size
+
+
     def emit_buffer_write(self, f, line_prefix, tlv_name, variable_name):
         for member in self.members:
             member['object'].emit_buffer_write(f, line_prefix, tlv_name, variable_name + '.' +  member['name'])
@@ -281,6 +296,46 @@ class VariableStruct(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    def emit_get_json(self, f, line_prefix, is_personal):
+        translations = { 'lp' : line_prefix }
+
+        template = (
+            '${lp}g_string_append_c (json, \'{\');\n')
+        f.write(string.Template(template).substitute(translations))
+
+        separator = ''
+        for member in self.members:
+            translations['variable_name'] = member['name']
+            translations['separator'] = separator
+            template = (
+                '${lp}g_string_append (json, "${separator}\\"${variable_name}\\":");\n')
+            f.write(string.Template(template).substitute(translations))
+
+            member['object'].emit_get_json(f, line_prefix, self.personal_info or is_personal)
+            separator = ','
+
+        template = (
+            '${lp}g_string_append_c (json, \'}\');\n')
+        f.write(string.Template(template).substitute(translations))
+
+
+    def build_sample(self):
+        sample = []
+        for member in self.members:
+            sample += member['object'].build_sample()
+        return sample
+
+
+    def emit_sample_value(self, f, line_prefix, variable_name):
+        for member in self.members:
+            member['object'].emit_sample_value(f, line_prefix, variable_name + '.' + member['name'])
+
+
+    def emit_sample_dispose(self, f, line_prefix, variable_name):
+        for member in self.members:
+            member['object'].emit_sample_dispose(f, line_prefix, variable_name + '.' + member['name'])
+
+
     def build_dispose(self, line_prefix, variable_name):
         translations = { 'lp'            : line_prefix,
                          'underscore'    : utils.build_underscore_name(self.struct_type_name),
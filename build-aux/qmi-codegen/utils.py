@@ -21,6 +21,24 @@
 import string
 import re
 
+"""
+Whether output bundles decode their optional fields on first access instead
+of when the message is parsed (--lazy-output)
+"""
+lazy_output = False
+
+"""
+Whether TLV printables are built from constant item tables instead of being
+open-coded (--table-driven-printables)
+"""
+table_driven_printables = False
+
+"""
+Whether visitor types and methods are generated for responses and indications
+(--message-visitors)
+"""
+message_visitors = False
+
 """
 Add the common copyright header to the given file
 """
@@ -111,6 +129,7 @@ Write the common source file start chunk
 def add_source_start(f, output_name):
     template = string.Template (
         "\n"
+        "#include <math.h>\n"
         "#include <string.h>\n"
         "\n"
         "#include \"${name}.h\"\n"
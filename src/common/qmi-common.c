@@ -6,40 +6,90 @@
 
 #include "qmi-common.h"
 
-#include <stdio.h>
+#include <string.h>
 
 /*****************************************************************************/
 
+/* Hexadecimal representation of every byte value, 2 chars each */
+static const gchar hex_pairs[] =
+    "000102030405060708090A0B0C0D0E0F"
+    "101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F"
+    "303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F"
+    "505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F"
+    "707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F"
+    "909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+    "B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+    "D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+    "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+gsize
+qmi_common_str_hex_to_buffer (gconstpointer  mem,
+                              gsize          size,
+                              gchar          delimiter,
+                              gchar         *out)
+{
+    const guint8 *data = mem;
+    gchar        *p = out;
+    gsize         i;
+
+    if (size == 0) {
+        out[0] = '\0';
+        return 0;
+    }
+
+    /* Every byte except for the last one is followed by the delimiter, and
+     * the NUL char takes the place of the last delimiter */
+    for (i = 0; i < size - 1; i++) {
+        memcpy (p, &hex_pairs[data[i] * 2], 2);
+        p[2] = delimiter;
+        p += 3;
+    }
+    memcpy (p, &hex_pairs[data[i] * 2], 2);
+    p[2] = '\0';
+
+    return (p + 2) - out;
+}
+
+void
+qmi_common_str_hex_append (GString       *str,
+                           gconstpointer  mem,
+                           gsize          size,
+                           gchar          delimiter)
+{
+    gsize len;
+
+    if (size == 0)
+        return;
+
+    len = str->len;
+    g_string_set_size (str, len + 3 * size - 1);
+    qmi_common_str_hex_to_buffer (mem, size, delimiter, &str->str[len]);
+}
+
 gchar *
 qmi_common_str_hex (gconstpointer mem,
                     gsize         size,
                     gchar         delimiter)
 {
-    const guint8 *data = mem;
-    gsize         i;
-    gsize         j;
-    gsize         new_str_length;
-    gchar        *new_str;
+    gchar *new_str;
+
+    /* An empty input has always been reported as NULL */
+    if (size == 0)
+        return NULL;
 
-    /* Get new string length. If input string has N bytes, we need:
+    /* If input string has N bytes, we need:
      * - 1 byte for last NUL char
      * - 2N bytes for hexadecimal char representation of each byte...
      * - N-1 bytes for the separator ':'
      * So... a total of (1+2N+N-1) = 3N bytes are needed... */
-    new_str_length =  3 * size;
-
-    /* Allocate memory for new array and initialize contents to NUL */
-    new_str = g_malloc0 (new_str_length);
-
-    /* Print hexadecimal representation of each byte... */
-    for (i = 0, j = 0; i < size; i++, j += 3) {
-        /* Print character in output string... */
-        snprintf (&new_str[j], 3, "%02X", data[i]);
-        /* And if needed, add separator */
-        if (i != (size - 1) )
-            new_str[j + 2] = delimiter;
-    }
-
-    /* Set output string */
+    new_str = g_malloc (3 * size);
+    qmi_common_str_hex_to_buffer (mem, size, delimiter, new_str);
     return new_str;
 }
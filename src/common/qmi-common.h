@@ -9,8 +9,21 @@
 
 #include <glib.h>
 
-gchar *qmi_common_str_hex (gconstpointer mem,
-                           gsize         size,
-                           gchar         delimiter);
+/* Returns a newly allocated string, or NULL if size is 0 */
+gchar *qmi_common_str_hex           (gconstpointer  mem,
+                                     gsize          size,
+                                     gchar          delimiter);
+
+/* The output buffer must be at least 3*size bytes long (1 byte if size is 0),
+ * the length of the NUL-terminated string written is returned */
+gsize  qmi_common_str_hex_to_buffer (gconstpointer  mem,
+                                     gsize          size,
+                                     gchar          delimiter,
+                                     gchar         *out);
+
+void   qmi_common_str_hex_append    (GString       *str,
+                                     gconstpointer  mem,
+                                     gsize          size,
+                                     gchar          delimiter);
 
 #endif /* _COMMON_QMI_COMMON_H_ */
@@ -145,19 +145,31 @@ guint16
 qmi_client_get_next_transaction_id (QmiClient *self)
 {
     guint16 next;
+    guint16 max_id;
 
     g_return_val_if_fail (QMI_IS_CLIENT (self), 0);
 
+    /* Don't go further than 8bits in the CTL service */
+    max_id = (self->priv->service == QMI_SERVICE_CTL ? G_MAXUINT8 : G_MAXUINT16);
+
+    /* Skip the IDs still used by in-flight or queued transactions of this
+     * same client */
     next = self->priv->transaction_id;
+    if (self->priv->device) {
+        next = __qmi_device_get_free_transaction_id (self->priv->device,
+                                                     self->priv->service,
+                                                     self->priv->cid,
+                                                     next,
+                                                     max_id);
+        if (!next)
+            return 0;
+    }
 
-    /* Don't go further than 8bits in the CTL service */
-    if ((self->priv->service == QMI_SERVICE_CTL &&
-         self->priv->transaction_id == G_MAXUINT8) ||
-        self->priv->transaction_id == G_MAXUINT16)
+    if (next >= max_id)
         /* Reset! */
         self->priv->transaction_id = 0x01;
     else
-        self->priv->transaction_id++;
+        self->priv->transaction_id = next + 1;
 
     return next;
 }
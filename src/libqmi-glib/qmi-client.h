@@ -264,7 +264,10 @@ gboolean qmi_client_check_version (QmiClient *self,
  * Acquire the next transaction ID of this #QmiClient.
  * The internal transaction ID gets incremented.
  *
- * Returns: the next transaction ID.
+ * IDs used by transactions of this same client still in flight or queued
+ * are skipped.
+ *
+ * Returns: the next transaction ID, or 0 if all of them are in use.
  *
  * Since: 1.0
  */
@@ -62,14 +62,17 @@
 #include "qmi-ims.h"
 #include "qmi-imsp.h"
 #include "qmi-imsa.h"
+#include "qmi-imsdcm.h"
 #include "qmi-ssc.h"
 #include "qmi-utils.h"
 #include "qmi-helpers.h"
+#include "qmi-sysfs-attribute.h"
 #include "qmi-error-types.h"
 #include "qmi-enum-types.h"
 #include "qmi-flag-types.h"
 #include "qmi-proxy.h"
 #include "qmi-net-port-manager-qmiwwan.h"
+#include "qmi-link-inventory.h"
 #include "qmi-version.h"
 
 #if QMI_QRTR_SUPPORTED
@@ -97,6 +100,8 @@ enum {
     PROP_PROXY_PATH,
     PROP_WWAN_IFACE,
     PROP_CONSECUTIVE_TIMEOUTS,
+    PROP_VERSION_INFO_CACHE_DIR,
+    PROP_MAX_IN_FLIGHT_PER_CLIENT,
 #if QMI_QRTR_SUPPORTED
     PROP_NODE,
 #endif
@@ -106,6 +111,7 @@ enum {
 enum {
     SIGNAL_INDICATION,
     SIGNAL_REMOVED,
+    SIGNAL_LINKS_CHANGED,
     SIGNAL_LAST
 };
 
@@ -124,9 +130,17 @@ struct _QmiDevicePrivate {
     gboolean no_wwan_check;
     gchar *wwan_iface;
 
+    /* Expected data format attributes of the WWAN iface */
+    QmiSysfsAttribute *raw_ip_attribute;
+    QmiSysfsAttribute *pass_through_attribute;
+
     /* Information necessary for data port */
     QmiNetPortManager *net_port_manager;
 
+    /* Inventory of links, kept across net port managers */
+    QmiLinkInventory *link_inventory;
+    gboolean link_inventory_unavailable;
+
     /* Implicit CTL client */
     QmiClientCtl *client_ctl;
     guint sync_indication_id;
@@ -145,11 +159,25 @@ struct _QmiDevicePrivate {
     /* HT to keep track of ongoing transactions */
     GHashTable *transactions;
 
+    /* HT of the transaction IDs in use by each client */
+    GHashTable *transaction_ids;
+
     /* HT of clients that want to get indications */
     GHashTable *registered_clients;
 
     /* Number of consecutive timeouts detected */
     guint consecutive_timeouts;
+
+    /* Persistent version info cache */
+    gchar *version_info_cache_dir;
+
+    /* Background validation of the cached version info, if running */
+    GCancellable *version_info_validate_cancellable;
+
+    /* Per-client flow control */
+    guint       max_in_flight_per_client;
+    GHashTable *flow_control;
+    GSource    *flow_control_dispatch_source;
 };
 
 #if QMI_QRTR_SUPPORTED
@@ -164,6 +192,16 @@ typedef struct {
     gpointer   key;
 } TransactionWaitContext;
 
+/* Credits of a given client; transactions are queued in the client when
+ * there are already max_in_flight_per_client transactions in flight */
+typedef struct {
+    QmiDevice *self;
+    guint      n_in_flight;
+    GQueue     pending;
+    /* set once the client is released, freed with the last transaction */
+    gboolean   released;
+} FlowControlClient;
+
 typedef struct {
     QmiMessage             *message;
     QmiMessageContext      *message_context;
@@ -180,8 +218,15 @@ typedef struct {
     QmiDeviceCommandAbortableParseResponseFn  abort_parse_response_fn;
     gpointer                                  abort_user_data;
     GDestroyNotify                            abort_user_data_free;
+
+    /* flow control support */
+    FlowControlClient *flow_control;       /* set while holding a credit */
+    FlowControlClient *flow_control_queue; /* set while queued */
+    gint64             deadline;           /* only needed while queued, 0 if no timeout */
 } Transaction;
 
+static void flow_control_release (FlowControlClient *fc);
+
 static Transaction *
 transaction_new (QmiDevice           *self,
                  QmiMessage          *message,
@@ -248,6 +293,9 @@ transaction_complete_and_free (Transaction  *tr,
     if (tr->abort_user_data && tr->abort_user_data_free)
         tr->abort_user_data_free (tr->abort_user_data);
 
+    if (tr->flow_control)
+        flow_control_release (tr->flow_control);
+
     g_simple_async_result_complete_in_idle (tr->result);
     g_object_unref (tr->result);
     if (tr->message_context)
@@ -256,24 +304,133 @@ transaction_complete_and_free (Transaction  *tr,
     g_slice_free (Transaction, tr);
 }
 
+static inline gpointer
+build_transaction_key_full (guint8  service,
+                            guint8  client_id,
+                            guint16 transaction_id)
+{
+    /* We're putting a 32 bit value into a gpointer */
+    return GUINT_TO_POINTER ((((service << 8) | client_id) << 16) | transaction_id);
+}
+
 static inline gpointer
 build_transaction_key (QmiMessage *message)
 {
-    gpointer key;
-    guint8 service;
-    guint8 client_id;
-    guint16 transaction_id;
+    return build_transaction_key_full ((guint8)qmi_message_get_service (message),
+                                       qmi_message_get_client_id (message),
+                                       qmi_message_get_transaction_id (message));
+}
 
-    service = (guint8)qmi_message_get_service (message);
-    client_id = qmi_message_get_client_id (message);
-    transaction_id = qmi_message_get_transaction_id (message);
+/*****************************************************************************/
+/* Transaction IDs in use (private)
+ *
+ * The transaction IDs of the transactions of each client that are either in
+ * flight or queued are flagged in a bitmap, with one bit per possible ID (256
+ * in the CTL service, 65536 in all others), so that new IDs are chosen without
+ * colliding with them. Bitmaps are freed as soon as no ID is in use. */
 
-    /* We're putting a 32 bit value into a gpointer */
-    key = GUINT_TO_POINTER ((((service << 8) | client_id) << 16) | transaction_id);
+typedef struct {
+    guint    n_in_use;
+    guint    n_ids;
+    guint32 *bits;
+} TransactionIds;
+
+static void
+transaction_ids_free (TransactionIds *ids)
+{
+    g_free (ids->bits);
+    g_slice_free (TransactionIds, ids);
+}
+
+static inline gpointer
+build_transaction_ids_key (guint8 service,
+                           guint8 client_id)
+{
+    return GUINT_TO_POINTER ((service << 8) | client_id);
+}
+
+/* Flags or clears the ID of the transaction with the given key */
+static void
+transaction_ids_update (QmiDevice     *self,
+                        gconstpointer  transaction_key,
+                        gboolean       in_use)
+{
+    TransactionIds *ids;
+    gpointer        key;
+    guint8          service;
+    guint16         transaction_id;
+    guint32         mask;
+
+    /* The upper bits of the transaction key are the service and client ID */
+    service = (guint8) (GPOINTER_TO_UINT (transaction_key) >> 24);
+    key = build_transaction_ids_key (service, (guint8) (GPOINTER_TO_UINT (transaction_key) >> 16));
+    transaction_id = (guint16) GPOINTER_TO_UINT (transaction_key);
+    mask = 1u << (transaction_id % 32);
+
+    ids = g_hash_table_lookup (self->priv->transaction_ids, key);
+
+    if (!in_use) {
+        if (ids && transaction_id < ids->n_ids && (ids->bits[transaction_id / 32] & mask)) {
+            ids->bits[transaction_id / 32] &= ~mask;
+            if (--ids->n_in_use == 0)
+                g_hash_table_remove (self->priv->transaction_ids, key);
+        }
+        return;
+    }
+
+    /* ID 0 is never assigned, and raw messages may come with IDs out of the
+     * range of the service */
+    if (transaction_id == 0 || (service == QMI_SERVICE_CTL && transaction_id > G_MAXUINT8))
+        return;
+
+    if (!ids) {
+        ids = g_slice_new0 (TransactionIds);
+        ids->n_ids = (service == QMI_SERVICE_CTL ? G_MAXUINT8 : G_MAXUINT16) + 1;
+        ids->bits = g_new0 (guint32, ids->n_ids / 32);
+        g_hash_table_insert (self->priv->transaction_ids, key, ids);
+    }
+
+    if (!(ids->bits[transaction_id / 32] & mask)) {
+        ids->bits[transaction_id / 32] |= mask;
+        ids->n_in_use++;
+    }
+}
 
-    return key;
+guint16
+__qmi_device_get_free_transaction_id (QmiDevice  *self,
+                                      QmiService  service,
+                                      guint8      cid,
+                                      guint16     first,
+                                      guint16     max_id)
+{
+    TransactionIds *ids;
+    guint           id;
+
+    id = (first >= 0x01 && first <= max_id) ? first : 0x01;
+
+    ids = g_hash_table_lookup (self->priv->transaction_ids, build_transaction_ids_key ((guint8)service, cid));
+    if (!ids)
+        return (guint16) id;
+    if (ids->n_in_use >= max_id)
+        return 0;
+
+    /* There is at least one ID not in use; look for the first one from the
+     * given one on, wrapping to 1 after max_id and skipping whole words with
+     * all IDs in use */
+    while (TRUE) {
+        if (ids->bits[id / 32] == G_MAXUINT32)
+            id = (id | 31) + 1;
+        else if (!(ids->bits[id / 32] & (1u << (id % 32))))
+            return (guint16) id;
+        else
+            id++;
+        if (id > max_id)
+            id = 0x01;
+    }
 }
 
+/*****************************************************************************/
+
 static Transaction *
 device_peek_transaction (QmiDevice *self,
                          gconstpointer key)
@@ -289,8 +446,10 @@ device_release_transaction (QmiDevice *self,
 
     /* If found, remove it from the HT */
     tr = device_peek_transaction (self, key);
-    if (tr)
+    if (tr) {
         g_hash_table_remove (self->priv->transactions, key);
+        transaction_ids_update (self, key, FALSE);
+    }
 
     return tr;
 }
@@ -349,6 +508,19 @@ transaction_abort_ready (QmiDevice    *self,
         qmi_message_unref (abort_response);
 }
 
+static void device_command (QmiDevice                                *self,
+                            QmiMessage                               *message,
+                            QmiMessageContext                        *message_context,
+                            guint                                     timeout,
+                            QmiDeviceCommandAbortableBuildRequestFn   abort_build_request_fn,
+                            QmiDeviceCommandAbortableParseResponseFn  abort_parse_response_fn,
+                            gpointer                                  abort_user_data,
+                            GDestroyNotify                            abort_user_data_free,
+                            gboolean                                  flow_controlled,
+                            GCancellable                             *cancellable,
+                            GAsyncReadyCallback                       callback,
+                            gpointer                                  user_data);
+
 static void
 transaction_abort (QmiDevice   *self,
                    Transaction *tr,
@@ -407,13 +579,19 @@ transaction_abort (QmiDevice   *self,
     tr->abort_error = abort_error_take;
     tr->abort_cancellable = g_cancellable_new ();
 
-    qmi_device_command_full (self,
-                             abort_request,
-                             NULL,
-                             30,
-                             tr->abort_cancellable,
-                             (GAsyncReadyCallback) transaction_abort_ready,
-                             tr->wait_ctx->key);
+    /* The abort request must not be queued behind the transaction it aborts */
+    device_command (self,
+                    abort_request,
+                    NULL,
+                    30,
+                    NULL,
+                    NULL,
+                    NULL,
+                    NULL,
+                    FALSE,
+                    tr->abort_cancellable,
+                    (GAsyncReadyCallback) transaction_abort_ready,
+                    tr->wait_ctx->key);
 
     qmi_message_unref (abort_request);
 }
@@ -523,6 +701,7 @@ device_store_transaction (QmiDevice *self,
 
     /* Keep in the HT */
     g_hash_table_insert (self->priv->transactions, key, tr);
+    transaction_ids_update (self, key, TRUE);
 
     return TRUE;
 }
@@ -535,6 +714,278 @@ device_match_transaction (QmiDevice *self,
     return device_release_transaction (self, build_transaction_key (message));
 }
 
+/*****************************************************************************/
+/* Per-client flow control (private)
+ *
+ * When a maximum number of in-flight transactions per client is configured,
+ * each client gets that number of credits. A transaction takes one credit
+ * while it is tracked, and requests exceeding the limit are queued in order
+ * until one of the in-flight transactions of the same client completes.
+ * Queued requests may time out or be cancelled before being sent, and they
+ * fail right away if the device is closed or the client released.
+ * CTL requests and abort requests are never queued. */
+
+static void device_command_send (QmiDevice   *self,
+                                 Transaction *tr,
+                                 guint        timeout);
+
+static inline gpointer
+build_flow_control_key (QmiService service,
+                        guint8     cid)
+{
+    return GUINT_TO_POINTER ((service << 8) | cid);
+}
+
+static void
+flow_control_client_free (FlowControlClient *fc)
+{
+    /* Queued transactions keep a reference to the device */
+    g_assert (fc->n_in_flight == 0);
+    g_assert (g_queue_is_empty (&fc->pending));
+    g_slice_free (FlowControlClient, fc);
+}
+
+static void
+flow_control_unqueue (Transaction *tr)
+{
+    g_assert (tr->flow_control_queue);
+    g_queue_remove (&tr->flow_control_queue->pending, tr);
+    transaction_ids_update (tr->flow_control_queue->self, build_transaction_key (tr->message), FALSE);
+    tr->flow_control_queue = NULL;
+
+    /* The timeout and cancellation of the request are setup again when it is
+     * stored in the tracking table */
+    if (tr->timeout_source) {
+        g_source_destroy (tr->timeout_source);
+        tr->timeout_source = NULL;
+    }
+    if (tr->cancellable_id) {
+        g_cancellable_disconnect (tr->cancellable, tr->cancellable_id);
+        tr->cancellable_id = 0;
+    }
+}
+
+static gboolean
+flow_control_queued_timed_out (Transaction *tr)
+{
+    QmiDevice *self;
+    GError    *error;
+
+    self = tr->flow_control_queue->self;
+    tr->timeout_source = NULL;
+    flow_control_unqueue (tr);
+
+    g_debug ("[%s] queued transaction 0x%x timed out before being sent",
+             qmi_file_get_path_display (self->priv->file),
+             qmi_message_get_transaction_id (tr->message));
+
+    /* The request was never sent, so there is nothing to abort */
+    error = g_error_new (QMI_CORE_ERROR, QMI_CORE_ERROR_TIMEOUT, "Transaction timed out");
+    transaction_complete_and_free (tr, NULL, error);
+    g_error_free (error);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+flow_control_queued_cancelled (GCancellable *cancellable,
+                               Transaction  *tr)
+{
+    GError *error;
+
+    /* Must not disconnect from within the signal handler */
+    tr->cancellable_id = 0;
+    flow_control_unqueue (tr);
+
+    error = g_error_new (QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED, "Transaction aborted");
+    transaction_complete_and_free (tr, NULL, error);
+    g_error_free (error);
+}
+
+static void
+flow_control_fail_pending (FlowControlClient *fc,
+                           const GError      *error)
+{
+    Transaction *tr;
+
+    while ((tr = g_queue_peek_head (&fc->pending)) != NULL) {
+        flow_control_unqueue (tr);
+        transaction_complete_and_free (tr, NULL, error);
+    }
+}
+
+static gboolean
+flow_control_dispatch_cb (QmiDevice *self)
+{
+    GHashTableIter     iter;
+    FlowControlClient *fc;
+
+    self->priv->flow_control_dispatch_source = NULL;
+
+    g_hash_table_iter_init (&iter, self->priv->flow_control);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&fc)) {
+        while (!g_queue_is_empty (&fc->pending) &&
+               (!self->priv->max_in_flight_per_client ||
+                fc->n_in_flight < self->priv->max_in_flight_per_client)) {
+            Transaction *tr;
+            guint        timeout = 0;
+
+            tr = g_queue_peek_head (&fc->pending);
+            flow_control_unqueue (tr);
+
+            /* The time spent in the queue counts towards the timeout */
+            if (tr->deadline) {
+                gint64 remaining;
+
+                remaining = tr->deadline - g_get_monotonic_time ();
+                timeout = (guint) MAX (1, (remaining + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC);
+            }
+
+            fc->n_in_flight++;
+            tr->flow_control = fc;
+            device_command_send (self, tr, timeout);
+        }
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+flow_control_schedule_dispatch (QmiDevice *self)
+{
+    /* Always dispatch in idle, as credits are released while completing
+     * transactions, e.g. when iterating the tracking table */
+    if (self->priv->flow_control_dispatch_source)
+        return;
+
+    self->priv->flow_control_dispatch_source = g_idle_source_new ();
+    g_source_set_callback (self->priv->flow_control_dispatch_source,
+                           (GSourceFunc)flow_control_dispatch_cb,
+                           g_object_ref (self),
+                           g_object_unref);
+    g_source_attach (self->priv->flow_control_dispatch_source, g_main_context_get_thread_default ());
+    g_source_unref (self->priv->flow_control_dispatch_source);
+}
+
+static void
+flow_control_release (FlowControlClient *fc)
+{
+    g_assert (fc->n_in_flight > 0);
+    fc->n_in_flight--;
+
+    if (fc->released) {
+        if (!fc->n_in_flight)
+            flow_control_client_free (fc);
+        return;
+    }
+
+    if (!g_queue_is_empty (&fc->pending))
+        flow_control_schedule_dispatch (fc->self);
+}
+
+static gboolean
+flow_control_acquire (QmiDevice   *self,
+                      Transaction *tr,
+                      guint        timeout)
+{
+    FlowControlClient *fc;
+    gpointer           key;
+
+    if (!self->priv->max_in_flight_per_client ||
+        qmi_message_get_service (tr->message) == QMI_SERVICE_CTL)
+        return TRUE;
+
+    key = build_flow_control_key (qmi_message_get_service (tr->message), qmi_message_get_client_id (tr->message));
+    fc = g_hash_table_lookup (self->priv->flow_control, key);
+    if (!fc) {
+        fc = g_slice_new0 (FlowControlClient);
+        fc->self = self;
+        g_queue_init (&fc->pending);
+        g_hash_table_insert (self->priv->flow_control, key, fc);
+    }
+
+    /* Never overtake already queued requests */
+    if (fc->n_in_flight < self->priv->max_in_flight_per_client && g_queue_is_empty (&fc->pending)) {
+        fc->n_in_flight++;
+        tr->flow_control = fc;
+        return TRUE;
+    }
+
+    g_debug ("[%s] queueing transaction 0x%x: %u transactions already in flight in '%s' client with ID '%u'",
+             qmi_file_get_path_display (self->priv->file),
+             qmi_message_get_transaction_id (tr->message),
+             fc->n_in_flight,
+             qmi_service_get_string (qmi_message_get_service (tr->message)),
+             qmi_message_get_client_id (tr->message));
+    tr->flow_control_queue = fc;
+    g_queue_push_tail (&fc->pending, tr);
+    transaction_ids_update (self, build_transaction_key (tr->message), TRUE);
+
+    /* The timeout and cancellation apply from the moment the request is
+     * queued, not only once it is sent */
+    if (timeout > 0) {
+        tr->deadline = g_get_monotonic_time () + (gint64) timeout * G_USEC_PER_SEC;
+        tr->timeout_source = g_timeout_source_new_seconds (timeout);
+        g_source_set_callback (tr->timeout_source, (GSourceFunc)flow_control_queued_timed_out, tr, NULL);
+        g_source_attach (tr->timeout_source, g_main_context_get_thread_default ());
+        g_source_unref (tr->timeout_source);
+    }
+
+    /* Note: if already cancelled, flow_control_queued_cancelled() is called
+     * right away and the transaction is completed, so it must not be used
+     * unless the handler was really connected */
+    if (tr->cancellable) {
+        gulong cancellable_id;
+
+        cancellable_id = g_cancellable_connect (tr->cancellable,
+                                                (GCallback)flow_control_queued_cancelled,
+                                                tr,
+                                                NULL);
+        if (cancellable_id)
+            tr->cancellable_id = cancellable_id;
+    }
+    return FALSE;
+}
+
+static void
+flow_control_client_released (QmiDevice  *self,
+                              QmiService  service,
+                              guint8      cid)
+{
+    FlowControlClient *fc;
+    gpointer           key;
+    g_autoptr(GError)  error = NULL;
+
+    key = build_flow_control_key (service, cid);
+    fc = g_hash_table_lookup (self->priv->flow_control, key);
+    if (!fc)
+        return;
+
+    error = g_error_new (QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE, "Client released");
+    flow_control_fail_pending (fc, error);
+
+    /* A new client may reuse the same CID, so the entry is removed right away;
+     * if there are transactions still in flight, the last one to complete
+     * frees it */
+    g_hash_table_steal (self->priv->flow_control, key);
+    if (fc->n_in_flight > 0)
+        fc->released = TRUE;
+    else
+        flow_control_client_free (fc);
+}
+
+static void
+device_fail_queued_transactions (QmiDevice    *self,
+                                 const GError *error)
+{
+    GHashTableIter     iter;
+    FlowControlClient *fc;
+
+    g_hash_table_iter_init (&iter, self->priv->flow_control);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&fc))
+        flow_control_fail_pending (fc, error);
+}
+
 /*****************************************************************************/
 
 static void
@@ -546,12 +997,16 @@ device_hangup_transactions (QmiDevice *self)
 
     common_error = g_error_new (QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED, "endpoint hangup");
 
+    /* Requests not yet sent */
+    device_fail_queued_transactions (self, common_error);
+
     g_hash_table_iter_init (&iter, self->priv->transactions);
     while (g_hash_table_iter_next (&iter, &key, &value)) {
         Transaction *tr = value;
 
         transaction_complete_and_free (tr, NULL, common_error);
         g_hash_table_iter_remove (&iter);
+        transaction_ids_update (self, key, FALSE);
     }
 }
 
@@ -565,6 +1020,323 @@ qmi_device_get_consecutive_timeouts (QmiDevice *self)
     return self->priv->consecutive_timeouts;
 }
 
+/*****************************************************************************/
+/* Version info cache (private)
+ *
+ * The list of supported services retrieved while opening a device is kept
+ * per device path for the whole life of the process, also across closes and
+ * resets, so that later pipelined opens of the same path don't need to wait
+ * for the modem to report it. Those opens validate the cached list in the
+ * background, and the list reported replaces the cached one. */
+
+G_LOCK_DEFINE_STATIC (version_info_cache);
+static GHashTable *version_info_cache;
+
+static GArray *
+version_info_cache_lookup (const gchar *path)
+{
+    GArray *services = NULL;
+
+    G_LOCK (version_info_cache);
+    if (version_info_cache) {
+        services = g_hash_table_lookup (version_info_cache, path);
+        if (services)
+            g_array_ref (services);
+    }
+    G_UNLOCK (version_info_cache);
+
+    return services;
+}
+
+static void
+version_info_cache_store (const gchar *path,
+                          GArray      *services)
+{
+    G_LOCK (version_info_cache);
+    if (!version_info_cache)
+        version_info_cache = g_hash_table_new_full (g_str_hash,
+                                                    g_str_equal,
+                                                    g_free,
+                                                    (GDestroyNotify)g_array_unref);
+    g_hash_table_replace (version_info_cache, g_strdup (path), g_array_ref (services));
+    G_UNLOCK (version_info_cache);
+}
+
+/*****************************************************************************/
+/* Persistent version info cache (private)
+ *
+ * When a cache directory is configured, the list of supported services is
+ * stored in a keyfile named after a hash of the device identity (sysfs USB
+ * device path plus vid/pid and the device revision reported, or just the
+ * port path if the device isn't a USB one). The device revision changes
+ * across firmware upgrades, so those look up a different entry. Cached lists
+ * are reported right away, both when opening the device and when explicitly
+ * requested, and validated in the background. */
+
+#define VERSION_INFO_CACHE_GROUP            "version-info"
+#define VERSION_INFO_CACHE_KEY_IDENTITY     "identity"
+#define VERSION_INFO_CACHE_KEY_SERVICES     "services"
+#define VERSION_INFO_CACHE_KEY_MAJORS       "major-versions"
+#define VERSION_INFO_CACHE_KEY_MINORS       "minor-versions"
+
+static gchar *
+build_version_info_cache_path (QmiDevice  *self,
+                               gchar     **out_identity)
+{
+    g_autofree gchar  *identity = NULL;
+    g_autofree gchar  *checksum = NULL;
+    g_autofree gchar  *filename = NULL;
+    g_autoptr(GError)  error = NULL;
+
+    if (!self->priv->version_info_cache_dir || !self->priv->file)
+        return NULL;
+
+#if QMI_QRTR_SUPPORTED
+    /* QRTR nodes don't support version info queries */
+    if (self->priv->node)
+        return NULL;
+#endif
+
+    identity = qmi_helpers_get_usb_device_identity (qmi_file_get_path (self->priv->file), &error);
+    if (!identity) {
+        g_debug ("[%s] using port path as version info cache identity: %s",
+                 qmi_file_get_path_display (self->priv->file), error->message);
+        identity = g_strdup (qmi_file_get_path (self->priv->file));
+    }
+
+    checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256, identity, -1);
+    filename = g_strdup_printf ("%s.version-info", checksum);
+    if (out_identity)
+        *out_identity = g_steal_pointer (&identity);
+    return g_build_filename (self->priv->version_info_cache_dir, filename, NULL);
+}
+
+static GArray *
+version_info_disk_cache_load (QmiDevice *self)
+{
+    g_autofree gchar    *path = NULL;
+    g_autofree gchar    *identity = NULL;
+    g_autofree gchar    *stored_identity = NULL;
+    g_autofree gint     *services = NULL;
+    g_autofree gint     *majors = NULL;
+    g_autofree gint     *minors = NULL;
+    gsize                n_services = 0;
+    gsize                n_majors = 0;
+    gsize                n_minors = 0;
+    g_autoptr(GKeyFile)  keyfile = NULL;
+    g_autoptr(GError)    error = NULL;
+    GArray              *service_list;
+    gsize                i;
+
+    path = build_version_info_cache_path (self, &identity);
+    if (!path)
+        return NULL;
+
+    keyfile = g_key_file_new ();
+    if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            g_debug ("[%s] couldn't load version info cache: %s",
+                     qmi_file_get_path_display (self->priv->file), error->message);
+        return NULL;
+    }
+
+    stored_identity = g_key_file_get_string (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_IDENTITY, NULL);
+    if (g_strcmp0 (stored_identity, identity) != 0) {
+        g_debug ("[%s] ignoring version info cache: device identity mismatch",
+                 qmi_file_get_path_display (self->priv->file));
+        return NULL;
+    }
+
+    services = g_key_file_get_integer_list (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_SERVICES, &n_services, NULL);
+    majors   = g_key_file_get_integer_list (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_MAJORS,   &n_majors,   NULL);
+    minors   = g_key_file_get_integer_list (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_MINORS,   &n_minors,   NULL);
+    if (!services || !majors || !minors || n_services != n_majors || n_services != n_minors) {
+        g_debug ("[%s] ignoring version info cache: invalid contents",
+                 qmi_file_get_path_display (self->priv->file));
+        return NULL;
+    }
+
+    service_list = g_array_sized_new (FALSE, FALSE, sizeof (QmiMessageCtlGetVersionInfoOutputServiceListService), n_services);
+    for (i = 0; i < n_services; i++) {
+        QmiMessageCtlGetVersionInfoOutputServiceListService info;
+
+        info.service = (QmiService) services[i];
+        info.major_version = (guint16) majors[i];
+        info.minor_version = (guint16) minors[i];
+        g_array_append_val (service_list, info);
+    }
+
+    g_debug ("[%s] loaded version info cache from %s",
+             qmi_file_get_path_display (self->priv->file), path);
+    return service_list;
+}
+
+static void
+version_info_disk_cache_store (QmiDevice *self,
+                               GArray    *service_list)
+{
+    g_autofree gchar    *path = NULL;
+    g_autofree gchar    *identity = NULL;
+    g_autofree gint     *services = NULL;
+    g_autofree gint     *majors = NULL;
+    g_autofree gint     *minors = NULL;
+    g_autoptr(GKeyFile)  keyfile = NULL;
+    g_autoptr(GError)    error = NULL;
+    guint                i;
+
+    path = build_version_info_cache_path (self, &identity);
+    if (!path)
+        return;
+
+    services = g_new (gint, service_list->len);
+    majors = g_new (gint, service_list->len);
+    minors = g_new (gint, service_list->len);
+    for (i = 0; i < service_list->len; i++) {
+        const QmiMessageCtlGetVersionInfoOutputServiceListService *info;
+
+        info = &g_array_index (service_list, QmiMessageCtlGetVersionInfoOutputServiceListService, i);
+        services[i] = info->service;
+        majors[i] = info->major_version;
+        minors[i] = info->minor_version;
+    }
+
+    keyfile = g_key_file_new ();
+    g_key_file_set_string       (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_IDENTITY, identity);
+    g_key_file_set_integer_list (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_SERVICES, services, service_list->len);
+    g_key_file_set_integer_list (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_MAJORS,   majors,   service_list->len);
+    g_key_file_set_integer_list (keyfile, VERSION_INFO_CACHE_GROUP, VERSION_INFO_CACHE_KEY_MINORS,   minors,   service_list->len);
+
+    if (g_mkdir_with_parents (self->priv->version_info_cache_dir, 0755) < 0) {
+        g_debug ("[%s] couldn't create version info cache directory: %s",
+                 qmi_file_get_path_display (self->priv->file), g_strerror (errno));
+        return;
+    }
+
+    if (!g_key_file_save_to_file (keyfile, path, &error))
+        g_debug ("[%s] couldn't store version info cache: %s",
+                 qmi_file_get_path_display (self->priv->file), error->message);
+}
+
+static gboolean
+service_lists_equal (GArray *a,
+                     GArray *b)
+{
+    guint i;
+
+    if (a->len != b->len)
+        return FALSE;
+
+    for (i = 0; i < a->len; i++) {
+        const QmiMessageCtlGetVersionInfoOutputServiceListService *info_a;
+        const QmiMessageCtlGetVersionInfoOutputServiceListService *info_b;
+
+        info_a = &g_array_index (a, QmiMessageCtlGetVersionInfoOutputServiceListService, i);
+        info_b = &g_array_index (b, QmiMessageCtlGetVersionInfoOutputServiceListService, i);
+        if (info_a->service != info_b->service ||
+            info_a->major_version != info_b->major_version ||
+            info_a->minor_version != info_b->minor_version)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Cached version info validation (private) */
+
+#define VERSION_INFO_VALIDATE_TIMEOUT_SECS 10
+
+typedef struct {
+    QmiDevice    *self;
+    GCancellable *cancellable;
+} VersionInfoValidateContext;
+
+static void
+version_info_validate_context_free (VersionInfoValidateContext *ctx)
+{
+    g_object_unref (ctx->cancellable);
+    g_object_unref (ctx->self);
+    g_slice_free (VersionInfoValidateContext, ctx);
+}
+
+static void
+version_info_validate_ready (QmiClientCtl               *client_ctl,
+                             GAsyncResult               *res,
+                             VersionInfoValidateContext *ctx)
+{
+    g_autoptr(QmiMessageCtlGetVersionInfoOutput)  output = NULL;
+    g_autoptr(GError)                             error = NULL;
+    QmiDevice                                    *self;
+    GArray                                       *service_list = NULL;
+
+    self = ctx->self;
+    if (self->priv->version_info_validate_cancellable == ctx->cancellable)
+        g_clear_object (&self->priv->version_info_validate_cancellable);
+
+    output = qmi_client_ctl_get_version_info_finish (client_ctl, res, &error);
+    if (!output || !qmi_message_ctl_get_version_info_output_get_result (output, &error)) {
+        g_debug ("[%s] couldn't validate cached version info: %s",
+                 qmi_file_get_path_display (self->priv->file), error->message);
+        version_info_validate_context_free (ctx);
+        return;
+    }
+
+    /* Device closed in the meantime */
+    if (g_cancellable_is_cancelled (ctx->cancellable)) {
+        version_info_validate_context_free (ctx);
+        return;
+    }
+
+    qmi_message_ctl_get_version_info_output_get_service_list (output, &service_list, NULL);
+    if (self->priv->supported_services && service_lists_equal (self->priv->supported_services, service_list)) {
+        g_debug ("[%s] cached version info validated",
+                 qmi_file_get_path_display (self->priv->file));
+        version_info_validate_context_free (ctx);
+        return;
+    }
+
+    g_debug ("[%s] cached version info outdated, updating...",
+             qmi_file_get_path_display (self->priv->file));
+    g_clear_pointer (&self->priv->supported_services, g_array_unref);
+    self->priv->supported_services = g_array_ref (service_list);
+    version_info_cache_store (qmi_file_get_path (self->priv->file), service_list);
+    version_info_disk_cache_store (self, service_list);
+    version_info_validate_context_free (ctx);
+}
+
+/* Queries the version info in the background, and replaces the supported
+ * services (and the cached ones) with the list reported, if different. Runs
+ * until the device is closed at most. */
+static void
+version_info_validate (QmiDevice *self)
+{
+    VersionInfoValidateContext *ctx;
+
+    if (self->priv->version_info_validate_cancellable)
+        return;
+
+    ctx = g_slice_new0 (VersionInfoValidateContext);
+    ctx->self = g_object_ref (self);
+    ctx->cancellable = g_cancellable_new ();
+    self->priv->version_info_validate_cancellable = g_object_ref (ctx->cancellable);
+
+    qmi_client_ctl_get_version_info (self->priv->client_ctl,
+                                     NULL,
+                                     VERSION_INFO_VALIDATE_TIMEOUT_SECS,
+                                     ctx->cancellable,
+                                     (GAsyncReadyCallback)version_info_validate_ready,
+                                     ctx);
+}
+
+static void
+version_info_validate_cancel (QmiDevice *self)
+{
+    if (self->priv->version_info_validate_cancellable) {
+        g_cancellable_cancel (self->priv->version_info_validate_cancellable);
+        g_clear_object (&self->priv->version_info_validate_cancellable);
+    }
+}
+
 /*****************************************************************************/
 /* Version info request */
 
@@ -576,6 +1348,28 @@ qmi_device_get_service_version_info_finish (QmiDevice *self,
     return g_task_propagate_pointer (G_TASK (res), error);
 }
 
+static GArray *
+build_service_version_info_list (GArray *service_list)
+{
+    GArray *out;
+    guint i;
+
+    out = g_array_sized_new (FALSE, FALSE, sizeof (QmiDeviceServiceVersionInfo), service_list->len);
+    for (i = 0; i < service_list->len; i++) {
+        QmiMessageCtlGetVersionInfoOutputServiceListService *info;
+        QmiDeviceServiceVersionInfo outinfo;
+
+        info = &g_array_index (service_list,
+                               QmiMessageCtlGetVersionInfoOutputServiceListService,
+                               i);
+        outinfo.service = info->service;
+        outinfo.major_version = info->major_version;
+        outinfo.minor_version = info->minor_version;
+        g_array_append_val (out, outinfo);
+    }
+    return out;
+}
+
 static void
 version_info_ready (QmiClientCtl *client_ctl,
                     GAsyncResult *res,
@@ -585,7 +1379,6 @@ version_info_ready (QmiClientCtl *client_ctl,
     GArray *out;
     QmiMessageCtlGetVersionInfoOutput *output;
     GError *error = NULL;
-    guint i;
 
     /* Check result of the async operation */
     output = qmi_client_ctl_get_version_info_finish (client_ctl, res, &error);
@@ -605,19 +1398,8 @@ version_info_ready (QmiClientCtl *client_ctl,
 
     /* QMI operation succeeded, we can now get the outputs */
     qmi_message_ctl_get_version_info_output_get_service_list (output, &service_list, NULL);
-    out = g_array_sized_new (FALSE, FALSE, sizeof (QmiDeviceServiceVersionInfo), service_list->len);
-    for (i = 0; i < service_list->len; i++) {
-        QmiMessageCtlGetVersionInfoOutputServiceListService *info;
-        QmiDeviceServiceVersionInfo outinfo;
-
-        info = &g_array_index (service_list,
-                               QmiMessageCtlGetVersionInfoOutputServiceListService,
-                               i);
-        outinfo.service = info->service;
-        outinfo.major_version = info->major_version;
-        outinfo.minor_version = info->minor_version;
-        g_array_append_val (out, outinfo);
-    }
+    version_info_disk_cache_store (g_task_get_source_object (task), service_list);
+    out = build_service_version_info_list (service_list);
 
     qmi_message_ctl_get_version_info_output_unref (output);
     g_task_return_pointer (task, out, (GDestroyNotify)g_array_unref);
@@ -631,13 +1413,30 @@ qmi_device_get_service_version_info (QmiDevice *self,
                                      GAsyncReadyCallback callback,
                                      gpointer user_data)
 {
+    GTask *task;
+    GArray *cached = NULL;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    /* The list in the persistent cache is reported right away, and validated
+     * in the background */
+    if (qmi_device_is_open (self))
+        cached = version_info_disk_cache_load (self);
+    if (cached) {
+        version_info_validate (self);
+        g_task_return_pointer (task, build_service_version_info_list (cached), (GDestroyNotify)g_array_unref);
+        g_array_unref (cached);
+        g_object_unref (task);
+        return;
+    }
+
     qmi_client_ctl_get_version_info (
         self->priv->client_ctl,
         NULL,
         timeout,
         cancellable,
         (GAsyncReadyCallback)version_info_ready,
-        g_task_new (self, cancellable, callback, user_data));
+        task);
 }
 
 /*****************************************************************************/
@@ -829,26 +1628,45 @@ build_raw_ip_sysfs_path (QmiDevice *self)
 static gchar *
 build_pass_through_sysfs_path (QmiDevice *self)
 {
-    return g_strdup_printf ("/sys/class/net/%s/qmi/pass_through", self->priv->wwan_iface);
+    return g_strdup_printf ("/sys/class/net/%s/qmi/pass_through", self->priv->wwan_iface);
+}
+
+/* The attribute files are kept open as long as the WWAN iface name doesn't
+ * change, so this must be called right after reloading it */
+static void
+reload_data_format_attributes (QmiDevice *self)
+{
+    g_autofree gchar *raw_ip_sysfs_path = NULL;
+    g_autofree gchar *pass_through_sysfs_path = NULL;
+
+    raw_ip_sysfs_path = build_raw_ip_sysfs_path (self);
+    if (self->priv->raw_ip_attribute &&
+        g_str_equal (qmi_sysfs_attribute_get_path (self->priv->raw_ip_attribute), raw_ip_sysfs_path))
+        return;
+
+    pass_through_sysfs_path = build_pass_through_sysfs_path (self);
+
+    g_clear_pointer (&self->priv->raw_ip_attribute, qmi_sysfs_attribute_unref);
+    g_clear_pointer (&self->priv->pass_through_attribute, qmi_sysfs_attribute_unref);
+    self->priv->raw_ip_attribute = qmi_sysfs_attribute_new (raw_ip_sysfs_path);
+    self->priv->pass_through_attribute = qmi_sysfs_attribute_new (pass_through_sysfs_path);
 }
 
 static gboolean
-get_expected_data_format (QmiDevice    *self,
-                          const gchar  *raw_ip_sysfs_path,
-                          const gchar  *pass_through_sysfs_path,
-                          GError      **error)
+get_expected_data_format (QmiDevice  *self,
+                          GError    **error)
 {
     gchar raw_ip_value = '\0';
     gchar pass_through_value = '\0';
 
-    if (!qmi_helpers_read_sysfs_file (raw_ip_sysfs_path, &raw_ip_value, 1, error) ||
+    if (!qmi_sysfs_attribute_read (self->priv->raw_ip_attribute, &raw_ip_value, 1, error) ||
         !validate_yes_or_no (raw_ip_value, error))
         return QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN;
 
     if (raw_ip_value == 'N')
         return QMI_DEVICE_EXPECTED_DATA_FORMAT_802_3;
 
-    if (qmi_helpers_read_sysfs_file (pass_through_sysfs_path, &pass_through_value, 1, NULL) &&
+    if (qmi_sysfs_attribute_read (self->priv->pass_through_attribute, &pass_through_value, 1, NULL) &&
         (pass_through_value == 'Y'))
         return QMI_DEVICE_EXPECTED_DATA_FORMAT_QMAP_PASS_THROUGH;
 
@@ -857,24 +1675,22 @@ get_expected_data_format (QmiDevice    *self,
 
 static gboolean
 set_expected_data_format (QmiDevice                    *self,
-                          const gchar                  *raw_ip_sysfs_path,
-                          const gchar                  *pass_through_sysfs_path,
                           QmiDeviceExpectedDataFormat   requested,
                           GError                      **error)
 {
     if (requested == QMI_DEVICE_EXPECTED_DATA_FORMAT_802_3) {
-        qmi_helpers_write_sysfs_file (pass_through_sysfs_path, "N", NULL);
-        return qmi_helpers_write_sysfs_file (raw_ip_sysfs_path, "N", error);
+        qmi_sysfs_attribute_write (self->priv->pass_through_attribute, "N", NULL);
+        return qmi_sysfs_attribute_write (self->priv->raw_ip_attribute, "N", error);
     }
 
     if (requested == QMI_DEVICE_EXPECTED_DATA_FORMAT_RAW_IP) {
-        qmi_helpers_write_sysfs_file (pass_through_sysfs_path, "N", NULL);
-        return qmi_helpers_write_sysfs_file (raw_ip_sysfs_path, "Y", error);
+        qmi_sysfs_attribute_write (self->priv->pass_through_attribute, "N", NULL);
+        return qmi_sysfs_attribute_write (self->priv->raw_ip_attribute, "Y", error);
     }
 
     if (requested == QMI_DEVICE_EXPECTED_DATA_FORMAT_QMAP_PASS_THROUGH) {
-        return (qmi_helpers_write_sysfs_file (raw_ip_sysfs_path, "Y", error) &&
-                qmi_helpers_write_sysfs_file (pass_through_sysfs_path, "Y", error));
+        return (qmi_sysfs_attribute_write (self->priv->raw_ip_attribute, "Y", error) &&
+                qmi_sysfs_attribute_write (self->priv->pass_through_attribute, "Y", error));
     }
 
     g_assert_not_reached ();
@@ -885,8 +1701,6 @@ common_get_set_expected_data_format (QmiDevice                    *self,
                                      QmiDeviceExpectedDataFormat   requested,
                                      GError                      **error)
 {
-    g_autofree gchar            *raw_ip = NULL;
-    g_autofree gchar            *pass_through = NULL;
     QmiDeviceExpectedDataFormat  expected = QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN;
     gboolean                     readonly;
 
@@ -905,16 +1719,14 @@ common_get_set_expected_data_format (QmiDevice                    *self,
 
     readonly = (requested == QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN);
 
-    /* Build sysfs file paths */
-    raw_ip = build_raw_ip_sysfs_path (self);
-    pass_through = build_pass_through_sysfs_path (self);
+    reload_data_format_attributes (self);
 
     /* Set operation? */
-    if (!readonly && !set_expected_data_format (self, raw_ip, pass_through, requested, error))
+    if (!readonly && !set_expected_data_format (self, requested, error))
         return QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN;
 
     /* Get/Set operations */
-    if ((expected = get_expected_data_format (self, raw_ip, pass_through, error)) == QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN)
+    if ((expected = get_expected_data_format (self, error)) == QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN)
         return QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN;
 
     /* If we requested an update but we didn't read that value, report an error */
@@ -957,8 +1769,8 @@ qmi_device_check_expected_data_format_supported (QmiDevice                    *s
                                                  QmiDeviceExpectedDataFormat   format,
                                                  GError                      **error)
 {
-    g_autofree gchar *sysfs_path = NULL;
-    gchar             value = '\0';
+    QmiSysfsAttribute *attribute = NULL;
+    gchar              value = '\0';
 
     g_return_val_if_fail (QMI_IS_DEVICE (self), FALSE);
 
@@ -967,11 +1779,13 @@ qmi_device_check_expected_data_format_supported (QmiDevice                    *s
             return TRUE;
         case QMI_DEVICE_EXPECTED_DATA_FORMAT_RAW_IP:
             reload_wwan_iface_name (self);
-            sysfs_path = build_raw_ip_sysfs_path (self);
+            reload_data_format_attributes (self);
+            attribute = self->priv->raw_ip_attribute;
             break;
         case QMI_DEVICE_EXPECTED_DATA_FORMAT_QMAP_PASS_THROUGH:
             reload_wwan_iface_name (self);
-            sysfs_path = build_pass_through_sysfs_path (self);
+            reload_data_format_attributes (self);
+            attribute = self->priv->pass_through_attribute;
             break;
         default:
         case QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN:
@@ -980,8 +1794,8 @@ qmi_device_check_expected_data_format_supported (QmiDevice                    *s
             return FALSE;
     }
 
-    g_assert (sysfs_path);
-    return (qmi_helpers_read_sysfs_file (sysfs_path, &value, 1, error) &&
+    g_assert (attribute);
+    return (qmi_sysfs_attribute_read (attribute, &value, 1, error) &&
             validate_yes_or_no (value, error));
 }
 
@@ -1190,8 +2004,9 @@ qmi_device_allocate_client (QmiDevice           *self,
                             GAsyncReadyCallback  callback,
                             gpointer             user_data)
 {
-    AllocateClientContext *ctx;
-    GTask                 *task;
+    AllocateClientContext  *ctx;
+    GTask                  *task;
+    const QmiServiceModule *module;
 
     g_return_if_fail (QMI_IS_DEVICE (self));
     g_return_if_fail (service != QMI_SERVICE_UNKNOWN);
@@ -1216,171 +2031,19 @@ qmi_device_allocate_client (QmiDevice           *self,
         return;
     }
 
-    switch (service) {
-    case QMI_SERVICE_CTL:
+    if (service == QMI_SERVICE_CTL) {
         g_task_return_new_error (task,
                                  QMI_CORE_ERROR,
                                  QMI_CORE_ERROR_INVALID_ARGS,
                                  "Cannot create additional clients for the CTL service");
         g_object_unref (task);
         return;
-    case QMI_SERVICE_DMS:
-#if defined HAVE_QMI_SERVICE_DMS
-        ctx->client_type = QMI_TYPE_CLIENT_DMS;
-#endif
-        break;
-    case QMI_SERVICE_WDS:
-#if defined HAVE_QMI_SERVICE_WDS
-        ctx->client_type = QMI_TYPE_CLIENT_WDS;
-#endif
-        break;
-    case QMI_SERVICE_NAS:
-#if defined HAVE_QMI_SERVICE_NAS
-        ctx->client_type = QMI_TYPE_CLIENT_NAS;
-#endif
-        break;
-    case QMI_SERVICE_WMS:
-#if defined HAVE_QMI_SERVICE_WMS
-        ctx->client_type = QMI_TYPE_CLIENT_WMS;
-#endif
-        break;
-    case QMI_SERVICE_PDS:
-#if defined HAVE_QMI_SERVICE_PDS
-        ctx->client_type = QMI_TYPE_CLIENT_PDS;
-#endif
-        break;
-    case QMI_SERVICE_PDC:
-#if defined HAVE_QMI_SERVICE_PDC
-        ctx->client_type = QMI_TYPE_CLIENT_PDC;
-#endif
-        break;
-    case QMI_SERVICE_PBM:
-#if defined HAVE_QMI_SERVICE_PBM
-        ctx->client_type = QMI_TYPE_CLIENT_PBM;
-#endif
-        break;
-    case QMI_SERVICE_UIM:
-#if defined HAVE_QMI_SERVICE_UIM
-        ctx->client_type = QMI_TYPE_CLIENT_UIM;
-#endif
-        break;
-    case QMI_SERVICE_OMA:
-#if defined HAVE_QMI_SERVICE_OMA
-        ctx->client_type = QMI_TYPE_CLIENT_OMA;
-#endif
-        break;
-    case QMI_SERVICE_GAS:
-#if defined HAVE_QMI_SERVICE_GAS
-        ctx->client_type = QMI_TYPE_CLIENT_GAS;
-#endif
-        break;
-    case QMI_SERVICE_GMS:
-#if defined HAVE_QMI_SERVICE_GMS
-        ctx->client_type = QMI_TYPE_CLIENT_GMS;
-#endif
-        break;
-    case QMI_SERVICE_WDA:
-#if defined HAVE_QMI_SERVICE_WDA
-        ctx->client_type = QMI_TYPE_CLIENT_WDA;
-#endif
-        break;
-    case QMI_SERVICE_VOICE:
-#if defined HAVE_QMI_SERVICE_VOICE
-        ctx->client_type = QMI_TYPE_CLIENT_VOICE;
-#endif
-        break;
-    case QMI_SERVICE_LOC:
-#if defined HAVE_QMI_SERVICE_LOC
-        ctx->client_type = QMI_TYPE_CLIENT_LOC;
-#endif
-        break;
-    case QMI_SERVICE_QOS:
-#if defined HAVE_QMI_SERVICE_QOS
-        ctx->client_type = QMI_TYPE_CLIENT_QOS;
-#endif
-        break;
-    case QMI_SERVICE_DSD:
-#if defined HAVE_QMI_SERVICE_DSD
-        ctx->client_type = QMI_TYPE_CLIENT_DSD;
-#endif
-        break;
-    case QMI_SERVICE_SAR:
-#if defined HAVE_QMI_SERVICE_SAR
-        ctx->client_type = QMI_TYPE_CLIENT_SAR;
-#endif
-        break;
-    case QMI_SERVICE_DPM:
-#if defined HAVE_QMI_SERVICE_DPM
-        ctx->client_type = QMI_TYPE_CLIENT_DPM;
-#endif
-        break;
-    case QMI_SERVICE_FOX:
-#if defined HAVE_QMI_SERVICE_FOX
-        ctx->client_type = QMI_TYPE_CLIENT_FOX;
-#endif
-        break;
-    case QMI_SERVICE_ATR:
-#if defined HAVE_QMI_SERVICE_ATR
-        ctx->client_type = QMI_TYPE_CLIENT_ATR;
-#endif
-        break;
-    case QMI_SERVICE_IMSP:
-#if defined HAVE_QMI_SERVICE_IMSP
-        ctx->client_type = QMI_TYPE_CLIENT_IMSP;
-#endif
-        break;
-    case QMI_SERVICE_IMSA:
-#if defined HAVE_QMI_SERVICE_IMSA
-        ctx->client_type = QMI_TYPE_CLIENT_IMSA;
-#endif
-        break;
-    case QMI_SERVICE_IMS:
-#if defined HAVE_QMI_SERVICE_IMS
-        ctx->client_type = QMI_TYPE_CLIENT_IMS;
-#endif
-        break;
-    case QMI_SERVICE_SSC:
-#if defined HAVE_QMI_SERVICE_SSC
-        ctx->client_type = QMI_TYPE_CLIENT_SSC;
-#endif
-        break;
-    case QMI_SERVICE_UNKNOWN:
-        g_assert_not_reached ();
-
-    case QMI_SERVICE_AUTH:
-    case QMI_SERVICE_AT:
-    case QMI_SERVICE_CAT2:
-    case QMI_SERVICE_QCHAT:
-    case QMI_SERVICE_RMTFS:
-    case QMI_SERVICE_TEST:
-    case QMI_SERVICE_ADC:
-    case QMI_SERVICE_CSD:
-    case QMI_SERVICE_MFS:
-    case QMI_SERVICE_TIME:
-    case QMI_SERVICE_TS:
-    case QMI_SERVICE_TMD:
-    case QMI_SERVICE_UIM_HTTP:
-    case QMI_SERVICE_UIM_RMT:
-    case QMI_SERVICE_SAP:
-    case QMI_SERVICE_TSYNC:
-    case QMI_SERVICE_RFSA:
-    case QMI_SERVICE_CSVT:
-    case QMI_SERVICE_QCMAP:
-    case QMI_SERVICE_IMSVT:
-    case QMI_SERVICE_COEX:
-    case QMI_SERVICE_STX:
-    case QMI_SERVICE_BIT:
-    case QMI_SERVICE_IMSRTP:
-    case QMI_SERVICE_IMSDCM:
-    case QMI_SERVICE_RFRPE:
-    case QMI_SERVICE_SSCTL:
-    case QMI_SERVICE_CAT:
-    case QMI_SERVICE_RMS:
-    case QMI_SERVICE_FOTA:
-    default:
-        break;
     }
 
+    module = __qmi_service_module_lookup (service);
+    if (module)
+        ctx->client_type = module->get_client_type ();
+
     if (ctx->client_type == G_TYPE_INVALID) {
         g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
                                  "Clients for service '%s' not supported",
@@ -1430,6 +2093,174 @@ qmi_device_allocate_client (QmiDevice           *self,
     build_client_object (task);
 }
 
+/*****************************************************************************/
+/* Allocate multiple clients */
+
+/* All CID allocations go through the implicit CTL client, which only has an
+ * 8-bit transaction ID space shared with any other CTL request, so limit
+ * how many of them are in flight at the same time. */
+#define MAX_PARALLEL_CLIENT_ALLOCATIONS 16
+
+typedef struct {
+    QmiService *services;
+    guint       n_services;
+    guint       timeout;
+    guint       next;
+    guint       n_pending;
+    GPtrArray  *clients;
+    GError     *error;
+} AllocateClientsContext;
+
+static void
+allocate_clients_context_free (AllocateClientsContext *ctx)
+{
+    g_assert (ctx->n_pending == 0);
+    g_clear_error (&ctx->error);
+    if (ctx->clients) {
+        guint i;
+
+        /* Only on error, with possibly unset entries */
+        for (i = 0; i < ctx->clients->len; i++) {
+            if (g_ptr_array_index (ctx->clients, i))
+                g_object_unref (g_ptr_array_index (ctx->clients, i));
+        }
+        g_ptr_array_unref (ctx->clients);
+    }
+    g_free (ctx->services);
+    g_slice_free (AllocateClientsContext, ctx);
+}
+
+GPtrArray *
+qmi_device_allocate_clients_finish (QmiDevice     *self,
+                                    GAsyncResult  *res,
+                                    GError       **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static void allocate_clients_run (GTask *task);
+
+static void
+allocate_clients_client_ready (QmiDevice    *self,
+                               GAsyncResult *res,
+                               GTask        *task)
+{
+    AllocateClientsContext *ctx;
+    QmiClient              *client;
+    GError                 *error = NULL;
+    guint                   i;
+
+    ctx = g_task_get_task_data (task);
+    g_assert (ctx->n_pending > 0);
+    ctx->n_pending--;
+
+    client = qmi_device_allocate_client_finish (self, res, &error);
+    if (client) {
+        /* Clients are stored in the same order as the requested services */
+        for (i = 0; i < ctx->n_services; i++) {
+            if (!g_ptr_array_index (ctx->clients, i) && ctx->services[i] == qmi_client_get_service (client)) {
+                g_ptr_array_index (ctx->clients, i) = client;
+                break;
+            }
+        }
+        g_assert (i < ctx->n_services);
+    } else if (!ctx->error)
+        ctx->error = error;
+    else
+        g_error_free (error);
+
+    allocate_clients_run (task);
+}
+
+static void
+allocate_clients_run (GTask *task)
+{
+    QmiDevice              *self;
+    AllocateClientsContext *ctx;
+    guint                   i;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* Launch as many new allocations as allowed, unless something failed */
+    while (!ctx->error &&
+           ctx->next < ctx->n_services &&
+           ctx->n_pending < MAX_PARALLEL_CLIENT_ALLOCATIONS) {
+        ctx->n_pending++;
+        qmi_device_allocate_client (self,
+                                    ctx->services[ctx->next++],
+                                    QMI_CID_NONE,
+                                    ctx->timeout,
+                                    g_task_get_cancellable (task),
+                                    (GAsyncReadyCallback)allocate_clients_client_ready,
+                                    task);
+    }
+
+    if (ctx->n_pending > 0)
+        return;
+
+    if (!ctx->error) {
+        /* All entries are set at this point */
+        g_ptr_array_set_free_func (ctx->clients, g_object_unref);
+        g_task_return_pointer (task, g_steal_pointer (&ctx->clients), (GDestroyNotify)g_ptr_array_unref);
+        g_object_unref (task);
+        return;
+    }
+
+    /* On error, release all the clients already allocated, so that the
+     * operation either fully succeeds or leaves no CIDs behind */
+    for (i = 0; i < ctx->n_services; i++) {
+        QmiClient *client;
+
+        client = g_ptr_array_index (ctx->clients, i);
+        if (!client)
+            continue;
+        qmi_device_release_client (self,
+                                   client,
+                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   ctx->timeout,
+                                   NULL,
+                                   NULL,
+                                   NULL);
+    }
+
+    g_task_return_error (task, g_steal_pointer (&ctx->error));
+    g_object_unref (task);
+}
+
+void
+qmi_device_allocate_clients (QmiDevice           *self,
+                             const QmiService    *services,
+                             guint                n_services,
+                             guint                timeout,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+    AllocateClientsContext *ctx;
+    GTask                  *task;
+
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (services != NULL || n_services == 0);
+
+    ctx = g_slice_new0 (AllocateClientsContext);
+    ctx->services = g_new (QmiService, n_services);
+    memcpy (ctx->services, services, n_services * sizeof (QmiService));
+    ctx->n_services = n_services;
+    ctx->timeout = timeout;
+    ctx->clients = g_ptr_array_sized_new (n_services);
+    g_ptr_array_set_size (ctx->clients, n_services);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_task_data (task, ctx, (GDestroyNotify)allocate_clients_context_free);
+
+    g_debug ("[%s] allocating %u clients...",
+             qmi_file_get_path_display (self->priv->file),
+             n_services);
+
+    allocate_clients_run (task);
+}
+
 /*****************************************************************************/
 /* Release client */
 
@@ -1522,6 +2353,9 @@ qmi_device_release_client (QmiDevice                   *self,
         /* Unregister from device */
         unregister_client (self, client);
 
+        /* Requests queued in the client are never sent */
+        flow_control_client_released (self, service, cid);
+
         g_debug ("[%s] unregistered '%s' client with ID '%u'",
                  qmi_file_get_path_display (self->priv->file),
                  qmi_service_get_string (service),
@@ -1752,10 +2586,12 @@ trace_message (QmiDevice         *self,
                                          ((GByteArray *)message)->len,
                                          ':');
     } else {
-        g_autofree gchar *tmp = NULL;
+        GString *str;
 
-        tmp = qmi_common_str_hex (((GByteArray *)message)->data, MAX_PRINTED_BYTES, ':');
-        printable = g_strdup_printf ("%s...", tmp);
+        str = g_string_sized_new (3 * MAX_PRINTED_BYTES + 3);
+        qmi_common_str_hex_append (str, ((GByteArray *)message)->data, MAX_PRINTED_BYTES, ':');
+        g_string_append (str, "...");
+        printable = g_string_free (str, FALSE);
     }
 
     g_debug ("[%s] %s message...\n"
@@ -1882,6 +2718,55 @@ process_message (QmiMessage *message,
 
 /*****************************************************************************/
 
+static void
+link_inventory_links_changed_cb (QmiLinkInventory *link_inventory,
+                                 const gchar      *base_ifname,
+                                 QmiDevice        *self)
+{
+    g_signal_emit (self, signals[SIGNAL_LINKS_CHANGED], 0, base_ifname);
+}
+
+/* Starts tracking the links of the given base interface, so that changes
+ * are notified even if they were never listed */
+static void
+track_links (QmiDevice   *self,
+             const gchar *base_ifname)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (self->priv->link_inventory &&
+        !qmi_link_inventory_track (self->priv->link_inventory, base_ifname, &error))
+        g_debug ("Couldn't track links in %s: %s", base_ifname, error->message);
+}
+
+/* The inventory outlives the net port manager, which is cleared whenever the
+ * expected data format changes, so that link changes are always notified */
+static void
+setup_link_inventory (QmiDevice *self)
+{
+    g_autoptr(QmiLinkInventory) link_inventory = NULL;
+    g_autoptr(GError)           error = NULL;
+
+    if (self->priv->link_inventory || self->priv->link_inventory_unavailable)
+        return;
+
+    link_inventory = qmi_link_inventory_new ("/sys/class/net");
+    if (!qmi_link_inventory_monitor (link_inventory, g_main_context_get_thread_default (), &error)) {
+        g_debug ("Couldn't monitor link notifications, links will be listed from sysfs: %s", error->message);
+        self->priv->link_inventory_unavailable = TRUE;
+        return;
+    }
+
+    g_signal_connect (link_inventory,
+                      QMI_LINK_INVENTORY_SIGNAL_LINKS_CHANGED,
+                      G_CALLBACK (link_inventory_links_changed_cb),
+                      self);
+    self->priv->link_inventory = g_steal_pointer (&link_inventory);
+
+    if (self->priv->wwan_iface)
+        track_links (self, self->priv->wwan_iface);
+}
+
 static gboolean
 setup_net_port_manager (QmiDevice  *self,
                         GError    **error)
@@ -1920,7 +2805,11 @@ setup_net_port_manager (QmiDevice  *self,
         break;
     }
 
-    return !!self->priv->net_port_manager;
+    if (!self->priv->net_port_manager)
+        return FALSE;
+
+    setup_link_inventory (self);
+    return TRUE;
 }
 
 /*****************************************************************************/
@@ -2024,6 +2913,8 @@ qmi_device_add_link_with_flags (QmiDevice             *self,
         return;
     }
 
+    track_links (self, base_ifname);
+
     g_assert (self->priv->net_port_manager);
     qmi_net_port_manager_add_link (self->priv->net_port_manager,
                                    mux_id,
@@ -2061,6 +2952,8 @@ void qmi_device_add_link_with_flags_and_initial_mux_id (QmiDevice             *s
         return;
     }
 
+    track_links (self, base_ifname);
+
     g_assert (self->priv->net_port_manager);
     qmi_net_port_manager_add_link (self->priv->net_port_manager,
                                    QMI_DEVICE_MUX_ID_AUTOMATIC,
@@ -2088,6 +2981,108 @@ qmi_device_add_link (QmiDevice           *self,
                                     cancellable, callback, user_data);
 }
 
+typedef struct {
+    GPtrArray *ifnames;
+    GArray    *mux_ids;
+} AddLinksResult;
+
+static void
+add_links_result_free (AddLinksResult *ctx)
+{
+    if (ctx->mux_ids)
+        g_array_unref (ctx->mux_ids);
+    if (ctx->ifnames)
+        g_ptr_array_unref (ctx->ifnames);
+    g_free (ctx);
+}
+
+GPtrArray *
+qmi_device_add_links_finish (QmiDevice     *self,
+                             GAsyncResult  *res,
+                             GArray       **mux_ids,
+                             GError       **error)
+{
+    AddLinksResult *ctx;
+    GPtrArray      *ifnames;
+
+    ctx = g_task_propagate_pointer (G_TASK (res), error);
+    if (!ctx)
+        return NULL;
+
+    if (mux_ids)
+        *mux_ids = g_steal_pointer (&ctx->mux_ids);
+
+    ifnames = g_steal_pointer (&ctx->ifnames);
+    add_links_result_free (ctx);
+    return ifnames;
+}
+
+static void
+device_add_links_ready (QmiNetPortManager *net_port_manager,
+                        GAsyncResult      *res,
+                        GTask             *task)
+{
+    GError         *error = NULL;
+    AddLinksResult *ctx;
+
+    ctx = g_new0 (AddLinksResult, 1);
+    ctx->ifnames = qmi_net_port_manager_add_links_finish (net_port_manager, &ctx->mux_ids, res, &error);
+
+    if (!ctx->ifnames) {
+        g_prefix_error (&error, "Could not allocate links: ");
+        g_task_return_error (task, error);
+        add_links_result_free (ctx);
+    } else
+        g_task_return_pointer (task, ctx, (GDestroyNotify) add_links_result_free);
+
+    g_object_unref (task);
+}
+
+void
+qmi_device_add_links (QmiDevice             *self,
+                      guint                  n_links,
+                      guint                  initial_mux_id,
+                      const gchar           *base_ifname,
+                      const gchar           *ifname_prefix,
+                      QmiDeviceAddLinkFlags  flags,
+                      guint                  timeout,
+                      GCancellable          *cancellable,
+                      GAsyncReadyCallback    callback,
+                      gpointer               user_data)
+{
+    GTask  *task;
+    GError *error = NULL;
+
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (base_ifname);
+    g_return_if_fail (timeout > 0);
+    g_return_if_fail (initial_mux_id >= QMI_DEVICE_MUX_ID_MIN);
+    g_return_if_fail (initial_mux_id <= QMI_DEVICE_MUX_ID_MAX);
+    g_return_if_fail (n_links <= QMI_DEVICE_MUX_ID_MAX - initial_mux_id + 1);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    if (!setup_net_port_manager (self, &error)) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    track_links (self, base_ifname);
+
+    g_assert (self->priv->net_port_manager);
+    qmi_net_port_manager_add_links (self->priv->net_port_manager,
+                                    n_links,
+                                    initial_mux_id,
+                                    base_ifname,
+                                    ifname_prefix,
+                                    flags,
+                                    timeout,
+                                    cancellable,
+                                    (GAsyncReadyCallback) device_add_links_ready,
+                                    task);
+}
+
 gboolean
 qmi_device_delete_link_finish (QmiDevice     *self,
                                GAsyncResult  *res,
@@ -2187,6 +3182,8 @@ qmi_device_delete_all_links (QmiDevice           *self,
         return;
     }
 
+    track_links (self, base_ifname);
+
     g_assert (self->priv->net_port_manager);
     qmi_net_port_manager_del_all_links (self->priv->net_port_manager,
                                         base_ifname,
@@ -2209,6 +3206,12 @@ qmi_device_list_links (QmiDevice    *self,
     if (!setup_net_port_manager (self, error))
         return FALSE;
 
+    if (self->priv->link_inventory)
+        return qmi_link_inventory_list_links (self->priv->link_inventory,
+                                              base_ifname,
+                                              out_links,
+                                              error);
+
     g_assert (self->priv->net_port_manager);
     return qmi_net_port_manager_list_links (self->priv->net_port_manager,
                                             base_ifname,
@@ -2238,6 +3241,7 @@ typedef enum {
     DEVICE_OPEN_CONTEXT_STEP_DRIVER,
     DEVICE_OPEN_CONTEXT_STEP_CREATE_ENDPOINT,
     DEVICE_OPEN_CONTEXT_STEP_OPEN_ENDPOINT,
+    DEVICE_OPEN_CONTEXT_STEP_FLAGS_PIPELINED,
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_VERSION_INFO,
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_SYNC,
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_NETPORT,
@@ -2251,11 +3255,14 @@ typedef struct {
     guint timeout;
     guint version_check_retries;
     guint sync_retries;
+    guint pipelined_pending;
+    GError *pipelined_error;
 } DeviceOpenContext;
 
 static void
 device_open_context_free (DeviceOpenContext *ctx)
 {
+    g_clear_error (&ctx->pipelined_error);
     g_slice_free (DeviceOpenContext, ctx);
 }
 
@@ -2269,6 +3276,51 @@ qmi_device_open_finish (QmiDevice *self,
 
 static void device_open_step (GTask *task);
 
+/* Completes one of the operations of the open sequence. When pipelining,
+ * the sequence only goes on once all the concurrent operations are done, and
+ * the first error reported by any of them is the one propagated. */
+static void
+device_open_operation_complete (GTask  *task,
+                                GError *error)
+{
+    DeviceOpenContext *ctx;
+
+    ctx = g_task_get_task_data (task);
+
+    if (!(ctx->flags & QMI_DEVICE_OPEN_FLAGS_PIPELINED)) {
+        if (error) {
+            g_task_return_error (task, error);
+            g_object_unref (task);
+            return;
+        }
+        ctx->step++;
+        device_open_step (task);
+        return;
+    }
+
+    g_assert (ctx->pipelined_pending > 0);
+    ctx->pipelined_pending--;
+
+    if (error) {
+        if (!ctx->pipelined_error)
+            ctx->pipelined_error = error;
+        else
+            g_error_free (error);
+    }
+
+    if (ctx->pipelined_pending > 0)
+        return;
+
+    if (ctx->pipelined_error) {
+        g_task_return_error (task, g_steal_pointer (&ctx->pipelined_error));
+        g_object_unref (task);
+        return;
+    }
+
+    /* The step was already moved past the pipelined operations */
+    device_open_step (task);
+}
+
 static void
 setup_indications_ready (QmiEndpoint *endpoint,
                          GAsyncResult *res,
@@ -2295,23 +3347,20 @@ ctl_set_data_format_ready (QmiClientCtl *client,
                            GTask *task)
 {
     QmiDevice *self;
-    DeviceOpenContext *ctx;
     QmiMessageCtlSetDataFormatOutput *output = NULL;
     GError *error = NULL;
 
     output = qmi_client_ctl_set_data_format_finish (client, res, &error);
     /* Check result of the async operation */
     if (!output) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_operation_complete (task, error);
         return;
     }
 
     /* Check result of the QMI operation */
     if (!qmi_message_ctl_set_data_format_output_get_result (output, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
         qmi_message_ctl_set_data_format_output_unref (output);
+        device_open_operation_complete (task, error);
         return;
     }
 
@@ -2323,9 +3372,7 @@ ctl_set_data_format_ready (QmiClientCtl *client,
     qmi_message_ctl_set_data_format_output_unref (output);
 
     /* Go on */
-    ctx = g_task_get_task_data (task);
-    ctx->step++;
-    device_open_step (task);
+    device_open_operation_complete (task, NULL);
 }
 
 static void
@@ -2361,27 +3408,55 @@ sync_ready (QmiClientCtl *client_ctl,
 
             /* Otherwise, propagate the error */
         }
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_operation_complete (task, error);
         return;
     }
 
     /* Check result of the QMI operation */
     if (!qmi_message_ctl_sync_output_get_result (output, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
         qmi_message_ctl_sync_output_unref (output);
+        device_open_operation_complete (task, error);
         return;
     }
 
     g_debug ("[%s] sync operation finished",
              qmi_file_get_path_display (self->priv->file));
 
-    qmi_message_ctl_sync_output_unref (output);
+    qmi_message_ctl_sync_output_unref (output);
+
+    /* Go on */
+    device_open_operation_complete (task, NULL);
+}
+
+static void
+debug_supported_services (QmiDevice *self)
+{
+    guint i;
+
+    g_debug ("[%s] device supports %u services:",
+             qmi_file_get_path_display (self->priv->file),
+             self->priv->supported_services->len);
+    for (i = 0; i < self->priv->supported_services->len; i++) {
+        QmiMessageCtlGetVersionInfoOutputServiceListService *info;
+        const gchar *service_str;
 
-    /* Go on */
-    ctx->step++;
-    device_open_step (task);
+        info = &g_array_index (self->priv->supported_services,
+                               QmiMessageCtlGetVersionInfoOutputServiceListService,
+                               i);
+        service_str = qmi_service_get_string (info->service);
+        if (service_str)
+            g_debug ("[%s]    %s (%u.%u)",
+                     qmi_file_get_path_display (self->priv->file),
+                     service_str,
+                     info->major_version,
+                     info->minor_version);
+        else
+            g_debug ("[%s]    unknown [0x%02x] (%u.%u)",
+                     qmi_file_get_path_display (self->priv->file),
+                     info->service,
+                     info->major_version,
+                     info->minor_version);
+    }
 }
 
 static void
@@ -2394,7 +3469,6 @@ open_version_info_ready (QmiClientCtl *client_ctl,
     GArray *service_list;
     QmiMessageCtlGetVersionInfoOutput *output;
     GError *error = NULL;
-    guint i;
 
     self = g_task_get_source_object (task);
     ctx = g_task_get_task_data (task);
@@ -2420,16 +3494,14 @@ open_version_info_ready (QmiClientCtl *client_ctl,
             /* Otherwise, propagate the error */
         }
 
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_operation_complete (task, error);
         return;
     }
 
     /* Check result of the QMI operation */
     if (!qmi_message_ctl_get_version_info_output_get_result (output, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
         qmi_message_ctl_get_version_info_output_unref (output);
+        device_open_operation_complete (task, error);
         return;
     }
 
@@ -2439,39 +3511,20 @@ open_version_info_ready (QmiClientCtl *client_ctl,
                                                               &service_list,
                                                               NULL);
 
+    if (self->priv->supported_services && !service_lists_equal (self->priv->supported_services, service_list))
+        g_debug ("[%s] cached version info outdated, updating...",
+                 qmi_file_get_path_display (self->priv->file));
     g_clear_pointer (&self->priv->supported_services, g_array_unref);
     self->priv->supported_services = g_array_ref (service_list);
+    version_info_cache_store (qmi_file_get_path (self->priv->file), service_list);
+    version_info_disk_cache_store (self, service_list);
 
-    g_debug ("[%s] device supports %u services:",
-             qmi_file_get_path_display (self->priv->file),
-             self->priv->supported_services->len);
-    for (i = 0; i < self->priv->supported_services->len; i++) {
-        QmiMessageCtlGetVersionInfoOutputServiceListService *info;
-        const gchar *service_str;
-
-        info = &g_array_index (self->priv->supported_services,
-                               QmiMessageCtlGetVersionInfoOutputServiceListService,
-                               i);
-        service_str = qmi_service_get_string (info->service);
-        if (service_str)
-            g_debug ("[%s]    %s (%u.%u)",
-                     qmi_file_get_path_display (self->priv->file),
-                     service_str,
-                     info->major_version,
-                     info->minor_version);
-        else
-            g_debug ("[%s]    unknown [0x%02x] (%u.%u)",
-                     qmi_file_get_path_display (self->priv->file),
-                     info->service,
-                     info->major_version,
-                     info->minor_version);
-    }
+    debug_supported_services (self);
 
     qmi_message_ctl_get_version_info_output_unref (output);
 
     /* Go on */
-    ctx->step++;
-    device_open_step (task);
+    device_open_operation_complete (task, NULL);
 }
 
 #if QMI_QRTR_SUPPORTED
@@ -2480,14 +3533,12 @@ static void
 build_services_from_qrtr_node (GTask *task)
 {
     QmiDevice           *self;
-    DeviceOpenContext   *ctx;
     GList               *services;
     guint                n_services;
     GList               *elem;
     QrtrNodeServiceInfo *qrtr_serv_info;
 
     self = g_task_get_source_object (task);
-    ctx = g_task_get_task_data (task);
 
     g_assert (self->priv->node);
     services = qrtr_node_peek_service_info_list (self->priv->node);
@@ -2525,8 +3576,7 @@ build_services_from_qrtr_node (GTask *task)
                      info.major_version);
     }
 
-    ctx->step++;
-    device_open_step (task);
+    device_open_operation_complete (task, NULL);
 }
 #endif
 
@@ -2663,6 +3713,112 @@ out:
     return TRUE;
 }
 
+static void
+device_open_run_version_info (GTask *task)
+{
+    QmiDevice         *self;
+    DeviceOpenContext *ctx;
+    GArray            *cached = NULL;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* Setup how many times to retry... We'll retry once per second */
+    ctx->version_check_retries = ctx->timeout > 0 ? ctx->timeout : 1;
+    g_debug ("[%s] checking version info (%u retries)...",
+             qmi_file_get_path_display (self->priv->file),
+             ctx->version_check_retries);
+#if QMI_QRTR_SUPPORTED
+    if (self->priv->node) {
+        g_debug ("[%s] QRTR does not support version info check: checking only for available services",
+                 qmi_file_get_path_display (self->priv->file));
+        build_services_from_qrtr_node (task);
+        return;
+    }
+#endif
+
+    /* When pipelining, the version info of a previous open of the same path
+     * is used right away; if there is none, the one in the persistent cache.
+     * Either one is validated in the background. */
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_PIPELINED)
+        cached = version_info_cache_lookup (qmi_file_get_path (self->priv->file));
+    if (!cached)
+        cached = version_info_disk_cache_load (self);
+    if (cached) {
+        g_debug ("[%s] using cached version info",
+                 qmi_file_get_path_display (self->priv->file));
+        g_clear_pointer (&self->priv->supported_services, g_array_unref);
+        self->priv->supported_services = cached;
+        debug_supported_services (self);
+        version_info_validate (self);
+        device_open_operation_complete (task, NULL);
+        return;
+    }
+
+    qmi_client_ctl_get_version_info (self->priv->client_ctl,
+                                     NULL,
+                                     1,
+                                     g_task_get_cancellable (task),
+                                     (GAsyncReadyCallback)open_version_info_ready,
+                                     task);
+}
+
+static void
+device_open_run_sync (GTask *task)
+{
+    QmiDevice         *self;
+    DeviceOpenContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* Setup how many times to retry... We'll retry once per second */
+    ctx->sync_retries = ctx->timeout > SYNC_TIMEOUT_SECS ? (ctx->timeout / SYNC_TIMEOUT_SECS) : 1;
+    g_debug ("[%s] running sync (%u retries)...",
+             qmi_file_get_path_display (self->priv->file),
+             ctx->sync_retries);
+    qmi_client_ctl_sync (self->priv->client_ctl,
+                         NULL,
+                         SYNC_TIMEOUT_SECS,
+                         g_task_get_cancellable (task),
+                         (GAsyncReadyCallback)sync_ready,
+                         task);
+}
+
+static void
+device_open_run_netport (GTask *task)
+{
+    QmiDevice                       *self;
+    DeviceOpenContext               *ctx;
+    QmiMessageCtlSetDataFormatInput *input;
+    QmiCtlDataFormat                 qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_ABSENT;
+    QmiCtlDataLinkProtocol           link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_802_3;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    g_debug ("[%s] setting network port data format...",
+             qmi_file_get_path_display (self->priv->file));
+
+    input = qmi_message_ctl_set_data_format_input_new ();
+
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_QOS_HEADER)
+        qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_PRESENT;
+    qmi_message_ctl_set_data_format_input_set_format (input, qos, NULL);
+
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_RAW_IP)
+        link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_RAW_IP;
+    qmi_message_ctl_set_data_format_input_set_protocol (input, link_protocol, NULL);
+
+    qmi_client_ctl_set_data_format (self->priv->client_ctl,
+                                    input,
+                                    5,
+                                    NULL,
+                                    (GAsyncReadyCallback)ctl_set_data_format_ready,
+                                    task);
+    qmi_message_ctl_set_data_format_input_unref (input);
+}
+
 static void
 device_open_step (GTask *task)
 {
@@ -2716,29 +3872,42 @@ device_open_step (GTask *task)
                            task);
         return;
 
+    case DEVICE_OPEN_CONTEXT_STEP_FLAGS_PIPELINED:
+        /* Run version info, sync and network port setup all at once? */
+        if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_PIPELINED) {
+            g_debug ("[%s] running pipelined open operations...",
+                     qmi_file_get_path_display (self->priv->file));
+
+            /* Once all are done, we go on with the step right after the
+             * ones being pipelined */
+            ctx->step = DEVICE_OPEN_CONTEXT_STEP_FLAGS_EXPECT_INDICATIONS;
+
+            /* Hold one pending operation ourselves until all the others have
+             * been launched, so that any operation completing right away
+             * doesn't make the sequence go on too early */
+            ctx->pipelined_pending = 1;
+            if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_VERSION_INFO) {
+                ctx->pipelined_pending++;
+                device_open_run_version_info (task);
+            }
+            if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_SYNC) {
+                ctx->pipelined_pending++;
+                device_open_run_sync (task);
+            }
+            if (ctx->flags & NETPORT_FLAGS) {
+                ctx->pipelined_pending++;
+                device_open_run_netport (task);
+            }
+            device_open_operation_complete (task, NULL);
+            return;
+        }
+        ctx->step++;
+        /* Fall through */
+
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_VERSION_INFO:
         /* Query version info? */
         if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_VERSION_INFO) {
-            /* Setup how many times to retry... We'll retry once per second */
-            ctx->version_check_retries = ctx->timeout > 0 ? ctx->timeout : 1;
-            g_debug ("[%s] checking version info (%u retries)...",
-                     qmi_file_get_path_display (self->priv->file),
-                     ctx->version_check_retries);
-#if QMI_QRTR_SUPPORTED
-            if (self->priv->node) {
-                g_debug ("[%s] QRTR does not support version info check: checking only for available services",
-                         qmi_file_get_path_display (self->priv->file));
-                build_services_from_qrtr_node (task);
-            }
-            else
-#endif
-                qmi_client_ctl_get_version_info (self->priv->client_ctl,
-                                                NULL,
-                                                1,
-                                                g_task_get_cancellable (task),
-                                                (GAsyncReadyCallback)open_version_info_ready,
-                                                task);
-
+            device_open_run_version_info (task);
             return;
         }
         ctx->step++;
@@ -2747,17 +3916,7 @@ device_open_step (GTask *task)
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_SYNC:
         /* Sync? */
         if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_SYNC) {
-            /* Setup how many times to retry... We'll retry once per second */
-            ctx->sync_retries = ctx->timeout > SYNC_TIMEOUT_SECS ? (ctx->timeout / SYNC_TIMEOUT_SECS) : 1;
-            g_debug ("[%s] running sync (%u retries)...",
-                     qmi_file_get_path_display (self->priv->file),
-                     ctx->sync_retries);
-            qmi_client_ctl_sync (self->priv->client_ctl,
-                                 NULL,
-                                 SYNC_TIMEOUT_SECS,
-                                 g_task_get_cancellable (task),
-                                 (GAsyncReadyCallback)sync_ready,
-                                 task);
+            device_open_run_sync (task);
             return;
         }
         ctx->step++;
@@ -2766,30 +3925,7 @@ device_open_step (GTask *task)
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_NETPORT:
         /* Network port setup */
         if (ctx->flags & NETPORT_FLAGS) {
-            QmiMessageCtlSetDataFormatInput *input;
-            QmiCtlDataFormat qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_ABSENT;
-            QmiCtlDataLinkProtocol link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_802_3;
-
-            g_debug ("[%s] setting network port data format...",
-                     qmi_file_get_path_display (self->priv->file));
-
-            input = qmi_message_ctl_set_data_format_input_new ();
-
-            if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_QOS_HEADER)
-                qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_PRESENT;
-            qmi_message_ctl_set_data_format_input_set_format (input, qos, NULL);
-
-            if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_RAW_IP)
-                link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_RAW_IP;
-            qmi_message_ctl_set_data_format_input_set_protocol (input, link_protocol, NULL);
-
-            qmi_client_ctl_set_data_format (self->priv->client_ctl,
-                                            input,
-                                            5,
-                                            NULL,
-                                            (GAsyncReadyCallback)ctl_set_data_format_ready,
-                                            task);
-            qmi_message_ctl_set_data_format_input_unref (input);
+            device_open_run_netport (task);
             return;
         }
         ctx->step++;
@@ -2849,7 +3985,7 @@ qmi_device_open (QmiDevice *self,
              flags_str);
     g_free (flags_str);
 
-    ctx = g_slice_new (DeviceOpenContext);
+    ctx = g_slice_new0 (DeviceOpenContext);
     ctx->step = DEVICE_OPEN_CONTEXT_STEP_FIRST;
     ctx->flags = flags;
     ctx->timeout = timeout;
@@ -2912,6 +4048,7 @@ qmi_device_close_async (QmiDevice           *self,
 {
     GTask        *task;
     CloseContext *ctx;
+    GError       *error;
 
     task = g_task_new (self, cancellable, callback, user_data);
 
@@ -2922,6 +4059,14 @@ qmi_device_close_async (QmiDevice           *self,
         return;
     }
 
+    /* The cached version info is kept, but no longer validated */
+    version_info_validate_cancel (self);
+
+    /* Requests not yet sent will never be */
+    error = g_error_new (QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE, "Device closed");
+    device_fail_queued_transactions (self, error);
+    g_error_free (error);
+
     /* Steal endpoint setup from private info, it will be freed once
      * the task is completed and disposed */
     ctx = g_slice_new0 (CloseContext);
@@ -2971,29 +4116,56 @@ transaction_early_error (QmiDevice   *self,
     g_error_free (error);
 }
 
-void
-qmi_device_command_abortable (QmiDevice                                *self,
-                              QmiMessage                               *message,
-                              QmiMessageContext                        *message_context,
-                              guint                                     timeout,
-                              QmiDeviceCommandAbortableBuildRequestFn   abort_build_request_fn,
-                              QmiDeviceCommandAbortableParseResponseFn  abort_parse_response_fn,
-                              gpointer                                  abort_user_data,
-                              GDestroyNotify                            abort_user_data_free,
-                              GCancellable                             *cancellable,
-                              GAsyncReadyCallback                       callback,
-                              gpointer                                  user_data)
+static void
+device_command_send (QmiDevice   *self,
+                     Transaction *tr,
+                     guint        timeout)
 {
     GError *error = NULL;
-    Transaction *tr;
 
-    g_return_if_fail (QMI_IS_DEVICE (self));
-    g_return_if_fail (message != NULL);
-    g_return_if_fail (timeout > 0);
+    /* Device may have been closed while the request was queued */
+    if (!qmi_device_is_open (self)) {
+        error = g_error_new (QMI_CORE_ERROR,
+                             QMI_CORE_ERROR_WRONG_STATE,
+                             "Device must be open to send commands");
+        transaction_early_error (self, tr, FALSE, error);
+        return;
+    }
 
-    /* either none or both set */
-    g_return_if_fail ((!abort_build_request_fn && !abort_parse_response_fn) ||
-                      (abort_build_request_fn  && abort_parse_response_fn));
+    /* Setup context to match response */
+    if (!device_store_transaction (self, tr, timeout, &error)) {
+        g_prefix_error (&error, "Cannot store transaction: ");
+        transaction_early_error (self, tr, FALSE, error);
+        return;
+    }
+
+    /* From now on, if we want to complete the transaction with an early error,
+     *  it needs to be removed from the tracking table as well. */
+
+    trace_message (self, tr->message, TRUE, "request", tr->message_context);
+
+    if (!qmi_endpoint_send (self->priv->endpoint, tr->message, timeout, tr->cancellable, &error)) {
+        transaction_early_error (self, tr, TRUE, error);
+        return;
+    }
+}
+
+static void
+device_command (QmiDevice                                *self,
+                QmiMessage                               *message,
+                QmiMessageContext                        *message_context,
+                guint                                     timeout,
+                QmiDeviceCommandAbortableBuildRequestFn   abort_build_request_fn,
+                QmiDeviceCommandAbortableParseResponseFn  abort_parse_response_fn,
+                gpointer                                  abort_user_data,
+                GDestroyNotify                            abort_user_data_free,
+                gboolean                                  flow_controlled,
+                GCancellable                             *cancellable,
+                GAsyncReadyCallback                       callback,
+                gpointer                                  user_data)
+{
+    GError *error = NULL;
+    Transaction *tr;
 
     /* Use a proper transaction id for CTL messages if they don't have one */
     if (qmi_message_get_service (message) == QMI_SERVICE_CTL &&
@@ -3027,6 +4199,16 @@ qmi_device_command_abortable (QmiDevice                                *self,
         return;
     }
 
+    /* No transaction ID is given when all of them are in use by the client */
+    if (qmi_message_get_transaction_id (message) == 0) {
+        error = g_error_new (QMI_CORE_ERROR,
+                             QMI_CORE_ERROR_FAILED,
+                             "Cannot send message in service '%s' without a transaction ID: all in use",
+                             qmi_service_get_string (qmi_message_get_service (message)));
+        transaction_early_error (self, tr, FALSE, error);
+        return;
+    }
+
     /* If message is not abortable, we should not allow using the abortable() interface */
     if (!__qmi_message_is_abortable (message, message_context)) {
         if (abort_build_request_fn || abort_parse_response_fn) {
@@ -3044,22 +4226,46 @@ qmi_device_command_abortable (QmiDevice                                *self,
         tr->abort_user_data_free    = abort_user_data_free;
     }
 
-    /* Setup context to match response */
-    if (!device_store_transaction (self, tr, timeout, &error)) {
-        g_prefix_error (&error, "Cannot store transaction: ");
-        transaction_early_error (self, tr, FALSE, error);
+    /* Queue the request if the client has no credits left */
+    if (flow_controlled && !flow_control_acquire (self, tr, timeout))
         return;
-    }
 
-    /* From now on, if we want to complete the transaction with an early error,
-     *  it needs to be removed from the tracking table as well. */
+    device_command_send (self, tr, timeout);
+}
+
+void
+qmi_device_command_abortable (QmiDevice                                *self,
+                              QmiMessage                               *message,
+                              QmiMessageContext                        *message_context,
+                              guint                                     timeout,
+                              QmiDeviceCommandAbortableBuildRequestFn   abort_build_request_fn,
+                              QmiDeviceCommandAbortableParseResponseFn  abort_parse_response_fn,
+                              gpointer                                  abort_user_data,
+                              GDestroyNotify                            abort_user_data_free,
+                              GCancellable                             *cancellable,
+                              GAsyncReadyCallback                       callback,
+                              gpointer                                  user_data)
+{
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (message != NULL);
+    g_return_if_fail (timeout > 0);
 
-    trace_message (self, message, TRUE, "request", message_context);
+    /* either none or both set */
+    g_return_if_fail ((!abort_build_request_fn && !abort_parse_response_fn) ||
+                      (abort_build_request_fn  && abort_parse_response_fn));
 
-    if (!qmi_endpoint_send (self->priv->endpoint, message, timeout, cancellable, &error)) {
-        transaction_early_error (self, tr, TRUE, error);
-        return;
-    }
+    device_command (self,
+                    message,
+                    message_context,
+                    timeout,
+                    abort_build_request_fn,
+                    abort_parse_response_fn,
+                    abort_user_data,
+                    abort_user_data_free,
+                    TRUE,
+                    cancellable,
+                    callback,
+                    user_data);
 }
 
 /*****************************************************************************/
@@ -3324,6 +4530,15 @@ set_property (GObject      *object,
     case PROP_CONSECUTIVE_TIMEOUTS:
         g_assert_not_reached ();
         break;
+    case PROP_VERSION_INFO_CACHE_DIR:
+        g_free (self->priv->version_info_cache_dir);
+        self->priv->version_info_cache_dir = g_value_dup_string (value);
+        break;
+    case PROP_MAX_IN_FLIGHT_PER_CLIENT:
+        self->priv->max_in_flight_per_client = g_value_get_uint (value);
+        /* More credits may be available now */
+        flow_control_schedule_dispatch (self);
+        break;
 #if QMI_QRTR_SUPPORTED
     case PROP_NODE:
         g_assert (!self->priv->node);
@@ -3360,6 +4575,12 @@ get_property (GObject    *object,
     case PROP_CONSECUTIVE_TIMEOUTS:
         g_value_set_uint (value, self->priv->consecutive_timeouts);
         break;
+    case PROP_VERSION_INFO_CACHE_DIR:
+        g_value_set_string (value, self->priv->version_info_cache_dir);
+        break;
+    case PROP_MAX_IN_FLIGHT_PER_CLIENT:
+        g_value_set_uint (value, self->priv->max_in_flight_per_client);
+        break;
 #if QMI_QRTR_SUPPORTED
     case PROP_NODE:
         g_value_set_object (value, self->priv->node);
@@ -3380,11 +4601,19 @@ qmi_device_init (QmiDevice *self)
 
     self->priv->transactions = g_hash_table_new (g_direct_hash,
                                                  g_direct_equal);
+    self->priv->transaction_ids = g_hash_table_new_full (g_direct_hash,
+                                                         g_direct_equal,
+                                                         NULL,
+                                                         (GDestroyNotify)transaction_ids_free);
 
     self->priv->registered_clients = g_hash_table_new_full (g_direct_hash,
                                                             g_direct_equal,
                                                             NULL,
                                                             g_object_unref);
+    self->priv->flow_control = g_hash_table_new_full (g_direct_hash,
+                                                      g_direct_equal,
+                                                      NULL,
+                                                      (GDestroyNotify)flow_control_client_free);
     self->priv->proxy_path = g_strdup (QMI_PROXY_SOCKET_PATH);
 }
 
@@ -3406,6 +4635,8 @@ dispose (GObject *object)
 {
     QmiDevice *self = QMI_DEVICE (object);
 
+    version_info_validate_cancel (self);
+
     /* unregister our CTL client */
     if (self->priv->client_ctl)
         unregister_client (self, QMI_CLIENT (self->priv->client_ctl));
@@ -3438,6 +4669,7 @@ dispose (GObject *object)
     }
 
     g_clear_object (&self->priv->net_port_manager);
+    g_clear_object (&self->priv->link_inventory);
     g_clear_object (&self->priv->file);
 
 #if QMI_QRTR_SUPPORTED
@@ -3459,13 +4691,18 @@ finalize (GObject *object)
         g_hash_table_unref (self->priv->transactions);
     }
 
+    g_hash_table_unref (self->priv->transaction_ids);
     g_hash_table_unref (self->priv->registered_clients);
+    g_hash_table_unref (self->priv->flow_control);
 
     if (self->priv->supported_services)
         g_array_unref (self->priv->supported_services);
 
     g_free (self->priv->proxy_path);
     g_free (self->priv->wwan_iface);
+    g_clear_pointer (&self->priv->raw_ip_attribute, qmi_sysfs_attribute_unref);
+    g_clear_pointer (&self->priv->pass_through_attribute, qmi_sysfs_attribute_unref);
+    g_free (self->priv->version_info_cache_dir);
 
     G_OBJECT_CLASS (qmi_device_parent_class)->finalize (object);
 }
@@ -3555,6 +4792,44 @@ qmi_device_class_init (QmiDeviceClass *klass)
                            G_PARAM_READABLE);
     g_object_class_install_property (object_class, PROP_CONSECUTIVE_TIMEOUTS, properties[PROP_CONSECUTIVE_TIMEOUTS]);
 
+    /**
+     * QmiDevice:device-version-info-cache-dir:
+     *
+     * Directory where the list of services supported by the device is
+     * cached, keyed by USB device path and firmware revision. Opens with
+     * %QMI_DEVICE_OPEN_FLAGS_VERSION_INFO and qmi_device_get_service_version_info()
+     * report the cached list without waiting for the device, and validate it
+     * in the background, replacing it if the device reports a different one.
+     * Give %QMI_DEVICE_OPEN_FLAGS_SYNC as well to still wait for the modem to
+     * be ready when opening.
+     *
+     * Since: 1.40
+     */
+    properties[PROP_VERSION_INFO_CACHE_DIR] =
+        g_param_spec_string (QMI_DEVICE_VERSION_INFO_CACHE_DIR,
+                             "Version info cache directory",
+                             "Directory where the service version info is cached",
+                             NULL,
+                             G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_VERSION_INFO_CACHE_DIR, properties[PROP_VERSION_INFO_CACHE_DIR]);
+
+    /**
+     * QmiDevice:device-max-in-flight-per-client:
+     *
+     * Maximum number of requests each client may have in flight at the same
+     * time; additional requests are queued until one of the ongoing ones
+     * completes. Requests in the CTL service are not limited.
+     *
+     * Since: 1.40
+     */
+    properties[PROP_MAX_IN_FLIGHT_PER_CLIENT] =
+        g_param_spec_uint (QMI_DEVICE_MAX_IN_FLIGHT_PER_CLIENT,
+                           "Max in flight per client",
+                           "Maximum number of in-flight requests per client, or 0 for no limit",
+                           0, G_MAXUINT, 0,
+                           G_PARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_MAX_IN_FLIGHT_PER_CLIENT, properties[PROP_MAX_IN_FLIGHT_PER_CLIENT]);
+
     /**
      * QmiDevice:device-node:
      *
@@ -3610,4 +4885,31 @@ qmi_device_class_init (QmiDeviceClass *klass)
                       NULL,
                       G_TYPE_NONE,
                       0);
+
+    /**
+     * QmiDevice::links-changed:
+     * @object: A #QmiDevice.
+     * @base_ifname: the base interface.
+     *
+     * The ::links-changed signal is emitted when virtual network interfaces
+     * are added to or removed from @base_ifname, either by this or by any
+     * other process.
+     *
+     * Once link management is used for the first time, the WWAN interface of
+     * the device is monitored, as well as any other base interface given to
+     * the link management methods.
+     *
+     * Since: 1.40
+     */
+    signals[SIGNAL_LINKS_CHANGED] =
+        g_signal_new (QMI_DEVICE_SIGNAL_LINKS_CHANGED,
+                      G_OBJECT_CLASS_TYPE (G_OBJECT_CLASS (klass)),
+                      G_SIGNAL_RUN_LAST,
+                      0,
+                      NULL,
+                      NULL,
+                      NULL,
+                      G_TYPE_NONE,
+                      1,
+                      G_TYPE_STRING);
 }
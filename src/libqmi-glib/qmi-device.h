@@ -98,6 +98,24 @@ typedef struct _QmiDevicePrivate QmiDevicePrivate;
  */
 #define QMI_DEVICE_CONSECUTIVE_TIMEOUTS "device-consecutive-timeouts"
 
+/**
+ * QMI_DEVICE_VERSION_INFO_CACHE_DIR:
+ *
+ * Symbol defining the #QmiDevice:device-version-info-cache-dir property.
+ *
+ * Since: 1.40
+ */
+#define QMI_DEVICE_VERSION_INFO_CACHE_DIR "device-version-info-cache-dir"
+
+/**
+ * QMI_DEVICE_MAX_IN_FLIGHT_PER_CLIENT:
+ *
+ * Symbol defining the #QmiDevice:device-max-in-flight-per-client property.
+ *
+ * Since: 1.40
+ */
+#define QMI_DEVICE_MAX_IN_FLIGHT_PER_CLIENT "device-max-in-flight-per-client"
+
 /**
  * QMI_DEVICE_SIGNAL_INDICATION:
  *
@@ -116,6 +134,15 @@ typedef struct _QmiDevicePrivate QmiDevicePrivate;
  */
 #define QMI_DEVICE_SIGNAL_REMOVED "device-removed"
 
+/**
+ * QMI_DEVICE_SIGNAL_LINKS_CHANGED:
+ *
+ * Symbol defining the #QmiDevice::links-changed signal.
+ *
+ * Since: 1.40
+ */
+#define QMI_DEVICE_SIGNAL_LINKS_CHANGED "links-changed"
+
 /**
  * QmiDevice:
  *
@@ -251,6 +278,7 @@ gboolean qmi_device_is_open (QmiDevice *self);
  * @QMI_DEVICE_OPEN_FLAGS_MBIM: Open an MBIM port with QMUX tunneling service. Since 1.16.
  * @QMI_DEVICE_OPEN_FLAGS_AUTO: Open a port either in QMI or MBIM mode, depending on device driver. Since 1.18.
  * @QMI_DEVICE_OPEN_FLAGS_EXPECT_INDICATIONS: Explicitly state that indications are wanted (implicit in QMI mode, optional when in MBIM mode).
+ * @QMI_DEVICE_OPEN_FLAGS_PIPELINED: Run the version info check, the sync and the network port setup concurrently instead of one after the other. The version info retrieved for a given device path is also kept within the process, across closes and resets, and later pipelined opens of the same path complete the version info check right away with it, validating it afterwards in the background. Such opens don't wait for the modem to reply to any version info query, so give @QMI_DEVICE_OPEN_FLAGS_SYNC as well to still wait for the modem to be ready. Since 1.40.
  *
  * Flags to specify which actions to be performed when the device is open.
  *
@@ -268,6 +296,7 @@ typedef enum { /*< since=1.0 >*/
     QMI_DEVICE_OPEN_FLAGS_MBIM               = 1 << 7,
     QMI_DEVICE_OPEN_FLAGS_AUTO               = 1 << 8,
     QMI_DEVICE_OPEN_FLAGS_EXPECT_INDICATIONS = 1 << 9,
+    QMI_DEVICE_OPEN_FLAGS_PIPELINED          = 1 << 10,
 } QmiDeviceOpenFlags;
 
 /**
@@ -413,6 +442,56 @@ typedef enum { /*< since=1.0 >*/
     QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID = 1 << 0
 } QmiDeviceReleaseClientFlags;
 
+/**
+ * qmi_device_allocate_clients:
+ * @self: a #QmiDevice.
+ * @services: (array length=n_services): an array of valid #QmiService values.
+ * @n_services: number of elements in @services.
+ * @timeout: maximum time to wait for each allocation.
+ * @cancellable: optional #GCancellable object, %NULL to ignore.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished.
+ * @user_data: the data to pass to callback function.
+ *
+ * Asynchronously allocates a new #QmiClient in @self for each one of the
+ * given @services, running the CID allocations in parallel.
+ *
+ * If any of the allocations fails, the clients already allocated are
+ * released and the operation returns the first error found.
+ *
+ * When the operation is finished @callback will be called. You can then call
+ * qmi_device_allocate_clients_finish() to get the result of the operation.
+ *
+ * Note: Clients for the %QMI_SERVICE_CTL cannot be created with this method;
+ * instead get/peek the implicit one from @self.
+ *
+ * Since: 1.40
+ */
+void qmi_device_allocate_clients (QmiDevice           *self,
+                                  const QmiService    *services,
+                                  guint                n_services,
+                                  guint                timeout,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data);
+
+/**
+ * qmi_device_allocate_clients_finish:
+ * @self: a #QmiDevice.
+ * @res: a #GAsyncResult.
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with qmi_device_allocate_clients().
+ *
+ * Returns: (transfer full) (element-type QmiClient): a #GPtrArray with one
+ * #QmiClient for each requested service, in the same order, or %NULL if
+ * @error is set. The returned value should be freed with g_ptr_array_unref().
+ *
+ * Since: 1.40
+ */
+GPtrArray *qmi_device_allocate_clients_finish (QmiDevice     *self,
+                                               GAsyncResult  *res,
+                                               GError       **error);
+
 /**
  * qmi_device_release_client:
  * @self: a #QmiDevice.
@@ -696,6 +775,9 @@ typedef struct {
  *
  * Asynchronously requests the service version information of the device.
  *
+ * If #QmiDevice:device-version-info-cache-dir is set and the information is
+ * cached, it is reported right away and validated in the background.
+ *
  * When the operation is finished, @callback will be invoked in the thread-default main loop of the thread you are calling this method from.
  *
  * You can then call qmi_device_get_service_version_info_finish() to get the result of the operation.
@@ -1105,6 +1187,77 @@ gchar *qmi_device_add_link_with_flags_and_initial_mux_id_finish (QmiDevice     *
                                                                  guint         *mux_id,
                                                                  GError       **error);
 
+/**
+ * qmi_device_add_links:
+ * @self: a #QmiDevice.
+ * @n_links: the number of links to create.
+ * @initial_mux_id: the initial mux id from which the available mux ids have
+ *   to be searched for in the [%QMI_DEVICE_MUX_ID_MIN,%QMI_DEVICE_MUX_ID_MAX]
+ *   range.
+ * @base_ifname: the interface which the new links will be created on.
+ * @ifname_prefix: the prefix suggested to be used for the name of the new links
+ *   created.
+ * @flags: bitmask of %QmiDeviceAddLinkFlags values to pass to the kernel when
+ *   creating the new links.
+ * @timeout: maximum time, in seconds, to wait for each of the kernel
+ *   operations to complete.
+ * @cancellable: a #GCancellable, or %NULL.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished.
+ * @user_data: the data to pass to callback function.
+ *
+ * Asynchronously creates @n_links new virtual network devices in the same way
+ * as qmi_device_add_link_with_flags_and_initial_mux_id() does, but selecting
+ * all the mux ids at once and, when using the rmnet backend, sending all the
+ * link creation requests to the kernel in a single batch.
+ *
+ * All the mux ids selected must be within the
+ * [%QMI_DEVICE_MUX_ID_MIN,%QMI_DEVICE_MUX_ID_MAX] range, so @n_links must not
+ * be greater than the number of mux ids available from @initial_mux_id
+ * onwards.
+ *
+ * The operation either creates all the requested links or none of them: if
+ * any of the links cannot be created, the ones already created are removed
+ * before the operation finishes, and any failure removing them is reported
+ * along with the original error.
+ *
+ * When the operation is finished @callback will be called. You can then call
+ * qmi_device_add_links_finish() to get the result of the operation.
+ *
+ * Since: 1.40
+ */
+void qmi_device_add_links (QmiDevice             *self,
+                           guint                  n_links,
+                           guint                  initial_mux_id,
+                           const gchar           *base_ifname,
+                           const gchar           *ifname_prefix,
+                           QmiDeviceAddLinkFlags  flags,
+                           guint                  timeout,
+                           GCancellable          *cancellable,
+                           GAsyncReadyCallback    callback,
+                           gpointer               user_data);
+
+/**
+ * qmi_device_add_links_finish:
+ * @self: a #QmiDevice.
+ * @res: a #GAsyncResult.
+ * @mux_ids: (out) (optional) (transfer full) (element-type guint): return
+ *   location for a #GArray with the mux IDs of the links created, in the same
+ *   order as the interface names returned.
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with qmi_device_add_links().
+ *
+ * Returns: (transfer full) (element-type utf8): a #GPtrArray with the names of
+ * the net interfaces created, or %NULL if @error is set. The returned value
+ * should be freed with g_ptr_array_unref().
+ *
+ * Since: 1.40
+ */
+GPtrArray *qmi_device_add_links_finish (QmiDevice     *self,
+                                        GAsyncResult  *res,
+                                        GArray       **mux_ids,
+                                        GError       **error);
+
 /**
  * qmi_device_delete_link:
  * @self: a #QmiDevice.
@@ -1211,6 +1364,12 @@ gboolean qmi_device_delete_all_links_finish (QmiDevice     *self,
  * Synchronously lists all virtual network interfaces that have been previously
  * created with qmi_device_add_link() in @base_ifname.
  *
+ * Since 1.40, the links of each @base_ifname are listed from sysfs only the
+ * first time, and then kept up to date with the link notifications of the
+ * kernel whenever these are available, also after the expected data format
+ * changes. The #QmiDevice::links-changed signal is emitted when the links in
+ * @base_ifname change.
+ *
  * Returns: %TRUE if successful, %FALSE if @error is set.
  *
  * Since: 1.28
@@ -1327,6 +1486,17 @@ QrtrNode *qmi_device_peek_node (QmiDevice *self);
 
 #endif /* QMI_QRTR_SUPPORTED */
 
+/* not part of the public API */
+
+#if defined (LIBQMI_GLIB_COMPILATION)
+G_GNUC_INTERNAL
+guint16 __qmi_device_get_free_transaction_id (QmiDevice  *self,
+                                              QmiService  service,
+                                              guint8      cid,
+                                              guint16     first,
+                                              guint16     max_id);
+#endif
+
 G_END_DECLS
 
 #endif /* _LIBQMI_GLIB_QMI_DEVICE_H_ */
@@ -34,9 +34,11 @@
 
 #include "qmi-endpoint-qmux.h"
 #include "qmi-ctl.h"
+#include "qmi-epoll-source.h"
 #include "qmi-errors.h"
 #include "qmi-error-types.h"
 #include "qmi-helpers.h"
+#include "qmi-utils.h"
 
 G_DEFINE_TYPE (QmiEndpointQmux, qmi_endpoint_qmux, QMI_TYPE_ENDPOINT)
 
@@ -46,6 +48,7 @@ struct _QmiEndpointQmuxPrivate {
     GInputStream *istream;
     GOutputStream *ostream;
     GSource *input_source;
+    QmiEpollWatch *input_watch;
 
     /* Proxy socket */
     gchar *proxy_path;
@@ -97,6 +100,38 @@ input_ready_cb (GInputStream *istream,
     return G_SOURCE_CONTINUE;
 }
 
+static gboolean
+input_watch_cb (gint             fd,
+                GIOCondition     condition,
+                QmiEndpointQmux *self)
+{
+    g_autoptr(QmiEndpointQmux)  self_ref = NULL;
+    QmiEpollWatch              *watch;
+
+    /* The hangup signal emitted while processing the input may end up
+     * closing the endpoint, and even disposing it */
+    self_ref = g_object_ref (self);
+    watch = self->priv->input_watch;
+
+    if (input_ready_cb (self->priv->istream, self) == G_SOURCE_CONTINUE)
+        return G_SOURCE_CONTINUE;
+
+    /* If still ours, the watch is removed by the shared source itself */
+    if (self->priv->input_watch == watch)
+        self->priv->input_watch = NULL;
+    return G_SOURCE_REMOVE;
+}
+
+static gint
+get_input_fd (QmiEndpointQmux *self)
+{
+    if (self->priv->fd >= 0)
+        return self->priv->fd;
+
+    g_assert (self->priv->socket_connection);
+    return g_socket_get_fd (g_socket_connection_get_socket (self->priv->socket_connection));
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -189,15 +224,32 @@ setup_iostream (GTask *task)
         return;
     }
 
-    /* Setup input events */
-    self->priv->input_source = g_pollable_input_stream_create_source (
-                                   G_POLLABLE_INPUT_STREAM (self->priv->istream),
-                                   NULL);
-    g_source_set_callback (self->priv->input_source,
-                           (GSourceFunc)input_ready_cb,
-                           self,
-                           NULL);
-    g_source_attach (self->priv->input_source, g_main_context_get_thread_default ());
+    /* Setup input events, either in the source shared by all endpoints
+     * or in our own pollable source */
+    if (qmi_utils_get_shared_io_source_enabled ()) {
+        GError *error = NULL;
+
+        self->priv->input_watch = qmi_epoll_watch_add (g_main_context_get_thread_default (),
+                                                       get_input_fd (self),
+                                                       (QmiEpollWatchFunc)input_watch_cb,
+                                                       self,
+                                                       &error);
+        if (!self->priv->input_watch) {
+            destroy_iostream (self);
+            g_task_return_error (task, error);
+            g_object_unref (task);
+            return;
+        }
+    } else {
+        self->priv->input_source = g_pollable_input_stream_create_source (
+                                       G_POLLABLE_INPUT_STREAM (self->priv->istream),
+                                       NULL);
+        g_source_set_callback (self->priv->input_source,
+                               (GSourceFunc)input_ready_cb,
+                               self,
+                               NULL);
+        g_source_attach (self->priv->input_source, g_main_context_get_thread_default ());
+    }
 
     if (!ctx->use_proxy) {
         /* We're done here */
@@ -521,6 +573,10 @@ destroy_iostream (QmiEndpointQmux *self)
         g_source_destroy (self->priv->input_source);
         g_clear_pointer (&self->priv->input_source, g_source_unref);
     }
+    if (self->priv->input_watch) {
+        qmi_epoll_watch_remove (self->priv->input_watch);
+        self->priv->input_watch = NULL;
+    }
     g_clear_object (&self->priv->istream);
     g_clear_object (&self->priv->ostream);
     g_clear_object (&self->priv->socket_connection);
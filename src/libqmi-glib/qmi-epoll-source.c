@@ -0,0 +1,283 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "qmi-epoll-source.h"
+#include "qmi-errors.h"
+#include "qmi-error-types.h"
+
+/* Maximum number of events processed in a single dispatch; if there are
+ * more, the epoll fd stays readable and we'll get dispatched again in the
+ * next main loop iteration. */
+#define MAX_EVENTS_PER_DISPATCH 64
+
+typedef struct {
+    GSource       source;
+    GMainContext *context;
+    gint          epfd;
+    gpointer      epfd_tag;
+    guint         n_watches; /* protected by the sources lock */
+    gboolean      dispatching;
+    GSList       *removed_watches;
+} QmiEpollSource;
+
+struct _QmiEpollWatch {
+    QmiEpollSource    *source;
+    gint               fd;
+    QmiEpollWatchFunc  func;
+    gpointer           user_data;
+    gboolean           removed;
+};
+
+/* One source per main context. Each source keeps a reference to its main
+ * context, so that the context used as key is not disposed (and its address
+ * reused by a different one) while the source is in the table. */
+G_LOCK_DEFINE_STATIC (sources);
+static GHashTable *sources;
+
+/*****************************************************************************/
+
+static void
+watch_free (QmiEpollWatch *watch)
+{
+    g_slice_free (QmiEpollWatch, watch);
+}
+
+static void
+epoll_source_unuse (QmiEpollSource *self)
+{
+    gboolean unused;
+
+    G_LOCK (sources);
+    {
+        g_assert (self->n_watches > 0);
+        self->n_watches--;
+        unused = (self->n_watches == 0);
+        /* Last watch gone, the source is no longer needed; once out of the
+         * table no new watch can use it */
+        if (unused)
+            g_hash_table_remove (sources, self->context);
+    }
+    G_UNLOCK (sources);
+
+    if (!unused)
+        return;
+
+    g_source_destroy ((GSource *)self);
+    g_source_unref ((GSource *)self);
+}
+
+/*****************************************************************************/
+
+static gboolean
+epoll_source_prepare (GSource *source,
+                      gint    *timeout)
+{
+    *timeout = -1;
+    return FALSE;
+}
+
+static gboolean
+epoll_source_check (GSource *source)
+{
+    QmiEpollSource *self = (QmiEpollSource *)source;
+
+    return !!(g_source_query_unix_fd (source, self->epfd_tag) & G_IO_IN);
+}
+
+static gboolean
+epoll_source_dispatch (GSource     *source,
+                       GSourceFunc  callback,
+                       gpointer     user_data)
+{
+    QmiEpollSource     *self = (QmiEpollSource *)source;
+    struct epoll_event  events[MAX_EVENTS_PER_DISPATCH];
+    gint                n_events;
+    gint                i;
+
+    n_events = epoll_wait (self->epfd, events, G_N_ELEMENTS (events), 0);
+    if (n_events < 0) {
+        if (errno != EINTR)
+            g_warning ("couldn't wait for epoll events: %s", g_strerror (errno));
+        return G_SOURCE_CONTINUE;
+    }
+
+    /* Callbacks may remove any watch, including the ones with events still
+     * pending in this same batch; so while dispatching, removed watches are
+     * only flagged, and freed once we're done. The source itself may also
+     * be destroyed if the last watch is removed. */
+    g_source_ref (source);
+    self->dispatching = TRUE;
+
+    for (i = 0; i < n_events; i++) {
+        QmiEpollWatch *watch;
+        GIOCondition   condition = 0;
+
+        watch = events[i].data.ptr;
+        if (watch->removed)
+            continue;
+
+        if (events[i].events & EPOLLIN)
+            condition |= G_IO_IN;
+        if (events[i].events & EPOLLERR)
+            condition |= G_IO_ERR;
+        if (events[i].events & EPOLLHUP)
+            condition |= G_IO_HUP;
+
+        if (!watch->func (watch->fd, condition, watch->user_data) && !watch->removed)
+            qmi_epoll_watch_remove (watch);
+    }
+
+    self->dispatching = FALSE;
+    g_slist_free_full (self->removed_watches, (GDestroyNotify)watch_free);
+    self->removed_watches = NULL;
+    g_source_unref (source);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+epoll_source_finalize (GSource *source)
+{
+    QmiEpollSource *self = (QmiEpollSource *)source;
+
+    g_assert (self->n_watches == 0);
+    g_assert (!self->removed_watches);
+    close (self->epfd);
+    g_main_context_unref (self->context);
+}
+
+static GSourceFuncs epoll_source_funcs = {
+    epoll_source_prepare,
+    epoll_source_check,
+    epoll_source_dispatch,
+    epoll_source_finalize,
+};
+
+static QmiEpollSource *
+epoll_source_new (GMainContext  *context,
+                  GError       **error)
+{
+    QmiEpollSource *self;
+    gint            epfd;
+
+    epfd = epoll_create1 (EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                     "Cannot create epoll instance: %s", g_strerror (errno));
+        return NULL;
+    }
+
+    self = (QmiEpollSource *) g_source_new (&epoll_source_funcs, sizeof (QmiEpollSource));
+    g_source_set_name ((GSource *)self, "QmiEpollSource");
+    self->context = g_main_context_ref (context);
+    self->epfd = epfd;
+    self->epfd_tag = g_source_add_unix_fd ((GSource *)self, epfd, G_IO_IN);
+    g_source_attach ((GSource *)self, context);
+    return self;
+}
+
+/*****************************************************************************/
+
+void
+qmi_epoll_watch_remove (QmiEpollWatch *watch)
+{
+    QmiEpollSource *self;
+
+    g_assert (!watch->removed);
+
+    self = watch->source;
+    watch->removed = TRUE;
+
+    /* The fd may already be closed, in which case it was implicitly removed
+     * from the epoll set */
+    if (epoll_ctl (self->epfd, EPOLL_CTL_DEL, watch->fd, NULL) < 0)
+        g_debug ("couldn't remove fd %d from epoll set: %s", watch->fd, g_strerror (errno));
+
+    if (self->dispatching)
+        self->removed_watches = g_slist_prepend (self->removed_watches, watch);
+    else
+        watch_free (watch);
+
+    epoll_source_unuse (self);
+}
+
+QmiEpollWatch *
+qmi_epoll_watch_add (GMainContext       *context,
+                     gint                fd,
+                     QmiEpollWatchFunc   func,
+                     gpointer            user_data,
+                     GError            **error)
+{
+    QmiEpollSource     *self;
+    QmiEpollWatch      *watch;
+    struct epoll_event  event;
+
+    g_return_val_if_fail (fd >= 0, NULL);
+    g_return_val_if_fail (func != NULL, NULL);
+
+    if (!context)
+        context = g_main_context_default ();
+
+    /* The watch count is updated in the same critical section as the lookup,
+     * so that the source cannot be released in between */
+    G_LOCK (sources);
+    {
+        if (!sources)
+            sources = g_hash_table_new (g_direct_hash, g_direct_equal);
+        self = g_hash_table_lookup (sources, context);
+        if (!self) {
+            self = epoll_source_new (context, error);
+            if (self)
+                g_hash_table_insert (sources, context, self);
+        }
+        if (self)
+            self->n_watches++;
+    }
+    G_UNLOCK (sources);
+
+    if (!self)
+        return NULL;
+
+    watch = g_slice_new0 (QmiEpollWatch);
+    watch->source = self;
+    watch->fd = fd;
+    watch->func = func;
+    watch->user_data = user_data;
+
+    memset (&event, 0, sizeof (event));
+    event.events = EPOLLIN;
+    event.data.ptr = watch;
+    if (epoll_ctl (self->epfd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                     "Cannot add fd %d to epoll set: %s", fd, g_strerror (errno));
+        watch_free (watch);
+        epoll_source_unuse (self);
+        return NULL;
+    }
+
+    return watch;
+}
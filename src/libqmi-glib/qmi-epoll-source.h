@@ -0,0 +1,55 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#ifndef _LIBQMI_GLIB_QMI_EPOLL_SOURCE_H_
+#define _LIBQMI_GLIB_QMI_EPOLL_SOURCE_H_
+
+#include <glib.h>
+
+/*
+ * A single epoll-backed GSource per GMainContext, multiplexing the input
+ * of any number of file descriptors. The main context only polls the epoll
+ * fd itself, so the cost of each main loop iteration no longer grows with
+ * the number of endpoints being monitored.
+ */
+
+typedef struct _QmiEpollWatch QmiEpollWatch;
+
+/*
+ * Callback called when the fd is readable or when an error or hangup
+ * is detected in the fd. Returning G_SOURCE_REMOVE removes the watch,
+ * same as calling qmi_epoll_watch_remove().
+ */
+typedef gboolean (* QmiEpollWatchFunc) (gint         fd,
+                                        GIOCondition condition,
+                                        gpointer     user_data);
+
+G_GNUC_INTERNAL
+QmiEpollWatch *qmi_epoll_watch_add    (GMainContext       *context,
+                                       gint                fd,
+                                       QmiEpollWatchFunc   func,
+                                       gpointer            user_data,
+                                       GError            **error);
+G_GNUC_INTERNAL
+void           qmi_epoll_watch_remove (QmiEpollWatch      *watch);
+
+#endif /* _LIBQMI_GLIB_QMI_EPOLL_SOURCE_H_ */
@@ -32,6 +32,7 @@
 #include <grp.h>
 #include <pwd.h>
 #include <errno.h>
+#include <sys/socket.h>
 
 #include "qmi-helpers.h"
 #include "qmi-error-types.h"
@@ -123,12 +124,53 @@ qmi_helpers_check_group_allowed (uid_t    uid,
 
 /*****************************************************************************/
 
+/* Printable 7-bit ASCII, plus the CR, LF and TAB control characters which
+ * are explicitly allowed in printable strings */
+#define IS_ASCII_PRINTABLE(c) \
+    (((c) >= 0x20 && (c) < 0x7F) || (c) == '\r' || (c) == '\n' || (c) == '\t')
+
+#define BYTES_ALL(c) (G_GUINT64_CONSTANT (0x0101010101010101) * (c))
+
+/* Length of the leading run of printable ASCII in the string. Checks a whole
+ * word at a time, looking for bytes with the high bit set, below 0x20 or
+ * equal to 0x7F; the check may give false positives, e.g. with CR, LF or TAB,
+ * in which case that word is checked byte by byte. */
+static gsize
+ascii_printable_prefix_length (const guint8 *str,
+                               gsize         str_len)
+{
+    gsize i = 0;
+
+    while (i < str_len) {
+        if (i + sizeof (guint64) <= str_len) {
+            guint64 word;
+            guint64 special;
+
+            memcpy (&word, &str[i], sizeof (word));
+            special = (word |
+                       ((word - BYTES_ALL (0x20)) & ~word) |
+                       (((word ^ BYTES_ALL (0x7F)) - BYTES_ALL (0x01)) & ~(word ^ BYTES_ALL (0x7F))));
+            if (!(special & BYTES_ALL (0x80))) {
+                i += sizeof (guint64);
+                continue;
+            }
+        }
+
+        if (!IS_ASCII_PRINTABLE (str[i]))
+            break;
+        i++;
+    }
+
+    return i;
+}
+
 gboolean
 qmi_helpers_string_utf8_validate_printable (const guint8 *utf8,
                                             gsize         utf8_len)
 {
     const gchar *p;
     const gchar *init;
+    gsize        ascii_len;
 
     g_assert (utf8);
     g_assert (utf8_len);
@@ -141,6 +183,14 @@ qmi_helpers_string_utf8_validate_printable (const guint8 *utf8,
     if (!utf8_len)
         return TRUE;
 
+    /* Most strings are plain ASCII, e.g. IMEIs, APNs or NMEA traces; only
+     * validate the remainder after the ASCII prefix, if any */
+    ascii_len = ascii_printable_prefix_length (utf8, utf8_len);
+    if (ascii_len == utf8_len)
+        return TRUE;
+    utf8 += ascii_len;
+    utf8_len -= ascii_len;
+
     /* First check if valid UTF-8 */
     init = (const gchar *)utf8;
     if (!g_utf8_validate (init, utf8_len, NULL))
@@ -170,16 +220,14 @@ qmi_helpers_string_utf8_validate_printable (const guint8 *utf8,
 /* GSM 03.38 encoding conversion stuff, imported from ModemManager */
 
 #define GSM_DEF_ALPHABET_SIZE 128
-#define GSM_EXT_ALPHABET_SIZE 10
 
 typedef struct GsmUtf8Mapping {
     gchar  chars[3];
-    guint8 len;
-    guint8 gsm;  /* only used for extended GSM charset */
+    guint8 len;  /* 0 if there is no mapping */
 } GsmUtf8Mapping;
 
-#define ONE(a)     { {a, 0x00, 0x00}, 1, 0 }
-#define TWO(a, b)  { {a, b,    0x00}, 2, 0 }
+#define ONE(a)     { {a, 0x00, 0x00}, 1 }
+#define TWO(a, b)  { {a, b,    0x00}, 2 }
 
 /*
  * Mapping from GSM default alphabet to UTF-8.
@@ -254,188 +302,246 @@ static const GsmUtf8Mapping gsm_def_utf8_alphabet[GSM_DEF_ALPHABET_SIZE] = {
     TWO(0xc3, 0xb6), TWO(0xc3, 0xb1), TWO(0xc3, 0xbc), TWO(0xc3, 0xa0)
 };
 
-static guint8
-gsm_def_char_to_utf8 (const guint8  gsm,
-                      guint8       *out_utf8)
-{
-    if (gsm >= GSM_DEF_ALPHABET_SIZE)
-        return 0;
-    memcpy (out_utf8, &gsm_def_utf8_alphabet[gsm].chars[0], gsm_def_utf8_alphabet[gsm].len);
-    return gsm_def_utf8_alphabet[gsm].len;
-}
-
-#define EONE(a, g)        { {a, 0x00, 0x00}, 1, g }
-#define ETHR(a, b, c, g)  { {a, b,    c},    3, g }
-
-/* Mapping from GSM extended alphabet to UTF-8 */
-static const GsmUtf8Mapping gsm_ext_utf8_alphabet[GSM_EXT_ALPHABET_SIZE] = {
-    /* form feed      ^                 {                 }  */
-    EONE(0x0c, 0x0a), EONE(0x5e, 0x14), EONE(0x7b, 0x28), EONE(0x7d, 0x29),
-    /* \              [                 ~                 ]  */
-    EONE(0x5c, 0x2f), EONE(0x5b, 0x3c), EONE(0x7e, 0x3d), EONE(0x5d, 0x3e),
-    /* |              €                                      */
-    EONE(0x7c, 0x40), ETHR(0xe2, 0x82, 0xac, 0x65)
+#define EONE(a)        { {a, 0x00, 0x00}, 1 }
+#define ETHR(a, b, c)  { {a, b,    c},    3 }
+
+/* Mapping from GSM extended alphabet to UTF-8, indexed by the GSM character
+ * following the escape code */
+static const GsmUtf8Mapping gsm_ext_utf8_alphabet[GSM_DEF_ALPHABET_SIZE] = {
+    [0x0a] = EONE(0x0c),             /* form feed */
+    [0x14] = EONE(0x5e),             /* ^ */
+    [0x28] = EONE(0x7b),             /* { */
+    [0x29] = EONE(0x7d),             /* } */
+    [0x2f] = EONE(0x5c),             /* \ */
+    [0x3c] = EONE(0x5b),             /* [ */
+    [0x3d] = EONE(0x7e),             /* ~ */
+    [0x3e] = EONE(0x5d),             /* ] */
+    [0x40] = EONE(0x7c),             /* | */
+    [0x65] = ETHR(0xe2, 0x82, 0xac), /* € */
 };
 
 #define GSM_ESCAPE_CHAR 0x1b
 
-static guint8
-gsm_ext_char_to_utf8 (const guint8  gsm,
-                      guint8       *out_utf8)
-{
-    int i;
-
-    for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
-        if (gsm == gsm_ext_utf8_alphabet[i].gsm) {
-            memcpy (out_utf8, &gsm_ext_utf8_alphabet[i].chars[0], gsm_ext_utf8_alphabet[i].len);
-            return gsm_ext_utf8_alphabet[i].len;
-        }
-    }
-    return 0;
-}
-
-static guint8 *
-charset_gsm_unpack (const guint8 *gsm,
-                    guint32       num_septets,
-                    guint8        start_offset,  /* in _bits_ */
-                    gsize        *out_unpacked_len)
+/* Random access to the septet at the given index of a packed buffer */
+static inline guint8
+gsm_packed_septet (const guint8 *gsm,
+                   gsize         index)
 {
-    GByteArray *unpacked;
-    guint       i;
-
-    unpacked = g_byte_array_sized_new (num_septets + 1);
-    for (i = 0; i < num_septets; i++) {
-        guint8 bits_here, bits_in_next, octet, offset, c;
-        guint32 start_bit;
-
-        start_bit = start_offset + (i * 7); /* Overall bit offset of char in buffer */
-        offset = start_bit % 8;  /* Offset to start of char in this byte */
-        bits_here = offset ? (8 - offset) : 7;
-        bits_in_next = 7 - bits_here;
-
-        /* Grab bits in the current byte */
-        octet = gsm[start_bit / 8];
-        c = (octet >> offset) & (0xFF >> (8 - bits_here));
-
-        /* Grab any bits that spilled over to next byte */
-        if (bits_in_next) {
-            octet = gsm[(start_bit / 8) + 1];
-            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
-        }
-        g_byte_array_append (unpacked, &c, 1);
-    }
-
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    gsize  start_bit;
+    guint  offset;
+    guint8 c;
+
+    start_bit = index * 7;
+    offset = start_bit % 8;
+    c = gsm[start_bit / 8] >> offset;
+    /* Grab any bits that spilled over to next byte */
+    if (offset > 1)
+        c |= gsm[(start_bit / 8) + 1] << (8 - offset);
+    return c & 0x7F;
 }
 
 gchar *
 qmi_helpers_string_utf8_from_gsm7 (const guint8 *gsm_packed,
                                    gsize         gsm_packed_len)
 {
-    GByteArray *utf8;
-    guint8     *gsm_unpacked;
-    gsize       gsm_unpacked_len;
-    gsize       i;
-
-    /* unpack operation needs input length in SEPTETS */
-    gsm_unpacked = charset_gsm_unpack (gsm_packed, gsm_packed_len * 8 / 7, 0, &gsm_unpacked_len);
-
-    /* worst case initial length */
-    utf8 = g_byte_array_sized_new (gsm_unpacked_len * 2 + 1);
-
-    for (i = 0; i < gsm_unpacked_len; i++) {
-        guint8 uchars[4];
-        guint8 ulen;
-
-        /*
-         * 	0x00 is NULL (when followed only by 0x00 up to the
-         * 	end of (fixed byte length) message, possibly also up to
-         * 	FORM FEED.  But 0x00 is also the code for COMMERCIAL AT
-         * 	when some other character (CARRIAGE RETURN if nothing else)
-         * 	comes after the 0x00.
-         *  http://unicode.org/Public/MAPPINGS/ETSI/GSM0338.TXT
-         *
-         * So, if we find a '@' (0x00) and all the next chars after that
-         * are also 0x00, we can consider the string finished already.
-         */
-        if (gsm_unpacked[i] == 0x00) {
-            gsize j;
+    gchar    *utf8;
+    gchar    *out;
+    gsize     n_septets;
+    gsize     n_valid;
+    gsize     i;
+    guint32   bits = 0;
+    guint     n_bits = 0;
+    gboolean  escaped = FALSE;
+
+    n_septets = gsm_packed_len * 8 / 7;
+
+    /*
+     * 	0x00 is NULL (when followed only by 0x00 up to the
+     * 	end of (fixed byte length) message, possibly also up to
+     * 	FORM FEED.  But 0x00 is also the code for COMMERCIAL AT
+     * 	when some other character (CARRIAGE RETURN if nothing else)
+     * 	comes after the 0x00.
+     *  http://unicode.org/Public/MAPPINGS/ETSI/GSM0338.TXT
+     *
+     * So, all trailing 0x00 chars are padding, and we can consider the
+     * string finished before them.
+     */
+    for (n_valid = n_septets; n_valid > 0; n_valid--) {
+        if (gsm_packed_septet (gsm_packed, n_valid - 1) != 0x00)
+            break;
+    }
 
-            for (j = i + 1; j < gsm_unpacked_len; j++) {
-                if (gsm_unpacked[j] != 0x00)
-                    break;
-            }
-            if (j == gsm_unpacked_len)
-                break;
+    /* worst case length: 2 bytes per septet, as extended chars use 2 septets
+     * for at most 3 bytes */
+    utf8 = out = g_malloc (n_valid * 2 + 1);
+
+    /* Unpack septets in order, keeping the pending bits of the last bytes */
+    for (i = 0; i < n_valid; i++) {
+        const GsmUtf8Mapping *mapping;
+        guint8                c;
+
+        if (n_bits < 7) {
+            bits |= ((guint32) *gsm_packed++) << n_bits;
+            n_bits += 8;
         }
+        c = bits & 0x7F;
+        bits >>= 7;
+        n_bits -= 7;
 
-        if (gsm_unpacked[i] == GSM_ESCAPE_CHAR) {
-            /* Extended alphabet, decode next char */
-            ulen = gsm_ext_char_to_utf8 (gsm_unpacked[i+1], uchars);
-            if (ulen)
-                i += 1;
-        } else {
-            /* Default alphabet */
-            ulen = gsm_def_char_to_utf8 (gsm_unpacked[i], uchars);
+        if (!escaped && c == GSM_ESCAPE_CHAR) {
+            escaped = TRUE;
+            continue;
         }
 
+        mapping = escaped ? &gsm_ext_utf8_alphabet[c] : &gsm_def_utf8_alphabet[c];
+        escaped = FALSE;
+
         /* Invalid GSM-7, abort */
-        if (!ulen) {
-            g_free (gsm_unpacked);
-            g_byte_array_unref (utf8);
+        if (!mapping->len) {
+            g_free (utf8);
             return NULL;
         }
 
-        g_byte_array_append (utf8, &uchars[0], ulen);
+        /* Always copy 3 bytes (mappings are padded with NULs), and only
+         * advance as many as needed */
+        memcpy (out, mapping->chars, 3);
+        out += mapping->len;
     }
 
-    g_byte_array_append (utf8, (guint8 *) "\0", 1);  /* NUL terminator */
-    g_free (gsm_unpacked);
-    return (gchar *) g_byte_array_free (utf8, FALSE);
+    /* An escape code as last char would need the padding to be decoded,
+     * which is never a valid extended char */
+    if (escaped) {
+        g_free (utf8);
+        return NULL;
+    }
+
+    *out = '\0';
+    return utf8;
 }
 
 /*****************************************************************************/
 
+#define UCS2LE_CHAR(p) ((gunichar) ((p)[0] | ((p)[1] << 8)))
+
+/* 4 UCS-2 chars in a 64-bit word, all of them in the [0x01,0x7F] range */
+static inline gboolean
+ucs2_word_is_ascii (guint64 word)
+{
+    if (word & G_GUINT64_CONSTANT (0xFF80FF80FF80FF80))
+        return FALSE;
+    /* No 0x0000 char, with no borrows across chars as all are < 0x80 */
+    return !((word - G_GUINT64_CONSTANT (0x0001000100010001)) & G_GUINT64_CONSTANT (0x8000800080008000));
+}
+
+gboolean
+qmi_helpers_string_utf8_from_ucs2le_to_buffer (const guint8 *ucs2le,
+                                               gsize         ucs2le_len,
+                                               gchar        *out,
+                                               gsize         out_size,
+                                               gsize        *out_len)
+{
+    gsize    n_chars;
+    gsize    i = 0;
+    gsize    written = 0;
+    gsize    max_written;
+    gboolean full = FALSE;
+
+    g_assert (out_size > 0);
+
+    /* UCS2 data length given in bytes must be multiple of 2 */
+    if (ucs2le_len % 2 != 0)
+        return FALSE;
+
+    /* Convert length from bytes to number of ucs2 characters */
+    n_chars = ucs2le_len / 2;
+    max_written = out_size - 1;
+
+    /* UCS2 is a subset of UTF-16, so we do the same conversion as
+     * g_utf16_to_utf8() would do (i.e. accepting surrogate pairs and
+     * stopping at the first NUL char), but reading the input in little
+     * endian directly without requiring any alignment, and without any
+     * intermediate allocation. */
+    while (i < n_chars) {
+        gunichar c;
+        gchar    utf8[6];
+        gint     utf8_len;
+
+        /* Fast path for ASCII, 4 chars at a time */
+        while (!full && (i + 4 <= n_chars) && (written + 4 <= max_written)) {
+            guint64 word;
+
+            memcpy (&word, &ucs2le[i * 2], sizeof (word));
+            word = GUINT64_FROM_LE (word);
+            if (!ucs2_word_is_ascii (word))
+                break;
+            out[written++] = (gchar) (word & 0x7F);
+            out[written++] = (gchar) ((word >> 16) & 0x7F);
+            out[written++] = (gchar) ((word >> 32) & 0x7F);
+            out[written++] = (gchar) ((word >> 48) & 0x7F);
+            i += 4;
+        }
+        if (i == n_chars)
+            break;
+
+        c = UCS2LE_CHAR (&ucs2le[i * 2]);
+        i++;
+
+        if (c == 0)
+            break;
+
+        if (c >= 0xD800 && c < 0xDC00) {
+            gunichar c2;
+
+            /* High surrogate must be followed by a low surrogate */
+            if (i == n_chars)
+                return FALSE;
+            c2 = UCS2LE_CHAR (&ucs2le[i * 2]);
+            if (c2 < 0xDC00 || c2 >= 0xE000)
+                return FALSE;
+            i++;
+            c = 0x10000 + ((c - 0xD800) << 10) + (c2 - 0xDC00);
+        } else if (c >= 0xDC00 && c < 0xE000)
+            return FALSE;
+
+        /* Once the output is full, keep on validating the input only */
+        if (full)
+            continue;
+
+        utf8_len = g_unichar_to_utf8 (c, utf8);
+        if (written + utf8_len > max_written) {
+            full = TRUE;
+            continue;
+        }
+        memcpy (&out[written], utf8, utf8_len);
+        written += utf8_len;
+    }
+
+    out[written] = '\0';
+    if (out_len)
+        *out_len = written;
+    return TRUE;
+}
+
 gchar *
 qmi_helpers_string_utf8_from_ucs2le (const guint8 *ucs2le,
                                      gsize         ucs2le_len)
 {
-    gsize               ucs2he_nchars;
-    g_autofree guint16 *ucs2he = NULL;
+    gchar *utf8;
+    gsize  utf8_size;
 
-    /* UCS2 data length given in bytes must be multiple of 2 */
     if (ucs2le_len % 2 != 0)
         return NULL;
 
-    /* Convert length from bytes to number of ucs2 characters */
-    ucs2he_nchars = ucs2le_len / 2;
-
-    /* We'll attempt to convert UCS2 to UTF-8, using GLib's support to convert
-     * from UTF-16 to UTF-8 (given that UCS2 is a subset of UTF-16). In order
-     * to do so, we need the input string in "host endian", so if we're in a
-     * BE system (where host endian is not little endian), we do an explicit
-     * conversion.
-     *
-     * We don't want to use g_convert() because that would mean requiring
-     * full iconv() support in the system.
-     *
-     * We're using an extra allocation always because we need to increase
-     * alignment (guint8 -> (guint16)gunichar2)
-     */
-    ucs2he = g_new (guint16, ucs2he_nchars);
-    g_assert (sizeof (guint16) * ucs2he_nchars == ucs2le_len);
-    memcpy (ucs2he, ucs2le, ucs2le_len);
-#if G_BYTE_ORDER == G_BIG_ENDIAN
-    {
-        guint i;
-
-        for (i = 0; i < ucs2he_nchars; i++)
-            ucs2he[i] = GUINT16_FROM_LE (ucs2he[i]);
+    /* Worst case: 3 bytes per char in the BMP, 4 bytes per surrogate pair */
+    utf8_size = (ucs2le_len / 2) * 3 + 1;
+    utf8 = g_malloc (utf8_size);
+    if (!qmi_helpers_string_utf8_from_ucs2le_to_buffer (ucs2le, ucs2le_len, utf8, utf8_size, NULL)) {
+        g_free (utf8);
+        return NULL;
     }
-#endif
-    return g_utf16_to_utf8 ((const gunichar2 *)ucs2he, ucs2he_nchars, NULL, NULL, NULL);
+    return utf8;
 }
+
 /*****************************************************************************/
 
 static gchar *
@@ -576,6 +682,87 @@ qmi_helpers_get_devname (const gchar  *cdc_wdm_path,
     return devname;
 }
 
+/* Maximum number of levels to walk up from the USB interface in sysfs
+ * until the USB device is found */
+#define MAX_USB_DEVICE_LOOKUP_DEPTH 3
+
+static gboolean
+read_usb_device_attribute (const gchar  *usb_device_path,
+                           const gchar  *attribute,
+                           gchar        *out_value,
+                           guint         max_read_size,
+                           GError      **error)
+{
+    g_autofree gchar *attribute_path = NULL;
+
+    attribute_path = g_build_filename (usb_device_path, attribute, NULL);
+    if (!qmi_helpers_read_sysfs_file (attribute_path, out_value, max_read_size, error))
+        return FALSE;
+    g_strstrip (out_value);
+    return TRUE;
+}
+
+gchar *
+qmi_helpers_get_usb_device_identity (const gchar  *cdc_wdm_path,
+                                     GError      **error)
+{
+    static const gchar *subsystems[] = { "usbmisc", "usb" };
+    g_autofree gchar   *device_basename = NULL;
+    g_autofree gchar   *usb_device_path = NULL;
+    gchar               vid[8] = { 0 };
+    gchar               pid[8] = { 0 };
+    gchar               revision[8] = { 0 };
+    guint               i;
+
+    device_basename = qmi_helpers_get_devname (cdc_wdm_path, error);
+    if (!device_basename)
+        return NULL;
+
+    for (i = 0; !usb_device_path && i < G_N_ELEMENTS (subsystems); i++) {
+        g_autofree gchar *tmp = NULL;
+        g_autofree gchar *path = NULL;
+        guint             depth;
+
+        /* The device link points to the USB interface, e.g.:
+         *    $ realpath /sys/class/usbmisc/cdc-wdm0/device
+         *    /sys/devices/pci0000:00/0000:00:14.0/usb2/2-3/2-3:1.8
+         * and the USB device is the first parent exposing a bcdDevice
+         * attribute. */
+        tmp = g_strdup_printf ("/sys/class/%s/%s/device", subsystems[i], device_basename);
+        path = realpath (tmp, NULL);
+
+        for (depth = 0; path && depth < MAX_USB_DEVICE_LOOKUP_DEPTH; depth++) {
+            g_autofree gchar *bcd_device_path = NULL;
+            gchar            *parent;
+
+            bcd_device_path = g_build_filename (path, "bcdDevice", NULL);
+            if (g_file_test (bcd_device_path, G_FILE_TEST_EXISTS)) {
+                usb_device_path = g_steal_pointer (&path);
+                break;
+            }
+
+            parent = g_path_get_dirname (path);
+            g_free (path);
+            path = parent;
+        }
+    }
+
+    if (!usb_device_path) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED,
+                     "Couldn't find USB device for port '%s'", device_basename);
+        return NULL;
+    }
+
+    /* The device revision reports the firmware revision, so that the
+     * identity changes across firmware upgrades */
+    if (!read_usb_device_attribute (usb_device_path, "idVendor", vid, sizeof (vid) - 1, error) ||
+        !read_usb_device_attribute (usb_device_path, "idProduct", pid, sizeof (pid) - 1, error) ||
+        !read_usb_device_attribute (usb_device_path, "bcdDevice", revision, sizeof (revision) - 1, error))
+        return NULL;
+
+    return g_strdup_printf ("%s;%s:%s;%s", usb_device_path, vid, pid, revision);
+}
+
 gboolean
 qmi_helpers_read_sysfs_file (const gchar  *sysfs_path,
                              gchar        *out_value,
@@ -644,6 +831,39 @@ qmi_helpers_write_sysfs_file (const gchar  *sysfs_path,
 
 /******************************************************************************/
 
+gssize
+qmi_helpers_netlink_receive (gint         fd,
+                             GByteArray  *buffer,
+                             GError     **error)
+{
+    gssize len;
+
+    /* Peek the size of the next datagram first, and grow the buffer as
+     * needed so that it's never truncated */
+    do {
+        len = recv (fd, NULL, 0, MSG_PEEK | MSG_TRUNC);
+    } while (len < 0 && errno == EINTR);
+
+    if (len >= 0) {
+        if ((gsize) len > buffer->len)
+            g_byte_array_set_size (buffer, len);
+        do {
+            len = recv (fd, buffer->data, buffer->len, 0);
+        } while (len < 0 && errno == EINTR);
+    }
+
+    if (len < 0) {
+        gint saved_errno = errno;
+
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                     "Failed to receive netlink message: %s", g_strerror (saved_errno));
+        return -1;
+    }
+    return len;
+}
+
+/******************************************************************************/
+
 gboolean
 qmi_helpers_list_links (GFile         *sysfs_file,
                         GCancellable  *cancellable,
@@ -717,6 +937,53 @@ qmi_helpers_clear_string (gchar **value)
 
 /******************************************************************************/
 
+void
+qmi_helpers_json_append_string (GString     *json,
+                                const gchar *str)
+{
+    const gchar *run;
+    const gchar *p;
+
+    g_string_append_c (json, '"');
+
+    /* Copy runs of characters not needing escaping in one go */
+    for (run = p = str; *p; p++) {
+        guchar c = (guchar) *p;
+
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        g_string_append_len (json, run, p - run);
+        run = p + 1;
+
+        switch (c) {
+        case '"':
+            g_string_append (json, "\\\"");
+            break;
+        case '\\':
+            g_string_append (json, "\\\\");
+            break;
+        case '\n':
+            g_string_append (json, "\\n");
+            break;
+        case '\r':
+            g_string_append (json, "\\r");
+            break;
+        case '\t':
+            g_string_append (json, "\\t");
+            break;
+        default:
+            g_string_append_printf (json, "\\u%04x", c);
+            break;
+        }
+    }
+    g_string_append_len (json, run, p - run);
+
+    g_string_append_c (json, '"');
+}
+
+/******************************************************************************/
+
 #if !GLIB_CHECK_VERSION(2,54,0)
 
 gboolean
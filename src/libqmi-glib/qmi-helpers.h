@@ -54,6 +54,16 @@ G_GNUC_INTERNAL
 gchar *qmi_helpers_string_utf8_from_ucs2le (const guint8 *ucs2le,
                                             gsize         ucs2le_len);
 
+/* Converts into the given buffer, truncating the output in a character
+ * boundary if it doesn't fit. The output is always NUL-terminated, and
+ * undefined if FALSE is returned. */
+G_GNUC_INTERNAL
+gboolean qmi_helpers_string_utf8_from_ucs2le_to_buffer (const guint8 *ucs2le,
+                                                        gsize         ucs2le_len,
+                                                        gchar        *out,
+                                                        gsize         out_size,
+                                                        gsize        *out_len);
+
 typedef enum {
     QMI_HELPERS_TRANSPORT_TYPE_UNKNOWN,
     QMI_HELPERS_TRANSPORT_TYPE_QMUX,
@@ -78,6 +88,10 @@ G_GNUC_INTERNAL
 gchar *qmi_helpers_get_devname (const gchar  *cdc_wdm_path,
                                 GError      **error);
 
+G_GNUC_INTERNAL
+gchar *qmi_helpers_get_usb_device_identity (const gchar  *cdc_wdm_path,
+                                            GError      **error);
+
 G_GNUC_INTERNAL
 gboolean qmi_helpers_read_sysfs_file (const gchar  *sysfs_path,
                                       gchar        *out_value, /* caller allocates */
@@ -89,6 +103,21 @@ gboolean qmi_helpers_write_sysfs_file (const gchar  *sysfs_path,
                                        const gchar  *value,
                                        GError      **error);
 
+/* Work around 'cast-align' warnings on some architectures */
+#define CAST_ALIGN(Type, ptr)                                         \
+    ({                                                                \
+        gconstpointer const _ptr = (ptr);                             \
+                                                                      \
+        g_assert (((gsize) (gpointer) _ptr % __alignof (Type)) == 0); \
+                                                                      \
+        ((Type *) _ptr);                                              \
+    })
+
+G_GNUC_INTERNAL
+gssize qmi_helpers_netlink_receive (gint         fd,
+                                    GByteArray  *buffer,
+                                    GError     **error);
+
 G_GNUC_INTERNAL
 gboolean qmi_helpers_list_links (GFile         *sysfs_file,
                                  GCancellable  *cancellable,
@@ -99,6 +128,10 @@ gboolean qmi_helpers_list_links (GFile         *sysfs_file,
 G_GNUC_INTERNAL
 void qmi_helpers_clear_string (gchar **value);
 
+G_GNUC_INTERNAL
+void qmi_helpers_json_append_string (GString     *json,
+                                     const gchar *str);
+
 static inline gfloat
 QMI_GFLOAT_SWAP_LE_BE (gfloat in)
 {
@@ -0,0 +1,427 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <stdlib.h>
+
+#include "qmi-link-inventory.h"
+#include "qmi-helpers.h"
+
+G_DEFINE_TYPE (QmiLinkInventory, qmi_link_inventory, G_TYPE_OBJECT)
+
+enum {
+    SIGNAL_LINKS_CHANGED,
+    SIGNAL_LAST
+};
+
+static guint signals[SIGNAL_LAST] = { 0 };
+
+struct _QmiLinkInventoryPrivate {
+    gchar               *sysfs_root;
+    /* NULL if not monitoring */
+    QmiLinkMonitorWatch *watch;
+    /* base ifname -> BaseLinks */
+    GHashTable          *bases;
+};
+
+typedef struct {
+    gchar *ifname;
+    guint  ifindex; /* 0 if unknown */
+} LinkInfo;
+
+typedef struct {
+    gchar     *ifname;
+    guint      ifindex; /* 0 if the interface doesn't exist */
+    gchar     *sysfs_path;
+    GFile     *sysfs_file;
+    GPtrArray *links; /* LinkInfo */
+} BaseLinks;
+
+/*****************************************************************************/
+
+static void
+link_info_free (LinkInfo *info)
+{
+    g_free (info->ifname);
+    g_slice_free (LinkInfo, info);
+}
+
+static LinkInfo *
+link_info_new (const gchar *ifname,
+               guint        ifindex)
+{
+    LinkInfo *info;
+
+    info = g_slice_new0 (LinkInfo);
+    info->ifname = g_strdup (ifname);
+    info->ifindex = ifindex;
+    return info;
+}
+
+/* Reads the interface index from sysfs; 0 if unknown */
+static guint
+read_ifindex (QmiLinkInventory *self,
+              const gchar      *ifname)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *contents = NULL;
+
+    path = g_strdup_printf ("%s/%s/ifindex", self->priv->sysfs_root, ifname);
+    if (!g_file_get_contents (path, &contents, NULL, NULL))
+        return 0;
+    return (guint) strtoul (contents, NULL, 10);
+}
+
+/*****************************************************************************/
+
+static void
+base_links_free (BaseLinks *base)
+{
+    g_ptr_array_unref (base->links);
+    g_object_unref (base->sysfs_file);
+    g_free (base->sysfs_path);
+    g_free (base->ifname);
+    g_slice_free (BaseLinks, base);
+}
+
+static BaseLinks *
+base_links_new (QmiLinkInventory *self,
+                const gchar      *ifname)
+{
+    BaseLinks *base;
+
+    base = g_slice_new0 (BaseLinks);
+    base->ifname = g_strdup (ifname);
+    base->sysfs_path = g_strdup_printf ("%s/%s", self->priv->sysfs_root, ifname);
+    base->sysfs_file = g_file_new_for_path (base->sysfs_path);
+    base->links = g_ptr_array_new_with_free_func ((GDestroyNotify) link_info_free);
+    return base;
+}
+
+static gint
+base_links_lookup (BaseLinks   *base,
+                   const gchar *ifname,
+                   guint        ifindex)
+{
+    guint i;
+
+    for (i = 0; i < base->links->len; i++) {
+        LinkInfo *info;
+
+        info = g_ptr_array_index (base->links, i);
+        if ((ifindex && info->ifindex == ifindex) || g_str_equal (info->ifname, ifname))
+            return (gint) i;
+    }
+    return -1;
+}
+
+static void
+base_links_set (QmiLinkInventory *self,
+                BaseLinks        *base,
+                GPtrArray        *links)
+{
+    guint i;
+
+    g_ptr_array_set_size (base->links, 0);
+    for (i = 0; links && i < links->len; i++) {
+        const gchar *ifname;
+
+        ifname = g_ptr_array_index (links, i);
+        g_ptr_array_add (base->links, link_info_new (ifname, read_ifindex (self, ifname)));
+    }
+}
+
+/* Lists the links from sysfs again; returns TRUE if they changed */
+static gboolean
+base_links_rescan (QmiLinkInventory *self,
+                   BaseLinks        *base)
+{
+    g_autoptr(GPtrArray) links = NULL;
+    gboolean             changed = FALSE;
+    guint                i;
+
+    base->ifindex = read_ifindex (self, base->ifname);
+
+    if (!qmi_helpers_list_links (base->sysfs_file, NULL, NULL, &links, NULL)) {
+        /* The base interface is gone, and so are all its links */
+        changed = (base->links->len > 0);
+        g_ptr_array_set_size (base->links, 0);
+        return changed;
+    }
+
+    if (!links || links->len != base->links->len)
+        changed = (links ? links->len : 0) != base->links->len;
+    else {
+        for (i = 0; i < links->len && !changed; i++)
+            changed = (base_links_lookup (base, g_ptr_array_index (links, i), 0) < 0);
+    }
+
+    if (changed)
+        base_links_set (self, base, links);
+
+    return changed;
+}
+
+/* Applies a link notification; returns TRUE if the links changed */
+static gboolean
+base_links_update (QmiLinkInventory    *self,
+                   BaseLinks           *base,
+                   QmiLinkMonitorEvent  event,
+                   guint                ifindex,
+                   guint                parent_ifindex,
+                   const gchar         *ifname)
+{
+    g_autofree gchar *upper_path = NULL;
+    gint              i;
+
+    if (event == QMI_LINK_MONITOR_EVENT_OVERFLOW)
+        return base_links_rescan (self, base);
+
+    if (g_str_equal (ifname, base->ifname)) {
+        if (event == QMI_LINK_MONITOR_EVENT_NEW) {
+            base->ifindex = ifindex;
+            return FALSE;
+        }
+        /* The links are always removed along with the base interface */
+        base->ifindex = 0;
+        if (!base->links->len)
+            return FALSE;
+        g_ptr_array_set_size (base->links, 0);
+        return TRUE;
+    }
+
+    i = base_links_lookup (base, ifname, ifindex);
+
+    if (event == QMI_LINK_MONITOR_EVENT_DEL) {
+        if (i < 0)
+            return FALSE;
+        g_ptr_array_remove_index (base->links, (guint) i);
+        return TRUE;
+    }
+
+    if (i >= 0) {
+        LinkInfo *info;
+
+        /* Link renamed? */
+        info = g_ptr_array_index (base->links, (guint) i);
+        if (g_str_equal (info->ifname, ifname))
+            return FALSE;
+        g_free (info->ifname);
+        info->ifname = g_strdup (ifname);
+        return TRUE;
+    }
+
+    /* Notifications are received for all links in the system; those
+     * reporting their parent are filtered out right away if it isn't the
+     * base interface. qmimux links don't report their parent, so for those
+     * sysfs is the only way to know. */
+    if (parent_ifindex && parent_ifindex != base->ifindex)
+        return FALSE;
+
+    upper_path = g_strdup_printf ("%s/upper_%s", base->sysfs_path, ifname);
+    if (!g_file_test (upper_path, G_FILE_TEST_EXISTS))
+        return FALSE;
+
+    g_ptr_array_add (base->links, link_info_new (ifname, ifindex));
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+void
+qmi_link_inventory_process_event (QmiLinkInventory    *self,
+                                  QmiLinkMonitorEvent  event,
+                                  guint                ifindex,
+                                  guint                parent_ifindex,
+                                  const gchar         *ifname)
+{
+    g_autoptr(GPtrArray) changed = NULL;
+    GHashTableIter       iter;
+    BaseLinks           *base;
+    guint                i;
+
+    changed = g_ptr_array_new_with_free_func (g_free);
+
+    g_hash_table_iter_init (&iter, self->priv->bases);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &base)) {
+        if (base_links_update (self, base, event, ifindex, parent_ifindex, ifname))
+            g_ptr_array_add (changed, g_strdup (base->ifname));
+    }
+
+    /* Emit once the bases are no longer being iterated, as the signal
+     * handlers may list links */
+    g_object_ref (self);
+    for (i = 0; i < changed->len; i++)
+        g_signal_emit (self, signals[SIGNAL_LINKS_CHANGED], 0, g_ptr_array_index (changed, i));
+    g_object_unref (self);
+}
+
+static BaseLinks *
+lookup_or_track (QmiLinkInventory  *self,
+                 const gchar       *base_ifname,
+                 GError           **error)
+{
+    g_autoptr(GPtrArray)  links = NULL;
+    BaseLinks            *base;
+
+    /* Process any notification not yet dispatched by the main context, so
+     * that links added or removed right before are reported correctly */
+    if (self->priv->watch)
+        qmi_link_monitor_watch_flush (self->priv->watch);
+
+    base = g_hash_table_lookup (self->priv->bases, base_ifname);
+    if (base)
+        return base;
+
+    base = base_links_new (self, base_ifname);
+    if (!qmi_helpers_list_links (base->sysfs_file, NULL, NULL, &links, error)) {
+        base_links_free (base);
+        return NULL;
+    }
+    base->ifindex = read_ifindex (self, base_ifname);
+    base_links_set (self, base, links);
+    g_hash_table_insert (self->priv->bases, base->ifname, base);
+    return base;
+}
+
+gboolean
+qmi_link_inventory_track (QmiLinkInventory  *self,
+                          const gchar       *base_ifname,
+                          GError           **error)
+{
+    return !!lookup_or_track (self, base_ifname, error);
+}
+
+static gint
+link_name_cmp (const gchar **a,
+               const gchar **b)
+{
+    return g_ascii_strcasecmp (*a, *b);
+}
+
+gboolean
+qmi_link_inventory_list_links (QmiLinkInventory  *self,
+                               const gchar       *base_ifname,
+                               GPtrArray        **out_links,
+                               GError           **error)
+{
+    BaseLinks *base;
+    guint      i;
+
+    base = lookup_or_track (self, base_ifname, error);
+    if (!base)
+        return FALSE;
+
+    if (!base->links->len) {
+        *out_links = NULL;
+        return TRUE;
+    }
+
+    *out_links = g_ptr_array_new_full (base->links->len, g_free);
+    for (i = 0; i < base->links->len; i++)
+        g_ptr_array_add (*out_links, g_strdup (((LinkInfo *) g_ptr_array_index (base->links, i))->ifname));
+    g_ptr_array_sort (*out_links, (GCompareFunc) link_name_cmp);
+    return TRUE;
+}
+
+static void
+link_event_cb (QmiLinkMonitorEvent  event,
+               guint                ifindex,
+               guint                parent_ifindex,
+               const gchar         *ifname,
+               QmiLinkInventory    *self)
+{
+    qmi_link_inventory_process_event (self, event, ifindex, parent_ifindex, ifname);
+}
+
+gboolean
+qmi_link_inventory_monitor (QmiLinkInventory  *self,
+                            GMainContext      *context,
+                            GError           **error)
+{
+    g_return_val_if_fail (!self->priv->watch, FALSE);
+
+    self->priv->watch = qmi_link_monitor_watch_add (context,
+                                                    (QmiLinkMonitorFunc) link_event_cb,
+                                                    self,
+                                                    error);
+    return !!self->priv->watch;
+}
+
+/*****************************************************************************/
+
+QmiLinkInventory *
+qmi_link_inventory_new (const gchar *sysfs_root)
+{
+    QmiLinkInventory *self;
+
+    self = QMI_LINK_INVENTORY (g_object_new (QMI_TYPE_LINK_INVENTORY, NULL));
+    self->priv->sysfs_root = g_strdup (sysfs_root);
+    return self;
+}
+
+static void
+qmi_link_inventory_init (QmiLinkInventory *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+                                              QMI_TYPE_LINK_INVENTORY,
+                                              QmiLinkInventoryPrivate);
+
+    self->priv->bases = g_hash_table_new_full (g_str_hash,
+                                               g_str_equal,
+                                               NULL,
+                                               (GDestroyNotify) base_links_free);
+}
+
+static void
+finalize (GObject *object)
+{
+    QmiLinkInventory *self = QMI_LINK_INVENTORY (object);
+
+    if (self->priv->watch)
+        qmi_link_monitor_watch_remove (self->priv->watch);
+    g_hash_table_unref (self->priv->bases);
+    g_free (self->priv->sysfs_root);
+
+    G_OBJECT_CLASS (qmi_link_inventory_parent_class)->finalize (object);
+}
+
+static void
+qmi_link_inventory_class_init (QmiLinkInventoryClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (QmiLinkInventoryPrivate));
+
+    object_class->finalize = finalize;
+
+    signals[SIGNAL_LINKS_CHANGED] =
+        g_signal_new (QMI_LINK_INVENTORY_SIGNAL_LINKS_CHANGED,
+                      G_OBJECT_CLASS_TYPE (object_class),
+                      G_SIGNAL_RUN_LAST,
+                      0,
+                      NULL,
+                      NULL,
+                      NULL,
+                      G_TYPE_NONE,
+                      1,
+                      G_TYPE_STRING);
+}
@@ -0,0 +1,97 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#ifndef _LIBQMI_GLIB_QMI_LINK_INVENTORY_H_
+#define _LIBQMI_GLIB_QMI_LINK_INVENTORY_H_
+
+#include <gio/gio.h>
+#include <glib-object.h>
+
+#include "qmi-link-monitor.h"
+
+/*
+ * In-memory inventory of the links created on top of a set of base
+ * interfaces. The links of each base interface are listed from sysfs only
+ * once, and then kept up to date with link notifications; either those of
+ * the link monitor, or those given explicitly.
+ */
+
+#define QMI_TYPE_LINK_INVENTORY            (qmi_link_inventory_get_type ())
+#define QMI_LINK_INVENTORY(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), QMI_TYPE_LINK_INVENTORY, QmiLinkInventory))
+#define QMI_LINK_INVENTORY_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  QMI_TYPE_LINK_INVENTORY, QmiLinkInventoryClass))
+#define QMI_IS_LINK_INVENTORY(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), QMI_TYPE_LINK_INVENTORY))
+#define QMI_IS_LINK_INVENTORY_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  QMI_TYPE_LINK_INVENTORY))
+#define QMI_LINK_INVENTORY_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  QMI_TYPE_LINK_INVENTORY, QmiLinkInventoryClass))
+
+#define QMI_LINK_INVENTORY_SIGNAL_LINKS_CHANGED "links-changed"
+
+typedef struct _QmiLinkInventory        QmiLinkInventory;
+typedef struct _QmiLinkInventoryClass   QmiLinkInventoryClass;
+typedef struct _QmiLinkInventoryPrivate QmiLinkInventoryPrivate;
+
+struct _QmiLinkInventory {
+    GObject                  parent;
+    QmiLinkInventoryPrivate *priv;
+};
+
+struct _QmiLinkInventoryClass {
+    GObjectClass parent;
+};
+
+G_GNUC_INTERNAL
+GType qmi_link_inventory_get_type (void);
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (QmiLinkInventory, g_object_unref)
+
+/* @sysfs_root is the sysfs directory of the network interfaces, i.e.
+ * /sys/class/net */
+G_GNUC_INTERNAL
+QmiLinkInventory *qmi_link_inventory_new (const gchar *sysfs_root);
+
+/* Keeps the inventory up to date with the link monitor of @context */
+G_GNUC_INTERNAL
+gboolean qmi_link_inventory_monitor (QmiLinkInventory  *self,
+                                     GMainContext      *context,
+                                     GError           **error);
+
+/* Applies a link notification, as reported by the link monitor */
+G_GNUC_INTERNAL
+void qmi_link_inventory_process_event (QmiLinkInventory    *self,
+                                       QmiLinkMonitorEvent  event,
+                                       guint                ifindex,
+                                       guint                parent_ifindex,
+                                       const gchar         *ifname);
+
+/* Starts tracking the links of @base_ifname, if not done already, so that
+ * changes are notified even if its links were never listed */
+G_GNUC_INTERNAL
+gboolean qmi_link_inventory_track (QmiLinkInventory  *self,
+                                   const gchar       *base_ifname,
+                                   GError           **error);
+
+/* Same output as qmi_net_port_manager_list_links() */
+G_GNUC_INTERNAL
+gboolean qmi_link_inventory_list_links (QmiLinkInventory  *self,
+                                        const gchar       *base_ifname,
+                                        GPtrArray        **out_links,
+                                        GError           **error);
+
+#endif /* _LIBQMI_GLIB_QMI_LINK_INVENTORY_H_ */
@@ -0,0 +1,383 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gio/gio.h>
+
+#include "qmi-link-monitor.h"
+#include "qmi-errors.h"
+#include "qmi-error-types.h"
+#include "qmi-helpers.h"
+
+/* Initial size of the receive buffer, grown as needed */
+#define BUFFER_SIZE 8192
+
+typedef struct {
+    GMainContext *context;
+    GSocket      *socket;
+    GSource      *source;
+    GByteArray   *buffer;
+    /* Watches may be added or removed from any thread, so the watches, their
+     * removed flags and the dispatching counter are protected by the mutex */
+    GMutex        mutex;
+    GPtrArray    *watches;
+    guint         dispatching;
+} QmiLinkMonitor;
+
+struct _QmiLinkMonitorWatch {
+    QmiLinkMonitor     *monitor;
+    QmiLinkMonitorFunc  func;
+    gpointer            user_data;
+    gboolean            removed;
+};
+
+/* One monitor per main context. Lock ordering: the monitors lock is always
+ * taken before the mutex of a monitor. */
+G_LOCK_DEFINE_STATIC (monitors);
+static GHashTable *monitors;
+
+/*****************************************************************************/
+
+static void
+watch_free (QmiLinkMonitorWatch *watch)
+{
+    g_slice_free (QmiLinkMonitorWatch, watch);
+}
+
+/* Must be called after removing the monitor from the monitors table */
+static void
+link_monitor_free (QmiLinkMonitor *self)
+{
+    g_assert (self->watches->len == 0);
+    g_assert (self->dispatching == 0);
+
+    g_source_destroy (self->source);
+    g_source_unref (self->source);
+    g_object_unref (self->socket);
+    g_byte_array_unref (self->buffer);
+    g_ptr_array_unref (self->watches);
+    g_mutex_clear (&self->mutex);
+    g_main_context_unref (self->context);
+    g_slice_free (QmiLinkMonitor, self);
+}
+
+/* Frees the watches flagged as removed, unless dispatching; and the monitor
+ * itself if there are no watches left. */
+static void
+link_monitor_purge_watches (QmiLinkMonitor *self)
+{
+    gboolean unused = FALSE;
+    guint    i;
+
+    G_LOCK (monitors);
+    g_mutex_lock (&self->mutex);
+    if (!self->dispatching) {
+        for (i = self->watches->len; i > 0; i--) {
+            QmiLinkMonitorWatch *watch;
+
+            watch = g_ptr_array_index (self->watches, i - 1);
+            if (watch->removed)
+                g_ptr_array_remove_index (self->watches, i - 1);
+        }
+
+        if (!self->watches->len) {
+            g_hash_table_remove (monitors, self->context);
+            unused = TRUE;
+        }
+    }
+    g_mutex_unlock (&self->mutex);
+    G_UNLOCK (monitors);
+
+    if (unused)
+        link_monitor_free (self);
+}
+
+/*****************************************************************************/
+
+static void
+link_monitor_emit (QmiLinkMonitor      *self,
+                   QmiLinkMonitorEvent  event,
+                   guint                ifindex,
+                   guint                parent_ifindex,
+                   const gchar         *ifname)
+{
+    g_autoptr(GPtrArray) watches = NULL;
+    guint                i;
+
+    /* Callbacks are run without the lock held, as they may add or remove
+     * watches. Removed watches are only flagged while dispatching, so the
+     * ones listed here are not freed until the dispatching is over. */
+    g_mutex_lock (&self->mutex);
+    watches = g_ptr_array_sized_new (self->watches->len);
+    for (i = 0; i < self->watches->len; i++)
+        g_ptr_array_add (watches, g_ptr_array_index (self->watches, i));
+    g_mutex_unlock (&self->mutex);
+
+    for (i = 0; i < watches->len; i++) {
+        QmiLinkMonitorWatch *watch;
+        gboolean             removed;
+
+        watch = g_ptr_array_index (watches, i);
+        g_mutex_lock (&self->mutex);
+        removed = watch->removed;
+        g_mutex_unlock (&self->mutex);
+        if (!removed)
+            watch->func (event, ifindex, parent_ifindex, ifname, watch->user_data);
+    }
+}
+
+static void
+link_monitor_process_message (QmiLinkMonitor        *self,
+                              const struct nlmsghdr *hdr)
+{
+    const struct ifinfomsg *ifi;
+    const struct rtattr    *attr;
+    g_autofree gchar       *ifname = NULL;
+    guint                   parent_ifindex = 0;
+    guint                   len;
+
+    if (hdr->nlmsg_type != RTM_NEWLINK && hdr->nlmsg_type != RTM_DELLINK)
+        return;
+
+    if (hdr->nlmsg_len < NLMSG_LENGTH (sizeof (struct ifinfomsg)))
+        return;
+
+    ifi = NLMSG_DATA (hdr);
+    len = IFLA_PAYLOAD (hdr);
+    for (attr = IFLA_RTA (ifi); RTA_OK (attr, len); attr = RTA_NEXT (attr, len)) {
+        if (attr->rta_type == IFLA_IFNAME && !ifname)
+            ifname = g_strndup (RTA_DATA (attr), RTA_PAYLOAD (attr));
+        else if (attr->rta_type == IFLA_LINK && RTA_PAYLOAD (attr) >= sizeof (guint32))
+            memcpy (&parent_ifindex, RTA_DATA (attr), sizeof (guint32));
+    }
+
+    if (!ifname)
+        return;
+
+    link_monitor_emit (self,
+                       (hdr->nlmsg_type == RTM_NEWLINK) ? QMI_LINK_MONITOR_EVENT_NEW : QMI_LINK_MONITOR_EVENT_DEL,
+                       ifi->ifi_index,
+                       parent_ifindex,
+                       ifname);
+}
+
+/* Returns FALSE if there was nothing to receive, or if receiving failed; the
+ * socket source is dispatched again if the socket is still readable */
+static gboolean
+link_monitor_receive (QmiLinkMonitor *self)
+{
+    GError          *error = NULL;
+    gssize           bytes_received;
+    guint            buffer_len;
+    struct nlmsghdr *hdr;
+
+    bytes_received = qmi_helpers_netlink_receive (g_socket_get_fd (self->socket), self->buffer, &error);
+    if (bytes_received < 0) {
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+            g_error_free (error);
+            return FALSE;
+        }
+
+        /* Most likely ENOBUFS: the kernel dropped notifications because we
+         * didn't read them fast enough */
+        g_debug ("[link monitor] notifications may have been lost: %s", error->message);
+        g_error_free (error);
+        link_monitor_emit (self, QMI_LINK_MONITOR_EVENT_OVERFLOW, 0, 0, NULL);
+        return FALSE;
+    }
+
+    buffer_len = (guint) bytes_received;
+    for (hdr = CAST_ALIGN (struct nlmsghdr, self->buffer->data); NLMSG_OK (hdr, buffer_len);
+         hdr = NLMSG_NEXT (hdr, buffer_len))
+        link_monitor_process_message (self, hdr);
+
+    return TRUE;
+}
+
+/* The monitor may be freed when this returns */
+static void
+link_monitor_dispatch (QmiLinkMonitor *self)
+{
+    gboolean dispatching;
+
+    g_mutex_lock (&self->mutex);
+    self->dispatching++;
+    g_mutex_unlock (&self->mutex);
+
+    while (link_monitor_receive (self))
+        ;
+
+    g_mutex_lock (&self->mutex);
+    dispatching = (--self->dispatching > 0);
+    g_mutex_unlock (&self->mutex);
+
+    if (!dispatching)
+        link_monitor_purge_watches (self);
+}
+
+static gboolean
+link_monitor_socket_cb (GSocket        *socket,
+                        GIOCondition    condition,
+                        QmiLinkMonitor *self)
+{
+    if (condition & G_IO_HUP || condition & G_IO_ERR) {
+        g_warning ("[link monitor] socket connection closed.");
+        return G_SOURCE_REMOVE;
+    }
+
+    link_monitor_dispatch (self);
+    return G_SOURCE_CONTINUE;
+}
+
+static QmiLinkMonitor *
+link_monitor_new (GMainContext  *context,
+                  GError       **error)
+{
+    QmiLinkMonitor     *self;
+    struct sockaddr_nl  addr;
+    GSocket            *gsocket;
+    gint                fd;
+
+    fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (fd < 0) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                     "Failed to create netlink socket: %s", g_strerror (errno));
+        return NULL;
+    }
+
+    memset (&addr, 0, sizeof (addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK;
+    if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                     "Failed to subscribe to link notifications: %s", g_strerror (errno));
+        close (fd);
+        return NULL;
+    }
+
+    gsocket = g_socket_new_from_fd (fd, error);
+    if (!gsocket) {
+        close (fd);
+        return NULL;
+    }
+
+    self = g_slice_new0 (QmiLinkMonitor);
+    g_mutex_init (&self->mutex);
+    self->context = g_main_context_ref (context);
+    self->socket = gsocket;
+    self->buffer = g_byte_array_sized_new (BUFFER_SIZE);
+    g_byte_array_set_size (self->buffer, BUFFER_SIZE);
+    self->watches = g_ptr_array_new_with_free_func ((GDestroyNotify) watch_free);
+    self->source = g_socket_create_source (self->socket, G_IO_IN | G_IO_ERR | G_IO_HUP, NULL);
+    g_source_set_callback (self->source, (GSourceFunc) link_monitor_socket_cb, self, NULL);
+    g_source_attach (self->source, context);
+    return self;
+}
+
+/*****************************************************************************/
+
+void
+qmi_link_monitor_watch_flush (QmiLinkMonitorWatch *watch)
+{
+    QmiLinkMonitor *self;
+    gboolean        dispatching;
+
+    self = watch->monitor;
+
+    g_mutex_lock (&self->mutex);
+    g_assert (!watch->removed);
+    dispatching = (self->dispatching > 0);
+    g_mutex_unlock (&self->mutex);
+
+    /* Already dispatching, e.g. when called from a watch callback */
+    if (dispatching)
+        return;
+
+    link_monitor_dispatch (self);
+}
+
+void
+qmi_link_monitor_watch_remove (QmiLinkMonitorWatch *watch)
+{
+    QmiLinkMonitor *self;
+
+    self = watch->monitor;
+
+    g_mutex_lock (&self->mutex);
+    g_assert (!watch->removed);
+    watch->removed = TRUE;
+    g_mutex_unlock (&self->mutex);
+
+    link_monitor_purge_watches (self);
+}
+
+QmiLinkMonitorWatch *
+qmi_link_monitor_watch_add (GMainContext        *context,
+                            QmiLinkMonitorFunc   func,
+                            gpointer             user_data,
+                            GError             **error)
+{
+    QmiLinkMonitor      *self;
+    QmiLinkMonitorWatch *watch;
+
+    g_return_val_if_fail (func != NULL, NULL);
+
+    if (!context)
+        context = g_main_context_default ();
+
+    watch = g_slice_new0 (QmiLinkMonitorWatch);
+    watch->func = func;
+    watch->user_data = user_data;
+
+    /* The watch is added with the monitors lock held, so that the monitor
+     * cannot be freed in the meantime */
+    G_LOCK (monitors);
+    if (!monitors)
+        monitors = g_hash_table_new (g_direct_hash, g_direct_equal);
+    self = g_hash_table_lookup (monitors, context);
+    if (!self) {
+        self = link_monitor_new (context, error);
+        if (self)
+            g_hash_table_insert (monitors, context, self);
+    }
+    if (self) {
+        watch->monitor = self;
+        g_mutex_lock (&self->mutex);
+        g_ptr_array_add (self->watches, watch);
+        g_mutex_unlock (&self->mutex);
+    }
+    G_UNLOCK (monitors);
+
+    if (!self) {
+        watch_free (watch);
+        return NULL;
+    }
+
+    return watch;
+}
@@ -0,0 +1,78 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#ifndef _LIBQMI_GLIB_QMI_LINK_MONITOR_H_
+#define _LIBQMI_GLIB_QMI_LINK_MONITOR_H_
+
+#include <glib.h>
+
+/*
+ * A single rtnetlink socket per GMainContext, subscribed to the link
+ * notifications of the kernel, and dispatching them to any number of
+ * watches.
+ *
+ * Watches may be added and removed from any thread, but callbacks run in
+ * the thread dispatching the main context (or flushing a watch), so their
+ * user data must stay valid until the watch is removed from that thread.
+ */
+
+typedef struct _QmiLinkMonitorWatch QmiLinkMonitorWatch;
+
+typedef enum {
+    QMI_LINK_MONITOR_EVENT_NEW,
+    QMI_LINK_MONITOR_EVENT_DEL,
+    /* The kernel dropped notifications, the state must be resynced */
+    QMI_LINK_MONITOR_EVENT_OVERFLOW,
+} QmiLinkMonitorEvent;
+
+/*
+ * Callback called for every link notification. The @parent_ifindex is the
+ * index of the link this one was created on top of, if reported; qmimux
+ * links, e.g., don't report it. All of @ifindex, @parent_ifindex and
+ * @ifname are unset in %QMI_LINK_MONITOR_EVENT_OVERFLOW events. Note that
+ * %QMI_LINK_MONITOR_EVENT_NEW is also reported when an existing link
+ * changes.
+ */
+typedef void (* QmiLinkMonitorFunc) (QmiLinkMonitorEvent  event,
+                                     guint                ifindex,
+                                     guint                parent_ifindex,
+                                     const gchar         *ifname,
+                                     gpointer             user_data);
+
+G_GNUC_INTERNAL
+QmiLinkMonitorWatch *qmi_link_monitor_watch_add    (GMainContext        *context,
+                                                    QmiLinkMonitorFunc   func,
+                                                    gpointer             user_data,
+                                                    GError             **error);
+G_GNUC_INTERNAL
+void                 qmi_link_monitor_watch_remove (QmiLinkMonitorWatch *watch);
+
+/*
+ * Processes right away all the notifications already queued in the socket,
+ * without blocking. Useful to get the notifications of an operation that is
+ * known to be finished in the kernel. Must be called from the thread
+ * dispatching the main context of the watch.
+ */
+G_GNUC_INTERNAL
+void                 qmi_link_monitor_watch_flush  (QmiLinkMonitorWatch *watch);
+
+#endif /* _LIBQMI_GLIB_QMI_LINK_MONITOR_H_ */
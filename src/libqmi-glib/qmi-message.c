@@ -69,6 +69,7 @@
 #include "qmi-ims.h"
 #include "qmi-imsa.h"
 #include "qmi-imsp.h"
+#include "qmi-imsdcm.h"
 
 #define PACKED __attribute__((packed))
 
@@ -1402,24 +1403,14 @@ qmi_message_tlv_read_gdouble (QmiMessage  *self,
     return TRUE;
 }
 
-gboolean
-qmi_message_tlv_read_string (QmiMessage  *self,
-                             gsize        tlv_offset,
-                             gsize       *offset,
-                             guint8       n_size_prefix_bytes,
-                             guint16      max_size,
-                             gchar      **out,
-                             GError     **error)
+static gboolean
+tlv_read_string_length (QmiMessage  *self,
+                        gsize        tlv_offset,
+                        gsize       *offset,
+                        guint8       n_size_prefix_bytes,
+                        guint16     *string_length,
+                        GError     **error)
 {
-    const guint8 *ptr;
-    guint16 string_length;
-    guint16 valid_string_length;
-
-    g_return_val_if_fail (self != NULL, FALSE);
-    g_return_val_if_fail (offset != NULL, FALSE);
-    g_return_val_if_fail (out != NULL, FALSE);
-    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
-
     switch (n_size_prefix_bytes) {
     case 0: {
         struct tlv *tlv;
@@ -1429,7 +1420,7 @@ qmi_message_tlv_read_string (QmiMessage  *self,
 
         /* If no length prefix given, read the remaining TLV buffer into a string */
         tlv = (struct tlv *) &(self->data[tlv_offset]);
-        string_length = (GUINT16_FROM_LE (tlv->length) - *offset);
+        *string_length = (GUINT16_FROM_LE (tlv->length) - *offset);
         break;
     }
     case 1: {
@@ -1437,17 +1428,63 @@ qmi_message_tlv_read_string (QmiMessage  *self,
 
         if (!qmi_message_tlv_read_guint8 (self, tlv_offset, offset, &string_length_8, error))
             return FALSE;
-        string_length = (guint16) string_length_8;
+        *string_length = (guint16) string_length_8;
         break;
     }
     case 2:
-        if (!qmi_message_tlv_read_guint16 (self, tlv_offset, offset, QMI_ENDIAN_LITTLE, &string_length, error))
+        if (!qmi_message_tlv_read_guint16 (self, tlv_offset, offset, QMI_ENDIAN_LITTLE, string_length, error))
             return FALSE;
         break;
     default:
         g_assert_not_reached ();
     }
 
+    return TRUE;
+}
+
+static gchar *
+string_utf8_from_fallback_encodings (const guint8  *ptr,
+                                     guint16        length,
+                                     GError       **error)
+{
+    gchar *out;
+
+    /* Attempt GSM-7 */
+    out = qmi_helpers_string_utf8_from_gsm7 (ptr, length);
+    if (out)
+        return out;
+
+    /* Otherwise, attempt UCS-2 */
+    out = qmi_helpers_string_utf8_from_ucs2le (ptr, length);
+    if (out)
+        return out;
+
+    /* Otherwise, error */
+    g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_DATA, "invalid string");
+    return NULL;
+}
+
+gboolean
+qmi_message_tlv_read_string (QmiMessage  *self,
+                             gsize        tlv_offset,
+                             gsize       *offset,
+                             guint8       n_size_prefix_bytes,
+                             guint16      max_size,
+                             gchar      **out,
+                             GError     **error)
+{
+    const guint8 *ptr;
+    guint16 string_length;
+    guint16 valid_string_length;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
+
+    if (!tlv_read_string_length (self, tlv_offset, offset, n_size_prefix_bytes, &string_length, error))
+        return FALSE;
+
     if (string_length == 0) {
         *out = g_strdup ("");
         return TRUE;
@@ -1471,16 +1508,76 @@ qmi_message_tlv_read_string (QmiMessage  *self,
         memcpy (*out, ptr, valid_string_length);
         (*out)[valid_string_length] = '\0';
     } else {
-        /* Otherwise, attempt GSM-7 */
-        *out =qmi_helpers_string_utf8_from_gsm7 (ptr, valid_string_length);
-        if (*out == NULL) {
-            /* Otherwise, attempt UCS-2 */
-            *out = qmi_helpers_string_utf8_from_ucs2le (ptr, valid_string_length);
-            if (*out == NULL) {
-                /* Otherwise, error */
-                g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_DATA, "invalid string");
-                return FALSE;
+        /* Otherwise, attempt GSM-7 or UCS-2 */
+        *out = string_utf8_from_fallback_encodings (ptr, valid_string_length, error);
+        if (*out == NULL)
+            return FALSE;
+    }
+
+    *offset = (*offset + string_length);
+    return TRUE;
+}
+
+gboolean
+qmi_message_tlv_read_string_to_buffer (QmiMessage  *self,
+                                       gsize        tlv_offset,
+                                       gsize       *offset,
+                                       guint8       n_size_prefix_bytes,
+                                       guint16      max_size,
+                                       gchar       *out,
+                                       GError     **error)
+{
+    const guint8 *ptr;
+    guint16 string_length;
+    guint16 valid_string_length;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
+    g_return_val_if_fail (max_size > 0, FALSE);
+
+    if (!tlv_read_string_length (self, tlv_offset, offset, n_size_prefix_bytes, &string_length, error))
+        return FALSE;
+
+    if (string_length == 0) {
+        out[0] = '\0';
+        return TRUE;
+    }
+
+    valid_string_length = MIN (string_length, max_size);
+    if (!(ptr = tlv_error_if_read_overflow (self, tlv_offset, *offset, valid_string_length, error)))
+        return FALSE;
+
+    /* Same validation logic as in qmi_message_tlv_read_string() */
+    if (qmi_helpers_string_utf8_validate_printable (ptr, valid_string_length)) {
+        memcpy (out, ptr, valid_string_length);
+        out[valid_string_length] = '\0';
+    } else {
+        g_autofree gchar *converted = NULL;
+
+        /* Same fallback encodings as in string_utf8_from_fallback_encodings(),
+         * but UCS-2 is converted straight into the output buffer */
+        converted = qmi_helpers_string_utf8_from_gsm7 (ptr, valid_string_length);
+        if (converted) {
+            const gchar *end;
+
+            /* The converted string may be longer than the original one, so make
+             * sure it fits in the buffer without breaking multibyte characters */
+            end = converted;
+            while (*end) {
+                const gchar *next;
+
+                next = g_utf8_next_char (end);
+                if (next - converted > max_size)
+                    break;
+                end = next;
             }
+            memcpy (out, converted, end - converted);
+            out[end - converted] = '\0';
+        } else if (!qmi_helpers_string_utf8_from_ucs2le_to_buffer (ptr, valid_string_length, out, max_size + 1, NULL)) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_DATA, "invalid string");
+            return FALSE;
         }
     }
 
@@ -1554,6 +1651,364 @@ qmi_message_tlv_read_remaining_size (QmiMessage *self,
     return (GUINT16_FROM_LE (tlv->length) >= offset ? (GUINT16_FROM_LE (tlv->length) - offset) : 0);
 }
 
+gboolean
+qmi_message_tlv_read_integer_array (QmiMessage  *self,
+                                    gsize        tlv_offset,
+                                    gsize       *offset,
+                                    guint        n_items,
+                                    guint        item_size,
+                                    QmiEndian    endian,
+                                    GArray      *out,
+                                    GError     **error)
+{
+    const guint8 *ptr;
+    gsize         len;
+    guint         start;
+    guint         i;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+    g_return_val_if_fail (item_size == 1 || item_size == 2 || item_size == 4 || item_size == 8, FALSE);
+    g_return_val_if_fail (g_array_get_element_size (out) == item_size, FALSE);
+
+    /* Single bounds check for the whole array; the number of items comes
+     * from the message itself, so don't multiply before validating it */
+    if (n_items > qmi_message_tlv_read_remaining_size (self, tlv_offset, *offset) / item_size) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_TLV_TOO_LONG,
+                     "Reading TLV would overflow");
+        return FALSE;
+    }
+    len = (gsize) n_items * item_size;
+    if (!(ptr = tlv_error_if_read_overflow (self, tlv_offset, *offset, len, error)))
+        return FALSE;
+
+    start = out->len;
+    g_array_set_size (out, start + n_items);
+    memcpy (out->data + (start * item_size), ptr, len);
+    *offset = *offset + len;
+
+    /* Nothing else to do if the endianness already matches the host one */
+    if (item_size == 1 ||
+        (endian == QMI_ENDIAN_LITTLE && G_BYTE_ORDER == G_LITTLE_ENDIAN) ||
+        (endian == QMI_ENDIAN_BIG && G_BYTE_ORDER == G_BIG_ENDIAN))
+        return TRUE;
+
+    switch (item_size) {
+    case 2: {
+        guint16 *items = &g_array_index (out, guint16, start);
+
+        for (i = 0; i < n_items; i++)
+            items[i] = GUINT16_SWAP_LE_BE (items[i]);
+        break;
+    }
+    case 4: {
+        guint32 *items = &g_array_index (out, guint32, start);
+
+        for (i = 0; i < n_items; i++)
+            items[i] = GUINT32_SWAP_LE_BE (items[i]);
+        break;
+    }
+    case 8: {
+        guint64 *items = &g_array_index (out, guint64, start);
+
+        for (i = 0; i < n_items; i++)
+            items[i] = GUINT64_SWAP_LE_BE (items[i]);
+        break;
+    }
+    default:
+        g_assert_not_reached ();
+    }
+
+    return TRUE;
+}
+
+gboolean
+qmi_message_tlv_read_borrowed (QmiMessage     *self,
+                               gsize           tlv_offset,
+                               gsize          *offset,
+                               guint           n_items,
+                               guint           item_size,
+                               const guint8  **out,
+                               GError        **error)
+{
+    const guint8 *ptr;
+    gsize         len;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (item_size > 0, FALSE);
+
+    /* Same bounds check as in qmi_message_tlv_read_integer_array() */
+    if (n_items > qmi_message_tlv_read_remaining_size (self, tlv_offset, *offset) / item_size) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_TLV_TOO_LONG,
+                     "Reading TLV would overflow");
+        return FALSE;
+    }
+    len = (gsize) n_items * item_size;
+    if (!(ptr = tlv_error_if_read_overflow (self, tlv_offset, *offset, len, error)))
+        return FALSE;
+
+    /* No copy: the data is given as found in the message */
+    if (out)
+        *out = ptr;
+    *offset = *offset + len;
+    return TRUE;
+}
+
+gboolean
+qmi_message_tlv_read_string_borrowed (QmiMessage   *self,
+                                      gsize         tlv_offset,
+                                      gsize        *offset,
+                                      guint8        n_size_prefix_bytes,
+                                      guint16       max_size,
+                                      const gchar **out,
+                                      gsize        *out_length,
+                                      GError      **error)
+{
+    const guint8 *ptr;
+    guint16 string_length;
+    guint16 valid_string_length;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
+
+    if (!tlv_read_string_length (self, tlv_offset, offset, n_size_prefix_bytes, &string_length, error))
+        return FALSE;
+
+    /* Same length limits as in qmi_message_tlv_read_string(), but the string
+     * is neither validated nor converted */
+    if (max_size > 0 && string_length > max_size)
+        valid_string_length = max_size;
+    else
+        valid_string_length = string_length;
+
+    if (!(ptr = tlv_error_if_read_overflow (self, tlv_offset, *offset, valid_string_length, error)))
+        return FALSE;
+
+    if (out)
+        *out = (const gchar *) ptr;
+    if (out_length)
+        *out_length = valid_string_length;
+    *offset = (*offset + string_length);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Table-driven TLV printables */
+
+static gboolean
+tlv_printable_item_read_value (QmiMessage                 *self,
+                               gsize                       tlv_offset,
+                               gsize                      *offset,
+                               const QmiTlvPrintableItem  *item,
+                               guint64                    *value,
+                               gdouble                    *value_double,
+                               GError                    **error)
+{
+    switch (item->format) {
+    case QMI_TLV_PRINTABLE_FORMAT_GUINT8: {
+        guint8 tmp;
+
+        if (!qmi_message_tlv_read_guint8 (self, tlv_offset, offset, &tmp, error))
+            return FALSE;
+        *value = tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GUINT16: {
+        guint16 tmp;
+
+        if (!qmi_message_tlv_read_guint16 (self, tlv_offset, offset, item->endian, &tmp, error))
+            return FALSE;
+        *value = tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GUINT32: {
+        guint32 tmp;
+
+        if (!qmi_message_tlv_read_guint32 (self, tlv_offset, offset, item->endian, &tmp, error))
+            return FALSE;
+        *value = tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GUINT64:
+        return qmi_message_tlv_read_guint64 (self, tlv_offset, offset, item->endian, value, error);
+    case QMI_TLV_PRINTABLE_FORMAT_GUINT_SIZED:
+        return qmi_message_tlv_read_sized_guint (self, tlv_offset, offset, item->size, item->endian, value, error);
+    /* Signed values are sign-extended to 64 bits */
+    case QMI_TLV_PRINTABLE_FORMAT_GINT8: {
+        gint8 tmp;
+
+        if (!qmi_message_tlv_read_gint8 (self, tlv_offset, offset, &tmp, error))
+            return FALSE;
+        *value = (guint64)(gint64) tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GINT16: {
+        gint16 tmp;
+
+        if (!qmi_message_tlv_read_gint16 (self, tlv_offset, offset, item->endian, &tmp, error))
+            return FALSE;
+        *value = (guint64)(gint64) tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GINT32: {
+        gint32 tmp;
+
+        if (!qmi_message_tlv_read_gint32 (self, tlv_offset, offset, item->endian, &tmp, error))
+            return FALSE;
+        *value = (guint64)(gint64) tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GINT64: {
+        gint64 tmp;
+
+        if (!qmi_message_tlv_read_gint64 (self, tlv_offset, offset, item->endian, &tmp, error))
+            return FALSE;
+        *value = (guint64) tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GFLOAT: {
+        gfloat tmp;
+
+        if (!qmi_message_tlv_read_gfloat_endian (self, tlv_offset, offset, item->endian, &tmp, error))
+            return FALSE;
+        *value_double = (gdouble) tmp;
+        return TRUE;
+    }
+    case QMI_TLV_PRINTABLE_FORMAT_GDOUBLE:
+        return qmi_message_tlv_read_gdouble (self, tlv_offset, offset, item->endian, value_double, error);
+    case QMI_TLV_PRINTABLE_FORMAT_STRING:
+    case QMI_TLV_PRINTABLE_FORMAT_FIXED_SIZE_STRING:
+    default:
+        g_assert_not_reached ();
+    }
+
+    return FALSE;
+}
+
+static void
+tlv_printable_item_append_value (GString                   *printable,
+                                 const QmiTlvPrintableItem *item,
+                                 guint64                    value,
+                                 gdouble                    value_double)
+{
+    switch (item->value) {
+    case QMI_TLV_PRINTABLE_VALUE_BOOLEAN:
+        g_string_append_printf (printable, "%s", value ? "yes" : "no");
+        return;
+    case QMI_TLV_PRINTABLE_VALUE_STRING: {
+        g_autofree gchar *str = NULL;
+
+        str = item->to_string (value);
+        g_string_append_printf (printable, "%s", str);
+        return;
+    }
+    case QMI_TLV_PRINTABLE_VALUE_NUMBER:
+    default:
+        break;
+    }
+
+    switch (item->format) {
+    case QMI_TLV_PRINTABLE_FORMAT_GINT8:
+    case QMI_TLV_PRINTABLE_FORMAT_GINT16:
+    case QMI_TLV_PRINTABLE_FORMAT_GINT32:
+    case QMI_TLV_PRINTABLE_FORMAT_GINT64:
+        g_string_append_printf (printable, "%" G_GINT64_FORMAT, (gint64) value);
+        break;
+    case QMI_TLV_PRINTABLE_FORMAT_GFLOAT:
+    case QMI_TLV_PRINTABLE_FORMAT_GDOUBLE:
+        g_string_append_printf (printable, "%lf", value_double);
+        break;
+    default:
+        g_string_append_printf (printable, "%" G_GUINT64_FORMAT, value);
+        break;
+    }
+}
+
+static gboolean
+tlv_printable_item_append (QmiMessage                 *self,
+                           gsize                       tlv_offset,
+                           gsize                      *offset,
+                           const QmiTlvPrintableItem  *item,
+                           GString                    *printable,
+                           GError                    **error)
+{
+    g_autofree gchar *str = NULL;
+    guint64           value = 0;
+    gdouble           value_double = 0.0;
+
+    /* Always read, even if the value isn't shown */
+    if (item->format == QMI_TLV_PRINTABLE_FORMAT_STRING) {
+        if (!qmi_message_tlv_read_string (self, tlv_offset, offset, (guint8) item->size, item->max_size, &str, error))
+            return FALSE;
+    } else if (item->format == QMI_TLV_PRINTABLE_FORMAT_FIXED_SIZE_STRING) {
+        str = g_malloc0 (item->size + 1);
+        if (!qmi_message_tlv_read_fixed_size_string (self, tlv_offset, offset, item->size, str, error))
+            return FALSE;
+    } else if (!tlv_printable_item_read_value (self, tlv_offset, offset, item, &value, &value_double, error))
+        return FALSE;
+
+    if (item->personal_info && !qmi_utils_get_show_personal_info ())
+        g_string_append_printf (printable, "'###'");
+    else if (str)
+        g_string_append (printable, str);
+    else
+        tlv_printable_item_append_value (printable, item, value, value_double);
+    return TRUE;
+}
+
+gchar *
+qmi_message_tlv_build_printable (QmiMessage                *self,
+                                 guint8                     tlv_type,
+                                 const QmiTlvPrintableItem *items,
+                                 guint                      n_items)
+{
+    gsize     offset = 0;
+    gsize     init_offset;
+    GString  *printable;
+    GError   *error = NULL;
+    gboolean  sequence;
+    guint     i;
+
+    if ((init_offset = qmi_message_tlv_read_init (self, tlv_type, NULL, NULL)) == 0)
+        return NULL;
+
+    printable = g_string_new ("");
+
+    /* Named items are members of a sequence */
+    sequence = (n_items > 0 && items[0].name != NULL);
+    if (sequence)
+        g_string_append (printable, "[");
+
+    for (i = 0; i < n_items; i++) {
+        if (sequence)
+            g_string_append_printf (printable, " %s = '", items[i].name);
+        if (!tlv_printable_item_append (self, init_offset, &offset, &items[i], printable, &error))
+            goto out;
+        if (sequence)
+            g_string_append (printable, "'");
+    }
+
+    if (sequence)
+        g_string_append (printable, " ]");
+
+    if ((offset = qmi_message_tlv_read_remaining_size (self, init_offset, offset)) > 0)
+        g_string_append_printf (printable, "Additional unexpected '%" G_GSIZE_FORMAT "' bytes", offset);
+
+out:
+    if (error) {
+        g_string_append_printf (printable, " ERROR: %s", error->message);
+        g_error_free (error);
+    }
+    return g_string_free (printable, FALSE);
+}
+
 /*****************************************************************************/
 
 const guint8 *
@@ -1743,6 +2198,7 @@ qmi_message_get_printable_full (QmiMessage        *self,
     GString *printable;
     gchar *qmi_flags_str;
     gchar *contents;
+    const QmiServiceModule *module;
 
     g_return_val_if_fail (self != NULL, NULL);
 
@@ -1793,254 +2249,246 @@ qmi_message_get_printable_full (QmiMessage        *self,
                             line_prefix, get_all_tlvs_length (self));
     g_free (qmi_flags_str);
 
-    contents = NULL;
-    switch (qmi_message_get_service (self)) {
-    case QMI_SERVICE_CTL:
+    module = __qmi_service_module_lookup (qmi_message_get_service (self));
+    contents = (module ? module->get_printable (self, context, line_prefix) : NULL);
+    if (!contents)
+        contents = get_generic_printable (self, line_prefix);
+    g_string_append (printable, contents);
+    g_free (contents);
+
+    return g_string_free (printable, FALSE);
+}
+
+/*****************************************************************************/
+/* JSON serialization */
+
+static void
+append_json_hex (GString      *json,
+                 const guint8 *raw,
+                 gsize         raw_length)
+{
+    static const gchar hex_digits[] = "0123456789abcdef";
+    gsize              i;
+
+    g_string_append_c (json, '"');
+    for (i = 0; i < raw_length; i++) {
+        if (i > 0)
+            g_string_append_c (json, ':');
+        g_string_append_c (json, hex_digits[raw[i] >> 4]);
+        g_string_append_c (json, hex_digits[raw[i] & 0x0F]);
+    }
+    g_string_append_c (json, '"');
+}
+
+static void
+append_json_tlvs (QmiMessage           *self,
+                  GString              *json,
+                  QmiTlvJsonLookupFunc  tlv_lookup)
+{
+    struct tlv *tlv;
+
+    g_string_append (json, ",\"tlvs\":[");
+
+    for (tlv = qmi_tlv_first (self); tlv; tlv = qmi_tlv_next (self, tlv)) {
+        const gchar    *tlv_type_str = NULL;
+        gboolean        value_has_personal_info = FALSE;
+        QmiTlvJsonFunc  tlv_json = NULL;
+
+        if (json->str[json->len - 1] != '[')
+            g_string_append_c (json, ',');
+        g_string_append_printf (json, "{\"type\":%u", tlv->type);
+
+        if (tlv_lookup)
+            tlv_json = tlv_lookup (self, tlv->type, &tlv_type_str, &value_has_personal_info);
+
+        if (tlv_type_str) {
+            g_string_append (json, ",\"name\":");
+            qmi_helpers_json_append_string (json, tlv_type_str);
+        }
+
+        if (tlv_json) {
+            gsize value_start;
+
+            /* On failure, drop whatever partial value was appended and
+             * fallback to the raw contents */
+            value_start = json->len;
+            g_string_append (json, ",\"value\":");
+            if (!tlv_json (self, json)) {
+                g_string_truncate (json, value_start);
+                tlv_json = NULL;
+            }
+        }
+
+        if (!tlv_json) {
+            g_string_append (json, ",\"raw\":");
+            if (qmi_utils_get_show_personal_info () || !value_has_personal_info)
+                append_json_hex (json, tlv->value, GUINT16_FROM_LE (tlv->length));
+            else
+                g_string_append (json, "\"###\"");
+        }
+
+        g_string_append_c (json, '}');
+    }
+
+    g_string_append_c (json, ']');
+}
+
+void
+qmi_message_append_json (QmiMessage        *self,
+                         QmiMessageContext *context,
+                         GString           *json)
+{
+    const gchar            *service_str;
+    const gchar            *message_name = NULL;
+    QmiTlvJsonLookupFunc    tlv_lookup = NULL;
+    const QmiServiceModule *module;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (json != NULL);
+
+    g_string_append (json, "{\"service\":");
+    service_str = qmi_service_get_string (qmi_message_get_service (self));
+    if (service_str)
+        qmi_helpers_json_append_string (json, service_str);
+    else
+        g_string_append_printf (json, "%u", (guint) qmi_message_get_service (self));
+
+    g_string_append_printf (json,
+                            ",\"client\":%u"
+                            ",\"transaction\":%u"
+                            ",\"kind\":\"%s\""
+                            ",\"message-id\":%u",
+                            qmi_message_get_client_id (self),
+                            qmi_message_get_transaction_id (self),
+                            (qmi_message_is_indication (self) ? "indication" :
+                             (qmi_message_is_response (self) ? "response" : "request")),
+                            qmi_message_get_message_id (self));
+
+    module = __qmi_service_module_lookup (qmi_message_get_service (self));
+    if (module)
+        module->get_json_info (self, context, &message_name, &tlv_lookup);
+
+    if (message_name) {
+        g_string_append (json, ",\"message\":");
+        qmi_helpers_json_append_string (json, message_name);
+    }
+
+    append_json_tlvs (self, json, tlv_lookup);
+    g_string_append_c (json, '}');
+}
+
+gboolean
+__qmi_message_is_abortable (QmiMessage        *self,
+                            QmiMessageContext *context)
+{
+    const QmiServiceModule *module;
+
+    module = __qmi_service_module_lookup (qmi_message_get_service (self));
+    return (module && module->is_abortable && module->is_abortable (self, context));
+}
+
+/*****************************************************************************/
+/* Service registry */
+
+/* Modules of all services included in the build, sorted by service id */
+static const QmiServiceModule *service_modules[] = {
 #if defined HAVE_QMI_SERVICE_CTL
-        contents = __qmi_message_ctl_get_printable (self, context, line_prefix);
-#endif
-        break;
-    case QMI_SERVICE_DMS:
-#if defined HAVE_QMI_SERVICE_DMS
-        contents = __qmi_message_dms_get_printable (self, context, line_prefix);
+    &__qmi_service_ctl_module,
 #endif
-        break;
-    case QMI_SERVICE_WDS:
 #if defined HAVE_QMI_SERVICE_WDS
-        contents = __qmi_message_wds_get_printable (self, context, line_prefix);
+    &__qmi_service_wds_module,
+#endif
+#if defined HAVE_QMI_SERVICE_DMS
+    &__qmi_service_dms_module,
 #endif
-        break;
-    case QMI_SERVICE_NAS:
 #if defined HAVE_QMI_SERVICE_NAS
-        contents = __qmi_message_nas_get_printable (self, context, line_prefix);
+    &__qmi_service_nas_module,
 #endif
-        break;
-    case QMI_SERVICE_WMS:
-#if defined HAVE_QMI_SERVICE_WMS
-        contents = __qmi_message_wms_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_QOS
+    &__qmi_service_qos_module,
 #endif
-        break;
-    case QMI_SERVICE_PDC:
-#if defined HAVE_QMI_SERVICE_PDC
-        contents = __qmi_message_pdc_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_WMS
+    &__qmi_service_wms_module,
 #endif
-        break;
-    case QMI_SERVICE_PDS:
 #if defined HAVE_QMI_SERVICE_PDS
-        contents = __qmi_message_pds_get_printable (self, context, line_prefix);
+    &__qmi_service_pds_module,
 #endif
-        break;
-    case QMI_SERVICE_PBM:
-#if defined HAVE_QMI_SERVICE_PBM
-        contents = __qmi_message_pbm_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_VOICE
+    &__qmi_service_voice_module,
 #endif
-        break;
-    case QMI_SERVICE_UIM:
 #if defined HAVE_QMI_SERVICE_UIM
-        contents = __qmi_message_uim_get_printable (self, context, line_prefix);
+    &__qmi_service_uim_module,
 #endif
-        break;
-    case QMI_SERVICE_OMA:
-#if defined HAVE_QMI_SERVICE_OMA
-        contents = __qmi_message_oma_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_PBM
+    &__qmi_service_pbm_module,
 #endif
-        break;
-    case QMI_SERVICE_GAS:
-#if defined HAVE_QMI_SERVICE_GAS
-        contents = __qmi_message_gas_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_LOC
+    &__qmi_service_loc_module,
 #endif
-        break;
-    case QMI_SERVICE_GMS:
-#if defined HAVE_QMI_SERVICE_GMS
-        contents = __qmi_message_gms_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_SAR
+    &__qmi_service_sar_module,
+#endif
+#if defined HAVE_QMI_SERVICE_IMS
+    &__qmi_service_ims_module,
 #endif
-        break;
-    case QMI_SERVICE_WDA:
 #if defined HAVE_QMI_SERVICE_WDA
-        contents = __qmi_message_wda_get_printable (self, context, line_prefix);
+    &__qmi_service_wda_module,
 #endif
-        break;
-    case QMI_SERVICE_VOICE:
-#if defined HAVE_QMI_SERVICE_VOICE
-        contents = __qmi_message_voice_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_IMSP
+    &__qmi_service_imsp_module,
 #endif
-        break;
-    case QMI_SERVICE_LOC:
-#if defined HAVE_QMI_SERVICE_LOC
-        contents = __qmi_message_loc_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_IMSA
+    &__qmi_service_imsa_module,
 #endif
-        break;
-    case QMI_SERVICE_QOS:
-#if defined HAVE_QMI_SERVICE_QOS
-        contents = __qmi_message_qos_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_PDC
+    &__qmi_service_pdc_module,
 #endif
-        break;
-    case QMI_SERVICE_DSD:
 #if defined HAVE_QMI_SERVICE_DSD
-        contents = __qmi_message_dsd_get_printable (self, context, line_prefix);
+    &__qmi_service_dsd_module,
 #endif
-        break;
-    case QMI_SERVICE_DPM:
 #if defined HAVE_QMI_SERVICE_DPM
-        contents = __qmi_message_dpm_get_printable (self, context, line_prefix);
-#endif
-        break;
-    case QMI_SERVICE_FOX:
-#if defined HAVE_QMI_SERVICE_FOX
-        contents = __qmi_message_fox_get_printable (self, context, line_prefix);
+    &__qmi_service_dpm_module,
 #endif
-        break;
-    case QMI_SERVICE_ATR:
-#if defined HAVE_QMI_SERVICE_ATR
-        contents = __qmi_message_atr_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_OMA
+    &__qmi_service_oma_module,
 #endif
-        break;
-    case QMI_SERVICE_IMSP:
-#if defined HAVE_QMI_SERVICE_IMSP
-        contents = __qmi_message_imsp_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_FOX
+    &__qmi_service_fox_module,
 #endif
-        break;
-    case QMI_SERVICE_IMSA:
-#if defined HAVE_QMI_SERVICE_IMSA
-        contents = __qmi_message_imsa_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_GMS
+    &__qmi_service_gms_module,
 #endif
-        break;
-    case QMI_SERVICE_IMSDCM:
-#if defined HAVE_QMI_SERVICE_IMSDCM
-        contents = __qmi_message_imsdcm_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_GAS
+    &__qmi_service_gas_module,
 #endif
-        break;
-    case QMI_SERVICE_IMS:
-#if defined HAVE_QMI_SERVICE_IMS
-        contents = __qmi_message_ims_get_printable (self, context, line_prefix);
+#if defined HAVE_QMI_SERVICE_ATR
+    &__qmi_service_atr_module,
 #endif
-        break;
-    case QMI_SERVICE_SSC:
 #if defined HAVE_QMI_SERVICE_SSC
-        contents = __qmi_message_ssc_get_printable (self, context, line_prefix);
+    &__qmi_service_ssc_module,
 #endif
-        break;
-
-    case QMI_SERVICE_UNKNOWN:
-        g_assert_not_reached ();
-
-    case QMI_SERVICE_AUTH:
-    case QMI_SERVICE_AT:
-    case QMI_SERVICE_CAT2:
-    case QMI_SERVICE_QCHAT:
-    case QMI_SERVICE_RMTFS:
-    case QMI_SERVICE_TEST:
-    case QMI_SERVICE_SAR:
-    case QMI_SERVICE_ADC:
-    case QMI_SERVICE_CSD:
-    case QMI_SERVICE_MFS:
-    case QMI_SERVICE_TIME:
-    case QMI_SERVICE_TS:
-    case QMI_SERVICE_TMD:
-    case QMI_SERVICE_UIM_HTTP:
-    case QMI_SERVICE_UIM_RMT:
-    case QMI_SERVICE_SAP:
-    case QMI_SERVICE_TSYNC:
-    case QMI_SERVICE_RFSA:
-    case QMI_SERVICE_CSVT:
-    case QMI_SERVICE_QCMAP:
-    case QMI_SERVICE_IMSVT:
-    case QMI_SERVICE_COEX:
-    case QMI_SERVICE_STX:
-    case QMI_SERVICE_BIT:
-    case QMI_SERVICE_IMSRTP:
-    case QMI_SERVICE_RFRPE:
-    case QMI_SERVICE_SSCTL:
-    case QMI_SERVICE_CAT:
-    case QMI_SERVICE_RMS:
-    case QMI_SERVICE_FOTA:
-    default:
-        break;
-    }
-
-    if (!contents)
-        contents = get_generic_printable (self, line_prefix);
-    g_string_append (printable, contents);
-    g_free (contents);
-
-    return g_string_free (printable, FALSE);
-}
+#if defined HAVE_QMI_SERVICE_IMSDCM
+    &__qmi_service_imsdcm_module,
+#endif
+};
 
-gboolean
-__qmi_message_is_abortable (QmiMessage        *self,
-                            QmiMessageContext *context)
+const QmiServiceModule *
+__qmi_service_module_lookup (QmiService service)
 {
-    switch (qmi_message_get_service (self)) {
-    case QMI_SERVICE_WDS:
-#if defined HAVE_QMI_SERVICE_WDS
-        return __qmi_message_wds_is_abortable (self, context);
-#else
-        return FALSE;
-#endif
-    case QMI_SERVICE_NAS:
-#if defined HAVE_QMI_SERVICE_NAS
-        return __qmi_message_nas_is_abortable (self, context);
-#else
-        return FALSE;
-#endif
+    guint first = 0;
+    guint last = G_N_ELEMENTS (service_modules);
 
-    case QMI_SERVICE_UNKNOWN:
-        g_assert_not_reached ();
+    while (first < last) {
+        guint middle;
 
-    case QMI_SERVICE_CTL:
-    case QMI_SERVICE_DMS:
-    case QMI_SERVICE_WMS:
-    case QMI_SERVICE_PDS:
-    case QMI_SERVICE_PBM:
-    case QMI_SERVICE_UIM:
-    case QMI_SERVICE_OMA:
-    case QMI_SERVICE_GAS:
-    case QMI_SERVICE_WDA:
-    case QMI_SERVICE_LOC:
-    case QMI_SERVICE_AUTH:
-    case QMI_SERVICE_AT:
-    case QMI_SERVICE_CAT2:
-    case QMI_SERVICE_QCHAT:
-    case QMI_SERVICE_RMTFS:
-    case QMI_SERVICE_TEST:
-    case QMI_SERVICE_SAR:
-    case QMI_SERVICE_IMS:
-    case QMI_SERVICE_ADC:
-    case QMI_SERVICE_CSD:
-    case QMI_SERVICE_MFS:
-    case QMI_SERVICE_TIME:
-    case QMI_SERVICE_TS:
-    case QMI_SERVICE_TMD:
-    case QMI_SERVICE_UIM_HTTP:
-    case QMI_SERVICE_UIM_RMT:
-    case QMI_SERVICE_SAP:
-    case QMI_SERVICE_TSYNC:
-    case QMI_SERVICE_RFSA:
-    case QMI_SERVICE_CSVT:
-    case QMI_SERVICE_QCMAP:
-    case QMI_SERVICE_IMSP:
-    case QMI_SERVICE_IMSVT:
-    case QMI_SERVICE_IMSA:
-    case QMI_SERVICE_COEX:
-    case QMI_SERVICE_STX:
-    case QMI_SERVICE_BIT:
-    case QMI_SERVICE_IMSRTP:
-    case QMI_SERVICE_RFRPE:
-    case QMI_SERVICE_SSCTL:
-    case QMI_SERVICE_DPM:
-    case QMI_SERVICE_CAT:
-    case QMI_SERVICE_RMS:
-    case QMI_SERVICE_FOTA:
-    case QMI_SERVICE_GMS:
-    case QMI_SERVICE_VOICE:
-    case QMI_SERVICE_PDC:
-    case QMI_SERVICE_DSD:
-    case QMI_SERVICE_QOS:
-    case QMI_SERVICE_FOX:
-    case QMI_SERVICE_ATR:
-    case QMI_SERVICE_SSC:
-    case QMI_SERVICE_IMSDCM:
-    default:
-        return FALSE;
+        middle = first + (last - first) / 2;
+        if (service_modules[middle]->service == service)
+            return service_modules[middle];
+        if (service_modules[middle]->service < service)
+            first = middle + 1;
+        else
+            last = middle;
     }
+
+    return NULL;
 }
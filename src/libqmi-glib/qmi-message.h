@@ -1002,6 +1002,85 @@ G_GNUC_INTERNAL
 guint16 qmi_message_tlv_read_remaining_size (QmiMessage  *self,
                                              gsize        tlv_offset,
                                              gsize        offset);
+G_GNUC_INTERNAL
+gboolean qmi_message_tlv_read_string_to_buffer (QmiMessage  *self,
+                                                gsize        tlv_offset,
+                                                gsize       *offset,
+                                                guint8       n_size_prefix_bytes,
+                                                guint16      max_size,
+                                                gchar       *out,
+                                                GError     **error);
+G_GNUC_INTERNAL
+gboolean qmi_message_tlv_read_integer_array (QmiMessage  *self,
+                                             gsize        tlv_offset,
+                                             gsize       *offset,
+                                             guint        n_items,
+                                             guint        item_size,
+                                             QmiEndian    endian,
+                                             GArray      *out,
+                                             GError     **error);
+G_GNUC_INTERNAL
+gboolean qmi_message_tlv_read_borrowed (QmiMessage     *self,
+                                        gsize           tlv_offset,
+                                        gsize          *offset,
+                                        guint           n_items,
+                                        guint           item_size,
+                                        const guint8  **out,
+                                        GError        **error);
+G_GNUC_INTERNAL
+gboolean qmi_message_tlv_read_string_borrowed (QmiMessage   *self,
+                                               gsize         tlv_offset,
+                                               gsize        *offset,
+                                               guint8        n_size_prefix_bytes,
+                                               guint16       max_size,
+                                               const gchar **out,
+                                               gsize        *out_length,
+                                               GError      **error);
+
+/* Item descriptors used by the table-driven TLV printables */
+
+typedef enum {
+    QMI_TLV_PRINTABLE_FORMAT_GUINT8,
+    QMI_TLV_PRINTABLE_FORMAT_GUINT16,
+    QMI_TLV_PRINTABLE_FORMAT_GUINT32,
+    QMI_TLV_PRINTABLE_FORMAT_GUINT64,
+    QMI_TLV_PRINTABLE_FORMAT_GUINT_SIZED,
+    QMI_TLV_PRINTABLE_FORMAT_GINT8,
+    QMI_TLV_PRINTABLE_FORMAT_GINT16,
+    QMI_TLV_PRINTABLE_FORMAT_GINT32,
+    QMI_TLV_PRINTABLE_FORMAT_GINT64,
+    QMI_TLV_PRINTABLE_FORMAT_GFLOAT,
+    QMI_TLV_PRINTABLE_FORMAT_GDOUBLE,
+    QMI_TLV_PRINTABLE_FORMAT_STRING,
+    QMI_TLV_PRINTABLE_FORMAT_FIXED_SIZE_STRING,
+} QmiTlvPrintableFormat;
+
+typedef enum {
+    QMI_TLV_PRINTABLE_VALUE_NUMBER,
+    QMI_TLV_PRINTABLE_VALUE_BOOLEAN,
+    QMI_TLV_PRINTABLE_VALUE_STRING,
+} QmiTlvPrintableValue;
+
+/* Typed wrapper around the enum or flags string builders, returns a newly
+ * allocated string, or %NULL for unknown enum values */
+typedef gchar *(* QmiTlvPrintableFunc) (guint64 value);
+
+typedef struct {
+    const gchar         *name;          /* member name, only in sequences */
+    guint8               format;        /* QmiTlvPrintableFormat */
+    guint8               value;         /* QmiTlvPrintableValue */
+    guint8               endian;        /* QmiEndian */
+    guint8               personal_info;
+    guint16              size;          /* guint-sized length, string size prefix or fixed string size */
+    guint16              max_size;      /* max string size, or 0 */
+    QmiTlvPrintableFunc  to_string;     /* enum or flags printable value builder */
+} QmiTlvPrintableItem;
+
+G_GNUC_INTERNAL
+gchar *qmi_message_tlv_build_printable (QmiMessage                *self,
+                                        guint8                     tlv_type,
+                                        const QmiTlvPrintableItem *items,
+                                        guint                      n_items);
 #endif
 
 /*****************************************************************************/
@@ -1144,6 +1223,81 @@ gchar *qmi_message_get_tlv_printable (QmiMessage   *self,
                                       const guint8 *raw,
                                       gsize         raw_length);
 
+/*****************************************************************************/
+/* JSON serialization */
+
+/**
+ * qmi_message_append_json:
+ * @self: a #QmiMessage.
+ * @context: (nullable): a #QmiMessageContext, or %NULL.
+ * @json: a #GString where the JSON object is appended.
+ *
+ * Appends to @json a single-line JSON object with the contents of the whole
+ * QMI message, including the service, client, transaction and message
+ * identifiers, and a "tlvs" array with one object per TLV.
+ *
+ * If known, each TLV object will contain the name of the TLV and its
+ * translated value, with the same field names used in the message
+ * definitions. Unknown TLVs, or those which cannot be translated, are
+ * given as a "raw" hexadecimal string instead.
+ *
+ * Values flagged as personal information are hidden unless
+ * qmi_utils_set_show_personal_info() is enabled, same as in
+ * qmi_message_get_printable_full().
+ *
+ * The translation of the contents may be specific to the @context provided,
+ * e.g. for vendor-specific messages.
+ *
+ * Since: 1.40
+ */
+void qmi_message_append_json (QmiMessage        *self,
+                              QmiMessageContext *context,
+                              GString           *json);
+
+#if defined (LIBQMI_GLIB_COMPILATION)
+
+/* Appends the translated value of a TLV in JSON; returns FALSE if the TLV
+ * cannot be translated, possibly after having appended partial contents. */
+typedef gboolean (* QmiTlvJsonFunc) (QmiMessage *self,
+                                     GString    *json);
+
+/* Looks up how to translate a given TLV of a message; returns NULL if the
+ * TLV is unknown. */
+typedef QmiTlvJsonFunc (* QmiTlvJsonLookupFunc) (QmiMessage   *self,
+                                                 guint8        tlv_type,
+                                                 const gchar **tlv_type_str,
+                                                 gboolean     *value_has_personal_info);
+
+#endif
+
+/*****************************************************************************/
+/* Service registry */
+
+#if defined (LIBQMI_GLIB_COMPILATION)
+
+/* Service-specific support provided by the generated code of each service
+ * included in the build. The is_abortable() method is only given in services
+ * with abortable messages. */
+typedef struct {
+    QmiService   service;
+    GType      (* get_client_type) (void);
+    gchar     *(* get_printable)   (QmiMessage            *self,
+                                    QmiMessageContext     *context,
+                                    const gchar           *line_prefix);
+    void       (* get_json_info)   (QmiMessage            *self,
+                                    QmiMessageContext     *context,
+                                    const gchar          **message_name,
+                                    QmiTlvJsonLookupFunc  *tlv_lookup);
+    gboolean   (* is_abortable)    (QmiMessage            *self,
+                                    QmiMessageContext     *context);
+} QmiServiceModule;
+
+/* Returns NULL if the service isn't supported in the build */
+G_GNUC_INTERNAL
+const QmiServiceModule *__qmi_service_module_lookup (QmiService service);
+
+#endif
+
 G_END_DECLS
 
 #endif /* _LIBQMI_GLIB_QMI_MESSAGE_H_ */
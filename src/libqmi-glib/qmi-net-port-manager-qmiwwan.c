@@ -29,6 +29,8 @@
 #include "qmi-error-types.h"
 #include "qmi-errors.h"
 #include "qmi-helpers.h"
+#include "qmi-link-monitor.h"
+#include "qmi-sysfs-attribute.h"
 
 
 G_DEFINE_TYPE (QmiNetPortManagerQmiwwan, qmi_net_port_manager_qmiwwan, QMI_TYPE_NET_PORT_MANAGER)
@@ -37,11 +39,14 @@ struct _QmiNetPortManagerQmiwwanPrivate {
     gchar *iface;
     gchar *sysfs_path;
     GFile *sysfs_file;
-    gchar *add_mux_sysfs_path;
-    gchar *del_mux_sysfs_path;
+    QmiSysfsAttribute *add_mux_attribute;
+    QmiSysfsAttribute *del_mux_attribute;
 
     /* mux id tracking table */
     GHashTable *mux_id_map;
+
+    /* add_link operations, run one at a time; the head is the one running */
+    GQueue *add_link_queue;
 };
 
 /*****************************************************************************/
@@ -116,51 +121,67 @@ read_link_mux_id (const gchar  *link_iface,
     return g_steal_pointer (&link_mux_id);
 }
 
-static gboolean
-lookup_mux_id_in_links (GPtrArray    *links,
-                        const gchar  *mux_id,
-                        gchar       **out_link,
-                        GError      **error)
-{
-    guint i;
-
-    for (i = 0; links && i < links->len; i++) {
-        const gchar      *link_iface;
-        g_autofree gchar *link_mux_id = NULL;
+/*****************************************************************************/
+/* Sysfs operations, all run in a worker thread so that they never block the
+ * main context */
 
-        link_iface = g_ptr_array_index (links, i);
-        link_mux_id = read_link_mux_id (link_iface, error);
-        if (!link_mux_id)
-            return FALSE;
+typedef struct {
+    GPtrArray *links;   /* NULL if there are no links */
+    GPtrArray *mux_ids; /* same size as links, NULL items if unknown */
+} LinksSnapshot;
 
-        if (g_strcmp0 (mux_id, link_mux_id) == 0) {
-            *out_link = g_strdup (link_iface);
-            return TRUE;
-        }
-    }
+static void
+links_snapshot_free (LinksSnapshot *snapshot)
+{
+    g_clear_pointer (&snapshot->mux_ids, g_ptr_array_unref);
+    g_clear_pointer (&snapshot->links, g_ptr_array_unref);
+    g_slice_free (LinksSnapshot, snapshot);
+}
 
-    *out_link = NULL;
-    return TRUE;
+static LinksSnapshot *
+list_links_finish (QmiNetPortManagerQmiwwan  *self,
+                   GAsyncResult              *res,
+                   GError                   **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
 }
 
-static gchar *
-lookup_first_new_link (GPtrArray *links_before,
-                       GPtrArray *links_after)
+static void
+list_links_thread (GTask                    *task,
+                   QmiNetPortManagerQmiwwan *self,
+                   gpointer                  task_data,
+                   GCancellable             *cancellable)
 {
-    guint i;
+    LinksSnapshot *snapshot;
+    GError        *error = NULL;
+    guint          i;
 
-    if (!links_after)
-        return NULL;
+    snapshot = g_slice_new0 (LinksSnapshot);
+    if (!qmi_helpers_list_links (self->priv->sysfs_file, cancellable, NULL, &snapshot->links, &error)) {
+        links_snapshot_free (snapshot);
+        g_task_return_error (task, error);
+        return;
+    }
 
-    for (i = 0; i < links_after->len; i++) {
-        const gchar *link_iface;
+    snapshot->mux_ids = g_ptr_array_new_with_free_func (g_free);
+    for (i = 0; snapshot->links && i < snapshot->links->len; i++)
+        g_ptr_array_add (snapshot->mux_ids, read_link_mux_id (g_ptr_array_index (snapshot->links, i), NULL));
 
-        link_iface = g_ptr_array_index (links_after, i);
+    g_task_return_pointer (task, snapshot, (GDestroyNotify) links_snapshot_free);
+}
 
-        if (!links_before || !g_ptr_array_find_with_equal_func (links_before, link_iface, g_str_equal, NULL))
-            return g_strdup (link_iface);
-    }
-    return NULL;
+/* Lists the links along with their mux ids */
+static void
+list_links (QmiNetPortManagerQmiwwan *self,
+            GCancellable             *cancellable,
+            GAsyncReadyCallback       callback,
+            gpointer                  user_data)
+{
+    GTask *task;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_run_in_thread (task, (GTaskThreadFunc) list_links_thread);
+    g_object_unref (task);
 }
 
 /*****************************************************************************/
@@ -175,7 +196,7 @@ cmpuint (const guint *a,
 static guint
 get_first_free_mux_id (QmiNetPortManagerQmiwwan  *self,
                        guint                      initial_mux_id,
-                       GPtrArray                 *links,
+                       LinksSnapshot             *snapshot,
                        GError                   **error)
 {
     guint              i;
@@ -183,33 +204,30 @@ get_first_free_mux_id (QmiNetPortManagerQmiwwan  *self,
     guint              next_mux_id;
     static const guint max_mux_id_upper_threshold = QMI_DEVICE_MUX_ID_MAX + 1;
 
-    if (!links)
+    if (!snapshot->links)
         return initial_mux_id;
 
     existing_mux_ids = g_array_new (FALSE, FALSE, sizeof (guint));
 
-    for (i = 0; i < links->len; i++) {
-        const gchar      *link_iface;
-        g_autofree gchar *link_mux_id = NULL;
-        gulong            link_mux_id_num;
+    for (i = 0; i < snapshot->links->len; i++) {
+        const gchar *link_iface;
+        const gchar *link_mux_id;
+        gulong       link_mux_id_num;
 
-        link_iface = g_ptr_array_index (links, i);
-        link_mux_id = read_link_mux_id (link_iface, NULL);
+        link_iface = g_ptr_array_index (snapshot->links, i);
+        link_mux_id = g_ptr_array_index (snapshot->mux_ids, i);
         if (!link_mux_id) {
-            const gchar *tracked_link_mux_id;
-
             g_debug ("Couldn't read mux id from sysfs for link '%s': unsupported by driver", link_iface);
             /* fallback to use our internal tracking table... far from perfect */
-            tracked_link_mux_id = get_tracked_mux_id (self, link_iface, NULL);
-            if (!tracked_link_mux_id) {
+            link_mux_id = get_tracked_mux_id (self, link_iface, NULL);
+            if (!link_mux_id) {
                 g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED,
                              "Couldn't get tracked mux id for link '%s'", link_iface);
                 return QMI_DEVICE_MUX_ID_UNBOUND;
             }
-            link_mux_id_num = strtoul (tracked_link_mux_id, NULL, 16);
-        } else
-            link_mux_id_num = strtoul (link_mux_id, NULL, 16);
+        }
 
+        link_mux_id_num = strtoul (link_mux_id, NULL, 16);
         if (!link_mux_id_num) {
             g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
                          "Couldn't parse mux id '%s'", link_mux_id);
@@ -224,13 +242,16 @@ get_first_free_mux_id (QmiNetPortManagerQmiwwan  *self,
     g_array_append_val (existing_mux_ids, max_mux_id_upper_threshold);
     g_array_sort (existing_mux_ids, (GCompareFunc)cmpuint);
 
-    for (next_mux_id = initial_mux_id, i = 0; i < existing_mux_ids->len; next_mux_id++, i++) {
+    for (next_mux_id = initial_mux_id, i = 0; i < existing_mux_ids->len; i++) {
         guint existing;
 
+        /* Ignore mux ids below the initial one */
         existing = g_array_index (existing_mux_ids, guint, i);
+        if (existing < next_mux_id)
+            continue;
         if (next_mux_id < existing)
             return next_mux_id;
-        g_assert_cmpuint (next_mux_id, ==, existing);
+        next_mux_id++;
     }
 
     g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED, "No mux ids left");
@@ -238,6 +259,170 @@ get_first_free_mux_id (QmiNetPortManagerQmiwwan  *self,
 }
 
 /*****************************************************************************/
+/* New link lookup, run in a worker thread */
+
+typedef struct {
+    GPtrArray *candidates;   /* NULL to look for new links in sysfs */
+    GPtrArray *links_before; /* NULL if there were no links */
+    gchar     *mux_id_str;
+} LookupNewLinkContext;
+
+static void
+lookup_new_link_context_free (LookupNewLinkContext *ctx)
+{
+    g_clear_pointer (&ctx->candidates, g_ptr_array_unref);
+    g_clear_pointer (&ctx->links_before, g_ptr_array_unref);
+    g_free (ctx->mux_id_str);
+    g_slice_free (LookupNewLinkContext, ctx);
+}
+
+static gchar *
+lookup_new_link_finish (QmiNetPortManagerQmiwwan  *self,
+                        GAsyncResult              *res,
+                        GError                   **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static void
+lookup_new_link_thread (GTask                    *task,
+                        QmiNetPortManagerQmiwwan *self,
+                        LookupNewLinkContext     *ctx,
+                        GCancellable             *cancellable)
+{
+    g_autoptr(GPtrArray)  candidates = NULL;
+    const gchar          *first_unknown = NULL;
+    GError               *error = NULL;
+    guint                 i;
+
+    if (ctx->candidates)
+        candidates = g_ptr_array_ref (ctx->candidates);
+    else if (!qmi_helpers_list_links (self->priv->sysfs_file,
+                                      cancellable,
+                                      ctx->links_before,
+                                      &candidates,
+                                      &error)) {
+        g_prefix_error (&error, "Couldn't enumerate files in the sysfs directory after link addition: ");
+        g_task_return_error (task, error);
+        return;
+    }
+
+    for (i = 0; candidates && i < candidates->len; i++) {
+        const gchar      *link_iface;
+        g_autofree gchar *upper_path = NULL;
+        g_autofree gchar *link_mux_id = NULL;
+
+        link_iface = g_ptr_array_index (candidates, i);
+
+        /* Link notifications are received for all interfaces in the system,
+         * so skip those not created on top of our interface */
+        upper_path = g_strdup_printf ("%s/upper_%s", self->priv->sysfs_path, link_iface);
+        if (!g_file_test (upper_path, G_FILE_TEST_EXISTS))
+            continue;
+
+        link_mux_id = read_link_mux_id (link_iface, NULL);
+        if (!link_mux_id) {
+            /* Assume this is because the mux_id attribute was added in a newer
+             * kernel. As a fallback, we'll use the first new link listed, even
+             * if this is definitely very racy. */
+            if (!first_unknown)
+                first_unknown = link_iface;
+            continue;
+        }
+
+        if (g_strcmp0 (ctx->mux_id_str, link_mux_id) == 0) {
+            g_debug ("Found link '%s' associated to mux id '%s'", link_iface, ctx->mux_id_str);
+            g_task_return_pointer (task, g_strdup (link_iface), g_free);
+            return;
+        }
+    }
+
+    if (first_unknown) {
+        g_debug ("Found first new link '%s' (unknown mux id)", first_unknown);
+        g_task_return_pointer (task, g_strdup (first_unknown), g_free);
+        return;
+    }
+
+    g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                             "No new link detected for mux id %s", ctx->mux_id_str);
+}
+
+/* Looks for the link created for the given mux id, either among the given
+ * candidates or among the links not listed before */
+static void
+lookup_new_link (QmiNetPortManagerQmiwwan *self,
+                 GPtrArray                *candidates,
+                 GPtrArray                *links_before,
+                 const gchar              *mux_id_str,
+                 GCancellable             *cancellable,
+                 GAsyncReadyCallback       callback,
+                 gpointer                  user_data)
+{
+    GTask                *task;
+    LookupNewLinkContext *ctx;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    ctx = g_slice_new0 (LookupNewLinkContext);
+    ctx->candidates = candidates ? g_ptr_array_ref (candidates) : NULL;
+    ctx->links_before = links_before ? g_ptr_array_ref (links_before) : NULL;
+    ctx->mux_id_str = g_strdup (mux_id_str);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) lookup_new_link_context_free);
+    g_task_run_in_thread (task, (GTaskThreadFunc) lookup_new_link_thread);
+    g_object_unref (task);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    guint                mux_id;
+    guint                initial_mux_id;
+    gchar               *mux_id_str;
+    LinksSnapshot       *snapshot;
+    QmiLinkMonitorWatch *watch;
+    GPtrArray           *new_links;
+    gboolean             new_links_lost;
+} AddLinkContext;
+
+static void
+add_link_context_free (AddLinkContext *ctx)
+{
+    if (ctx->watch)
+        qmi_link_monitor_watch_remove (ctx->watch);
+    g_ptr_array_unref (ctx->new_links);
+    g_clear_pointer (&ctx->snapshot, links_snapshot_free);
+    g_free (ctx->mux_id_str);
+    g_slice_free (AddLinkContext, ctx);
+}
+
+static void add_link_run (GTask *task);
+
+/* Completes the running add_link operation, and starts the next queued one.
+ * Operations must not overlap: both the automatic mux id selection and the
+ * new link lookup assume no other link is being added in the meantime. */
+static void
+add_link_complete (GTask  *task,
+                   gchar  *link_name,
+                   GError *error)
+{
+    QmiNetPortManagerQmiwwan *self;
+    GTask                    *next;
+
+    self = g_task_get_source_object (task);
+    g_assert (g_queue_peek_head (self->priv->add_link_queue) == task);
+    g_queue_pop_head (self->priv->add_link_queue);
+
+    /* Started before completing, so that a new operation requested from the
+     * completion callback is queued after the pending ones */
+    next = g_queue_peek_head (self->priv->add_link_queue);
+    if (next)
+        add_link_run (next);
+
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_pointer (task, link_name, g_free);
+    g_object_unref (task);
+}
 
 static gchar *
 net_port_manager_add_link_finish (QmiNetPortManager  *self,
@@ -245,18 +430,171 @@ net_port_manager_add_link_finish (QmiNetPortManager  *self,
                                   GAsyncResult       *res,
                                   GError            **error)
 {
-    gchar *link_name;
+    gchar          *link_name;
+    AddLinkContext *ctx;
 
     link_name = g_task_propagate_pointer (G_TASK (res), error);
     if (!link_name)
         return NULL;
 
+    ctx = g_task_get_task_data (G_TASK (res));
     if (mux_id)
-        *mux_id = GPOINTER_TO_UINT (g_task_get_task_data (G_TASK (res)));
+        *mux_id = ctx->mux_id;
 
     return link_name;
 }
 
+static void
+add_link_link_event (QmiLinkMonitorEvent  event,
+                     guint                ifindex,
+                     guint                parent_ifindex,
+                     const gchar         *ifname,
+                     AddLinkContext      *ctx)
+{
+    if (event == QMI_LINK_MONITOR_EVENT_OVERFLOW)
+        ctx->new_links_lost = TRUE;
+    else if (event == QMI_LINK_MONITOR_EVENT_NEW &&
+             !g_ptr_array_find_with_equal_func (ctx->new_links, ifname, g_str_equal, NULL))
+        g_ptr_array_add (ctx->new_links, g_strdup (ifname));
+}
+
+static void
+lookup_new_link_ready (QmiNetPortManagerQmiwwan *self,
+                       GAsyncResult             *res,
+                       GTask                    *task)
+{
+    AddLinkContext *ctx;
+    GError         *error = NULL;
+    gchar          *link_name;
+
+    ctx = g_task_get_task_data (task);
+
+    link_name = lookup_new_link_finish (self, res, &error);
+    if (!link_name) {
+        add_link_complete (task, NULL, error);
+        return;
+    }
+
+    if (!track_mux_id (self, link_name, ctx->mux_id_str, &error)) {
+        g_warning ("Couldn't track mux id: %s", error->message);
+        g_clear_error (&error);
+    }
+
+    add_link_complete (task, link_name, NULL);
+}
+
+static void
+add_mux_ready (GObject      *source,
+               GAsyncResult *res,
+               GTask        *task)
+{
+    QmiNetPortManagerQmiwwan *self;
+    AddLinkContext           *ctx;
+    GError                   *error = NULL;
+    g_autoptr(GPtrArray)      candidates = NULL;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    if (!qmi_sysfs_attribute_write_finish (self->priv->add_mux_attribute, res, &error)) {
+        g_prefix_error (&error, "Couldn't add create link with mux id %s: ", ctx->mux_id_str);
+        add_link_complete (task, NULL, error);
+        return;
+    }
+
+    /* The link has already been created by the time the add_mux write
+     * returns, so its notifications are already waiting in the socket */
+    if (ctx->watch) {
+        qmi_link_monitor_watch_flush (ctx->watch);
+        if (!ctx->new_links_lost) {
+            guint i;
+
+            candidates = g_ptr_array_new ();
+            for (i = 0; i < ctx->new_links->len; i++) {
+                const gchar *link_iface;
+
+                link_iface = g_ptr_array_index (ctx->new_links, i);
+                if (!ctx->snapshot->links ||
+                    !g_ptr_array_find_with_equal_func (ctx->snapshot->links, link_iface, g_str_equal, NULL))
+                    g_ptr_array_add (candidates, (gpointer) link_iface);
+            }
+        }
+    }
+
+    lookup_new_link (self,
+                     (candidates && candidates->len) ? candidates : NULL,
+                     ctx->snapshot->links,
+                     ctx->mux_id_str,
+                     g_task_get_cancellable (task),
+                     (GAsyncReadyCallback) lookup_new_link_ready,
+                     task);
+}
+
+static void
+add_link_list_links_ready (QmiNetPortManagerQmiwwan *self,
+                           GAsyncResult             *res,
+                           GTask                    *task)
+{
+    AddLinkContext *ctx;
+    GError         *error = NULL;
+
+    ctx = g_task_get_task_data (task);
+
+    ctx->snapshot = list_links_finish (self, res, &error);
+    if (!ctx->snapshot) {
+        g_prefix_error (&error, "Couldn't enumerate files in the sysfs directory before link addition: ");
+        add_link_complete (task, NULL, error);
+        return;
+    }
+
+    if (ctx->mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC) {
+        ctx->mux_id = get_first_free_mux_id (self, ctx->initial_mux_id, ctx->snapshot, &error);
+        if (ctx->mux_id == QMI_DEVICE_MUX_ID_UNBOUND) {
+            g_prefix_error (&error, "Couldn't add link with automatic mux id: ");
+            add_link_complete (task, NULL, error);
+            return;
+        }
+        g_debug ("Using mux id %u", ctx->mux_id);
+    }
+
+    ctx->mux_id_str = g_strdup_printf ("0x%02x", ctx->mux_id);
+
+    qmi_sysfs_attribute_write_async (self->priv->add_mux_attribute,
+                                     ctx->mux_id_str,
+                                     g_task_get_cancellable (task),
+                                     (GAsyncReadyCallback) add_mux_ready,
+                                     task);
+}
+
+static void
+add_link_run (GTask *task)
+{
+    QmiNetPortManagerQmiwwan *self;
+    AddLinkContext           *ctx;
+    GError                   *error = NULL;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    g_debug ("Running add link operation...");
+
+    /* Link notifications are used to detect the new link; if they're not
+     * available, we'll look for new links in sysfs */
+    ctx->watch = qmi_link_monitor_watch_add (g_task_get_context (task),
+                                             (QmiLinkMonitorFunc) add_link_link_event,
+                                             ctx,
+                                             &error);
+    if (!ctx->watch) {
+        g_debug ("Couldn't monitor link notifications: %s", error->message);
+        g_clear_error (&error);
+    }
+
+    list_links (self,
+                g_task_get_cancellable (task),
+                (GAsyncReadyCallback) add_link_list_links_ready,
+                task);
+}
+
 static void
 net_port_manager_add_link (QmiNetPortManager     *_self,
                            guint                  mux_id,
@@ -271,17 +609,18 @@ net_port_manager_add_link (QmiNetPortManager     *_self,
 {
     QmiNetPortManagerQmiwwan *self = QMI_NET_PORT_MANAGER_QMIWWAN (_self);
     GTask                    *task;
-    GError                   *error = NULL;
-    g_autoptr(GPtrArray)      links_before = NULL;
-    g_autoptr(GPtrArray)      links_after = NULL;
-    g_autofree gchar         *link_name = NULL;
-    g_autofree gchar         *mux_id_str = NULL;
+    AddLinkContext           *ctx;
 
     g_debug ("Net port manager based on qmi_wwan ignores the ifname prefix '%s'", ifname_prefix);
-    g_debug ("Running add link operation...");
 
     task = g_task_new (self, cancellable, callback, user_data);
 
+    ctx = g_slice_new0 (AddLinkContext);
+    ctx->mux_id = mux_id;
+    ctx->initial_mux_id = initial_mux_id;
+    ctx->new_links = g_ptr_array_new_with_free_func (g_free);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) add_link_context_free);
+
     if (flags != QMI_DEVICE_ADD_LINK_FLAGS_NONE) {
         g_autofree gchar *flags_str = NULL;
 
@@ -292,76 +631,30 @@ net_port_manager_add_link (QmiNetPortManager     *_self,
         return;
     }
 
-    if (!qmi_helpers_list_links (self->priv->sysfs_file,
-                                 cancellable,
-                                 NULL,
-                                 &links_before,
-                                 &error)) {
-        g_prefix_error (&error, "Couldn't enumerate files in the sysfs directory before link addition: ");
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
-
-    if (mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC) {
-        mux_id = get_first_free_mux_id (self, initial_mux_id, links_before, &error);
-        if (mux_id == QMI_DEVICE_MUX_ID_UNBOUND) {
-            g_prefix_error (&error, "Couldn't add link with automatic mux id: ");
-            g_task_return_error (task, error);
-            g_object_unref (task);
-            return;
-        }
-        g_debug ("Using mux id %u", mux_id);
-    }
-
-    g_task_set_task_data (task, GUINT_TO_POINTER (mux_id), NULL);
-    mux_id_str = g_strdup_printf ("0x%02x", mux_id);
-
-    if (!qmi_helpers_write_sysfs_file (self->priv->add_mux_sysfs_path, mux_id_str, &error)) {
-        g_prefix_error (&error, "Couldn't add create link with mux id %s: ", mux_id_str);
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
-
-    if (!qmi_helpers_list_links (self->priv->sysfs_file,
-                                 cancellable,
-                                 links_before,
-                                 &links_after,
-                                 &error)) {
-        g_prefix_error (&error, "Couldn't enumerate files in the sysfs directory after link addition: ");
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
+    g_queue_push_tail (self->priv->add_link_queue, task);
+    if (g_queue_get_length (self->priv->add_link_queue) == 1)
+        add_link_run (task);
+    else
+        g_debug ("Add link operation queued");
+}
 
-    if (!lookup_mux_id_in_links (links_after, mux_id_str, &link_name, NULL)) {
-        /* Now, assume this is because the mux_id attribute was added in a newer
-         * kernel. As a fallback, we'll try to detect the first new link listed,
-         * even if this is definitely very racy. */
-        link_name = lookup_first_new_link (links_before, links_after);
-        if (!link_name) {
-            g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
-                                     "No new link detected for mux id %s", mux_id_str);
-            g_object_unref (task);
-            return;
-        }
-        g_debug ("Found first new link '%s' (unknown mux id)", link_name);
-    } else
-        g_debug ("Found link '%s' associated to mux id '%s'", link_name, mux_id_str);
+/*****************************************************************************/
 
+typedef struct {
+    gchar *ifname;
+    gchar *mux_id_str;         /* NULL if unknown */
+    gchar *tracked_mux_id_str; /* NULL if unknown */
+} DelLinkContext;
 
-    if (!track_mux_id (self, link_name, mux_id_str, &error)) {
-        g_warning ("Couldn't track mux id: %s", error->message);
-        g_clear_error (&error);
-    }
-
-    g_task_return_pointer (task, g_steal_pointer (&link_name), g_free);
-    g_object_unref (task);
+static void
+del_link_context_free (DelLinkContext *ctx)
+{
+    g_free (ctx->ifname);
+    g_free (ctx->mux_id_str);
+    g_free (ctx->tracked_mux_id_str);
+    g_slice_free (DelLinkContext, ctx);
 }
 
-/*****************************************************************************/
-
 static gboolean
 net_port_manager_del_link_finish (QmiNetPortManager  *self,
                                   GAsyncResult       *res,
@@ -371,24 +664,15 @@ net_port_manager_del_link_finish (QmiNetPortManager  *self,
 }
 
 static void
-net_port_manager_del_link (QmiNetPortManager   *_self,
-                           const gchar         *ifname,
-                           guint                mux_id,
-                           guint                timeout,
-                           GCancellable        *cancellable,
-                           GAsyncReadyCallback  callback,
-                           gpointer             user_data)
+del_link_thread (GTask                    *task,
+                 QmiNetPortManagerQmiwwan *self,
+                 DelLinkContext           *ctx,
+                 GCancellable             *cancellable)
 {
-    QmiNetPortManagerQmiwwan *self = QMI_NET_PORT_MANAGER_QMIWWAN (_self);
-    GTask                    *task;
-    GError                   *error = NULL;
-    g_autoptr(GPtrArray)      links_before = NULL;
-    g_autoptr(GPtrArray)      links_after = NULL;
-    g_autofree gchar         *mux_id_str = NULL;
-
-    g_debug ("Running del link (%s) operation...", ifname);
-
-    task = g_task_new (self, cancellable, callback, user_data);
+    GError               *error = NULL;
+    g_autoptr(GPtrArray)  links_before = NULL;
+    g_autoptr(GPtrArray)  links_after = NULL;
+    g_autofree gchar     *mux_id_str = NULL;
 
     if (!qmi_helpers_list_links (self->priv->sysfs_file,
                                  cancellable,
@@ -397,41 +681,37 @@ net_port_manager_del_link (QmiNetPortManager   *_self,
                                  &error)) {
         g_prefix_error (&error, "Couldn't enumerate files in the sysfs directory before link deletion: ");
         g_task_return_error (task, error);
-        g_object_unref (task);
         return;
     }
 
-    if (!links_before || !g_ptr_array_find_with_equal_func (links_before, ifname, g_str_equal, NULL)) {
+    if (!links_before || !g_ptr_array_find_with_equal_func (links_before, ctx->ifname, g_str_equal, NULL)) {
         g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
                                  "Cannot delete link '%s': interface not found",
-                                 ifname);
-        g_object_unref (task);
+                                 ctx->ifname);
         return;
     }
 
     /* Try to guess mux id if not given as input */
-    if (mux_id != QMI_DEVICE_MUX_ID_UNBOUND)
-        mux_id_str = g_strdup_printf ("0x%02x", mux_id);
+    if (ctx->mux_id_str)
+        mux_id_str = g_strdup (ctx->mux_id_str);
     else {
-        mux_id_str = read_link_mux_id (ifname, NULL);
+        mux_id_str = read_link_mux_id (ctx->ifname, NULL);
         if (!mux_id_str) {
-            mux_id_str = g_strdup (get_tracked_mux_id (self, ifname, NULL));
+            mux_id_str = g_strdup (ctx->tracked_mux_id_str);
             if (!mux_id_str) {
                 /* This unsupported error allows us to flag when del_all_links()
                  * needs to switch to the fallback mechanism */
                 g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED,
                                          "Cannot delete link '%s': unknown mux id",
-                                         ifname);
-                g_object_unref (task);
+                                         ctx->ifname);
                 return;
             }
         }
     }
 
-    if (!qmi_helpers_write_sysfs_file (self->priv->del_mux_sysfs_path, mux_id_str, &error)) {
+    if (!qmi_sysfs_attribute_write (self->priv->del_mux_attribute, mux_id_str, &error)) {
         g_prefix_error (&error, "Couldn't delete link with mux id %s: ", mux_id_str);
         g_task_return_error (task, error);
-        g_object_unref (task);
         return;
     }
 
@@ -442,18 +722,35 @@ net_port_manager_del_link (QmiNetPortManager   *_self,
                                  &error)) {
         g_prefix_error (&error, "Couldn't enumerate files in the sysfs directory after link deletion: ");
         g_task_return_error (task, error);
-        g_object_unref (task);
         return;
     }
 
-    if (links_after && g_ptr_array_find_with_equal_func (links_after, ifname, g_str_equal, NULL)) {
+    if (links_after && g_ptr_array_find_with_equal_func (links_after, ctx->ifname, g_str_equal, NULL)) {
         g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
-                                 "link '%s' still detected", ifname);
+                                 "link '%s' still detected", ctx->ifname);
+        return;
+    }
+
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+del_link_ready (QmiNetPortManagerQmiwwan *self,
+                GAsyncResult             *res,
+                GTask                    *task)
+{
+    DelLinkContext *ctx;
+    GError         *error = NULL;
+
+    ctx = g_task_get_task_data (G_TASK (res));
+
+    if (!g_task_propagate_boolean (G_TASK (res), &error)) {
+        g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
-    if (!untrack_mux_id (self, ifname, &error)) {
+    if (!untrack_mux_id (self, ctx->ifname, &error)) {
         g_debug ("couldn't untrack mux id: %s", error->message);
         g_clear_error (&error);
     }
@@ -461,6 +758,37 @@ net_port_manager_del_link (QmiNetPortManager   *_self,
     g_object_unref (task);
 }
 
+static void
+net_port_manager_del_link (QmiNetPortManager   *_self,
+                           const gchar         *ifname,
+                           guint                mux_id,
+                           guint                timeout,
+                           GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+    QmiNetPortManagerQmiwwan *self = QMI_NET_PORT_MANAGER_QMIWWAN (_self);
+    GTask                    *task;
+    GTask                    *thread_task;
+    DelLinkContext           *ctx;
+
+    g_debug ("Running del link (%s) operation...", ifname);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    ctx = g_slice_new0 (DelLinkContext);
+    ctx->ifname = g_strdup (ifname);
+    if (mux_id != QMI_DEVICE_MUX_ID_UNBOUND)
+        ctx->mux_id_str = g_strdup_printf ("0x%02x", mux_id);
+    /* The tracking table is only used from the main context */
+    ctx->tracked_mux_id_str = g_strdup (get_tracked_mux_id (self, ifname, NULL));
+
+    thread_task = g_task_new (self, cancellable, (GAsyncReadyCallback) del_link_ready, task);
+    g_task_set_task_data (thread_task, ctx, (GDestroyNotify) del_link_context_free);
+    g_task_run_in_thread (thread_task, (GTaskThreadFunc) del_link_thread);
+    g_object_unref (thread_task);
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -472,33 +800,31 @@ net_port_manager_del_all_links_finish (QmiNetPortManager  *self,
 }
 
 static void
-fallback_del_all_links (GTask *task)
+fallback_del_all_links_thread (GTask                    *task,
+                               QmiNetPortManagerQmiwwan *self,
+                               gpointer                  task_data,
+                               GCancellable             *cancellable)
 {
-    QmiNetPortManagerQmiwwan *self;
-    guint                     i;
-    g_autoptr(GPtrArray)      links_before = NULL;
-    g_autoptr(GPtrArray)      links_after = NULL;
-    GError                   *error = NULL;
-    guint                     n_deleted = 0;
-
-    self = g_task_get_source_object (task);
+    guint                 i;
+    g_autoptr(GPtrArray)  links_before = NULL;
+    g_autoptr(GPtrArray)  links_after = NULL;
+    GError               *error = NULL;
+    guint                 n_deleted = 0;
 
     g_debug ("Running fallback link deletion logic...");
 
     if (!qmi_helpers_list_links (self->priv->sysfs_file,
-                                 g_task_get_cancellable (task),
+                                 cancellable,
                                  NULL,
                                  &links_before,
                                  &error)) {
         g_prefix_error (&error, "Couldn't list links before deleting all: ");
         g_task_return_error (task, error);
-        g_object_unref (task);
         return;
     }
 
     if (!links_before) {
         g_task_return_boolean (task, TRUE);
-        g_object_unref (task);
         return;
     }
 
@@ -509,7 +835,7 @@ fallback_del_all_links (GTask *task)
 
         /* attempt to delete link with the given mux id; if there is no such link
          * the kernel will complain with a harmless "mux_id not present" warning */
-        if ((qmi_helpers_write_sysfs_file (self->priv->del_mux_sysfs_path, mux_id, NULL) &&
+        if ((qmi_sysfs_attribute_write (self->priv->del_mux_attribute, mux_id, NULL) &&
              (++n_deleted == links_before->len))) {
             /* early break if all N links deleted already */
             break;
@@ -517,7 +843,7 @@ fallback_del_all_links (GTask *task)
     }
 
     if (!qmi_helpers_list_links (self->priv->sysfs_file,
-                                 g_task_get_cancellable (task),
+                                 cancellable,
                                  NULL,
                                  &links_after,
                                  &error)) {
@@ -528,9 +854,35 @@ fallback_del_all_links (GTask *task)
                                  "Not all links were deleted");
     else
         g_task_return_boolean (task, TRUE);
+}
+
+static void
+fallback_del_all_links_ready (QmiNetPortManagerQmiwwan *self,
+                              GAsyncResult             *res,
+                              GTask                    *task)
+{
+    GError *error = NULL;
+
+    if (!g_task_propagate_boolean (G_TASK (res), &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
     g_object_unref (task);
 }
 
+static void
+fallback_del_all_links (GTask *task)
+{
+    GTask *thread_task;
+
+    thread_task = g_task_new (g_task_get_source_object (task),
+                              g_task_get_cancellable (task),
+                              (GAsyncReadyCallback) fallback_del_all_links_ready,
+                              task);
+    g_task_run_in_thread (thread_task, (GTaskThreadFunc) fallback_del_all_links_thread);
+    g_object_unref (thread_task);
+}
+
 static void
 parent_del_all_links_ready (QmiNetPortManager *self,
                             GAsyncResult      *res,
@@ -584,6 +936,8 @@ qmi_net_port_manager_qmiwwan_new (const gchar  *iface,
                                   GError      **error)
 {
     g_autoptr(QmiNetPortManagerQmiwwan) self = NULL;
+    g_autofree gchar                   *add_mux_sysfs_path = NULL;
+    g_autofree gchar                   *del_mux_sysfs_path = NULL;
 
     self = QMI_NET_PORT_MANAGER_QMIWWAN (g_object_new (QMI_TYPE_NET_PORT_MANAGER_QMIWWAN, NULL));
 
@@ -592,16 +946,20 @@ qmi_net_port_manager_qmiwwan_new (const gchar  *iface,
     self->priv->sysfs_path = g_strdup_printf ("/sys/class/net/%s", iface);
     self->priv->sysfs_file = g_file_new_for_path (self->priv->sysfs_path);
 
-    self->priv->add_mux_sysfs_path = g_strdup_printf ("%s/qmi/add_mux", self->priv->sysfs_path);
-    self->priv->del_mux_sysfs_path = g_strdup_printf ("%s/qmi/del_mux", self->priv->sysfs_path);
+    add_mux_sysfs_path = g_strdup_printf ("%s/qmi/add_mux", self->priv->sysfs_path);
+    del_mux_sysfs_path = g_strdup_printf ("%s/qmi/del_mux", self->priv->sysfs_path);
 
-    if (!g_file_test (self->priv->add_mux_sysfs_path, G_FILE_TEST_EXISTS) ||
-        !g_file_test (self->priv->del_mux_sysfs_path, G_FILE_TEST_EXISTS)) {
+    if (!g_file_test (add_mux_sysfs_path, G_FILE_TEST_EXISTS) ||
+        !g_file_test (del_mux_sysfs_path, G_FILE_TEST_EXISTS)) {
         g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
                      "No support for multiplexing in the interface");
         return NULL;
     }
 
+    /* Kept open while the manager exists */
+    self->priv->add_mux_attribute = qmi_sysfs_attribute_new (add_mux_sysfs_path);
+    self->priv->del_mux_attribute = qmi_sysfs_attribute_new (del_mux_sysfs_path);
+
     return g_steal_pointer (&self);
 }
 
@@ -615,6 +973,7 @@ qmi_net_port_manager_qmiwwan_init (QmiNetPortManagerQmiwwan *self)
                                               QmiNetPortManagerQmiwwanPrivate);
 
     self->priv->mux_id_map = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    self->priv->add_link_queue = g_queue_new ();
 }
 
 static void
@@ -622,12 +981,15 @@ finalize (GObject *object)
 {
     QmiNetPortManagerQmiwwan *self = QMI_NET_PORT_MANAGER_QMIWWAN (object);
 
+    /* Queued operations hold a reference to the manager */
+    g_assert (g_queue_is_empty (self->priv->add_link_queue));
+    g_queue_free (self->priv->add_link_queue);
     g_hash_table_unref (self->priv->mux_id_map);
     g_free (self->priv->iface);
     g_object_unref (self->priv->sysfs_file);
     g_free (self->priv->sysfs_path);
-    g_free (self->priv->del_mux_sysfs_path);
-    g_free (self->priv->add_mux_sysfs_path);
+    g_clear_pointer (&self->priv->del_mux_attribute, qmi_sysfs_attribute_unref);
+    g_clear_pointer (&self->priv->add_mux_attribute, qmi_sysfs_attribute_unref);
 
     G_OBJECT_CLASS (qmi_net_port_manager_qmiwwan_parent_class)->finalize (object);
 }
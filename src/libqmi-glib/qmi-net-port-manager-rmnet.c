@@ -39,28 +39,38 @@
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <errno.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "qmi-device.h"
 #include "qmi-error-types.h"
 #include "qmi-errors.h"
+#include "qmi-helpers.h"
 #include "qmi-net-port-manager-rmnet.h"
 
 G_DEFINE_TYPE (QmiNetPortManagerRmnet, qmi_net_port_manager_rmnet, QMI_TYPE_NET_PORT_MANAGER)
 
 struct _QmiNetPortManagerRmnetPrivate {
     /* Netlink socket */
-    GSocket *socket;
-    GSource *source;
+    GSocket    *socket;
+    GSource    *source;
+    GByteArray *buffer;
 
     /* Netlink state */
     guint       current_sequence_id;
     GHashTable *transactions;
+
+    /* Queued link additions, per base interface index */
+    GHashTable *add_link_queues;
 };
 
 #define RMNET_DATA_TYPE "rmnet"
 #define RMNET_MAX_MUX_ID 255
 
+/* Initial size of the receive buffer, grown as needed */
+#define NETLINK_BUFFER_SIZE 8192
+
 /*****************************************************************************/
 
 static gchar *
@@ -89,16 +99,6 @@ typedef struct {
     struct ifinfomsg ifreq;
 } NetlinkHeader;
 
-/* Work around 'cast-align' warnings on some architectures */
-#define CAST_ALIGN(Type, ptr)                                         \
-    ({                                                                \
-        gconstpointer const _ptr = (ptr);                             \
-                                                                      \
-        g_assert (((gsize) (gpointer) _ptr % __alignof (Type)) == 0); \
-                                                                      \
-        ((Type *) _ptr);                                              \
-    })
-
 static NetlinkHeader *
 netlink_message_header (NetlinkMessage *msg)
 {
@@ -191,9 +191,12 @@ netlink_message_new (guint16 type,
     hdr = netlink_message_header (msg);
     hdr->msghdr.nlmsg_len = msg->len;
     hdr->msghdr.nlmsg_type = type;
-    hdr->msghdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | extra_flags;
+    hdr->msghdr.nlmsg_flags = NLM_F_REQUEST | extra_flags;
+    /* Dumps are finished with NLMSG_DONE, not with an ACK */
+    if (type != RTM_GETLINK)
+        hdr->msghdr.nlmsg_flags |= NLM_F_ACK;
     hdr->ifreq.ifi_family = AF_UNSPEC;
-    if (type != RTM_DELLINK) {
+    if (type == RTM_NEWLINK) {
         hdr->ifreq.ifi_type = ARPHRD_RAWIP;
         hdr->ifreq.ifi_flags = 0;
         hdr->ifreq.ifi_change = 0xFFFFFFFF;
@@ -214,6 +217,8 @@ typedef struct {
     guint32                 sequence_id;
     GSource                *timeout_source;
     GTask                  *completion_task;
+    /* Links reported so far, only in dump requests */
+    GPtrArray              *links;
 } Transaction;
 
 static gboolean
@@ -257,17 +262,22 @@ static void
 transaction_complete (Transaction *tr,
                       gint         saved_errno)
 {
-    GTask *task;
-    guint32 sequence_id;
+    GTask     *task;
+    GPtrArray *links;
+    guint32    sequence_id;
 
     task = g_steal_pointer (&tr->completion_task);
+    links = g_steal_pointer (&tr->links);
     sequence_id = tr->sequence_id;
 
     g_hash_table_remove (tr->manager->priv->transactions,
                          GUINT_TO_POINTER (tr->sequence_id));
 
     if (!saved_errno) {
-        g_task_return_boolean (task, TRUE);
+        if (links)
+            g_task_return_pointer (task, g_steal_pointer (&links), (GDestroyNotify) g_ptr_array_unref);
+        else
+            g_task_return_boolean (task, TRUE);
     } else {
         g_task_return_new_error (task,
                                  G_IO_ERROR,
@@ -277,6 +287,8 @@ transaction_complete (Transaction *tr,
                                  g_strerror (saved_errno));
     }
 
+    if (links)
+        g_ptr_array_unref (links);
     g_object_unref (task);
 }
 
@@ -284,8 +296,12 @@ static void
 transaction_free (Transaction *tr)
 {
     g_assert (tr->completion_task == NULL);
-    g_source_destroy (tr->timeout_source);
-    g_source_unref (tr->timeout_source);
+    if (tr->timeout_source) {
+        g_source_destroy (tr->timeout_source);
+        g_source_unref (tr->timeout_source);
+    }
+    if (tr->links)
+        g_ptr_array_unref (tr->links);
     g_slice_free (Transaction, tr);
 }
 
@@ -379,15 +395,169 @@ netlink_message_del_link (guint ifindex)
 
 /*****************************************************************************/
 
+/*
+ * Netlink message parsing functions
+ */
+
+typedef struct {
+    guint  ifindex;
+    gchar *ifname;
+    guint  link_ifindex; /* 0 if none */
+    guint  mux_id;       /* QMI_DEVICE_MUX_ID_UNBOUND if not a rmnet link */
+} LinkInfo;
+
+static void
+link_info_free (LinkInfo *info)
+{
+    g_free (info->ifname);
+    g_slice_free (LinkInfo, info);
+}
+
+static void
+parse_link_info_data (const struct rtattr *data,
+                      LinkInfo            *info)
+{
+    const struct rtattr *attr;
+    guint                len;
+
+    len = RTA_PAYLOAD (data);
+    for (attr = RTA_DATA (data); RTA_OK (attr, len); attr = RTA_NEXT (attr, len)) {
+        if (attr->rta_type == IFLA_RMNET_MUX_ID && RTA_PAYLOAD (attr) >= sizeof (guint16)) {
+            guint16 mux_id;
+
+            memcpy (&mux_id, RTA_DATA (attr), sizeof (mux_id));
+            info->mux_id = mux_id;
+        }
+    }
+}
+
+static void
+parse_link_info (const struct rtattr *linkinfo,
+                 LinkInfo            *info)
+{
+    const struct rtattr *attr;
+    const struct rtattr *data = NULL;
+    gboolean             is_rmnet = FALSE;
+    guint                len;
+
+    len = RTA_PAYLOAD (linkinfo);
+    for (attr = RTA_DATA (linkinfo); RTA_OK (attr, len); attr = RTA_NEXT (attr, len)) {
+        if (attr->rta_type == IFLA_INFO_KIND)
+            is_rmnet = (RTA_PAYLOAD (attr) >= strlen (RMNET_DATA_TYPE) &&
+                        strncmp (RTA_DATA (attr), RMNET_DATA_TYPE, RTA_PAYLOAD (attr)) == 0);
+        else if (attr->rta_type == IFLA_INFO_DATA)
+            data = attr;
+    }
+
+    if (is_rmnet && data)
+        parse_link_info_data (data, info);
+}
+
+/* Parses a RTM_NEWLINK message */
+static LinkInfo *
+netlink_message_parse_link (const struct nlmsghdr *hdr)
+{
+    const struct ifinfomsg *ifi;
+    const struct rtattr    *attr;
+    LinkInfo               *info;
+    guint                   len;
+
+    if (hdr->nlmsg_len < NLMSG_LENGTH (sizeof (struct ifinfomsg)))
+        return NULL;
+
+    ifi = NLMSG_DATA (hdr);
+    info = g_slice_new0 (LinkInfo);
+    info->ifindex = ifi->ifi_index;
+    info->mux_id = QMI_DEVICE_MUX_ID_UNBOUND;
+
+    len = IFLA_PAYLOAD (hdr);
+    for (attr = IFLA_RTA (ifi); RTA_OK (attr, len); attr = RTA_NEXT (attr, len)) {
+        switch (attr->rta_type) {
+        case IFLA_IFNAME:
+            g_free (info->ifname);
+            info->ifname = g_strndup (RTA_DATA (attr), RTA_PAYLOAD (attr));
+            break;
+        case IFLA_LINK:
+            if (RTA_PAYLOAD (attr) >= sizeof (guint32)) {
+                guint32 link_ifindex;
+
+                memcpy (&link_ifindex, RTA_DATA (attr), sizeof (link_ifindex));
+                info->link_ifindex = link_ifindex;
+            }
+            break;
+        case IFLA_LINKINFO:
+            parse_link_info (attr, info);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (!info->ifname) {
+        link_info_free (info);
+        return NULL;
+    }
+    return info;
+}
+
+/*****************************************************************************/
+
+static void
+process_netlink_message (QmiNetPortManagerRmnet *self,
+                         const struct nlmsghdr  *hdr)
+{
+    Transaction *tr;
+
+    tr = g_hash_table_lookup (self->priv->transactions,
+                              GUINT_TO_POINTER (hdr->nlmsg_seq));
+    if (!tr)
+        return;
+
+    switch (hdr->nlmsg_type) {
+    case NLMSG_ERROR: {
+        const struct nlmsgerr *err;
+
+        if (hdr->nlmsg_len < NLMSG_LENGTH (sizeof (struct nlmsgerr))) {
+            transaction_complete (tr, EBADMSG);
+            break;
+        }
+
+        /* Either an ACK (error 0) or a negative errno */
+        err = NLMSG_DATA (hdr);
+        transaction_complete (tr, -err->error);
+        break;
+    }
+    case NLMSG_DONE: {
+        gint error = 0;
+
+        /* The end of a dump may carry an error as well */
+        if (hdr->nlmsg_len >= NLMSG_LENGTH (sizeof (gint)))
+            memcpy (&error, NLMSG_DATA (hdr), sizeof (error));
+        transaction_complete (tr, -error);
+        break;
+    }
+    case RTM_NEWLINK:
+        if (tr->links && (hdr->nlmsg_flags & NLM_F_MULTI)) {
+            LinkInfo *info;
+
+            info = netlink_message_parse_link (hdr);
+            if (info)
+                g_ptr_array_add (tr->links, info);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 static gboolean
 netlink_message_cb (GSocket                *socket,
                     GIOCondition            condition,
                     QmiNetPortManagerRmnet *self)
 {
     GError          *error = NULL;
-    gchar            buf[512];
-    int              bytes_received;
-    unsigned int     buffer_len;
+    gssize           bytes_received;
+    guint            buffer_len;
     struct nlmsghdr *hdr;
 
     if (condition & G_IO_HUP || condition & G_IO_ERR) {
@@ -395,71 +565,230 @@ netlink_message_cb (GSocket                *socket,
         return G_SOURCE_REMOVE;
     }
 
-    bytes_received = g_socket_receive (socket, buf, sizeof (buf), NULL, &error);
-
+    bytes_received = qmi_helpers_netlink_receive (g_socket_get_fd (socket), self->priv->buffer, &error);
     if (bytes_received < 0) {
-        g_warning ("[netlink] socket i/o failure: %s", error->message);
+        /* Messages may have been dropped (e.g. ENOBUFS), in which case the
+         * affected transactions will time out; keep on listening */
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            g_warning ("[netlink] socket i/o failure: %s", error->message);
         g_error_free (error);
-        return G_SOURCE_REMOVE;
+        return G_SOURCE_CONTINUE;
     }
 
-    buffer_len = (unsigned int ) bytes_received;
-    for (hdr = CAST_ALIGN (struct nlmsghdr, buf); NLMSG_OK (hdr, buffer_len);
-         NLMSG_NEXT (hdr, buffer_len)) {
-        Transaction     *tr;
-        struct nlmsgerr *err;
+    /* A single datagram may contain multiple messages, e.g. the ACKs of a
+     * batch of requests or several parts of a dump reply */
+    buffer_len = (guint) bytes_received;
+    for (hdr = CAST_ALIGN (struct nlmsghdr, self->priv->buffer->data); NLMSG_OK (hdr, buffer_len);
+         hdr = NLMSG_NEXT (hdr, buffer_len))
+        process_netlink_message (self, hdr);
+
+    return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+static GPtrArray *
+netlink_dump_links_finish (QmiNetPortManagerRmnet  *self,
+                           GAsyncResult            *res,
+                           GError                 **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+/* Lists all network interfaces, with a single RTM_GETLINK dump request.
+ * The reply is received in multiple parts, and the operation finishes
+ * once NLMSG_DONE is received. */
+static void
+netlink_dump_links (QmiNetPortManagerRmnet *self,
+                    guint                   timeout,
+                    GCancellable           *cancellable,
+                    GAsyncReadyCallback     callback,
+                    gpointer                user_data)
+{
+    NetlinkMessage *msg;
+    Transaction    *tr;
+    GTask          *task;
+    GError         *error = NULL;
+    gssize          bytes_sent;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    msg = netlink_message_new (RTM_GETLINK, NLM_F_DUMP);
+
+    /* The task ownership is transferred to the transaction. */
+    tr = transaction_new (self, msg, timeout, task);
+    tr->links = g_ptr_array_new_with_free_func ((GDestroyNotify) link_info_free);
+
+    bytes_sent = g_socket_send (self->priv->socket,
+                                (const gchar *) msg->data,
+                                msg->len,
+                                cancellable,
+                                &error);
+    netlink_message_free (msg);
+
+    if (bytes_sent < 0)
+        transaction_complete_with_error (tr, error);
+
+    g_object_unref (task);
+}
+
+/*****************************************************************************/
 
-        if (hdr->nlmsg_type != NLMSG_ERROR)
+/* Looks for n_mux_ids free mux ids in the base interface, starting at
+ * initial_value, given the list of existing links. A mux id is free if there
+ * is no rmnet link using it on the base interface, and if there is no
+ * interface using the name associated to it. */
+static gboolean
+get_free_mux_ids (GPtrArray    *links,
+                  guint         base_if_index,
+                  const gchar  *ifname_prefix,
+                  guint         initial_value,
+                  guint         n_mux_ids,
+                  GArray       *out_mux_ids,
+                  GError      **error)
+{
+    g_autoptr(GHashTable) ifnames = NULL;
+    gboolean              used[QMI_DEVICE_MUX_ID_MAX + 1] = { FALSE };
+    guint                 i;
+
+    ifnames = g_hash_table_new (g_str_hash, g_str_equal);
+    for (i = 0; i < links->len; i++) {
+        LinkInfo *info;
+
+        info = g_ptr_array_index (links, i);
+        g_hash_table_add (ifnames, info->ifname);
+        if (info->link_ifindex == base_if_index && info->mux_id <= QMI_DEVICE_MUX_ID_MAX)
+            used[info->mux_id] = TRUE;
+    }
+
+    for (i = MAX (initial_value, QMI_DEVICE_MUX_ID_MIN); i <= QMI_DEVICE_MUX_ID_MAX && out_mux_ids->len < n_mux_ids; i++) {
+        g_autofree gchar *ifname = NULL;
+
+        if (used[i])
             continue;
 
-        tr = g_hash_table_lookup (self->priv->transactions,
-                                  GUINT_TO_POINTER (hdr->nlmsg_seq));
-        if (!tr)
+        ifname = mux_id_to_ifname (ifname_prefix, i);
+        if (g_hash_table_contains (ifnames, ifname))
             continue;
 
-        err = NLMSG_DATA (buf);
-        transaction_complete (tr, err->error);
+        g_array_append_val (out_mux_ids, i);
     }
-    return G_SOURCE_CONTINUE;
+
+    if (out_mux_ids->len < n_mux_ids) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                     "Failed to find %u available mux IDs", n_mux_ids);
+        return FALSE;
+    }
+    return TRUE;
 }
 
 /*****************************************************************************/
 
-static guint
-get_first_free_mux_id (QmiNetPortManagerRmnet *self,
-                       const gchar            *ifname_prefix,
-                       guint                   initial_value)
+/* Convert flags from libqmi API to rmnet API */
+static void
+build_rmnet_flags (QmiDeviceAddLinkFlags  flags,
+                   guint                 *out_rmnet_flags,
+                   guint                 *out_rmnet_mask)
 {
-    guint i;
+    guint rmnet_flags;
+
+    rmnet_flags = RMNET_FLAGS_INGRESS_DEAGGREGATION;
+    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_INGRESS_MAP_CKSUMV4)
+        rmnet_flags |= RMNET_FLAGS_INGRESS_MAP_CKSUMV4;
+    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_EGRESS_MAP_CKSUMV4)
+        rmnet_flags |= RMNET_FLAGS_EGRESS_MAP_CKSUMV4;
+    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_INGRESS_MAP_CKSUMV5)
+        rmnet_flags |= RMNET_FLAGS_INGRESS_MAP_CKSUMV5;
+    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_EGRESS_MAP_CKSUMV5)
+        rmnet_flags |= RMNET_FLAGS_EGRESS_MAP_CKSUMV5;
+
+    *out_rmnet_flags = rmnet_flags;
+    *out_rmnet_mask = (RMNET_FLAGS_EGRESS_MAP_CKSUMV4  |
+                       RMNET_FLAGS_INGRESS_MAP_CKSUMV4 |
+                       RMNET_FLAGS_EGRESS_MAP_CKSUMV5  |
+                       RMNET_FLAGS_INGRESS_MAP_CKSUMV5 |
+                       RMNET_FLAGS_INGRESS_DEAGGREGATION);
+}
 
-    /* Note that this function does not actually need to use the
-     * QmiNetPortManagerRmnet at the moment. But it will if we ever do rewrite it
-     * to inspect mux IDs of existing rmnet interfaces, so we will pass it
-     * for now. */
+/*****************************************************************************/
+/* Link additions on the same base interface are run one at a time: the
+ * automatic mux id selection looks for the mux ids not used in a link dump,
+ * so it assumes no other link is being added in the meantime. */
 
-    for (i = initial_value; i <= QMI_DEVICE_MUX_ID_MAX; i++) {
-        gchar   *ifname;
-        gboolean mux_id_is_free;
+typedef void (* AddLinkRunFunc) (GTask *task);
 
-        ifname = mux_id_to_ifname (ifname_prefix, i);
-        mux_id_is_free = !if_nametoindex (ifname);
-        g_free (ifname);
-        if (mux_id_is_free)
-            return i;
+typedef struct {
+    GTask          *task;
+    AddLinkRunFunc  run;
+} AddLinkOperation;
+
+static void
+add_link_queue_push (QmiNetPortManagerRmnet *self,
+                     guint                   base_if_index,
+                     GTask                  *task,
+                     AddLinkRunFunc          run)
+{
+    GQueue           *queue;
+    AddLinkOperation *op;
+
+    queue = g_hash_table_lookup (self->priv->add_link_queues, GUINT_TO_POINTER (base_if_index));
+    if (!queue) {
+        queue = g_queue_new ();
+        g_hash_table_insert (self->priv->add_link_queues, GUINT_TO_POINTER (base_if_index), queue);
     }
 
-    return QMI_DEVICE_MUX_ID_UNBOUND;
+    op = g_slice_new (AddLinkOperation);
+    op->task = task;
+    op->run = run;
+    g_queue_push_tail (queue, op);
+
+    if (g_queue_get_length (queue) == 1)
+        run (task);
+    else
+        g_debug ("Add link operation on interface index %u queued", base_if_index);
+}
+
+/* Removes the running operation, which must be completed right after, and
+ * starts the next queued one */
+static void
+add_link_queue_pop (QmiNetPortManagerRmnet *self,
+                    guint                   base_if_index,
+                    GTask                  *task)
+{
+    GQueue           *queue;
+    AddLinkOperation *op;
+
+    queue = g_hash_table_lookup (self->priv->add_link_queues, GUINT_TO_POINTER (base_if_index));
+    g_assert (queue);
+    op = g_queue_pop_head (queue);
+    g_assert (op && op->task == task);
+    g_slice_free (AddLinkOperation, op);
+
+    /* Started before completing, so that a new operation requested from the
+     * completion callback is queued after the pending ones */
+    op = g_queue_peek_head (queue);
+    if (op)
+        op->run (op->task);
+    else
+        g_hash_table_remove (self->priv->add_link_queues, GUINT_TO_POINTER (base_if_index));
 }
 
 /*****************************************************************************/
+
 typedef struct {
-    guint  mux_id;
-    gchar *ifname;
+    guint                  mux_id;
+    gchar                 *ifname;
+    guint                  initial_mux_id;
+    gchar                 *ifname_prefix;
+    guint                  base_if_index;
+    QmiDeviceAddLinkFlags  flags;
+    guint                  timeout;
 } AddLinkContext;
 
 static void
 add_link_context_free (AddLinkContext *ctx)
 {
+    g_free (ctx->ifname_prefix);
     g_free (ctx->ifname);
     g_free (ctx);
 }
@@ -484,6 +813,125 @@ net_port_manager_add_link_finish (QmiNetPortManager  *self,
     return g_steal_pointer (&ctx->ifname);
 }
 
+static void
+add_link_complete (GTask  *task,
+                   GError *error)
+{
+    QmiNetPortManagerRmnet *self;
+    AddLinkContext         *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    add_link_queue_pop (self, ctx->base_if_index, task);
+
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+static void
+add_link_send_ready (QmiNetPortManagerRmnet *self,
+                     GAsyncResult           *res,
+                     GTask                  *task)
+{
+    GError *error = NULL;
+
+    g_task_propagate_boolean (G_TASK (res), &error);
+    add_link_complete (task, error);
+}
+
+static void
+add_link_send (GTask *task)
+{
+    QmiNetPortManagerRmnet *self;
+    AddLinkContext         *ctx;
+    NetlinkMessage         *msg;
+    Transaction            *tr;
+    GTask                  *link_task;
+    GError                 *error = NULL;
+    gssize                  bytes_sent;
+    guint                   rmnet_flags;
+    guint                   rmnet_mask;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    ctx->ifname = mux_id_to_ifname (ctx->ifname_prefix, ctx->mux_id);
+
+    build_rmnet_flags (ctx->flags, &rmnet_flags, &rmnet_mask);
+    msg = netlink_message_new_link (ctx->mux_id, ctx->ifname, ctx->base_if_index, rmnet_flags, rmnet_mask);
+
+    /* The link task is completed by the transaction, and completes the
+     * operation once the link is created */
+    link_task = g_task_new (self, NULL, (GAsyncReadyCallback) add_link_send_ready, task);
+    tr = transaction_new (self, msg, ctx->timeout, link_task);
+    g_object_unref (link_task);
+
+    bytes_sent = g_socket_send (self->priv->socket,
+                                (const gchar *) msg->data,
+                                msg->len,
+                                g_task_get_cancellable (task),
+                                &error);
+    netlink_message_free (msg);
+
+    if (bytes_sent < 0)
+        transaction_complete_with_error (tr, error);
+}
+
+static void
+add_link_dump_links_ready (QmiNetPortManagerRmnet *self,
+                           GAsyncResult           *res,
+                           GTask                  *task)
+{
+    AddLinkContext       *ctx;
+    GError               *error = NULL;
+    g_autoptr(GPtrArray)  links = NULL;
+    g_autoptr(GArray)     mux_ids = NULL;
+
+    ctx = g_task_get_task_data (task);
+
+    links = netlink_dump_links_finish (self, res, &error);
+    if (!links) {
+        add_link_complete (task, error);
+        return;
+    }
+
+    mux_ids = g_array_sized_new (FALSE, FALSE, sizeof (guint), 1);
+    if (!get_free_mux_ids (links, ctx->base_if_index, ctx->ifname_prefix, ctx->initial_mux_id, 1, mux_ids, &error)) {
+        add_link_complete (task, error);
+        return;
+    }
+
+    ctx->mux_id = g_array_index (mux_ids, guint, 0);
+    g_debug ("Using dynamic mux ID %u", ctx->mux_id);
+    add_link_send (task);
+}
+
+static void
+add_link_run (GTask *task)
+{
+    QmiNetPortManagerRmnet *self;
+    AddLinkContext         *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    if (ctx->mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC) {
+        netlink_dump_links (self,
+                            ctx->timeout,
+                            g_task_get_cancellable (task),
+                            (GAsyncReadyCallback) add_link_dump_links_ready,
+                            task);
+        return;
+    }
+
+    g_debug ("Using static mux ID %u", ctx->mux_id);
+    add_link_send (task);
+}
+
 static void
 net_port_manager_add_link (QmiNetPortManager     *_self,
                            guint                  mux_id,
@@ -497,20 +945,17 @@ net_port_manager_add_link (QmiNetPortManager     *_self,
                            gpointer               user_data)
 {
     QmiNetPortManagerRmnet *self = QMI_NET_PORT_MANAGER_RMNET (_self);
-    NetlinkMessage         *msg;
-    Transaction            *tr;
     GTask                  *task;
-    GError                 *error = NULL;
-    gssize                  bytes_sent;
-    guint                   base_if_index;
     AddLinkContext         *ctx;
-    guint                   rmnet_flags;
-    guint                   rmnet_mask;
 
     task = g_task_new (self, cancellable, callback, user_data);
 
     ctx = g_new0 (AddLinkContext, 1);
     ctx->mux_id = mux_id;
+    ctx->initial_mux_id = initial_mux_id;
+    ctx->ifname_prefix = g_strdup (ifname_prefix);
+    ctx->flags = flags;
+    ctx->timeout = timeout;
     g_task_set_task_data (task, ctx, (GDestroyNotify) add_link_context_free);
 
     if (ctx->mux_id == QMI_DEVICE_MUX_ID_UNBOUND) {
@@ -522,23 +967,8 @@ net_port_manager_add_link (QmiNetPortManager     *_self,
         return;
     }
 
-    if (ctx->mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC) {
-        ctx->mux_id = get_first_free_mux_id (self, ifname_prefix, initial_mux_id);
-
-        g_debug ("Using dynamic mux ID %u", ctx->mux_id);
-        if (ctx->mux_id == QMI_DEVICE_MUX_ID_UNBOUND) {
-            g_task_return_new_error (task,
-                                     QMI_CORE_ERROR,
-                                     QMI_CORE_ERROR_FAILED,
-                                     "Failed to find an available mux ID");
-            g_object_unref (task);
-            return;
-        }
-    } else
-        g_debug ("Using static mux ID %u", ctx->mux_id);
-
-    base_if_index = if_nametoindex (base_ifname);
-    if (!base_if_index) {
+    ctx->base_if_index = if_nametoindex (base_ifname);
+    if (!ctx->base_if_index) {
         g_task_return_new_error (task,
                                  QMI_CORE_ERROR,
                                  QMI_CORE_ERROR_FAILED,
@@ -548,41 +978,281 @@ net_port_manager_add_link (QmiNetPortManager     *_self,
         return;
     }
 
-    ctx->ifname = mux_id_to_ifname (ifname_prefix, ctx->mux_id);
+    add_link_queue_push (self, ctx->base_if_index, task, add_link_run);
+}
 
-    /* Convert flags from libqmi API to rmnet API */
-    rmnet_flags = RMNET_FLAGS_INGRESS_DEAGGREGATION;
-    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_INGRESS_MAP_CKSUMV4)
-        rmnet_flags |= RMNET_FLAGS_INGRESS_MAP_CKSUMV4;
-    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_EGRESS_MAP_CKSUMV4)
-        rmnet_flags |= RMNET_FLAGS_EGRESS_MAP_CKSUMV4;
-    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_INGRESS_MAP_CKSUMV5)
-        rmnet_flags |= RMNET_FLAGS_INGRESS_MAP_CKSUMV5;
-    if (flags & QMI_DEVICE_ADD_LINK_FLAGS_EGRESS_MAP_CKSUMV5)
-        rmnet_flags |= RMNET_FLAGS_EGRESS_MAP_CKSUMV5;
+/*****************************************************************************/
 
-    rmnet_mask = (RMNET_FLAGS_EGRESS_MAP_CKSUMV4  |
-                  RMNET_FLAGS_INGRESS_MAP_CKSUMV4 |
-                  RMNET_FLAGS_EGRESS_MAP_CKSUMV5  |
-                  RMNET_FLAGS_INGRESS_MAP_CKSUMV5 |
-                  RMNET_FLAGS_INGRESS_DEAGGREGATION);
+typedef struct {
+    guint                  n_links;
+    guint                  initial_mux_id;
+    gchar                 *ifname_prefix;
+    guint                  base_if_index;
+    QmiDeviceAddLinkFlags  flags;
+    guint                  timeout;
+    guint                  n_pending;
+    GPtrArray             *ifnames;
+    GArray                *mux_ids;
+    GArray                *created;
+    GError                *error;
+} AddLinksContext;
+
+static void
+add_links_context_free (AddLinksContext *ctx)
+{
+    g_assert (ctx->n_pending == 0);
+    g_clear_error (&ctx->error);
+    g_clear_pointer (&ctx->created, g_array_unref);
+    g_clear_pointer (&ctx->mux_ids, g_array_unref);
+    g_clear_pointer (&ctx->ifnames, g_ptr_array_unref);
+    g_free (ctx->ifname_prefix);
+    g_slice_free (AddLinksContext, ctx);
+}
 
-    msg = netlink_message_new_link (ctx->mux_id, ctx->ifname, base_if_index, rmnet_flags, rmnet_mask);
+static GPtrArray *
+net_port_manager_add_links_finish (QmiNetPortManager  *self,
+                                   GArray            **mux_ids,
+                                   GAsyncResult       *res,
+                                   GError            **error)
+{
+    AddLinksContext *ctx;
 
-    /* The task ownership is transferred to the transaction. */
-    tr = transaction_new (self, msg, timeout, task);
+    if (!g_task_propagate_boolean (G_TASK (res), error))
+        return NULL;
+
+    ctx = g_task_get_task_data (G_TASK (res));
+    if (mux_ids)
+        *mux_ids = g_steal_pointer (&ctx->mux_ids);
+    return g_steal_pointer (&ctx->ifnames);
+}
+
+static void
+add_links_return (GTask  *task,
+                  GError *error)
+{
+    QmiNetPortManagerRmnet *self;
+    AddLinksContext        *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    add_link_queue_pop (self, ctx->base_if_index, task);
+
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+static void
+add_links_rollback_ready (QmiNetPortManager *self,
+                          GAsyncResult      *res,
+                          GTask             *task)
+{
+    AddLinksContext *ctx;
+
+    ctx = g_task_get_task_data (task);
+    add_links_return (task, qmi_net_port_manager_del_links_rollback_finish (self, res, g_steal_pointer (&ctx->error)));
+}
+
+static void
+add_links_complete (GTask *task)
+{
+    QmiNetPortManagerRmnet *self;
+    AddLinksContext        *ctx;
+    g_autoptr(GPtrArray)    created_ifnames = NULL;
+    g_autoptr(GArray)       created_mux_ids = NULL;
+    guint                   i;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    if (!ctx->error) {
+        add_links_return (task, NULL);
+        return;
+    }
+
+    /* Remove the links already created, so that the operation either fully
+     * succeeds or leaves no links behind */
+    created_ifnames = g_ptr_array_new ();
+    created_mux_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+    for (i = 0; i < ctx->ifnames->len; i++) {
+        if (g_array_index (ctx->created, gboolean, i)) {
+            g_ptr_array_add (created_ifnames, g_ptr_array_index (ctx->ifnames, i));
+            g_array_append_val (created_mux_ids, g_array_index (ctx->mux_ids, guint, i));
+        }
+    }
+
+    qmi_net_port_manager_del_links (QMI_NET_PORT_MANAGER (self),
+                                    created_ifnames,
+                                    created_mux_ids,
+                                    ctx->timeout,
+                                    NULL,
+                                    (GAsyncReadyCallback) add_links_rollback_ready,
+                                    task);
+}
+
+static void
+add_links_link_ready (QmiNetPortManagerRmnet *self,
+                      GAsyncResult           *res,
+                      GTask                  *task)
+{
+    AddLinksContext *ctx;
+    GError          *error = NULL;
+    guint            i;
+
+    ctx = g_task_get_task_data (task);
+    i = GPOINTER_TO_UINT (g_task_get_task_data (G_TASK (res)));
+
+    if (g_task_propagate_boolean (G_TASK (res), &error))
+        g_array_index (ctx->created, gboolean, i) = TRUE;
+    else if (!ctx->error) {
+        g_prefix_error (&error, "Failed to add link with mux id %u: ",
+                        g_array_index (ctx->mux_ids, guint, i));
+        ctx->error = error;
+    } else
+        g_error_free (error);
+
+    g_assert (ctx->n_pending > 0);
+    if (--ctx->n_pending == 0)
+        add_links_complete (task);
+}
+
+static void
+add_links_dump_links_ready (QmiNetPortManagerRmnet *self,
+                            GAsyncResult           *res,
+                            GTask                  *task)
+{
+    AddLinksContext       *ctx;
+    GError                *error = NULL;
+    g_autoptr(GPtrArray)   links = NULL;
+    g_autoptr(GByteArray)  batch = NULL;
+    g_autoptr(GPtrArray)   transactions = NULL;
+    guint                  rmnet_flags;
+    guint                  rmnet_mask;
+    gssize                 bytes_sent;
+    guint                  i;
+
+    ctx = g_task_get_task_data (task);
+
+    links = netlink_dump_links_finish (self, res, &error);
+    if (!links) {
+        add_links_return (task, error);
+        return;
+    }
+
+    /* All mux ids are selected from the same link dump */
+    if (!get_free_mux_ids (links, ctx->base_if_index, ctx->ifname_prefix, ctx->initial_mux_id, ctx->n_links, ctx->mux_ids, &error)) {
+        add_links_return (task, error);
+        return;
+    }
+
+    build_rmnet_flags (ctx->flags, &rmnet_flags, &rmnet_mask);
+
+    /* All link creation requests are sent in a single batch, each one with its
+     * own transaction so that the ACKs are matched by sequence id */
+    batch = g_byte_array_new ();
+    transactions = g_ptr_array_sized_new (ctx->n_links);
+    for (i = 0; i < ctx->n_links; i++) {
+        NetlinkMessage *msg;
+        GTask          *link_task;
+        guint           mux_id;
+        gchar          *ifname;
+
+        mux_id = g_array_index (ctx->mux_ids, guint, i);
+        ifname = mux_id_to_ifname (ctx->ifname_prefix, mux_id);
+        g_ptr_array_add (ctx->ifnames, ifname);
+        g_debug ("Using dynamic mux ID %u for link %s", mux_id, ifname);
+
+        link_task = g_task_new (self, NULL, (GAsyncReadyCallback) add_links_link_ready, task);
+        g_task_set_task_data (link_task, GUINT_TO_POINTER (i), NULL);
+
+        msg = netlink_message_new_link (mux_id, ifname, ctx->base_if_index, rmnet_flags, rmnet_mask);
+        g_ptr_array_add (transactions, transaction_new (self, msg, ctx->timeout, link_task));
+        g_byte_array_append (batch, msg->data, msg->len);
+        netlink_message_free (msg);
+
+        g_object_unref (link_task);
+        ctx->n_pending++;
+    }
 
     bytes_sent = g_socket_send (self->priv->socket,
-                                (const gchar *) msg->data,
-                                msg->len,
-                                cancellable,
+                                (const gchar *) batch->data,
+                                batch->len,
+                                g_task_get_cancellable (task),
                                 &error);
-    netlink_message_free (msg);
+    if (bytes_sent < 0) {
+        for (i = 0; i < transactions->len; i++)
+            transaction_complete_with_error (g_ptr_array_index (transactions, i), g_error_copy (error));
+        g_error_free (error);
+    }
+}
 
-    if (bytes_sent < 0)
-        transaction_complete_with_error (tr, error);
+static void
+add_links_run (GTask *task)
+{
+    QmiNetPortManagerRmnet *self;
+    AddLinksContext        *ctx;
 
-    g_object_unref (task);
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    netlink_dump_links (self,
+                        ctx->timeout,
+                        g_task_get_cancellable (task),
+                        (GAsyncReadyCallback) add_links_dump_links_ready,
+                        task);
+}
+
+static void
+net_port_manager_add_links (QmiNetPortManager     *_self,
+                            guint                  n_links,
+                            guint                  initial_mux_id,
+                            const gchar           *base_ifname,
+                            const gchar           *ifname_prefix,
+                            QmiDeviceAddLinkFlags  flags,
+                            guint                  timeout,
+                            GCancellable          *cancellable,
+                            GAsyncReadyCallback    callback,
+                            gpointer               user_data)
+{
+    QmiNetPortManagerRmnet *self = QMI_NET_PORT_MANAGER_RMNET (_self);
+    GTask                  *task;
+    AddLinksContext        *ctx;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    ctx = g_slice_new0 (AddLinksContext);
+    ctx->n_links = n_links;
+    ctx->initial_mux_id = initial_mux_id;
+    ctx->ifname_prefix = g_strdup (ifname_prefix);
+    ctx->flags = flags;
+    ctx->timeout = timeout;
+    ctx->ifnames = g_ptr_array_new_with_free_func (g_free);
+    ctx->mux_ids = g_array_sized_new (FALSE, FALSE, sizeof (guint), n_links);
+    ctx->created = g_array_sized_new (FALSE, TRUE, sizeof (gboolean), n_links);
+    g_array_set_size (ctx->created, n_links);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) add_links_context_free);
+
+    if (n_links == 0) {
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return;
+    }
+
+    ctx->base_if_index = if_nametoindex (base_ifname);
+    if (!ctx->base_if_index) {
+        g_task_return_new_error (task,
+                                 QMI_CORE_ERROR,
+                                 QMI_CORE_ERROR_FAILED,
+                                 "%s interface is not available",
+                                 base_ifname);
+        g_object_unref (task);
+        return;
+    }
+
+    add_link_queue_push (self, ctx->base_if_index, task, add_links_run);
 }
 
 static gboolean
@@ -642,6 +1312,152 @@ net_port_manager_del_link (QmiNetPortManager   *_self,
 
 /*****************************************************************************/
 
+typedef struct {
+    GPtrArray *links;
+    guint      n_pending;
+    GPtrArray *errors;
+} DelAllLinksContext;
+
+static void
+del_all_links_context_free (DelAllLinksContext *ctx)
+{
+    g_assert (ctx->n_pending == 0);
+    g_ptr_array_unref (ctx->errors);
+    g_clear_pointer (&ctx->links, g_ptr_array_unref);
+    g_slice_free (DelAllLinksContext, ctx);
+}
+
+static gboolean
+net_port_manager_del_all_links_finish (QmiNetPortManager  *self,
+                                       GAsyncResult       *res,
+                                       GError            **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+del_all_links_complete (GTask *task)
+{
+    DelAllLinksContext *ctx;
+    GError             *error;
+
+    ctx = g_task_get_task_data (task);
+
+    error = qmi_net_port_manager_build_del_links_error (ctx->errors, ctx->links->len);
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+static void
+del_all_links_link_ready (QmiNetPortManagerRmnet *self,
+                          GAsyncResult           *res,
+                          GTask                  *task)
+{
+    DelAllLinksContext *ctx;
+    GError             *error = NULL;
+    guint               i;
+
+    ctx = g_task_get_task_data (task);
+    i = GPOINTER_TO_UINT (g_task_get_task_data (G_TASK (res)));
+
+    if (!g_task_propagate_boolean (G_TASK (res), &error)) {
+        g_prefix_error (&error, "%s: ", (const gchar *) g_ptr_array_index (ctx->links, i));
+        g_ptr_array_add (ctx->errors, error);
+    }
+
+    g_assert (ctx->n_pending > 0);
+    if (--ctx->n_pending == 0)
+        del_all_links_complete (task);
+}
+
+static void
+net_port_manager_del_all_links (QmiNetPortManager    *_self,
+                                const gchar          *base_ifname,
+                                GCancellable         *cancellable,
+                                GAsyncReadyCallback   callback,
+                                gpointer              user_data)
+{
+    QmiNetPortManagerRmnet *self = QMI_NET_PORT_MANAGER_RMNET (_self);
+    GTask                  *task;
+    DelAllLinksContext     *ctx;
+    GError                 *error = NULL;
+    g_autoptr(GByteArray)   batch = NULL;
+    g_autoptr(GPtrArray)    transactions = NULL;
+    gssize                  bytes_sent;
+    guint                   i;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    ctx = g_slice_new0 (DelAllLinksContext);
+    ctx->errors = g_ptr_array_new_with_free_func ((GDestroyNotify) g_error_free);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) del_all_links_context_free);
+
+    if (!qmi_net_port_manager_list_links (_self, base_ifname, &ctx->links, &error)) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    if (!ctx->links) {
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return;
+    }
+
+    /* All link deletion requests are sent in a single batch, each one with its
+     * own transaction so that the ACKs are matched by sequence id */
+    batch = g_byte_array_new ();
+    transactions = g_ptr_array_sized_new (ctx->links->len);
+    for (i = 0; i < ctx->links->len; i++) {
+        const gchar    *ifname;
+        NetlinkMessage *msg;
+        GTask          *link_task;
+        guint           ifindex;
+
+        ifname = g_ptr_array_index (ctx->links, i);
+        ifindex = if_nametoindex (ifname);
+        if (ifindex == 0) {
+            g_ptr_array_add (ctx->errors,
+                             g_error_new (QMI_CORE_ERROR,
+                                          QMI_CORE_ERROR_FAILED,
+                                          "%s: Failed to retrieve interface index",
+                                          ifname));
+            continue;
+        }
+
+        link_task = g_task_new (self, cancellable, (GAsyncReadyCallback) del_all_links_link_ready, task);
+        g_task_set_task_data (link_task, GUINT_TO_POINTER (i), NULL);
+
+        msg = netlink_message_del_link (ifindex);
+        g_ptr_array_add (transactions, transaction_new (self, msg, 5, link_task));
+        g_byte_array_append (batch, msg->data, msg->len);
+        netlink_message_free (msg);
+
+        g_object_unref (link_task);
+        ctx->n_pending++;
+    }
+
+    if (!ctx->n_pending) {
+        del_all_links_complete (task);
+        return;
+    }
+
+    bytes_sent = g_socket_send (self->priv->socket,
+                                (const gchar *) batch->data,
+                                batch->len,
+                                cancellable,
+                                &error);
+    if (bytes_sent < 0) {
+        for (i = 0; i < transactions->len; i++)
+            transaction_complete_with_error (g_ptr_array_index (transactions, i), g_error_copy (error));
+        g_error_free (error);
+    }
+}
+
+/*****************************************************************************/
+
 QmiNetPortManagerRmnet *
 qmi_net_port_manager_rmnet_new (GError **error)
 {
@@ -669,6 +1485,8 @@ qmi_net_port_manager_rmnet_new (GError **error)
 
     self = g_object_new (QMI_TYPE_NET_PORT_MANAGER_RMNET, NULL);
     self->priv->socket = gsocket;
+    self->priv->buffer = g_byte_array_sized_new (NETLINK_BUFFER_SIZE);
+    g_byte_array_set_size (self->priv->buffer, NETLINK_BUFFER_SIZE);
     self->priv->source = g_socket_create_source (self->priv->socket,
                                                  G_IO_IN | G_IO_ERR | G_IO_HUP,
                                                  NULL);
@@ -684,6 +1502,11 @@ qmi_net_port_manager_rmnet_new (GError **error)
                                g_direct_equal,
                                NULL,
                                (GDestroyNotify) transaction_free);
+    self->priv->add_link_queues =
+        g_hash_table_new_full (g_direct_hash,
+                               g_direct_equal,
+                               NULL,
+                               (GDestroyNotify) g_queue_free);
     return self;
 }
 
@@ -703,12 +1526,15 @@ dispose (GObject *object)
     QmiNetPortManagerRmnet *self = QMI_NET_PORT_MANAGER_RMNET (object);
 
     g_assert (g_hash_table_size (self->priv->transactions) == 0);
+    g_assert (g_hash_table_size (self->priv->add_link_queues) == 0);
 
     g_clear_pointer (&self->priv->transactions, g_hash_table_unref);
+    g_clear_pointer (&self->priv->add_link_queues, g_hash_table_unref);
     if (self->priv->source)
         g_source_destroy (self->priv->source);
     g_clear_pointer (&self->priv->source, g_source_unref);
     g_clear_object (&self->priv->socket);
+    g_clear_pointer (&self->priv->buffer, g_byte_array_unref);
 
     G_OBJECT_CLASS (qmi_net_port_manager_rmnet_parent_class)->dispose (object);
 }
@@ -725,6 +1551,10 @@ qmi_net_port_manager_rmnet_class_init (QmiNetPortManagerRmnetClass *klass)
 
     net_port_manager_class->add_link = net_port_manager_add_link;
     net_port_manager_class->add_link_finish = net_port_manager_add_link_finish;
+    net_port_manager_class->add_links = net_port_manager_add_links;
+    net_port_manager_class->add_links_finish = net_port_manager_add_links_finish;
     net_port_manager_class->del_link = net_port_manager_del_link;
     net_port_manager_class->del_link_finish = net_port_manager_del_link_finish;
+    net_port_manager_class->del_all_links = net_port_manager_del_all_links;
+    net_port_manager_class->del_all_links_finish = net_port_manager_del_all_links_finish;
 }
@@ -23,6 +23,8 @@
 #include "qmi-net-port-manager.h"
 #include "qmi-device.h"
 #include "qmi-helpers.h"
+#include "qmi-errors.h"
+#include "qmi-error-types.h"
 
 G_DEFINE_ABSTRACT_TYPE (QmiNetPortManager, qmi_net_port_manager, G_TYPE_OBJECT)
 
@@ -61,6 +63,39 @@ qmi_net_port_manager_add_link_finish (QmiNetPortManager  *self,
     return QMI_NET_PORT_MANAGER_GET_CLASS (self)->add_link_finish (self, mux_id, res, error);
 }
 
+void
+qmi_net_port_manager_add_links (QmiNetPortManager     *self,
+                                guint                  n_links,
+                                guint                  initial_mux_id,
+                                const gchar           *base_ifname,
+                                const gchar           *ifname_prefix,
+                                QmiDeviceAddLinkFlags  flags,
+                                guint                  timeout,
+                                GCancellable          *cancellable,
+                                GAsyncReadyCallback    callback,
+                                gpointer               user_data)
+{
+    QMI_NET_PORT_MANAGER_GET_CLASS (self)->add_links (self,
+                                                      n_links,
+                                                      initial_mux_id,
+                                                      base_ifname,
+                                                      ifname_prefix,
+                                                      flags,
+                                                      timeout,
+                                                      cancellable,
+                                                      callback,
+                                                      user_data);
+}
+
+GPtrArray *
+qmi_net_port_manager_add_links_finish (QmiNetPortManager  *self,
+                                       GArray            **mux_ids,
+                                       GAsyncResult       *res,
+                                       GError            **error)
+{
+    return QMI_NET_PORT_MANAGER_GET_CLASS (self)->add_links_finish (self, mux_ids, res, error);
+}
+
 void
 qmi_net_port_manager_del_link (QmiNetPortManager    *self,
                                const gchar          *ifname,
@@ -118,6 +153,53 @@ qmi_net_port_manager_list_links (QmiNetPortManager  *self,
     return QMI_NET_PORT_MANAGER_GET_CLASS (self)->list_links (self, base_ifname, out_links, error);
 }
 
+GError *
+qmi_net_port_manager_build_del_links_error (GPtrArray *errors,
+                                            guint      n_links)
+{
+    g_autoptr(GString)  message = NULL;
+    const GError       *first;
+    GQuark              domain;
+    gint                code;
+    gboolean            unsupported = FALSE;
+    guint               i;
+
+    if (!errors->len)
+        return NULL;
+
+    /* Keep the error domain and code if all failures agree, so that callers
+     * can still match them */
+    first = g_ptr_array_index (errors, 0);
+    domain = first->domain;
+    code = first->code;
+
+    message = g_string_new (NULL);
+    g_string_append_printf (message, "Couldn't delete %u of %u links: ", errors->len, n_links);
+    for (i = 0; i < errors->len; i++) {
+        const GError *error;
+
+        error = g_ptr_array_index (errors, i);
+        if (error->domain != domain || error->code != code) {
+            domain = QMI_CORE_ERROR;
+            code = QMI_CORE_ERROR_FAILED;
+        }
+        if (g_error_matches (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED))
+            unsupported = TRUE;
+        if (i > 0)
+            g_string_append (message, "; ");
+        g_string_append (message, error->message);
+    }
+
+    /* A single unsupported deletion is enough for callers to fall back to a
+     * different method, which will also retry the other failed links */
+    if (unsupported) {
+        domain = QMI_CORE_ERROR;
+        code = QMI_CORE_ERROR_UNSUPPORTED;
+    }
+
+    return g_error_new_literal (domain, code, message->str);
+}
+
 /*****************************************************************************/
 /* Default implementations */
 
@@ -137,71 +219,314 @@ net_port_manager_list_links (QmiNetPortManager  *self,
 }
 
 typedef struct {
-    GPtrArray *links;
-    guint      link_i;
-} DelAllLinksContext;
+    guint                  n_links;
+    gchar                 *base_ifname;
+    gchar                 *ifname_prefix;
+    QmiDeviceAddLinkFlags  flags;
+    guint                  timeout;
+    GPtrArray             *ifnames;
+    GArray                *mux_ids;
+    GError                *error;
+} AddLinksContext;
 
 static void
-del_all_links_context_free (DelAllLinksContext *ctx)
+add_links_context_free (AddLinksContext *ctx)
 {
-    g_clear_pointer (&ctx->links, g_ptr_array_unref);
-    g_slice_free (DelAllLinksContext, ctx);
+    g_clear_error (&ctx->error);
+    g_clear_pointer (&ctx->mux_ids, g_array_unref);
+    g_clear_pointer (&ctx->ifnames, g_ptr_array_unref);
+    g_free (ctx->ifname_prefix);
+    g_free (ctx->base_ifname);
+    g_slice_free (AddLinksContext, ctx);
 }
 
-static gboolean
-net_port_manager_del_all_links_finish (QmiNetPortManager  *self,
-                                       GAsyncResult       *res,
-                                       GError            **error)
+static GPtrArray *
+net_port_manager_add_links_finish (QmiNetPortManager  *self,
+                                   GArray            **mux_ids,
+                                   GAsyncResult       *res,
+                                   GError            **error)
 {
-    return g_task_propagate_boolean (G_TASK (res), error);
+    AddLinksContext *ctx;
+
+    if (!g_task_propagate_boolean (G_TASK (res), error))
+        return NULL;
+
+    ctx = g_task_get_task_data (G_TASK (res));
+    if (mux_ids)
+        *mux_ids = g_steal_pointer (&ctx->mux_ids);
+    return g_steal_pointer (&ctx->ifnames);
 }
 
-static void delete_next_link (GTask *task);
+static void add_next_link (GTask *task);
 
 static void
-port_manager_del_link_ready (QmiNetPortManager *self,
+port_manager_rollback_ready (QmiNetPortManager *self,
                              GAsyncResult      *res,
                              GTask             *task)
 {
-    DelAllLinksContext *ctx;
-    GError             *error = NULL;
+    AddLinksContext *ctx;
 
     ctx = g_task_get_task_data (task);
+    g_task_return_error (task, qmi_net_port_manager_del_links_rollback_finish (self, res, g_steal_pointer (&ctx->error)));
+    g_object_unref (task);
+}
 
-    if (!qmi_net_port_manager_del_link_finish (self, res, &error)) {
+static void
+port_manager_add_link_ready (QmiNetPortManager *self,
+                             GAsyncResult      *res,
+                             GTask             *task)
+{
+    AddLinksContext *ctx;
+    GError          *error = NULL;
+    gchar           *ifname;
+    guint            mux_id;
+
+    ctx = g_task_get_task_data (task);
+
+    ifname = qmi_net_port_manager_add_link_finish (self, &mux_id, res, &error);
+    if (ifname) {
+        g_ptr_array_add (ctx->ifnames, ifname);
+        g_array_append_val (ctx->mux_ids, mux_id);
+        add_next_link (task);
+        return;
+    }
+
+    /* Remove the links already created, so that the operation either fully
+     * succeeds or leaves no links behind */
+    if (!ctx->ifnames->len) {
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
-    g_ptr_array_remove_index_fast (ctx->links, 0);
-    delete_next_link (task);
+    ctx->error = error;
+    qmi_net_port_manager_del_links (self,
+                                    ctx->ifnames,
+                                    ctx->mux_ids,
+                                    ctx->timeout,
+                                    NULL,
+                                    (GAsyncReadyCallback)port_manager_rollback_ready,
+                                    task);
 }
 
 static void
-delete_next_link (GTask *task)
+add_next_link (GTask *task)
 {
-    QmiNetPortManager  *self;
-    DelAllLinksContext *ctx;
+    QmiNetPortManager *self;
+    AddLinksContext   *ctx;
+    guint              initial_mux_id;
 
     self = g_task_get_source_object (task);
     ctx = g_task_get_task_data (task);
 
-    if (!ctx->links || ctx->links->len == 0) {
+    if (ctx->ifnames->len == ctx->n_links) {
         g_task_return_boolean (task, TRUE);
         g_object_unref (task);
         return;
     }
 
-    qmi_net_port_manager_del_link (self,
-                                   g_ptr_array_index (ctx->links, 0),
-                                   QMI_DEVICE_MUX_ID_UNBOUND,
-                                   5,
+    /* No need to look for free mux ids below the last one allocated */
+    initial_mux_id = g_array_index (ctx->mux_ids, guint, ctx->mux_ids->len - 1) + 1;
+    qmi_net_port_manager_add_link (self,
+                                   QMI_DEVICE_MUX_ID_AUTOMATIC,
+                                   initial_mux_id,
+                                   ctx->base_ifname,
+                                   ctx->ifname_prefix,
+                                   ctx->flags,
+                                   ctx->timeout,
                                    g_task_get_cancellable (task),
-                                   (GAsyncReadyCallback)port_manager_del_link_ready,
+                                   (GAsyncReadyCallback)port_manager_add_link_ready,
+                                   task);
+}
+
+static void
+net_port_manager_add_links (QmiNetPortManager     *self,
+                            guint                  n_links,
+                            guint                  initial_mux_id,
+                            const gchar           *base_ifname,
+                            const gchar           *ifname_prefix,
+                            QmiDeviceAddLinkFlags  flags,
+                            guint                  timeout,
+                            GCancellable          *cancellable,
+                            GAsyncReadyCallback    callback,
+                            gpointer               user_data)
+{
+    GTask           *task;
+    AddLinksContext *ctx;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    ctx = g_slice_new0 (AddLinksContext);
+    ctx->n_links = n_links;
+    ctx->base_ifname = g_strdup (base_ifname);
+    ctx->ifname_prefix = g_strdup (ifname_prefix);
+    ctx->flags = flags;
+    ctx->timeout = timeout;
+    ctx->ifnames = g_ptr_array_new_with_free_func (g_free);
+    ctx->mux_ids = g_array_sized_new (FALSE, FALSE, sizeof (guint), n_links);
+    g_task_set_task_data (task, ctx, (GDestroyNotify)add_links_context_free);
+
+    if (n_links == 0) {
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return;
+    }
+
+    /* The default implementation just creates the links one by one */
+    qmi_net_port_manager_add_link (self,
+                                   QMI_DEVICE_MUX_ID_AUTOMATIC,
+                                   initial_mux_id,
+                                   base_ifname,
+                                   ifname_prefix,
+                                   flags,
+                                   timeout,
+                                   cancellable,
+                                   (GAsyncReadyCallback)port_manager_add_link_ready,
                                    task);
 }
 
+typedef struct {
+    guint      n_links;
+    guint      n_pending;
+    GPtrArray *errors;
+} DelLinksContext;
+
+static void
+del_links_context_free (DelLinksContext *ctx)
+{
+    g_assert (ctx->n_pending == 0);
+    g_ptr_array_unref (ctx->errors);
+    g_slice_free (DelLinksContext, ctx);
+}
+
+gboolean
+qmi_net_port_manager_del_links_finish (QmiNetPortManager  *self,
+                                       GAsyncResult       *res,
+                                       GError            **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+GError *
+qmi_net_port_manager_del_links_rollback_finish (QmiNetPortManager *self,
+                                                GAsyncResult      *res,
+                                                GError            *error)
+{
+    g_autoptr(GError) rollback_error = NULL;
+    GError           *new_error;
+
+    if (qmi_net_port_manager_del_links_finish (self, res, &rollback_error))
+        return error;
+
+    new_error = g_error_new (error->domain, error->code,
+                             "%s (rollback failed: %s)",
+                             error->message, rollback_error->message);
+    g_error_free (error);
+    return new_error;
+}
+
+typedef struct {
+    GTask *task;
+    gchar *ifname;
+} DelLinksItem;
+
+static void
+port_manager_del_link_ready (QmiNetPortManager *self,
+                             GAsyncResult      *res,
+                             DelLinksItem      *item)
+{
+    GTask           *task;
+    DelLinksContext *ctx;
+    GError          *error = NULL;
+
+    task = item->task;
+    ctx = g_task_get_task_data (task);
+
+    if (!qmi_net_port_manager_del_link_finish (self, res, &error)) {
+        g_prefix_error (&error, "%s: ", item->ifname);
+        g_ptr_array_add (ctx->errors, error);
+    }
+
+    g_free (item->ifname);
+    g_slice_free (DelLinksItem, item);
+
+    g_assert (ctx->n_pending > 0);
+    if (--ctx->n_pending > 0)
+        return;
+
+    error = qmi_net_port_manager_build_del_links_error (ctx->errors, ctx->n_links);
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+void
+qmi_net_port_manager_del_links (QmiNetPortManager   *self,
+                                GPtrArray           *ifnames,
+                                GArray              *mux_ids,
+                                guint                timeout,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+    GTask           *task;
+    DelLinksContext *ctx;
+    guint            i;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    ctx = g_slice_new0 (DelLinksContext);
+    ctx->errors = g_ptr_array_new_with_free_func ((GDestroyNotify) g_error_free);
+    g_task_set_task_data (task, ctx, (GDestroyNotify)del_links_context_free);
+
+    if (!ifnames || !ifnames->len) {
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+        return;
+    }
+
+    /* All links are deleted at the same time, instead of waiting for each
+     * deletion to finish before starting the next one */
+    ctx->n_links = ifnames->len;
+    ctx->n_pending = ifnames->len;
+    for (i = 0; i < ifnames->len; i++) {
+        DelLinksItem *item;
+
+        item = g_slice_new0 (DelLinksItem);
+        item->task = task;
+        item->ifname = g_strdup (g_ptr_array_index (ifnames, i));
+        qmi_net_port_manager_del_link (self,
+                                       item->ifname,
+                                       mux_ids ? g_array_index (mux_ids, guint, i) : QMI_DEVICE_MUX_ID_UNBOUND,
+                                       timeout,
+                                       cancellable,
+                                       (GAsyncReadyCallback) port_manager_del_link_ready,
+                                       item);
+    }
+}
+
+static gboolean
+net_port_manager_del_all_links_finish (QmiNetPortManager  *self,
+                                       GAsyncResult       *res,
+                                       GError            **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+port_manager_del_links_ready (QmiNetPortManager *self,
+                              GAsyncResult      *res,
+                              GTask             *task)
+{
+    GError *error = NULL;
+
+    if (!qmi_net_port_manager_del_links_finish (self, res, &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
 static void
 net_port_manager_del_all_links (QmiNetPortManager    *self,
                                 const gchar          *base_ifname,
@@ -209,21 +534,25 @@ net_port_manager_del_all_links (QmiNetPortManager    *self,
                                 GAsyncReadyCallback   callback,
                                 gpointer              user_data)
 {
-    GTask              *task;
-    DelAllLinksContext *ctx;
-    GError             *error = NULL;
+    GTask                *task;
+    GError               *error = NULL;
+    g_autoptr(GPtrArray)  links = NULL;
 
     task = g_task_new (self, cancellable, callback, user_data);
-    ctx = g_slice_new0 (DelAllLinksContext);
-    g_task_set_task_data (task, ctx, (GDestroyNotify)del_all_links_context_free);
 
-    if (!qmi_net_port_manager_list_links (self, base_ifname, &ctx->links, &error)) {
+    if (!qmi_net_port_manager_list_links (self, base_ifname, &links, &error)) {
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
-    delete_next_link (task);
+    qmi_net_port_manager_del_links (self,
+                                    links,
+                                    NULL,
+                                    5,
+                                    cancellable,
+                                    (GAsyncReadyCallback)port_manager_del_links_ready,
+                                    task);
 }
 
 /*****************************************************************************/
@@ -237,6 +566,8 @@ static void
 qmi_net_port_manager_class_init (QmiNetPortManagerClass *klass)
 {
     klass->list_links = net_port_manager_list_links;
+    klass->add_links = net_port_manager_add_links;
+    klass->add_links_finish = net_port_manager_add_links_finish;
     klass->del_all_links = net_port_manager_del_all_links;
     klass->del_all_links_finish = net_port_manager_del_all_links_finish;
 }
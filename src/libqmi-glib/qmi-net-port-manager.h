@@ -67,6 +67,21 @@ struct _QmiNetPortManagerClass {
                                   GAsyncResult           *res,
                                   GError                **error);
 
+    void        (* add_links)        (QmiNetPortManager      *self,
+                                      guint                   n_links,
+                                      guint                   initial_mux_id,
+                                      const gchar            *base_ifname,
+                                      const gchar            *ifname_prefix,
+                                      QmiDeviceAddLinkFlags   flags,
+                                      guint                   timeout,
+                                      GCancellable           *cancellable,
+                                      GAsyncReadyCallback     callback,
+                                      gpointer                user_data);
+    GPtrArray * (* add_links_finish) (QmiNetPortManager      *self,
+                                      GArray                **mux_ids,
+                                      GAsyncResult           *res,
+                                      GError                **error);
+
     void     (* del_link)        (QmiNetPortManager    *self,
                                   const gchar          *ifname,
                                   guint                 mux_id,
@@ -111,6 +126,21 @@ gchar    *qmi_net_port_manager_add_link_finish (QmiNetPortManager      *self,
                                                 GAsyncResult           *res,
                                                 GError                **error);
 
+void       qmi_net_port_manager_add_links        (QmiNetPortManager      *self,
+                                                 guint                   n_links,
+                                                 guint                   initial_mux_id,
+                                                 const gchar            *base_ifname,
+                                                 const gchar            *ifname_prefix,
+                                                 QmiDeviceAddLinkFlags   flags,
+                                                 guint                   timeout,
+                                                 GCancellable           *cancellable,
+                                                 GAsyncReadyCallback     callback,
+                                                 gpointer                user_data);
+GPtrArray *qmi_net_port_manager_add_links_finish (QmiNetPortManager      *self,
+                                                 GArray                **mux_ids,
+                                                 GAsyncResult           *res,
+                                                 GError                **error);
+
 void      qmi_net_port_manager_del_link        (QmiNetPortManager    *self,
                                                 const gchar          *ifname,
                                                 guint                 mux_id,
@@ -131,4 +161,31 @@ gboolean qmi_net_port_manager_del_all_links_finish (QmiNetPortManager    *self,
                                                     GAsyncResult         *res,
                                                     GError              **error);
 
+/* Deletes all the given links at once; @mux_ids may be NULL if unknown */
+void     qmi_net_port_manager_del_links        (QmiNetPortManager    *self,
+                                                GPtrArray            *ifnames,
+                                                GArray               *mux_ids,
+                                                guint                 timeout,
+                                                GCancellable         *cancellable,
+                                                GAsyncReadyCallback   callback,
+                                                gpointer              user_data);
+gboolean qmi_net_port_manager_del_links_finish (QmiNetPortManager    *self,
+                                                GAsyncResult         *res,
+                                                GError              **error);
+
+/* Finishes a qmi_net_port_manager_del_links() operation run to roll back
+ * another operation that failed with @error, and returns @error including
+ * the rollback failures, if any */
+GError *qmi_net_port_manager_del_links_rollback_finish (QmiNetPortManager *self,
+                                                        GAsyncResult      *res,
+                                                        GError            *error);
+
+/* Builds the error of an operation deleting @n_links links at once from the
+ * errors of each of the failed link deletions, or NULL if none failed. The
+ * error keeps the domain and code of the failures if all agree, and is
+ * QMI_CORE_ERROR_UNSUPPORTED if any of them is, QMI_CORE_ERROR_FAILED
+ * otherwise. */
+GError *qmi_net_port_manager_build_del_links_error (GPtrArray *errors,
+                                                    guint      n_links);
+
 #endif /* _LIBQMI_GLIB_QMI_NET_PORT_MANAGER_H_ */
@@ -0,0 +1,333 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "qmi-sysfs-attribute.h"
+
+struct _QmiSysfsAttribute {
+    volatile gint  ref_count;
+    gchar         *path;
+    /* Both fds are opened on demand, -1 if not open */
+    GMutex         mutex;
+    gint           read_fd;
+    gint           write_fd;
+};
+
+/*****************************************************************************/
+
+/* Must be called with the mutex held */
+static gint
+sysfs_attribute_get_fd (QmiSysfsAttribute  *self,
+                        gboolean            write,
+                        GError            **error)
+{
+    gint *fd;
+
+    fd = write ? &self->write_fd : &self->read_fd;
+    if (*fd >= 0)
+        return *fd;
+
+    do {
+        *fd = open (self->path, (write ? O_WRONLY : O_RDONLY) | O_CLOEXEC);
+    } while (*fd < 0 && errno == EINTR);
+
+    if (*fd < 0) {
+        gint saved_errno = errno;
+
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                     "Failed to open sysfs file '%s'%s: %s",
+                     self->path, write ? " for writing" : "", g_strerror (saved_errno));
+    }
+    return *fd;
+}
+
+/* Reads or writes at offset 0, as attributes are generated again when read
+ * from the beginning, and always written in a single operation. Once the
+ * attribute is removed, the open file keeps failing with ENODEV even if the
+ * attribute is created back, so in that case it is opened again and the
+ * operation retried once. Returns -1 with @error set if the file couldn't be
+ * opened, or -1 with @out_errno set if the operation failed. */
+static gssize
+sysfs_attribute_access (QmiSysfsAttribute  *self,
+                        gboolean            write,
+                        gpointer            buffer,
+                        gsize               size,
+                        gint               *out_errno,
+                        GError            **error)
+{
+    gssize n = -1;
+    guint  attempt;
+
+    g_mutex_lock (&self->mutex);
+    for (attempt = 0; attempt < 2; attempt++) {
+        gint *fd;
+
+        fd = write ? &self->write_fd : &self->read_fd;
+        if (sysfs_attribute_get_fd (self, write, error) < 0)
+            break;
+
+        do {
+            n = write ? pwrite (*fd, buffer, size, 0) : pread (*fd, buffer, size, 0);
+        } while (n < 0 && errno == EINTR);
+        if (n >= 0)
+            break;
+
+        *out_errno = errno;
+        if (*out_errno != ENODEV)
+            break;
+        close (*fd);
+        *fd = -1;
+    }
+    g_mutex_unlock (&self->mutex);
+
+    return n;
+}
+
+gboolean
+qmi_sysfs_attribute_read (QmiSysfsAttribute  *self,
+                          gchar              *out_value,
+                          guint               max_read_size,
+                          GError            **error)
+{
+    GError *inner_error = NULL;
+    gssize  n_read;
+    gint    saved_errno = 0;
+
+    n_read = sysfs_attribute_access (self, FALSE, out_value, max_read_size, &saved_errno, &inner_error);
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+
+    if (n_read < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                     "Failed to read from sysfs file '%s': %s",
+                     self->path, g_strerror (saved_errno));
+        return FALSE;
+    }
+
+    if (n_read == 0) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                     "Failed to read from sysfs file '%s': unexpected EOF",
+                     self->path);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+gboolean
+qmi_sysfs_attribute_write (QmiSysfsAttribute  *self,
+                           const gchar        *value,
+                           GError            **error)
+{
+    GError *inner_error = NULL;
+    gsize   value_len;
+    gssize  n_written;
+    gint    saved_errno = 0;
+
+    value_len = strlen (value);
+
+    n_written = sysfs_attribute_access (self, TRUE, (gpointer) value, value_len, &saved_errno, &inner_error);
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+
+    if (n_written < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                     "Failed to write to sysfs file '%s': %s",
+                     self->path, g_strerror (saved_errno));
+        return FALSE;
+    }
+
+    if ((gsize) n_written != value_len) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                     "Failed to write to sysfs file '%s': short write (%" G_GSSIZE_FORMAT " of %" G_GSIZE_FORMAT " bytes)",
+                     self->path, n_written, value_len);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+gchar *
+qmi_sysfs_attribute_read_finish (QmiSysfsAttribute  *self,
+                                 GAsyncResult       *res,
+                                 GError            **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+typedef struct {
+    QmiSysfsAttribute *self;
+    guint              max_read_size;
+} ReadContext;
+
+static void
+read_context_free (ReadContext *ctx)
+{
+    qmi_sysfs_attribute_unref (ctx->self);
+    g_slice_free (ReadContext, ctx);
+}
+
+static void
+read_thread (GTask        *task,
+             gpointer      source_object,
+             ReadContext  *ctx,
+             GCancellable *cancellable)
+{
+    g_autofree gchar *value = NULL;
+    GError           *error = NULL;
+
+    value = g_malloc0 (ctx->max_read_size + 1);
+    if (!qmi_sysfs_attribute_read (ctx->self, value, ctx->max_read_size, &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_pointer (task, g_steal_pointer (&value), g_free);
+}
+
+void
+qmi_sysfs_attribute_read_async (QmiSysfsAttribute   *self,
+                                guint                max_read_size,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+    GTask       *task;
+    ReadContext *ctx;
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    ctx = g_slice_new0 (ReadContext);
+    ctx->self = qmi_sysfs_attribute_ref (self);
+    ctx->max_read_size = max_read_size;
+    g_task_set_task_data (task, ctx, (GDestroyNotify) read_context_free);
+    g_task_run_in_thread (task, (GTaskThreadFunc) read_thread);
+    g_object_unref (task);
+}
+
+typedef struct {
+    QmiSysfsAttribute *self;
+    gchar             *value;
+} WriteContext;
+
+static void
+write_context_free (WriteContext *ctx)
+{
+    qmi_sysfs_attribute_unref (ctx->self);
+    g_free (ctx->value);
+    g_slice_free (WriteContext, ctx);
+}
+
+gboolean
+qmi_sysfs_attribute_write_finish (QmiSysfsAttribute  *self,
+                                  GAsyncResult       *res,
+                                  GError            **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static void
+write_thread (GTask        *task,
+              gpointer      source_object,
+              WriteContext *ctx,
+              GCancellable *cancellable)
+{
+    GError *error = NULL;
+
+    if (!qmi_sysfs_attribute_write (ctx->self, ctx->value, &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+}
+
+void
+qmi_sysfs_attribute_write_async (QmiSysfsAttribute   *self,
+                                 const gchar         *value,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+    GTask        *task;
+    WriteContext *ctx;
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    ctx = g_slice_new0 (WriteContext);
+    ctx->self = qmi_sysfs_attribute_ref (self);
+    ctx->value = g_strdup (value);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) write_context_free);
+    g_task_run_in_thread (task, (GTaskThreadFunc) write_thread);
+    g_object_unref (task);
+}
+
+/*****************************************************************************/
+
+const gchar *
+qmi_sysfs_attribute_get_path (QmiSysfsAttribute *self)
+{
+    return self->path;
+}
+
+QmiSysfsAttribute *
+qmi_sysfs_attribute_ref (QmiSysfsAttribute *self)
+{
+    g_atomic_int_inc (&self->ref_count);
+    return self;
+}
+
+void
+qmi_sysfs_attribute_unref (QmiSysfsAttribute *self)
+{
+    if (!g_atomic_int_dec_and_test (&self->ref_count))
+        return;
+
+    if (self->read_fd >= 0)
+        close (self->read_fd);
+    if (self->write_fd >= 0)
+        close (self->write_fd);
+    g_mutex_clear (&self->mutex);
+    g_free (self->path);
+    g_slice_free (QmiSysfsAttribute, self);
+}
+
+QmiSysfsAttribute *
+qmi_sysfs_attribute_new (const gchar *path)
+{
+    QmiSysfsAttribute *self;
+
+    g_return_val_if_fail (path != NULL, NULL);
+
+    self = g_slice_new0 (QmiSysfsAttribute);
+    self->ref_count = 1;
+    self->path = g_strdup (path);
+    g_mutex_init (&self->mutex);
+    self->read_fd = -1;
+    self->write_fd = -1;
+    return self;
+}
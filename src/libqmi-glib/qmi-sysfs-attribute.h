@@ -0,0 +1,88 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+
+#ifndef _LIBQMI_GLIB_QMI_SYSFS_ATTRIBUTE_H_
+#define _LIBQMI_GLIB_QMI_SYSFS_ATTRIBUTE_H_
+
+#include <glib.h>
+#include <gio/gio.h>
+
+/*
+ * A sysfs attribute file kept open across reads and writes, so that only the
+ * first operation needs to resolve the path. The file is opened again if the
+ * attribute is removed and created back, e.g. when the network interface it
+ * belongs to is re-created.
+ *
+ * Handles are reference counted and may be used from any thread. The async
+ * operations run in a worker thread, so that a slow sysfs never blocks the
+ * main context.
+ */
+
+typedef struct _QmiSysfsAttribute QmiSysfsAttribute;
+
+G_GNUC_INTERNAL
+QmiSysfsAttribute *qmi_sysfs_attribute_new      (const gchar       *path);
+G_GNUC_INTERNAL
+QmiSysfsAttribute *qmi_sysfs_attribute_ref      (QmiSysfsAttribute *self);
+G_GNUC_INTERNAL
+void               qmi_sysfs_attribute_unref    (QmiSysfsAttribute *self);
+G_GNUC_INTERNAL
+const gchar       *qmi_sysfs_attribute_get_path (QmiSysfsAttribute *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (QmiSysfsAttribute, qmi_sysfs_attribute_unref)
+
+/* Same semantics as qmi_helpers_read_sysfs_file() */
+G_GNUC_INTERNAL
+gboolean qmi_sysfs_attribute_read  (QmiSysfsAttribute  *self,
+                                    gchar              *out_value, /* caller allocates */
+                                    guint               max_read_size,
+                                    GError            **error);
+G_GNUC_INTERNAL
+gboolean qmi_sysfs_attribute_write (QmiSysfsAttribute  *self,
+                                    const gchar        *value,
+                                    GError            **error);
+
+G_GNUC_INTERNAL
+void   qmi_sysfs_attribute_read_async  (QmiSysfsAttribute    *self,
+                                        guint                 max_read_size,
+                                        GCancellable         *cancellable,
+                                        GAsyncReadyCallback   callback,
+                                        gpointer              user_data);
+/* Returns the NUL-terminated value read */
+G_GNUC_INTERNAL
+gchar *qmi_sysfs_attribute_read_finish (QmiSysfsAttribute  *self,
+                                        GAsyncResult       *res,
+                                        GError            **error);
+
+G_GNUC_INTERNAL
+void     qmi_sysfs_attribute_write_async  (QmiSysfsAttribute    *self,
+                                           const gchar          *value,
+                                           GCancellable         *cancellable,
+                                           GAsyncReadyCallback   callback,
+                                           gpointer              user_data);
+G_GNUC_INTERNAL
+gboolean qmi_sysfs_attribute_write_finish (QmiSysfsAttribute  *self,
+                                           GAsyncResult       *res,
+                                           GError            **error);
+
+#endif /* _LIBQMI_GLIB_QMI_SYSFS_ATTRIBUTE_H_ */
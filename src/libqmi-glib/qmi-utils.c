@@ -30,6 +30,7 @@
 
 static volatile gint __traces_enabled = FALSE;
 static volatile gint __hide_personal_info = FALSE;
+static volatile gint __shared_io_source_enabled = FALSE;
 
 gboolean
 qmi_utils_get_traces_enabled (void)
@@ -53,4 +54,16 @@ gboolean
 qmi_utils_get_show_personal_info (void)
 {
     return (gboolean) g_atomic_int_get (&__hide_personal_info);
-}
\ No newline at end of file
+}
+
+gboolean
+qmi_utils_get_shared_io_source_enabled (void)
+{
+    return (gboolean) g_atomic_int_get (&__shared_io_source_enabled);
+}
+
+void
+qmi_utils_set_shared_io_source_enabled (gboolean enabled)
+{
+    g_atomic_int_set (&__shared_io_source_enabled, enabled);
+}
@@ -90,6 +90,38 @@ void qmi_utils_set_show_personal_info (gboolean show_personal_info);
  */
 gboolean qmi_utils_get_show_personal_info (void);
 
+/* Enabling/Disabling the shared I/O source */
+
+/**
+ * qmi_utils_get_shared_io_source_enabled:
+ *
+ * Checks whether the input of QMUX endpoints is monitored through a single
+ * source shared by all of them.
+ *
+ * Returns: %TRUE if the shared I/O source is enabled, %FALSE otherwise.
+ *
+ * Since: 1.40
+ */
+gboolean qmi_utils_get_shared_io_source_enabled (void);
+
+/**
+ * qmi_utils_set_shared_io_source_enabled:
+ * @enabled: %TRUE to enable the shared I/O source, %FALSE to disable it.
+ *
+ * Sets whether QMUX endpoints should monitor their input through a single
+ * epoll-backed source shared by all the endpoints running in the same
+ * #GMainContext, instead of attaching one pollable source per endpoint.
+ *
+ * Processes managing a large number of devices may enable this so that
+ * the cost of every main context iteration no longer grows with the number
+ * of open devices.
+ *
+ * The setting only applies to devices opened after it has been changed.
+ *
+ * Since: 1.40
+ */
+void qmi_utils_set_shared_io_source_enabled (gboolean enabled);
+
 G_END_DECLS
 
 #endif /* _LIBQMI_GLIB_QMI_UTILS_H_ */
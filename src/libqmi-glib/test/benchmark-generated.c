@@ -0,0 +1,321 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libqmi-glib.h>
+
+/*****************************************************************************/
+/* Message samples, built from the message definitions */
+
+typedef QmiMessage *(* SampleBuildFunc) (void);
+typedef gpointer     (* SampleParseFunc) (QmiMessage  *message,
+                                          GError     **error);
+
+typedef struct {
+    const gchar     *name;
+    QmiService       service;
+    guint16          message_id;
+    guint16          vendor_id;
+    gboolean         indication;
+    /* NULL for indications and for requests without a request creator */
+    SampleBuildFunc  build;
+    /* Raw TLVs of the response or indication */
+    const guint8    *response;
+    gsize            response_length;
+    /* NULL if the message has no public parser */
+    SampleParseFunc  parse;
+    GDestroyNotify   output_unref;
+} SampleInfo;
+
+#include "qmi-codegen-samples.h"
+
+/*****************************************************************************/
+/* Allocation counting, overriding the allocator entry points used by GLib.
+ *
+ * g_mem_set_vtable() is a no-op since GLib 2.46, so the libc entry points
+ * are the only place to hook. Sanitizers replace those same entry points
+ * with their own, so the counting is disabled when building with them. */
+
+#if defined (__SANITIZE_ADDRESS__) && !defined (BENCHMARK_NO_ALLOCATION_COUNTING)
+# define BENCHMARK_NO_ALLOCATION_COUNTING
+#endif
+
+#if defined (__GLIBC__) && !defined (BENCHMARK_NO_ALLOCATION_COUNTING)
+
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void  __libc_free    (void *ptr);
+
+static guint64 n_allocations;
+
+void *
+malloc (size_t size)
+{
+    n_allocations++;
+    return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb,
+        size_t size)
+{
+    n_allocations++;
+    return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void   *ptr,
+         size_t  size)
+{
+    n_allocations++;
+    return __libc_realloc (ptr, size);
+}
+
+void
+free (void *ptr)
+{
+    __libc_free (ptr);
+}
+
+#define ALLOCATIONS_SUPPORTED TRUE
+
+#else
+
+static guint64 n_allocations;
+
+#define ALLOCATIONS_SUPPORTED FALSE
+
+#endif
+
+/*****************************************************************************/
+
+typedef enum {
+    PHASE_BUILD,
+    PHASE_PARSE,
+    PHASE_PRINTABLE,
+    PHASE_FREE,
+    PHASE_LAST
+} Phase;
+
+static const gchar *phase_names[PHASE_LAST] = {
+    [PHASE_BUILD]     = "build",
+    [PHASE_PARSE]     = "parse",
+    [PHASE_PRINTABLE] = "printable",
+    [PHASE_FREE]      = "free",
+};
+
+typedef struct {
+    gint64  time;
+    guint64 allocations;
+    guint   n_operations;
+} PhaseResult;
+
+static void
+phase_start (PhaseResult *result)
+{
+    result->time -= g_get_monotonic_time ();
+    result->allocations -= n_allocations;
+}
+
+static void
+phase_stop (PhaseResult *result,
+            guint        n_operations)
+{
+    result->allocations += n_allocations;
+    result->time += g_get_monotonic_time ();
+    result->n_operations += n_operations;
+}
+
+static void
+phase_print (const gchar       *name,
+             const PhaseResult *results)
+{
+    guint i;
+
+    g_print ("%-60s", name);
+    for (i = 0; i < PHASE_LAST; i++) {
+        if (!results[i].n_operations) {
+            g_print (" %9s %-9s %9s", "-", phase_names[i], "");
+            continue;
+        }
+        g_print (" %9.0f %-9s", ((gdouble) results[i].time * 1000.0) / results[i].n_operations, phase_names[i]);
+        if (ALLOCATIONS_SUPPORTED)
+            g_print (" %6.1f al.", (gdouble) results[i].allocations / results[i].n_operations);
+        else
+            g_print (" %9s", "");
+    }
+    g_print ("\n");
+}
+
+/*****************************************************************************/
+
+static QmiMessage *
+build_response (const SampleInfo *sample)
+{
+    g_autoptr(GByteArray) qmi_data = NULL;
+    g_autoptr(GError)     error = NULL;
+    QmiMessage           *message;
+    guint8                header[7];
+
+    /* Service header: flags, transaction, message id and TLVs length */
+    header[0] = (sample->indication ? QMI_SERVICE_FLAG_INDICATION : QMI_SERVICE_FLAG_RESPONSE);
+    header[1] = 1;
+    header[2] = 0;
+    header[3] = sample->message_id & 0xFF;
+    header[4] = sample->message_id >> 8;
+    header[5] = sample->response_length & 0xFF;
+    header[6] = sample->response_length >> 8;
+
+    qmi_data = g_byte_array_sized_new (sizeof (header) + sample->response_length);
+    g_byte_array_append (qmi_data, header, sizeof (header));
+    if (sample->response_length)
+        g_byte_array_append (qmi_data, sample->response, sample->response_length);
+
+    message = qmi_message_new_from_data (sample->service, 1, qmi_data, &error);
+    if (!message)
+        g_error ("couldn't build %s sample: %s", sample->name, error->message);
+    return message;
+}
+
+static void
+benchmark_sample (const SampleInfo *sample,
+                  guint             n_iterations,
+                  PhaseResult      *results)
+{
+    g_autoptr(QmiMessageContext) context = NULL;
+    GError                      *error = NULL;
+    QmiMessage                  *response;
+    QmiMessage                 **requests;
+    gpointer                    *outputs;
+    gchar                      **printables;
+    guint                        i;
+
+    requests = g_new0 (QmiMessage *, n_iterations);
+    outputs = g_new0 (gpointer, n_iterations);
+    printables = g_new0 (gchar *, n_iterations);
+
+    if (sample->vendor_id) {
+        context = qmi_message_context_new ();
+        qmi_message_context_set_vendor_id (context, sample->vendor_id);
+    }
+
+    response = build_response (sample);
+
+    if (sample->build) {
+        phase_start (&results[PHASE_BUILD]);
+        for (i = 0; i < n_iterations; i++)
+            requests[i] = sample->build ();
+        phase_stop (&results[PHASE_BUILD], n_iterations);
+    }
+
+    if (sample->parse) {
+        phase_start (&results[PHASE_PARSE]);
+        for (i = 0; i < n_iterations; i++) {
+            outputs[i] = sample->parse (response, &error);
+            if (!outputs[i])
+                g_error ("couldn't parse %s sample: %s", sample->name, error->message);
+        }
+        phase_stop (&results[PHASE_PARSE], n_iterations);
+    }
+
+    phase_start (&results[PHASE_PRINTABLE]);
+    for (i = 0; i < n_iterations; i++)
+        printables[i] = qmi_message_get_printable_full (response, context, "");
+    phase_stop (&results[PHASE_PRINTABLE], n_iterations);
+
+    phase_start (&results[PHASE_FREE]);
+    for (i = 0; i < n_iterations; i++) {
+        if (requests[i])
+            qmi_message_unref (requests[i]);
+        if (outputs[i])
+            sample->output_unref (outputs[i]);
+        g_free (printables[i]);
+    }
+    phase_stop (&results[PHASE_FREE], n_iterations);
+
+    qmi_message_unref (response);
+    g_free (printables);
+    g_free (outputs);
+    g_free (requests);
+}
+
+/*****************************************************************************/
+
+static gint      iterations = 100;
+static gchar    *filter;
+
+static GOptionEntry entries[] = {
+    { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations,
+      "Number of operations run per message and phase (default: 100)",
+      "[N]"
+    },
+    { "filter", 'f', 0, G_OPTION_ARG_STRING, &filter,
+      "Only run messages with names containing the given string",
+      "[NAME]"
+    },
+    { NULL, 0, 0, 0, NULL, NULL, NULL }
+};
+
+int main (int argc, char **argv)
+{
+    g_autoptr(GOptionContext) option_context = NULL;
+    g_autoptr(GError)         error = NULL;
+    PhaseResult               total[PHASE_LAST];
+    guint                     i;
+
+    option_context = g_option_context_new ("- Benchmark generated message support");
+    g_option_context_add_main_entries (option_context, entries, NULL);
+    if (!g_option_context_parse (option_context, &argc, &argv, &error)) {
+        g_printerr ("error: %s\n", error->message);
+        return EXIT_FAILURE;
+    }
+
+    if (iterations <= 0) {
+        g_printerr ("error: invalid number of iterations: %d\n", iterations);
+        return EXIT_FAILURE;
+    }
+
+    g_print ("Times in ns per operation%s, %d operations per message and phase\n",
+             ALLOCATIONS_SUPPORTED ? " along with allocations per operation" : "",
+             iterations);
+
+    memset (total, 0, sizeof (total));
+    for (i = 0; i < G_N_ELEMENTS (samples); i++) {
+        PhaseResult results[PHASE_LAST];
+        guint       j;
+
+        if (filter && !strstr (samples[i].name, filter))
+            continue;
+
+        memset (results, 0, sizeof (results));
+        benchmark_sample (&samples[i], (guint) iterations, results);
+        phase_print (samples[i].name, results);
+
+        for (j = 0; j < PHASE_LAST; j++) {
+            total[j].time += results[j].time;
+            total[j].allocations += results[j].allocations;
+            total[j].n_operations += results[j].n_operations;
+        }
+    }
+
+    phase_print ("Total", total);
+
+    g_free (filter);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <unistd.h>
+#include <glib.h>
+#include <glib-unix.h>
+
+#include "qmi-epoll-source.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    gint             fds[2];
+    QmiEpollWatch   *watch;
+    guint            n_calls;
+    GIOCondition     condition;
+    gboolean         remove;
+    /* watch to remove when called */
+    QmiEpollWatch  **remove_other;
+} Pipe;
+
+static void
+pipe_init (Pipe *p)
+{
+    GError   *error = NULL;
+    gboolean  ret;
+
+    ret = g_unix_open_pipe (p->fds, FD_CLOEXEC, &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+}
+
+static void
+pipe_clear (Pipe *p)
+{
+    if (p->watch)
+        qmi_epoll_watch_remove (p->watch);
+    if (p->fds[0] >= 0)
+        close (p->fds[0]);
+    if (p->fds[1] >= 0)
+        close (p->fds[1]);
+}
+
+static void
+pipe_write (Pipe *p)
+{
+    g_assert_cmpint (write (p->fds[1], "x", 1), ==, 1);
+}
+
+static gboolean
+pipe_ready (gint          fd,
+            GIOCondition  condition,
+            Pipe         *p)
+{
+    gchar c;
+
+    g_assert_cmpint (fd, ==, p->fds[0]);
+    p->n_calls++;
+    p->condition = condition;
+
+    if (condition & G_IO_IN)
+        g_assert_cmpint (read (fd, &c, 1), ==, 1);
+
+    if (p->remove_other) {
+        qmi_epoll_watch_remove (*p->remove_other);
+        *p->remove_other = NULL;
+    }
+
+    if (p->remove) {
+        p->watch = NULL;
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+pipe_watch (Pipe         *p,
+            GMainContext *context)
+{
+    GError *error = NULL;
+
+    p->watch = qmi_epoll_watch_add (context, p->fds[0], (QmiEpollWatchFunc) pipe_ready, p, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (p->watch);
+}
+
+/*****************************************************************************/
+
+static void
+test_dispatch (void)
+{
+    GMainContext *context;
+    Pipe          p = { { -1, -1 } };
+
+    context = g_main_context_new ();
+    pipe_init (&p);
+    pipe_watch (&p, context);
+
+    g_assert (!g_main_context_pending (context));
+    g_assert_cmpuint (p.n_calls, ==, 0);
+
+    pipe_write (&p);
+    while (p.n_calls == 0)
+        g_main_context_iteration (context, TRUE);
+    g_assert_cmpuint (p.n_calls, ==, 1);
+    g_assert_cmpuint (p.condition, ==, G_IO_IN);
+
+    pipe_write (&p);
+    while (p.n_calls == 1)
+        g_main_context_iteration (context, TRUE);
+    g_assert_cmpuint (p.n_calls, ==, 2);
+
+    pipe_clear (&p);
+    g_main_context_unref (context);
+}
+
+static void
+test_hangup (void)
+{
+    GMainContext *context;
+    Pipe          p = { { -1, -1 } };
+
+    context = g_main_context_new ();
+    pipe_init (&p);
+    pipe_watch (&p, context);
+
+    /* Returning G_SOURCE_REMOVE removes the watch */
+    p.remove = TRUE;
+    close (p.fds[1]);
+    p.fds[1] = -1;
+    while (p.n_calls == 0)
+        g_main_context_iteration (context, TRUE);
+    g_assert_cmpuint (p.n_calls, ==, 1);
+    g_assert (p.condition & G_IO_HUP);
+    g_assert_null (p.watch);
+
+    /* And the source with it, as it was the last one */
+    g_assert (!g_main_context_pending (context));
+
+    pipe_clear (&p);
+    g_main_context_unref (context);
+}
+
+static void
+test_remove_pending (void)
+{
+    GMainContext *context;
+    Pipe          a = { { -1, -1 } };
+    Pipe          b = { { -1, -1 } };
+
+    context = g_main_context_new ();
+    pipe_init (&a);
+    pipe_init (&b);
+    pipe_watch (&a, context);
+    pipe_watch (&b, context);
+
+    /* Both are readable in the same dispatch; whichever is called first
+     * removes the other one, which must then not be called */
+    a.remove_other = &b.watch;
+    b.remove_other = &a.watch;
+    pipe_write (&a);
+    pipe_write (&b);
+    while (a.n_calls + b.n_calls == 0)
+        g_main_context_iteration (context, TRUE);
+    while (g_main_context_pending (context))
+        g_main_context_iteration (context, FALSE);
+    g_assert_cmpuint (a.n_calls + b.n_calls, ==, 1);
+    g_assert ((a.watch == NULL) != (b.watch == NULL));
+
+    pipe_clear (&a);
+    pipe_clear (&b);
+    g_main_context_unref (context);
+}
+
+static void
+test_context_lifetime (void)
+{
+    GMainContext *context;
+    guint         i;
+
+    /* Contexts are usually allocated at the same address once the previous
+     * one is disposed; each of them must get its own source */
+    for (i = 0; i < 10; i++) {
+        Pipe p = { { -1, -1 } };
+
+        context = g_main_context_new ();
+        pipe_init (&p);
+        pipe_watch (&p, context);
+        pipe_write (&p);
+        while (p.n_calls == 0)
+            g_main_context_iteration (context, TRUE);
+        pipe_clear (&p);
+        g_main_context_unref (context);
+    }
+}
+
+/*****************************************************************************/
+
+#define N_THREADS    8
+#define N_ITERATIONS 1000
+
+static gpointer
+add_remove_thread (GMainContext *context)
+{
+    Pipe  p = { { -1, -1 } };
+    guint i;
+
+    pipe_init (&p);
+    for (i = 0; i < N_ITERATIONS; i++) {
+        pipe_watch (&p, context);
+        qmi_epoll_watch_remove (p.watch);
+        p.watch = NULL;
+    }
+    pipe_clear (&p);
+    return NULL;
+}
+
+static void
+test_threads (void)
+{
+    GMainContext *context;
+    GThread      *threads[N_THREADS];
+    Pipe          p = { { -1, -1 } };
+    guint         i;
+
+    /* Watches in the same context added and removed from several threads */
+    context = g_main_context_new ();
+    for (i = 0; i < N_THREADS; i++)
+        threads[i] = g_thread_new ("epoll-source", (GThreadFunc) add_remove_thread, context);
+    for (i = 0; i < N_THREADS; i++)
+        g_thread_join (threads[i]);
+
+    /* All gone, the context is usable as usual */
+    g_assert (!g_main_context_pending (context));
+    pipe_init (&p);
+    pipe_watch (&p, context);
+    pipe_write (&p);
+    while (p.n_calls == 0)
+        g_main_context_iteration (context, TRUE);
+    pipe_clear (&p);
+    g_main_context_unref (context);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/libqmi-glib/epoll-source/dispatch",         test_dispatch);
+    g_test_add_func ("/libqmi-glib/epoll-source/hangup",           test_hangup);
+    g_test_add_func ("/libqmi-glib/epoll-source/remove-pending",   test_remove_pending);
+    g_test_add_func ("/libqmi-glib/epoll-source/context-lifetime", test_context_lifetime);
+    g_test_add_func ("/libqmi-glib/epoll-source/threads",          test_threads);
+
+    return g_test_run ();
+}
@@ -84,6 +84,65 @@ device_virtual_new_ready (GObject      *source,
     test_fixture_loop_stop (fixture);
 }
 
+void
+test_fixture_expect_proxy_open (TestFixture *fixture,
+                                guint16      transaction_id)
+{
+    guint8 expected[] = {
+        0x01, /* marker */
+        /* QMUX */
+        0x22, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x00, 0xFF, /* message: Internal proxy open */
+        0x17, 0x00, /* tlv length */
+        /* TLV */
+        0x01,       /* type */
+        0x14, 0x00, /* length */
+        0x2F, 0x64, 0x65, 0x76, 0x2F, 0x76, 0x69, 0x72, 0x74, 0x75, 0x61, 0x6C, 0x2F, 0x71, 0x6D, 0x69, 0x00, 0x00, 0x00, 0x00
+    };
+    guint8 response[] = {
+        0x01, /* marker */
+        /* QMUX */
+        0x12, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags */
+        0xFF,       /* transaction */
+        0x00, 0xFF, /* message: Internal proxy open */
+        0x07, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+    };
+
+    g_assert_cmpuint (strlen (fixture->path), ==, 20);
+    memcpy (&expected[15], fixture->path, strlen (fixture->path));
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   transaction_id);
+}
+
+void
+test_fixture_open (TestFixture *fixture)
+{
+    test_fixture_expect_proxy_open (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+    qmi_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_PROXY, 1, NULL,
+                     (GAsyncReadyCallback) device_open_ready,
+                     fixture);
+    test_fixture_loop_run (fixture);
+}
+
 void
 test_fixture_setup (TestFixture *fixture)
 {
@@ -117,55 +176,7 @@ test_fixture_setup (TestFixture *fixture)
     test_fixture_loop_run (fixture);
 
     /* Open device */
-    {
-        guint8 expected[] = {
-            0x01, /* marker */
-            /* QMUX */
-            0x22, 0x00, /* length */
-            0x00,       /* flags */
-            0x00,       /* service CTL */
-            0x00,       /* client */
-            /* QMI header */
-            0x00,       /* flags */
-            0xFF,       /* transaction */
-            0x00, 0xFF, /* message: Internal proxy open */
-            0x17, 0x00, /* tlv length */
-            /* TLV */
-            0x01,       /* type */
-            0x14, 0x00, /* length */
-            0x2F, 0x64, 0x65, 0x76, 0x2F, 0x76, 0x69, 0x72, 0x74, 0x75, 0x61, 0x6C, 0x2F, 0x71, 0x6D, 0x69, 0x00, 0x00, 0x00, 0x00
-        };
-        guint8 response[] = {
-            0x01, /* marker */
-            /* QMUX */
-            0x12, 0x00, /* length */
-            0x00,       /* flags */
-            0x00,       /* service CTL */
-            0x00,       /* client */
-            /* QMI header */
-            0x01,       /* flags */
-            0xFF,       /* transaction */
-            0x00, 0xFF, /* message: Internal proxy open */
-            0x07, 0x00, /* tlv length */
-            /* TLV */
-            0x02,       /* type: Result */
-            0x04, 0x00, /* length */
-            0x00, 0x00, /* error status */
-            0x00, 0x00, /* error code */
-        };
-
-        g_assert_cmpuint (strlen (fixture->path), ==, 20);
-        memcpy (&expected[15], fixture->path, strlen (fixture->path));
-
-        test_port_context_set_command (fixture->ctx,
-                                       expected, G_N_ELEMENTS (expected),
-                                       response, G_N_ELEMENTS (response),
-                                       fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
-    }
-    qmi_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_PROXY, 1, NULL,
-                     (GAsyncReadyCallback) device_open_ready,
-                     fixture);
-    test_fixture_loop_run (fixture);
+    test_fixture_open (fixture);
 
     /* Allocate clients */
     for (i = 0; i < G_N_ELEMENTS (services); i++) {
@@ -300,6 +311,10 @@ test_fixture_teardown (TestFixture *fixture)
             0x01,       /* cid: 1 */
         };
 
+        /* Clients may have already been released by the test */
+        if (!fixture->service_info[services[i]].client)
+            continue;
+
         expected[15] = services[i];
         response[22] = services[i];
         test_port_context_set_command (fixture->ctx,
@@ -39,9 +39,15 @@ typedef struct {
 
 void test_fixture_setup     (TestFixture *fixture);
 void test_fixture_teardown  (TestFixture *fixture);
+void test_fixture_open      (TestFixture *fixture);
 void test_fixture_loop_run  (TestFixture *fixture);
 void test_fixture_loop_stop (TestFixture *fixture);
 
+/* Sets the proxy open command expected when opening a device in the fixture
+ * path */
+void test_fixture_expect_proxy_open (TestFixture *fixture,
+                                     guint16      transaction_id);
+
 typedef void (*TCFunc) (TestFixture *, gconstpointer);
 #define TEST_ADD(path,method)                        \
     g_test_add (path,                                \
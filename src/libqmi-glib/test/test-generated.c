@@ -14,6 +14,7 @@
  */
 
 #include <config.h>
+#include <glib/gstdio.h>
 #include <libqmi-glib.h>
 
 #include "test-fixture.h"
@@ -26,6 +27,1091 @@ test_generated_core (TestFixture *fixture)
     /* Noop */
 }
 
+/*****************************************************************************/
+/* Core: allocate multiple clients */
+
+#if defined HAVE_QMI_SERVICE_DMS
+
+static void
+device_allocate_clients_ready (QmiDevice    *device,
+                               GAsyncResult *res,
+                               TestFixture  *fixture)
+{
+    GError    *error = NULL;
+    GPtrArray *clients;
+    QmiClient *client;
+
+    clients = qmi_device_allocate_clients_finish (device, res, &error);
+    g_assert_no_error (error);
+    g_assert (clients);
+    g_assert_cmpuint (clients->len, ==, 1);
+
+    client = g_ptr_array_index (clients, 0);
+    g_assert (QMI_IS_CLIENT_DMS (client));
+    g_assert_cmpuint (qmi_client_get_cid (client), ==, 2);
+
+    /* Don't send a CID release request, the test port context doesn't expect it */
+    qmi_device_release_client (device, client, QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE, 1, NULL, NULL, NULL);
+    g_ptr_array_unref (clients);
+
+    test_fixture_loop_stop (fixture);
+}
+
+static void
+test_generated_core_allocate_clients (TestFixture *fixture)
+{
+    const QmiService services[] = { QMI_SERVICE_DMS };
+    guint8 expected[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x0F, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x22, 0x00, /* message: Allocate CID */
+        0x04, 0x00, /* tlv length */
+        /* TLV */
+        0x01,       /* type */
+        0x01, 0x00, /* length */
+        0x02        /* service: DMS */
+    };
+    guint8 response[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x17, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x22, 0x00, /* message */
+        0x0C, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Allocation info */
+        0x02, 0x00, /* length */
+        0x02,       /* service: DMS */
+        0x02,       /* cid: 2 */
+    };
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+
+    qmi_device_allocate_clients (fixture->device, services, G_N_ELEMENTS (services), 10, NULL,
+                                 (GAsyncReadyCallback) device_allocate_clients_ready,
+                                 fixture);
+    test_fixture_loop_run (fixture);
+}
+
+#endif /* HAVE_QMI_SERVICE_DMS */
+
+#if defined HAVE_QMI_SERVICE_IMSDCM
+
+static void
+device_allocate_client_imsdcm_ready (QmiDevice    *device,
+                                     GAsyncResult *res,
+                                     TestFixture  *fixture)
+{
+    GError    *error = NULL;
+    QmiClient *client;
+
+    client = qmi_device_allocate_client_finish (device, res, &error);
+    g_assert_no_error (error);
+    g_assert (QMI_IS_CLIENT_IMSDCM (client));
+    g_assert_cmpuint (qmi_client_get_service (client), ==, QMI_SERVICE_IMSDCM);
+    g_assert_cmpuint (qmi_client_get_cid (client), ==, 2);
+
+    /* Don't send a CID release request, the test port context doesn't expect it */
+    qmi_device_release_client (device, client, QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE, 1, NULL, NULL, NULL);
+    g_object_unref (client);
+
+    test_fixture_loop_stop (fixture);
+}
+
+static void
+test_generated_core_allocate_client_imsdcm (TestFixture *fixture)
+{
+    guint8 expected[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x10, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x22, 0xFF, /* message: Internal Allocate CID QRTR */
+        0x05, 0x00, /* tlv length */
+        /* TLV */
+        0x01,       /* type */
+        0x02, 0x00, /* length */
+        0x02, 0x03  /* service: IMSDCM */
+    };
+    guint8 response[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x18, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x22, 0xFF, /* message */
+        0x0D, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Allocation info */
+        0x03, 0x00, /* length */
+        0x02, 0x03, /* service: IMSDCM */
+        0x02,       /* cid: 2 */
+    };
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+
+    qmi_device_allocate_client (fixture->device, QMI_SERVICE_IMSDCM, QMI_CID_NONE, 10, NULL,
+                                (GAsyncReadyCallback) device_allocate_client_imsdcm_ready,
+                                fixture);
+    test_fixture_loop_run (fixture);
+}
+
+#endif /* HAVE_QMI_SERVICE_IMSDCM */
+
+#if defined HAVE_QMI_SERVICE_DMS && defined HAVE_QMI_SERVICE_NAS && defined HAVE_QMI_SERVICE_WDS
+
+static void
+allocate_clients_expect (TestFixture *fixture,
+                         QmiService   service,
+                         gboolean     success)
+{
+    guint8 expected[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x0F, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x22, 0x00, /* message: Allocate CID */
+        0x04, 0x00, /* tlv length */
+        /* TLV */
+        0x01,       /* type */
+        0x01, 0x00, /* length */
+        0xFF        /* UPDATE: service */
+    };
+    guint8 response[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x17, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x22, 0x00, /* message */
+        0x0C, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Allocation info */
+        0x02, 0x00, /* length */
+        0xFF,       /* UPDATE: service */
+        0x02,       /* cid: 2 */
+    };
+    guint8 error_response[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x12, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x22, 0x00, /* message */
+        0x07, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x01, 0x00, /* error status */
+        0x05, 0x00, /* error code: client ids exhausted */
+    };
+
+    expected[15] = service;
+    response[22] = service;
+    if (success)
+        test_port_context_set_command (fixture->ctx,
+                                       expected, G_N_ELEMENTS (expected),
+                                       response, G_N_ELEMENTS (response),
+                                       fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+    else
+        test_port_context_set_command (fixture->ctx,
+                                       expected, G_N_ELEMENTS (expected),
+                                       error_response, G_N_ELEMENTS (error_response),
+                                       fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+}
+
+static void
+allocate_clients_expect_release (TestFixture *fixture,
+                                 QmiService   service)
+{
+    guint8 expected[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x10, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x23, 0x00, /* message: Release CID */
+        0x05, 0x00, /* tlv length: 5 bytes */
+        /* TLV */
+        0x01,       /* type */
+        0x02, 0x00, /* length */
+        0xFF,       /* UPDATE: service */
+        0x02        /* cid: 2 */
+    };
+    guint8 response[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x17, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x23, 0x00, /* message */
+        0x0C, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result*/
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Allocation Info */
+        0x02, 0x00, /* length */
+        0xFF,       /* UPDATE: service */
+        0x02,       /* cid: 2 */
+    };
+
+    expected[15] = service;
+    response[22] = service;
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+}
+
+static void
+allocate_clients_result_ready (GObject       *source,
+                               GAsyncResult  *res,
+                               GAsyncResult **out_res)
+{
+    *out_res = g_object_ref (res);
+}
+
+static void
+test_generated_core_allocate_clients_failure (TestFixture *fixture)
+{
+    const QmiService         services[] = { QMI_SERVICE_DMS, QMI_SERVICE_NAS, QMI_SERVICE_WDS };
+    g_autoptr(GAsyncResult)  res = NULL;
+    GPtrArray               *clients;
+    GError                  *error = NULL;
+
+    /* All allocations are sent right away; the last one fails */
+    allocate_clients_expect (fixture, QMI_SERVICE_DMS, TRUE);
+    allocate_clients_expect (fixture, QMI_SERVICE_NAS, TRUE);
+    allocate_clients_expect (fixture, QMI_SERVICE_WDS, FALSE);
+
+    /* And the CIDs already allocated are released, in order */
+    allocate_clients_expect_release (fixture, QMI_SERVICE_DMS);
+    allocate_clients_expect_release (fixture, QMI_SERVICE_NAS);
+
+    qmi_device_allocate_clients (fixture->device, services, G_N_ELEMENTS (services), 10, NULL,
+                                 (GAsyncReadyCallback) allocate_clients_result_ready,
+                                 &res);
+    while (!res)
+        g_main_context_iteration (NULL, TRUE);
+
+    clients = qmi_device_allocate_clients_finish (fixture->device, res, &error);
+    g_assert_error (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_CLIENT_IDS_EXHAUSTED);
+    g_assert (!clients);
+    g_clear_error (&error);
+
+    /* The port context fails if any release request is missing or wrong */
+    test_port_context_wait_commands (fixture->ctx);
+}
+
+#endif /* HAVE_QMI_SERVICE_DMS && HAVE_QMI_SERVICE_NAS && HAVE_QMI_SERVICE_WDS */
+
+/*****************************************************************************/
+/* Core: per-client flow control */
+
+#if defined HAVE_QMI_MESSAGE_DMS_GET_IDS
+
+static void
+flow_control_result_ready (GObject       *source,
+                           GAsyncResult  *res,
+                           GAsyncResult **out_res)
+{
+    *out_res = g_object_ref (res);
+}
+
+static void
+flow_control_wait_result (GAsyncResult **res)
+{
+    while (!*res)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+flow_control_assert_result_error (TestFixture  *fixture,
+                                  GAsyncResult *res,
+                                  GQuark        domain,
+                                  gint          code)
+{
+    GError                    *error = NULL;
+    QmiMessageDmsGetIdsOutput *output;
+
+    output = qmi_client_dms_get_ids_finish (QMI_CLIENT_DMS (fixture->service_info[QMI_SERVICE_DMS].client), res, &error);
+    g_assert_error (error, domain, code);
+    g_assert (!output);
+    g_error_free (error);
+    g_object_unref (res);
+}
+
+/* Sends a first request which is never replied, so that it keeps the only
+ * credit of the client, and then a second one which gets queued */
+static void
+flow_control_setup (TestFixture   *fixture,
+                    GCancellable  *first_cancellable,
+                    GAsyncResult **first_res,
+                    guint          second_timeout,
+                    GCancellable  *second_cancellable,
+                    GAsyncResult **second_res)
+{
+    guint8 expected[] = {
+        0x01,
+        0x0C, 0x00, 0x00, 0x02, 0x01,
+        0x00, 0xFF, 0xFF, 0x25, 0x00, 0x00, 0x00
+    };
+
+    g_object_set (fixture->device, QMI_DEVICE_MAX_IN_FLIGHT_PER_CLIENT, 1, NULL);
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   NULL, 0,
+                                   fixture->service_info[QMI_SERVICE_DMS].transaction_id++);
+    qmi_client_dms_get_ids (QMI_CLIENT_DMS (fixture->service_info[QMI_SERVICE_DMS].client), NULL, 10, first_cancellable,
+                            (GAsyncReadyCallback) flow_control_result_ready,
+                            first_res);
+
+    /* The port context would fail if the queued request was ever sent */
+    fixture->service_info[QMI_SERVICE_DMS].transaction_id++;
+    qmi_client_dms_get_ids (QMI_CLIENT_DMS (fixture->service_info[QMI_SERVICE_DMS].client), NULL, second_timeout, second_cancellable,
+                            (GAsyncReadyCallback) flow_control_result_ready,
+                            second_res);
+}
+
+static void
+flow_control_teardown (TestFixture   *fixture,
+                       GCancellable  *first_cancellable,
+                       GAsyncResult **first_res)
+{
+    /* The request without reply is not abortable, so cancelling it completes
+     * it right away */
+    g_cancellable_cancel (first_cancellable);
+    flow_control_wait_result (first_res);
+    flow_control_assert_result_error (fixture, *first_res, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+}
+
+static void
+test_generated_core_flow_control_queued_timeout (TestFixture *fixture)
+{
+    g_autoptr(GCancellable)  first_cancellable = NULL;
+    GAsyncResult            *first_res = NULL;
+    GAsyncResult            *second_res = NULL;
+
+    first_cancellable = g_cancellable_new ();
+    flow_control_setup (fixture, first_cancellable, &first_res, 1, NULL, &second_res);
+
+    /* The timeout applies while queued */
+    flow_control_wait_result (&second_res);
+    flow_control_assert_result_error (fixture, second_res, QMI_CORE_ERROR, QMI_CORE_ERROR_TIMEOUT);
+    g_assert (!first_res);
+
+    flow_control_teardown (fixture, first_cancellable, &first_res);
+}
+
+static void
+test_generated_core_flow_control_queued_cancel (TestFixture *fixture)
+{
+    g_autoptr(GCancellable)  first_cancellable = NULL;
+    g_autoptr(GCancellable)  second_cancellable = NULL;
+    GAsyncResult            *first_res = NULL;
+    GAsyncResult            *second_res = NULL;
+
+    first_cancellable = g_cancellable_new ();
+    second_cancellable = g_cancellable_new ();
+    flow_control_setup (fixture, first_cancellable, &first_res, 10, second_cancellable, &second_res);
+
+    /* The cancellable applies while queued */
+    g_cancellable_cancel (second_cancellable);
+    flow_control_wait_result (&second_res);
+    flow_control_assert_result_error (fixture, second_res, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+    g_assert (!first_res);
+
+    flow_control_teardown (fixture, first_cancellable, &first_res);
+}
+
+static void
+test_generated_core_flow_control_queued_transaction_id (TestFixture *fixture)
+{
+    g_autoptr(GCancellable)  first_cancellable = NULL;
+    g_autoptr(GCancellable)  second_cancellable = NULL;
+    GAsyncResult            *first_res = NULL;
+    GAsyncResult            *second_res = NULL;
+    QmiClient               *client;
+    guint                    i;
+
+    first_cancellable = g_cancellable_new ();
+    second_cancellable = g_cancellable_new ();
+    flow_control_setup (fixture, first_cancellable, &first_res, 10, second_cancellable, &second_res);
+
+    /* Transaction IDs 1 (in flight) and 2 (queued) are in use; once the
+     * counter wraps both must be skipped */
+    client = fixture->service_info[QMI_SERVICE_DMS].client;
+    for (i = 3; i <= G_MAXUINT16; i++)
+        g_assert_cmpuint (qmi_client_get_next_transaction_id (client), ==, i);
+    g_assert_cmpuint (qmi_client_get_next_transaction_id (client), ==, 3);
+
+    g_cancellable_cancel (second_cancellable);
+    flow_control_wait_result (&second_res);
+    flow_control_assert_result_error (fixture, second_res, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+
+    flow_control_teardown (fixture, first_cancellable, &first_res);
+}
+
+static void
+flow_control_command_ready (QmiDevice    *device,
+                            GAsyncResult *res,
+                            guint        *n_pending)
+{
+    GError     *error = NULL;
+    QmiMessage *response;
+
+    response = qmi_device_command_full_finish (device, res, &error);
+    g_assert_error (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+    g_assert (!response);
+    g_error_free (error);
+    (*n_pending)--;
+}
+
+static void
+test_generated_core_flow_control_transaction_id_exhausted (TestFixture *fixture)
+{
+    g_autoptr(GCancellable)  first_cancellable = NULL;
+    g_autoptr(GCancellable)  second_cancellable = NULL;
+    GAsyncResult            *first_res = NULL;
+    GAsyncResult            *second_res = NULL;
+    GAsyncResult            *res = NULL;
+    QmiClient               *client;
+    guint                    n_pending = 0;
+    guint                    i;
+
+    first_cancellable = g_cancellable_new ();
+    second_cancellable = g_cancellable_new ();
+    flow_control_setup (fixture, first_cancellable, &first_res, 10, second_cancellable, &second_res);
+
+    /* Transaction IDs 1 (in flight) and 2 (queued) are in use; queue
+     * requests with all the remaining ones */
+    client = fixture->service_info[QMI_SERVICE_DMS].client;
+    for (i = 3; i <= G_MAXUINT16; i++) {
+        g_autoptr(QmiMessage) message = NULL;
+
+        message = qmi_message_new (QMI_SERVICE_DMS, qmi_client_get_cid (client), (guint16) i, 0x0025);
+        qmi_device_command_full (fixture->device, message, NULL, 60, second_cancellable,
+                                 (GAsyncReadyCallback) flow_control_command_ready,
+                                 &n_pending);
+        n_pending++;
+    }
+
+    /* No ID left, so new requests fail right away */
+    g_assert_cmpuint (qmi_client_get_next_transaction_id (client), ==, 0);
+    qmi_client_dms_get_ids (QMI_CLIENT_DMS (client), NULL, 10, NULL,
+                            (GAsyncReadyCallback) flow_control_result_ready,
+                            &res);
+    flow_control_wait_result (&res);
+    flow_control_assert_result_error (fixture, res, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED);
+
+    /* All IDs of the queued requests are released when they complete */
+    g_cancellable_cancel (second_cancellable);
+    flow_control_wait_result (&second_res);
+    flow_control_assert_result_error (fixture, second_res, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+    while (n_pending > 0)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert_cmpuint (qmi_client_get_next_transaction_id (client), ==, 3);
+    g_assert_cmpuint (qmi_client_get_next_transaction_id (client), ==, 4);
+
+    flow_control_teardown (fixture, first_cancellable, &first_res);
+}
+
+static void
+flow_control_device_close_ready (QmiDevice    *device,
+                                 GAsyncResult *res,
+                                 TestFixture  *fixture)
+{
+    GError *error = NULL;
+
+    g_assert (qmi_device_close_finish (device, res, &error));
+    g_assert_no_error (error);
+    test_fixture_loop_stop (fixture);
+}
+
+static void
+test_generated_core_flow_control_queued_close (TestFixture *fixture)
+{
+    g_autoptr(GCancellable)  first_cancellable = NULL;
+    GAsyncResult            *first_res = NULL;
+    GAsyncResult            *second_res = NULL;
+
+    first_cancellable = g_cancellable_new ();
+    flow_control_setup (fixture, first_cancellable, &first_res, 10, NULL, &second_res);
+
+    /* Closing the device fails the queued request right away */
+    qmi_device_close_async (fixture->device, 10, NULL,
+                            (GAsyncReadyCallback) flow_control_device_close_ready,
+                            fixture);
+    test_fixture_loop_run (fixture);
+    flow_control_wait_result (&second_res);
+    flow_control_assert_result_error (fixture, second_res, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE);
+
+    flow_control_teardown (fixture, first_cancellable, &first_res);
+
+    /* Reopen so that the clients are released during teardown */
+    test_fixture_open (fixture);
+}
+
+static void
+flow_control_release_client_ready (QmiDevice    *device,
+                                   GAsyncResult *res,
+                                   TestFixture  *fixture)
+{
+    GError *error = NULL;
+
+    g_assert (qmi_device_release_client_finish (device, res, &error));
+    g_assert_no_error (error);
+    test_fixture_loop_stop (fixture);
+}
+
+static void
+test_generated_core_flow_control_queued_release (TestFixture *fixture)
+{
+    g_autoptr(GCancellable)  first_cancellable = NULL;
+    g_autoptr(QmiClient)     client = NULL;
+    GAsyncResult            *first_res = NULL;
+    GAsyncResult            *second_res = NULL;
+    GError                  *error = NULL;
+
+    first_cancellable = g_cancellable_new ();
+    flow_control_setup (fixture, first_cancellable, &first_res, 10, NULL, &second_res);
+
+    /* Releasing the client fails the queued request right away; the request
+     * in flight keeps running until it completes */
+    client = g_object_ref (fixture->service_info[QMI_SERVICE_DMS].client);
+    qmi_device_release_client (fixture->device, client, QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE, 10, NULL,
+                               (GAsyncReadyCallback) flow_control_release_client_ready,
+                               fixture);
+    test_fixture_loop_run (fixture);
+    flow_control_wait_result (&second_res);
+    g_assert (!qmi_client_dms_get_ids_finish (QMI_CLIENT_DMS (client), second_res, &error));
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE);
+    g_clear_error (&error);
+    g_object_unref (second_res);
+    g_assert (!first_res);
+
+    g_cancellable_cancel (first_cancellable);
+    flow_control_wait_result (&first_res);
+    g_assert (!qmi_client_dms_get_ids_finish (QMI_CLIENT_DMS (client), first_res, &error));
+    g_assert_error (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+    g_clear_error (&error);
+    g_object_unref (first_res);
+
+    /* Already released, not to be released during teardown */
+    g_clear_object (&fixture->service_info[QMI_SERVICE_DMS].client);
+}
+
+#endif /* HAVE_QMI_MESSAGE_DMS_GET_IDS */
+
+/*****************************************************************************/
+/* Core: version info cache */
+
+#if defined HAVE_QMI_SERVICE_NAS
+
+static void
+version_info_result_ready (GObject       *source,
+                           GAsyncResult  *res,
+                           GAsyncResult **out_res)
+{
+    *out_res = g_object_ref (res);
+}
+
+static void
+version_info_wait_result (GAsyncResult **res)
+{
+    while (!*res)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+/* Sets the CTL Get Version Info command expected, replied with the given
+ * list of services, all of them reported as version 1.0; or never replied
+ * if no list is given */
+static void
+version_info_expect (TestFixture      *fixture,
+                     guint16           transaction_id,
+                     const QmiService *services,
+                     guint             n_services)
+{
+    guint8 expected[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x0B, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x21, 0x00, /* message: Get Version Info */
+        0x00, 0x00, /* tlv length */
+    };
+    guint8 response_header[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0xFF, 0xFF, /* UPDATE: length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x21, 0x00, /* message */
+        0xFF, 0xFF, /* UPDATE: tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Service list */
+        0xFF, 0xFF, /* UPDATE: length */
+        0xFF,       /* UPDATE: number of services */
+    };
+    g_autoptr(GByteArray) response = NULL;
+    guint16               list_length;
+    guint                 i;
+
+    if (!services) {
+        test_port_context_set_command (fixture->ctx,
+                                       expected, G_N_ELEMENTS (expected),
+                                       NULL, 0,
+                                       transaction_id);
+        return;
+    }
+
+    list_length = 1 + 5 * n_services;
+    response_header[1]  = (guint8)(list_length + 21);
+    response_header[2]  = (guint8)((list_length + 21) >> 8);
+    response_header[10] = (guint8)(list_length + 10);
+    response_header[11] = (guint8)((list_length + 10) >> 8);
+    response_header[20] = (guint8)list_length;
+    response_header[21] = (guint8)(list_length >> 8);
+    response_header[22] = (guint8)n_services;
+
+    response = g_byte_array_append (g_byte_array_new (), response_header, G_N_ELEMENTS (response_header));
+    for (i = 0; i < n_services; i++) {
+        guint8 info[] = {
+            0xFF,       /* UPDATE: service */
+            0x01, 0x00, /* major version */
+            0x00, 0x00, /* minor version */
+        };
+
+        info[0] = services[i];
+        g_byte_array_append (response, info, G_N_ELEMENTS (info));
+    }
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response->data, response->len,
+                                   transaction_id);
+}
+
+static QmiDevice *
+version_info_device_new (TestFixture *fixture)
+{
+    g_autoptr(GFile)         file = NULL;
+    g_autoptr(GAsyncResult)  res = NULL;
+    GError                  *error = NULL;
+    QmiDevice               *device;
+
+    file = g_file_new_for_path (fixture->path);
+    g_async_initable_new_async (QMI_TYPE_DEVICE,
+                                G_PRIORITY_DEFAULT,
+                                NULL,
+                                (GAsyncReadyCallback) version_info_result_ready,
+                                &res,
+                                QMI_DEVICE_FILE,          file,
+                                QMI_DEVICE_NO_FILE_CHECK, TRUE,
+                                QMI_DEVICE_PROXY_PATH,    fixture->path,
+                                NULL);
+    version_info_wait_result (&res);
+
+    device = qmi_device_new_finish (res, &error);
+    g_assert_no_error (error);
+    g_assert (QMI_IS_DEVICE (device));
+    return device;
+}
+
+static void
+version_info_device_open (QmiDevice          *device,
+                          QmiDeviceOpenFlags  flags)
+{
+    g_autoptr(GAsyncResult)  res = NULL;
+    GError                  *error = NULL;
+
+    qmi_device_open (device,
+                     QMI_DEVICE_OPEN_FLAGS_PROXY | QMI_DEVICE_OPEN_FLAGS_VERSION_INFO | flags,
+                     5, NULL,
+                     (GAsyncReadyCallback) version_info_result_ready,
+                     &res);
+    version_info_wait_result (&res);
+    g_assert (qmi_device_open_finish (device, res, &error));
+    g_assert_no_error (error);
+}
+
+static void
+version_info_device_close (QmiDevice *device)
+{
+    g_autoptr(GAsyncResult)  res = NULL;
+    GError                  *error = NULL;
+
+    qmi_device_close_async (device, 10, NULL,
+                            (GAsyncReadyCallback) version_info_result_ready,
+                            &res);
+    version_info_wait_result (&res);
+    g_assert (qmi_device_close_finish (device, res, &error));
+    g_assert_no_error (error);
+}
+
+/* NAS was in the cached list, but not in the reported one, so no request is
+ * sent to allocate the client */
+static void
+version_info_assert_nas_unsupported (QmiDevice *device)
+{
+    g_autoptr(GAsyncResult)  res = NULL;
+    GError                  *error = NULL;
+
+    qmi_device_allocate_client (device, QMI_SERVICE_NAS, QMI_CID_NONE, 10, NULL,
+                                (GAsyncReadyCallback) version_info_result_ready,
+                                &res);
+    version_info_wait_result (&res);
+    g_assert (!qmi_device_allocate_client_finish (device, res, &error));
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED);
+    g_clear_error (&error);
+}
+
+/* Sets the CTL Sync command expected, replied with success */
+static void
+version_info_expect_sync (TestFixture *fixture,
+                          guint16      transaction_id)
+{
+    const guint8 expected[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x0B, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service CTL */
+        0x00,       /* client */
+        /* QMI header */
+        0x00,       /* flags */
+        0xFF,       /* transaction */
+        0x27, 0x00, /* message: Sync */
+        0x00, 0x00, /* tlv length */
+    };
+    const guint8 response[] = {
+        0x01,       /* marker */
+        /* QMUX */
+        0x12, 0x00, /* length */
+        0x00,       /* flags */
+        0x00,       /* service */
+        0x00,       /* client */
+        /* QMI header */
+        0x01,       /* flags: Response */
+        0xFF,       /* transaction */
+        0x27, 0x00, /* message */
+        0x07, 0x00, /* tlv length */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length */
+        0x00, 0x00, /* error status */
+        0x00, 0x00, /* error code */
+    };
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   transaction_id);
+}
+
+static void
+test_generated_core_version_info_pipelined_cache (TestFixture *fixture)
+{
+    const QmiService      cached_services[] = { QMI_SERVICE_CTL, QMI_SERVICE_DMS, QMI_SERVICE_NAS };
+    const QmiService      reported_services[] = { QMI_SERVICE_CTL, QMI_SERVICE_DMS };
+    g_autoptr(QmiDevice)  first = NULL;
+    g_autoptr(QmiDevice)  second = NULL;
+    g_autoptr(QmiDevice)  third = NULL;
+
+    /* Reopen the fixture device querying the version info, so that it gets
+     * cached, and close it; the cached entry is kept */
+    version_info_device_close (fixture->device);
+    test_fixture_expect_proxy_open (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+    version_info_expect (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++,
+                         cached_services, G_N_ELEMENTS (cached_services));
+    version_info_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_PIPELINED);
+    version_info_device_close (fixture->device);
+
+    /* A pipelined open of the same path with another device completes with
+     * the cached list, without waiting for the modem to report it; the
+     * validation is cancelled when closing */
+    first = version_info_device_new (fixture);
+    test_fixture_expect_proxy_open (fixture, 0x0001);
+    version_info_expect (fixture, 0x0002, NULL, 0);
+    version_info_device_open (first, QMI_DEVICE_OPEN_FLAGS_PIPELINED);
+    test_port_context_wait_commands (fixture->ctx);
+    version_info_device_close (first);
+
+    /* The list reported while validating replaces the cached one. The sync
+     * reply comes after the version info one, so the validation is done once
+     * the open finishes. */
+    second = version_info_device_new (fixture);
+    test_fixture_expect_proxy_open (fixture, 0x0001);
+    version_info_expect (fixture, 0x0002, reported_services, G_N_ELEMENTS (reported_services));
+    version_info_expect_sync (fixture, 0x0003);
+    version_info_device_open (second, QMI_DEVICE_OPEN_FLAGS_PIPELINED | QMI_DEVICE_OPEN_FLAGS_SYNC);
+    version_info_assert_nas_unsupported (second);
+    version_info_device_close (second);
+
+    /* Also in the process-wide cache */
+    third = version_info_device_new (fixture);
+    test_fixture_expect_proxy_open (fixture, 0x0001);
+    version_info_expect (fixture, 0x0002, NULL, 0);
+    version_info_device_open (third, QMI_DEVICE_OPEN_FLAGS_PIPELINED);
+    version_info_assert_nas_unsupported (third);
+    test_port_context_wait_commands (fixture->ctx);
+    version_info_device_close (third);
+
+    /* Reopen so that the clients are released during teardown */
+    test_fixture_open (fixture);
+}
+
+static gchar *
+version_info_find_cache_file (const gchar *cache_dir)
+{
+    g_autoptr(GDir)  dir = NULL;
+    GError          *error = NULL;
+    const gchar     *name;
+    gchar           *path = NULL;
+
+    dir = g_dir_open (cache_dir, 0, &error);
+    g_assert_no_error (error);
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        g_assert (g_str_has_suffix (name, ".version-info"));
+        g_assert (!path);
+        path = g_build_filename (cache_dir, name, NULL);
+    }
+    g_assert (path);
+    return path;
+}
+
+static void
+version_info_assert_cache_file (const gchar      *cache_file,
+                                const QmiService *services,
+                                guint             n_services)
+{
+    g_autoptr(GKeyFile)  keyfile = NULL;
+    g_autofree gint     *cached = NULL;
+    gsize                n_cached = 0;
+    GError              *error = NULL;
+    guint                i;
+
+    keyfile = g_key_file_new ();
+    g_key_file_load_from_file (keyfile, cache_file, G_KEY_FILE_NONE, &error);
+    g_assert_no_error (error);
+    cached = g_key_file_get_integer_list (keyfile, "version-info", "services", &n_cached, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (n_cached, ==, n_services);
+    for (i = 0; i < n_services; i++)
+        g_assert_cmpint (cached[i], ==, services[i]);
+}
+
+/* The cache file is updated when the background validation finishes */
+static gboolean
+version_info_cache_file_matches (const gchar      *cache_file,
+                                 const QmiService *services,
+                                 guint             n_services)
+{
+    g_autoptr(GKeyFile)  keyfile = NULL;
+    g_autofree gint     *cached = NULL;
+    gsize                n_cached = 0;
+    guint                i;
+
+    keyfile = g_key_file_new ();
+    if (!g_key_file_load_from_file (keyfile, cache_file, G_KEY_FILE_NONE, NULL))
+        return FALSE;
+    cached = g_key_file_get_integer_list (keyfile, "version-info", "services", &n_cached, NULL);
+    if (!cached || n_cached != n_services)
+        return FALSE;
+    for (i = 0; i < n_services; i++) {
+        if (cached[i] != (gint) services[i])
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+version_info_get (QmiDevice    *device,
+                  GCancellable *cancellable,
+                  guint         n_expected)
+{
+    GAsyncResult *res = NULL;
+    GArray       *services;
+    GError       *error = NULL;
+
+    qmi_device_get_service_version_info (device, 10, cancellable,
+                                         (GAsyncReadyCallback) version_info_result_ready,
+                                         &res);
+    version_info_wait_result (&res);
+    services = qmi_device_get_service_version_info_finish (device, res, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (services->len, ==, n_expected);
+    g_array_unref (services);
+    g_object_unref (res);
+}
+
+static void
+test_generated_core_version_info_disk_cache (TestFixture *fixture)
+{
+    const QmiService         cached_services[] = { QMI_SERVICE_CTL, QMI_SERVICE_DMS, QMI_SERVICE_NAS };
+    const QmiService         reported_services[] = { QMI_SERVICE_CTL, QMI_SERVICE_DMS };
+    g_autofree gchar        *cache_dir = NULL;
+    g_autofree gchar        *cache_file = NULL;
+    g_autoptr(GCancellable)  cancellable = NULL;
+    GAsyncResult            *res = NULL;
+    GError                  *error = NULL;
+
+    cache_dir = g_dir_make_tmp ("test-qmi-version-info-XXXXXX", &error);
+    g_assert_no_error (error);
+    g_object_set (fixture->device, QMI_DEVICE_VERSION_INFO_CACHE_DIR, cache_dir, NULL);
+
+    /* Reopen the fixture device querying the version info, so that it gets
+     * stored in the cache directory */
+    version_info_device_close (fixture->device);
+    test_fixture_expect_proxy_open (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+    version_info_expect (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++,
+                         cached_services, G_N_ELEMENTS (cached_services));
+    version_info_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_NONE);
+    version_info_device_close (fixture->device);
+    cache_file = version_info_find_cache_file (cache_dir);
+    version_info_assert_cache_file (cache_file, cached_services, G_N_ELEMENTS (cached_services));
+
+    /* The next open completes with the cached list, which is validated in the
+     * background. The sync reply comes after the version info one, so the
+     * validation is done once the open finishes. */
+    test_fixture_expect_proxy_open (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+    version_info_expect (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++,
+                         reported_services, G_N_ELEMENTS (reported_services));
+    version_info_expect_sync (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
+    version_info_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_SYNC);
+    version_info_assert_nas_unsupported (fixture->device);
+    version_info_assert_cache_file (cache_file, reported_services, G_N_ELEMENTS (reported_services));
+
+    /* Explicit requests report the cached list right away, validating it in
+     * the background as well */
+    version_info_expect (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++,
+                         cached_services, G_N_ELEMENTS (cached_services));
+    version_info_get (fixture->device, NULL, G_N_ELEMENTS (reported_services));
+    while (!version_info_cache_file_matches (cache_file, cached_services, G_N_ELEMENTS (cached_services)))
+        g_main_context_iteration (NULL, TRUE);
+    version_info_get (fixture->device, NULL, G_N_ELEMENTS (cached_services));
+
+    /* Without cache, the device is asked, honouring the cancellable given */
+    g_object_set (fixture->device, QMI_DEVICE_VERSION_INFO_CACHE_DIR, NULL, NULL);
+    version_info_expect (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++,
+                         reported_services, G_N_ELEMENTS (reported_services));
+    version_info_get (fixture->device, NULL, G_N_ELEMENTS (reported_services));
+    cancellable = g_cancellable_new ();
+    version_info_expect (fixture, fixture->service_info[QMI_SERVICE_CTL].transaction_id++, NULL, 0);
+    qmi_device_get_service_version_info (fixture->device, 10, cancellable,
+                                         (GAsyncReadyCallback) version_info_result_ready,
+                                         &res);
+    g_cancellable_cancel (cancellable);
+    version_info_wait_result (&res);
+    g_assert (!qmi_device_get_service_version_info_finish (fixture->device, res, &error));
+    g_assert_error (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_ABORTED);
+    g_clear_error (&error);
+    g_clear_object (&res);
+    test_port_context_wait_commands (fixture->ctx);
+
+    /* The cache is never used if the device isn't open */
+    g_object_set (fixture->device, QMI_DEVICE_VERSION_INFO_CACHE_DIR, cache_dir, NULL);
+    version_info_device_close (fixture->device);
+    qmi_device_get_service_version_info (fixture->device, 10, NULL,
+                                         (GAsyncReadyCallback) version_info_result_ready,
+                                         &res);
+    version_info_wait_result (&res);
+    g_assert (!qmi_device_get_service_version_info_finish (fixture->device, res, &error));
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE);
+    g_clear_error (&error);
+    g_clear_object (&res);
+
+    /* Reopen so that the clients are released during teardown */
+    g_object_set (fixture->device, QMI_DEVICE_VERSION_INFO_CACHE_DIR, NULL, NULL);
+    test_fixture_open (fixture);
+
+    g_assert_cmpint (g_unlink (cache_file), ==, 0);
+    g_assert_cmpint (g_rmdir (cache_dir), ==, 0);
+}
+
+#endif /* HAVE_QMI_SERVICE_NAS */
+
 /*****************************************************************************/
 /* DMS Get IDs */
 
@@ -353,6 +1439,90 @@ test_generated_dms_get_time (TestFixture *fixture)
 
 #endif /* HAVE_QMI_MESSAGE_DMS_GET_TIME */
 
+/*****************************************************************************/
+/* DMS Get Time, with an optional TLV that cannot be decoded
+ *
+ * The 'System Time' TLV is 4 bytes long instead of 8. Eager parsing ignores it,
+ * while lazy parsing reports the decoding error the first time it is accessed.
+ */
+
+#if defined HAVE_QMI_MESSAGE_DMS_GET_TIME
+
+static void
+dms_get_time_invalid_tlv_ready (QmiClientDms *client,
+                                GAsyncResult *res,
+                                TestFixture  *fixture)
+{
+    QmiMessageDmsGetTimeOutput *output;
+    GError *error = NULL;
+    gboolean st;
+    guint64 system_time;
+    guint64 user_time;
+
+    output = qmi_client_dms_get_time_finish (client, res, &error);
+    g_assert_no_error (error);
+    g_assert (output);
+
+    st = qmi_message_dms_get_time_output_get_result (output, &error);
+    g_assert_no_error (error);
+    g_assert (st);
+
+#if defined LAZY_OUTPUT_BUNDLES_ENABLED
+    st = qmi_message_dms_get_time_output_get_system_time (output, &system_time, &error);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_TOO_LONG);
+    g_assert (g_str_has_prefix (error->message, "Couldn't decode the System Time TLV: "));
+    g_assert (!st);
+    g_clear_error (&error);
+#endif
+
+    st = qmi_message_dms_get_time_output_get_system_time (output, &system_time, &error);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_NOT_FOUND);
+    g_assert (!st);
+    g_clear_error (&error);
+
+    /* Other fields are not affected */
+    st = qmi_message_dms_get_time_output_get_user_time (output, &user_time, &error);
+    g_assert_no_error (error);
+    g_assert (st);
+    g_assert_cmpuint (user_time, ==, 11774664);
+
+    qmi_message_dms_get_time_output_unref (output);
+
+    test_fixture_loop_stop (fixture);
+}
+
+static void
+test_generated_dms_get_time_invalid_tlv (TestFixture *fixture)
+{
+    guint8 expected[] = {
+        0x01,
+        0x0C, 0x00, 0x00, 0x02, 0x01, 0x00, 0x01, 0x00, 0x2F, 0x00,
+        0x00, 0x00
+    };
+    guint8 response[] = {
+        0x01,
+        0x30, 0x00, 0x80, 0x02, 0x01, 0x02, 0x01, 0x00, 0x2F, 0x00,
+        0x24, 0x00,
+        0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x01, 0x08, 0x00, 0x41, 0x0C, 0x90, 0x01, 0xCE, 0x00, 0x02, 0x00,
+        0x10, 0x04, 0x00, 0x51, 0x0F, 0xF4, 0x81,
+        0x11, 0x08, 0x00, 0xC8, 0xAA, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   fixture->service_info[QMI_SERVICE_DMS].transaction_id++);
+
+    qmi_client_dms_get_time (QMI_CLIENT_DMS (fixture->service_info[QMI_SERVICE_DMS].client), NULL, 3, NULL,
+                             (GAsyncReadyCallback) dms_get_time_invalid_tlv_ready,
+                             fixture);
+
+    test_fixture_loop_run (fixture);
+}
+
+#endif /* HAVE_QMI_MESSAGE_DMS_GET_TIME */
+
 /*****************************************************************************/
 /* NAS Network Scan */
 
@@ -1393,10 +2563,29 @@ int main (int argc, char **argv)
 
     /* Test the setup/teardown test methods */
     TEST_ADD ("/libqmi-glib/generated/core", test_generated_core);
+#if defined HAVE_QMI_SERVICE_DMS
+    TEST_ADD ("/libqmi-glib/generated/core/allocate-clients", test_generated_core_allocate_clients);
+#endif
+#if defined HAVE_QMI_SERVICE_IMSDCM
+    TEST_ADD ("/libqmi-glib/generated/core/allocate-client/imsdcm", test_generated_core_allocate_client_imsdcm);
+#endif
+#if defined HAVE_QMI_SERVICE_DMS && defined HAVE_QMI_SERVICE_NAS && defined HAVE_QMI_SERVICE_WDS
+    TEST_ADD ("/libqmi-glib/generated/core/allocate-clients/failure", test_generated_core_allocate_clients_failure);
+#endif
 
 #if defined HAVE_QMI_MESSAGE_DMS_GET_IDS
+    TEST_ADD ("/libqmi-glib/generated/core/flow-control/queued-timeout",        test_generated_core_flow_control_queued_timeout);
+    TEST_ADD ("/libqmi-glib/generated/core/flow-control/queued-cancel",         test_generated_core_flow_control_queued_cancel);
+    TEST_ADD ("/libqmi-glib/generated/core/flow-control/queued-transaction-id", test_generated_core_flow_control_queued_transaction_id);
+    TEST_ADD ("/libqmi-glib/generated/core/flow-control/transaction-id-exhausted", test_generated_core_flow_control_transaction_id_exhausted);
+    TEST_ADD ("/libqmi-glib/generated/core/flow-control/queued-close",          test_generated_core_flow_control_queued_close);
+    TEST_ADD ("/libqmi-glib/generated/core/flow-control/queued-release",        test_generated_core_flow_control_queued_release);
     TEST_ADD ("/libqmi-glib/generated/dms/get-ids", test_generated_dms_get_ids);
 #endif
+#if defined HAVE_QMI_SERVICE_NAS
+    TEST_ADD ("/libqmi-glib/generated/core/version-info/pipelined-cache", test_generated_core_version_info_pipelined_cache);
+    TEST_ADD ("/libqmi-glib/generated/core/version-info/disk-cache",      test_generated_core_version_info_disk_cache);
+#endif
 #if defined HAVE_QMI_MESSAGE_DMS_UIM_GET_PIN_STATUS
     TEST_ADD ("/libqmi-glib/generated/dms/uim-get-pin-status", test_generated_dms_uim_get_pin_status);
 #endif
@@ -1405,6 +2594,7 @@ int main (int argc, char **argv)
 #endif
 #if defined HAVE_QMI_MESSAGE_DMS_GET_TIME
     TEST_ADD ("/libqmi-glib/generated/dms/get-time", test_generated_dms_get_time);
+    TEST_ADD ("/libqmi-glib/generated/dms/get-time/invalid-tlv", test_generated_dms_get_time_invalid_tlv);
 #endif
 
 #if defined HAVE_QMI_MESSAGE_NAS_NETWORK_SCAN
@@ -0,0 +1,434 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "qmi-link-inventory.h"
+#include "test-netlink.h"
+
+/*****************************************************************************/
+/* Fake sysfs tree, with the same layout as /sys/class/net */
+
+typedef struct {
+    gchar            *root;
+    QmiLinkInventory *inventory;
+    /* base ifnames of the links-changed signals */
+    GPtrArray        *changed;
+} Fixture;
+
+static void
+fake_iface_add (Fixture     *fixture,
+                const gchar *ifname,
+                guint        ifindex)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *contents = NULL;
+    GError           *error = NULL;
+
+    path = g_build_filename (fixture->root, ifname, NULL);
+    g_assert_cmpint (g_mkdir (path, 0755), ==, 0);
+    g_free (path);
+
+    path = g_build_filename (fixture->root, ifname, "ifindex", NULL);
+    contents = g_strdup_printf ("%u\n", ifindex);
+    g_file_set_contents (path, contents, -1, &error);
+    g_assert_no_error (error);
+}
+
+static void
+fake_iface_del (Fixture     *fixture,
+                const gchar *ifname)
+{
+    g_autofree gchar *path = NULL;
+
+    path = g_build_filename (fixture->root, ifname, "ifindex", NULL);
+    g_assert_cmpint (g_unlink (path), ==, 0);
+    g_free (path);
+
+    path = g_build_filename (fixture->root, ifname, NULL);
+    g_assert_cmpint (g_rmdir (path), ==, 0);
+}
+
+static void
+fake_upper_add (Fixture     *fixture,
+                const gchar *base_ifname,
+                const gchar *ifname)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *target = NULL;
+
+    path = g_strdup_printf ("%s/%s/upper_%s", fixture->root, base_ifname, ifname);
+    target = g_strdup_printf ("../%s", ifname);
+    g_assert_cmpint (symlink (target, path), ==, 0);
+}
+
+static void
+fake_upper_del (Fixture     *fixture,
+                const gchar *base_ifname,
+                const gchar *ifname)
+{
+    g_autofree gchar *path = NULL;
+
+    path = g_strdup_printf ("%s/%s/upper_%s", fixture->root, base_ifname, ifname);
+    g_assert_cmpint (g_unlink (path), ==, 0);
+}
+
+static void
+links_changed_cb (QmiLinkInventory *inventory,
+                  const gchar      *base_ifname,
+                  Fixture          *fixture)
+{
+    g_ptr_array_add (fixture->changed, g_strdup (base_ifname));
+}
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  user_data)
+{
+    GError *error = NULL;
+
+    fixture->root = g_dir_make_tmp ("test-link-inventory-XXXXXX", &error);
+    g_assert_no_error (error);
+
+    /* base0 with a single link, link0 */
+    fake_iface_add (fixture, "base0", 10);
+    fake_iface_add (fixture, "link0", 11);
+    fake_upper_add (fixture, "base0", "link0");
+
+    fixture->changed = g_ptr_array_new_with_free_func (g_free);
+    fixture->inventory = qmi_link_inventory_new (fixture->root);
+    g_signal_connect (fixture->inventory,
+                      QMI_LINK_INVENTORY_SIGNAL_LINKS_CHANGED,
+                      G_CALLBACK (links_changed_cb),
+                      fixture);
+}
+
+static void
+remove_tree (const gchar *path)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (dir) {
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            g_autofree gchar *child = NULL;
+
+            child = g_build_filename (path, name, NULL);
+            if (g_file_test (child, G_FILE_TEST_IS_SYMLINK) || !g_file_test (child, G_FILE_TEST_IS_DIR))
+                g_unlink (child);
+            else
+                remove_tree (child);
+        }
+        g_dir_close (dir);
+    }
+    g_rmdir (path);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  user_data)
+{
+    g_object_unref (fixture->inventory);
+    g_ptr_array_unref (fixture->changed);
+    remove_tree (fixture->root);
+    g_free (fixture->root);
+}
+
+/* Checks the links listed, given as a comma separated string */
+static void
+assert_links (QmiLinkInventory *inventory,
+              const gchar      *base_ifname,
+              const gchar      *expected)
+{
+    g_autoptr(GPtrArray)  links = NULL;
+    g_autofree gchar     *joined = NULL;
+    GError               *error = NULL;
+
+    g_assert (qmi_link_inventory_list_links (inventory, base_ifname, &links, &error));
+    g_assert_no_error (error);
+    if (links) {
+        g_ptr_array_add (links, NULL);
+        joined = g_strjoinv (",", (gchar **) links->pdata);
+    }
+    g_assert_cmpstr (joined ? joined : "", ==, expected);
+}
+
+/* Checks the signals emitted since the last check */
+static void
+assert_changed (Fixture     *fixture,
+                const gchar *expected)
+{
+    g_autofree gchar *joined = NULL;
+
+    g_ptr_array_add (fixture->changed, NULL);
+    joined = g_strjoinv (",", (gchar **) fixture->changed->pdata);
+    g_assert_cmpstr (joined, ==, expected);
+    g_ptr_array_set_size (fixture->changed, 0);
+}
+
+/*****************************************************************************/
+
+static void
+test_list (Fixture       *fixture,
+           gconstpointer  user_data)
+{
+    GPtrArray *links = NULL;
+    GError    *error = NULL;
+
+    assert_links (fixture->inventory, "base0", "link0");
+
+    /* Listed once, then only updated with notifications */
+    fake_iface_add (fixture, "link1", 12);
+    fake_upper_add (fixture, "base0", "link1");
+    assert_links (fixture->inventory, "base0", "link0");
+
+    g_assert (!qmi_link_inventory_list_links (fixture->inventory, "unknown0", &links, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+    g_assert_null (links);
+    g_error_free (error);
+
+    assert_changed (fixture, "");
+}
+
+static void
+test_events (Fixture       *fixture,
+             gconstpointer  user_data)
+{
+    assert_links (fixture->inventory, "base0", "link0");
+
+    /* New link on top of the base */
+    fake_iface_add (fixture, "link1", 12);
+    fake_upper_add (fixture, "base0", "link1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 0, "link1");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link0,link1");
+
+    /* Repeated notifications of known links change nothing */
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 0, "link1");
+    assert_changed (fixture, "");
+
+    /* Links of other interfaces */
+    fake_iface_add (fixture, "eth0", 20);
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 20, 0, "eth0");
+    assert_changed (fixture, "");
+
+    /* Rename, same ifindex */
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 0, "renamed1");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link0,renamed1");
+
+    /* Removal */
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_DEL, 11, 0, "link0");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "renamed1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_DEL, 20, 0, "eth0");
+    assert_changed (fixture, "");
+}
+
+static void
+test_parent_filter (Fixture       *fixture,
+                    gconstpointer  user_data)
+{
+    assert_links (fixture->inventory, "base0", "link0");
+
+    /* Links reporting a different parent are never looked up in sysfs, so
+     * a stale upper entry doesn't add them */
+    fake_iface_add (fixture, "link1", 12);
+    fake_upper_add (fixture, "base0", "link1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 99, "link1");
+    assert_changed (fixture, "");
+    assert_links (fixture->inventory, "base0", "link0");
+
+    /* Same link reporting the base as parent */
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 10, "link1");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link0,link1");
+}
+
+static void
+test_late_upper (Fixture       *fixture,
+                 gconstpointer  user_data)
+{
+    assert_links (fixture->inventory, "base0", "link0");
+
+    /* Notified before being linked on top of the base, as qmimux links are;
+     * the next notification must still find it */
+    fake_iface_add (fixture, "link1", 12);
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 0, "link1");
+    assert_changed (fixture, "");
+    fake_upper_add (fixture, "base0", "link1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 0, "link1");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link0,link1");
+}
+
+static void
+test_overflow (Fixture       *fixture,
+               gconstpointer  user_data)
+{
+    assert_links (fixture->inventory, "base0", "link0");
+
+    /* Notifications lost, sysfs is listed again */
+    fake_upper_del (fixture, "base0", "link0");
+    fake_iface_add (fixture, "link1", 12);
+    fake_upper_add (fixture, "base0", "link1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_OVERFLOW, 0, 0, NULL);
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link1");
+
+    /* Nothing changed */
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_OVERFLOW, 0, 0, NULL);
+    assert_changed (fixture, "");
+}
+
+static void
+test_base_removed (Fixture       *fixture,
+                   gconstpointer  user_data)
+{
+    assert_links (fixture->inventory, "base0", "link0");
+
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_DEL, 10, 0, "base0");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "");
+
+    /* Back again, with a new index */
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 30, 0, "base0");
+    assert_changed (fixture, "");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 11, 30, "link0");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link0");
+}
+
+static void
+test_track (Fixture       *fixture,
+            gconstpointer  user_data)
+{
+    GError *error = NULL;
+
+    /* Changes of untracked bases aren't notified */
+    fake_iface_add (fixture, "link1", 12);
+    fake_upper_add (fixture, "base0", "link1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_NEW, 12, 0, "link1");
+    assert_changed (fixture, "");
+
+    /* Tracked bases are, even if their links were never listed */
+    g_assert (qmi_link_inventory_track (fixture->inventory, "base0", &error));
+    g_assert_no_error (error);
+    fake_upper_del (fixture, "base0", "link1");
+    fake_iface_del (fixture, "link1");
+    qmi_link_inventory_process_event (fixture->inventory, QMI_LINK_MONITOR_EVENT_DEL, 12, 0, "link1");
+    assert_changed (fixture, "base0");
+    assert_links (fixture->inventory, "base0", "link0");
+
+    g_assert (!qmi_link_inventory_track (fixture->inventory, "unknown0", &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+    g_error_free (error);
+}
+
+/*****************************************************************************/
+/* Real links, a macvlan on top of a veth */
+
+static void
+test_monitor (void)
+{
+    g_autoptr(QmiLinkInventory) inventory = NULL;
+    GMainContext               *context;
+    Fixture                     fixture = { 0 };
+    GError                     *error = NULL;
+    gchar                       base_ifname[16];
+    gchar                       peer_ifname[16];
+    gchar                       link_ifname[16];
+    gboolean                    added = FALSE;
+
+    g_snprintf (base_ifname, sizeof (base_ifname), "qmili%ua", (guint) getpid ());
+    g_snprintf (peer_ifname, sizeof (peer_ifname), "qmili%ub", (guint) getpid ());
+    g_snprintf (link_ifname, sizeof (link_ifname), "qmili%um", (guint) getpid ());
+
+    context = g_main_context_new ();
+    fixture.changed = g_ptr_array_new_with_free_func (g_free);
+
+    inventory = qmi_link_inventory_new ("/sys/class/net");
+    if (!qmi_link_inventory_monitor (inventory, context, &error)) {
+        g_test_skip (error->message);
+        g_clear_error (&error);
+        goto out;
+    }
+    g_signal_connect (inventory,
+                      QMI_LINK_INVENTORY_SIGNAL_LINKS_CHANGED,
+                      G_CALLBACK (links_changed_cb),
+                      &fixture);
+
+    if (!test_netlink_add_veth (base_ifname, peer_ifname, &error)) {
+        g_test_skip (error->message);
+        g_clear_error (&error);
+        goto out;
+    }
+    added = TRUE;
+
+    g_assert (qmi_link_inventory_track (inventory, base_ifname, &error));
+    g_assert_no_error (error);
+    assert_links (inventory, base_ifname, "");
+
+    /* Notified from the main context */
+    test_netlink_add_macvlan (link_ifname, base_ifname, &error);
+    g_assert_no_error (error);
+    while (!fixture.changed->len)
+        g_main_context_iteration (context, TRUE);
+    assert_changed (&fixture, base_ifname);
+    assert_links (inventory, base_ifname, link_ifname);
+
+    /* And also when listing right after the change */
+    test_netlink_del (link_ifname, &error);
+    g_assert_no_error (error);
+    assert_links (inventory, base_ifname, "");
+    assert_changed (&fixture, base_ifname);
+
+out:
+    if (added) {
+        test_netlink_del (base_ifname, &error);
+        g_assert_no_error (error);
+    }
+    g_clear_object (&inventory);
+    g_ptr_array_unref (fixture.changed);
+    g_main_context_unref (context);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+#define ADD_FAKE_SYSFS_TEST(path, func) \
+    g_test_add ("/libqmi-glib/link-inventory/fake-sysfs/" path, Fixture, NULL, fixture_setup, func, fixture_teardown)
+
+    ADD_FAKE_SYSFS_TEST ("list",          test_list);
+    ADD_FAKE_SYSFS_TEST ("events",        test_events);
+    ADD_FAKE_SYSFS_TEST ("parent-filter", test_parent_filter);
+    ADD_FAKE_SYSFS_TEST ("late-upper",    test_late_upper);
+    ADD_FAKE_SYSFS_TEST ("overflow",      test_overflow);
+    ADD_FAKE_SYSFS_TEST ("base-removed",  test_base_removed);
+    ADD_FAKE_SYSFS_TEST ("track",         test_track);
+
+#undef ADD_FAKE_SYSFS_TEST
+
+    g_test_add_func ("/libqmi-glib/link-inventory/monitor", test_monitor);
+
+    return g_test_run ();
+}
@@ -0,0 +1,298 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "qmi-link-monitor.h"
+#include "test-netlink.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    QmiLinkMonitorWatch  *watch;
+    /* "new:<ifname>" and "del:<ifname>" of the test links */
+    GPtrArray            *events;
+    /* watch to remove when called */
+    QmiLinkMonitorWatch **remove_other;
+} Watcher;
+
+static void
+watcher_event (QmiLinkMonitorEvent  event,
+               guint                ifindex,
+               guint                parent_ifindex,
+               const gchar         *ifname,
+               Watcher             *w)
+{
+    if (w->remove_other && *w->remove_other) {
+        qmi_link_monitor_watch_remove (*w->remove_other);
+        *w->remove_other = NULL;
+    }
+
+    /* Other links in the system may change while the test runs */
+    if (event == QMI_LINK_MONITOR_EVENT_OVERFLOW || !g_str_has_prefix (ifname, "qmilm"))
+        return;
+
+    g_assert_cmpuint (ifindex, >, 0);
+    g_ptr_array_add (w->events, g_strdup_printf ("%s:%s", event == QMI_LINK_MONITOR_EVENT_NEW ? "new" : "del", ifname));
+}
+
+static gboolean
+watcher_init (Watcher      *w,
+              GMainContext *context)
+{
+    GError *error = NULL;
+
+    w->events = g_ptr_array_new_with_free_func (g_free);
+    w->watch = qmi_link_monitor_watch_add (context, (QmiLinkMonitorFunc) watcher_event, w, &error);
+    if (!w->watch) {
+        g_test_skip (error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+watcher_clear (Watcher *w)
+{
+    if (w->watch)
+        qmi_link_monitor_watch_remove (w->watch);
+    g_ptr_array_unref (w->events);
+}
+
+static gboolean
+watcher_has_event (Watcher     *w,
+                   const gchar *event)
+{
+    return g_ptr_array_find_with_equal_func (w->events, event, g_str_equal, NULL);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    gchar ifname[16];
+    gchar peer_ifname[16];
+} VethPair;
+
+static gboolean
+veth_pair_add (VethPair *pair)
+{
+    GError *error = NULL;
+
+    g_snprintf (pair->ifname, sizeof (pair->ifname), "qmilm%ua", (guint) getpid ());
+    g_snprintf (pair->peer_ifname, sizeof (pair->peer_ifname), "qmilm%ub", (guint) getpid ());
+    if (!test_netlink_add_veth (pair->ifname, pair->peer_ifname, &error)) {
+        g_test_skip (error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+veth_pair_del (VethPair *pair)
+{
+    GError *error = NULL;
+
+    test_netlink_del (pair->ifname, &error);
+    g_assert_no_error (error);
+}
+
+/*****************************************************************************/
+
+static void
+test_add_remove (void)
+{
+    GMainContext *context;
+    Watcher       a = { 0 };
+    Watcher       b = { 0 };
+    guint         i;
+
+    context = g_main_context_new ();
+
+    /* The monitor is freed with its last watch, and created again when
+     * needed */
+    for (i = 0; i < 3; i++) {
+        gboolean ok;
+
+        ok = (watcher_init (&a, context) && watcher_init (&b, context));
+        if (b.events)
+            watcher_clear (&b);
+        watcher_clear (&a);
+        memset (&a, 0, sizeof (a));
+        memset (&b, 0, sizeof (b));
+        if (!ok)
+            break;
+        g_assert (!g_main_context_pending (context));
+    }
+
+    g_main_context_unref (context);
+}
+
+static void
+test_events (void)
+{
+    GMainContext *context;
+    Watcher       w = { 0 };
+    VethPair      pair;
+    gchar        *event;
+
+    context = g_main_context_new ();
+    if (!watcher_init (&w, context))
+        goto out;
+    if (!veth_pair_add (&pair))
+        goto out;
+
+    /* The notifications of a finished operation are already queued */
+    qmi_link_monitor_watch_flush (w.watch);
+    event = g_strdup_printf ("new:%s", pair.ifname);
+    g_assert (watcher_has_event (&w, event));
+    g_free (event);
+    event = g_strdup_printf ("new:%s", pair.peer_ifname);
+    g_assert (watcher_has_event (&w, event));
+    g_free (event);
+
+    /* And they're also dispatched from the main context */
+    veth_pair_del (&pair);
+    event = g_strdup_printf ("del:%s", pair.ifname);
+    while (!watcher_has_event (&w, event))
+        g_main_context_iteration (context, TRUE);
+    g_free (event);
+
+out:
+    watcher_clear (&w);
+    g_main_context_unref (context);
+}
+
+static void
+test_remove_in_callback (void)
+{
+    GMainContext *context;
+    Watcher       a = { 0 };
+    Watcher       b = { 0 };
+    Watcher       c = { 0 };
+    VethPair      pair;
+    gboolean      added = FALSE;
+
+    context = g_main_context_new ();
+    if (!watcher_init (&a, context) || !watcher_init (&b, context))
+        goto out;
+    if (!veth_pair_add (&pair))
+        goto out;
+    added = TRUE;
+
+    /* The first watch removes the second one when called, which must then
+     * not be called */
+    a.remove_other = &b.watch;
+    qmi_link_monitor_watch_flush (a.watch);
+    g_assert_cmpuint (a.events->len, >, 0);
+    g_assert_cmpuint (b.events->len, ==, 0);
+    g_assert_null (b.watch);
+
+    qmi_link_monitor_watch_remove (a.watch);
+    a.watch = NULL;
+
+    /* All watches gone, a new one gets a new monitor */
+    g_assert (watcher_init (&c, context));
+    veth_pair_del (&pair);
+    added = FALSE;
+    qmi_link_monitor_watch_flush (c.watch);
+    g_assert_cmpuint (c.events->len, >, 0);
+
+out:
+    if (added)
+        veth_pair_del (&pair);
+    if (c.events)
+        watcher_clear (&c);
+    if (b.events)
+        watcher_clear (&b);
+    if (a.events)
+        watcher_clear (&a);
+    g_main_context_unref (context);
+}
+
+/*****************************************************************************/
+
+#define N_THREADS    4
+#define N_ITERATIONS 100
+
+static void
+ignore_event (QmiLinkMonitorEvent  event,
+              guint                ifindex,
+              guint                parent_ifindex,
+              const gchar         *ifname,
+              gpointer             user_data)
+{
+}
+
+static gpointer
+add_remove_thread (GMainContext *context)
+{
+    guint i;
+
+    /* Callbacks run in the thread flushing the watches, so no user data that
+     * could go away while they run */
+    for (i = 0; i < N_ITERATIONS; i++) {
+        QmiLinkMonitorWatch *watch;
+        GError              *error = NULL;
+
+        watch = qmi_link_monitor_watch_add (context, ignore_event, NULL, &error);
+        g_assert_no_error (error);
+        qmi_link_monitor_watch_remove (watch);
+    }
+    return NULL;
+}
+
+static void
+test_threads (void)
+{
+    GMainContext *context;
+    GThread      *threads[N_THREADS];
+    Watcher       w = { 0 };
+    guint         i;
+
+    context = g_main_context_new ();
+    if (!watcher_init (&w, context))
+        goto out;
+
+    /* Watches added and removed from other threads while the monitor is
+     * in use */
+    for (i = 0; i < N_THREADS; i++)
+        threads[i] = g_thread_new ("link-monitor", (GThreadFunc) add_remove_thread, context);
+    for (i = 0; i < 10 * N_ITERATIONS; i++)
+        qmi_link_monitor_watch_flush (w.watch);
+    for (i = 0; i < N_THREADS; i++)
+        g_thread_join (threads[i]);
+
+out:
+    watcher_clear (&w);
+    g_main_context_unref (context);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/libqmi-glib/link-monitor/add-remove",         test_add_remove);
+    g_test_add_func ("/libqmi-glib/link-monitor/events",             test_events);
+    g_test_add_func ("/libqmi-glib/link-monitor/remove-in-callback", test_remove_in_callback);
+    g_test_add_func ("/libqmi-glib/link-monitor/threads",            test_threads);
+
+    return g_test_run ();
+}
@@ -314,6 +314,20 @@ test_message_parse_string_with_trailing_tab (void)
     test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC, "EM12-AW");
 }
 
+static void
+test_message_parse_string_with_utf8 (void)
+{
+    /* Model string with a non-ASCII character after a long enough ASCII
+     * prefix, so that both the ASCII and UTF-8 validations are run */
+    const guint8 buffer[] = {
+        0x01, 0x21, 0x00, 0x80, 0x02, 0x05, 0x02, 0x01, 0x00, 0x22, 0x00, 0x15,
+        0x00, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x0B, 0x00, 0x4D,
+        0x6F, 0x64, 0x65, 0x6D, 0x2D, 0x41, 0x42, 0x43, 0xC3, 0xA9
+    };
+
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC, "Modem-ABC\xc3\xa9");
+}
+
 #endif
 
 #if defined HAVE_QMI_MESSAGE_NAS_SWI_GET_STATUS
@@ -380,6 +394,200 @@ test_message_parse_empty_fixed_string (void)
     test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC, "mcc = '' mnc = ''");
 }
 
+/* The translated TLV values below are the ones built by the open-coded
+ * printables; the table-driven printables must give the exact same output */
+
+#if defined HAVE_QMI_MESSAGE_NAS_GET_TECHNOLOGY_PREFERENCE
+
+static void
+test_message_printable_flags_and_enum (void)
+{
+    /* NAS response: Get Technology Preference */
+    const guint8 buffer[] = {
+        0x01,       /* marker */
+        0x1E, 0x00, /* qmux length */
+        0x80,       /* qmux flags */
+        0x03,       /* service: NAS */
+        0x03,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x2B, 0x00, /* message: Get Technology Preference */
+        0x12, 0x00, /* all tlvs length: 18 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, 0x00, 0x00,
+        /* TLV */
+        0x01,       /* type: Active */
+        0x03, 0x00, /* length: 3 bytes */
+        0x22, 0x00, /* Technology Preference: 3GPP | LTE */
+        0x01,       /* Technology Preference Duration: Power Cycle */
+        /* TLV */
+        0x10,       /* type: Persistent */
+        0x02, 0x00, /* length: 2 bytes */
+        0x21, 0x00  /* 3GPP2 | LTE */
+    };
+
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "TLV:\n"
+                                   "  type       = \"Active\" (0x01)\n"
+                                   "  length     = 3\n"
+                                   "  value      = 22:00:01\n"
+                                   "  translated = [ technology_preference = '3gpp, lte' technology_preference_duration = 'power-cycle' ]\n");
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "TLV:\n"
+                                   "  type       = \"Persistent\" (0x10)\n"
+                                   "  length     = 2\n"
+                                   "  value      = 21:00\n"
+                                   "  translated = 3gpp2, lte\n");
+}
+
+#endif
+
+#if defined HAVE_QMI_MESSAGE_DMS_GET_BAND_CAPABILITIES
+
+static void
+test_message_printable_flags64 (void)
+{
+    /* DMS response: Get Band Capabilities */
+    const guint8 buffer[] = {
+        0x01,       /* marker */
+        0x1E, 0x00, /* qmux length */
+        0x80,       /* qmux flags */
+        0x02,       /* service: DMS */
+        0x03,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x45, 0x00, /* message: Get Band Capabilities */
+        0x12, 0x00, /* all tlvs length: 18 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, 0x00, 0x00,
+        /* TLV */
+        0x01,       /* type: Band Capability */
+        0x08, 0x00, /* length: 8 bytes */
+        0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x02, 0x00 /* WCDMA 2100 | WCDMA 900 */
+    };
+
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "TLV:\n"
+                                   "  type       = \"Band Capability\" (0x01)\n"
+                                   "  length     = 8\n"
+                                   "  value      = 00:00:40:00:00:00:02:00\n"
+                                   "  translated = wcdma-2100, wcdma-900\n");
+}
+
+#endif
+
+#if defined HAVE_QMI_MESSAGE_SAR_RF_GET_STATE
+
+static void
+test_message_printable_sar (void)
+{
+    /* SAR response: RF Get State */
+    const guint8 buffer[] = {
+        0x01,       /* marker */
+        0x1A, 0x00, /* qmux length */
+        0x80,       /* qmux flags */
+        0x11,       /* service: SAR */
+        0x03,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x02, 0x00, /* message: RF Get State */
+        0x0E, 0x00, /* all tlvs length: 14 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, 0x00, 0x00,
+        /* TLV */
+        0x10,       /* type: State */
+        0x04, 0x00, /* length: 4 bytes */
+        0x02, 0x00, 0x00, 0x00
+    };
+
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "  message     = \"RF Get State\" (0x0002)\n"
+                                   "TLV:\n"
+                                   "  type       = \"Result\" (0x02)\n");
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "TLV:\n"
+                                   "  type       = \"State\" (0x10)\n"
+                                   "  length     = 4\n"
+                                   "  value      = 02:00:00:00\n");
+}
+
+#endif
+
+#if defined HAVE_QMI_INDICATION_IMSDCM_PDP_ACTIVATE
+
+static void
+test_message_printable_imsdcm (void)
+{
+    /* IMSDCM indication: PDP Activate */
+    const guint8 buffer[] = {
+        0x02,       /* marker is the QRTR one because we have a 16bit service! */
+        0x10, 0x00, /* message length: 16 bytes */
+        0x02, 0x03, /* service: IMSDCM */
+        0x03,       /* client */
+        0x04,       /* service flags: Indication */
+        0x01, 0x00, /* transaction */
+        0x20, 0x00, /* message: PDP Activate */
+        0x04, 0x00, /* all tlvs length: 4 bytes */
+        /* TLV */
+        0x01,       /* type: PDP Id */
+        0x01, 0x00, /* length: 1 byte */
+        0x05
+    };
+
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "  message     = \"PDP Activate\" (0x0020)\n"
+                                   "TLV:\n"
+                                   "  type       = \"PDP Id\" (0x01)\n"
+                                   "  length     = 1\n"
+                                   "  value      = 05\n"
+                                   "  translated = 5\n");
+}
+
+#endif
+
+#if defined HAVE_QMI_MESSAGE_NAS_GET_SIGNAL_STRENGTH
+
+static void
+test_message_printable_signed_enum (void)
+{
+    /* NAS response: Get Signal Strength */
+    const guint8 buffer[] = {
+        0x01,       /* marker */
+        0x18, 0x00, /* qmux length */
+        0x80,       /* qmux flags */
+        0x03,       /* service: NAS */
+        0x03,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x20, 0x00, /* message: Get Signal Strength */
+        0x0C, 0x00, /* all tlvs length: 12 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, 0x00, 0x00,
+        /* TLV */
+        0x16,       /* type: RSRQ */
+        0x02, 0x00, /* length: 2 bytes */
+        0xF6,       /* RSRQ: -10 */
+        0xFF        /* Radio Interface: Unknown (-1) */
+    };
+
+    test_message_printable_common (buffer, sizeof (buffer), QMI_MESSAGE_VENDOR_GENERIC,
+                                   "TLV:\n"
+                                   "  type       = \"RSRQ\" (0x16)\n"
+                                   "  length     = 2\n"
+                                   "  value      = F6:FF\n"
+                                   "  translated = [ rsrq = '-10' radio_interface = 'unknown' ]\n");
+}
+
+#endif
+
 
 /*****************************************************************************/
 
@@ -1862,6 +2070,409 @@ test_message_16bit_service_indication (void)
 
 /*****************************************************************************/
 
+#if defined HAVE_QMI_INDICATION_NAS_SIGNAL_INFO
+
+static void
+test_message_peek_fixed_layout_tlv (void)
+{
+    g_autoptr(GByteArray) buffer = NULL;
+    g_autoptr(QmiMessage) message = NULL;
+    g_autoptr(GError)     error = NULL;
+    gboolean              tlv_exists;
+    gint8                 rssi = 0;
+    gint8                 rsrq = 0;
+    gint16                rsrp = 0;
+    gint16                snr = 0;
+
+    const guint8 nas_message[] = {
+        0x01,       /* marker */
+        0x15, 0x00, /* qmux length: 21 bytes */
+        0x80,       /* qmux flags */
+        0x03,       /* service: NAS */
+        0x02,       /* client */
+        0x04,       /* service flags: Indication */
+        0x01, 0x00, /* transaction */
+        0x51, 0x00, /* message: Signal Info */
+        0x09, 0x00, /* all tlvs length: 9 bytes */
+        /* TLV */
+        0x14,       /* type: LTE signal strength */
+        0x06, 0x00, /* length: 6 bytes */
+        0xC0,       /* rssi: -64 */
+        0xF6,       /* rsrq: -10 */
+        0xA6, 0xFF, /* rsrp: -90 */
+        0x50, 0x00, /* snr: 80 */
+    };
+
+    buffer = g_byte_array_append (g_byte_array_sized_new (sizeof (nas_message)), nas_message, sizeof (nas_message));
+    message = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (message);
+
+    tlv_exists = qmi_indication_nas_signal_info_output_peek_lte_signal_strength (message, &rssi, &rsrq, &rsrp, &snr, &error);
+    g_assert_no_error (error);
+    g_assert (tlv_exists);
+    g_assert_cmpint (rssi, ==, -64);
+    g_assert_cmpint (rsrq, ==, -10);
+    g_assert_cmpint (rsrp, ==, -90);
+    g_assert_cmpint (snr, ==, 80);
+
+    /* Not all output values are required */
+    tlv_exists = qmi_indication_nas_signal_info_output_peek_lte_signal_strength (message, NULL, NULL, &rsrp, NULL, &error);
+    g_assert_no_error (error);
+    g_assert (tlv_exists);
+    g_assert_cmpint (rsrp, ==, -90);
+
+    /* TLV not in the message */
+    tlv_exists = qmi_indication_nas_signal_info_output_peek_gsm_signal_strength (message, &rssi, &error);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_NOT_FOUND);
+    g_assert (!tlv_exists);
+    g_clear_error (&error);
+
+#if defined HAVE_QMI_MESSAGE_NAS_GET_SIGNAL_INFO
+    /* Same TLV, but in a different message */
+    tlv_exists = qmi_message_nas_get_signal_info_output_peek_lte_signal_strength (message, &rssi, &rsrq, &rsrp, &snr, &error);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_MESSAGE);
+    g_assert (!tlv_exists);
+    g_clear_error (&error);
+#endif
+
+    /* Same message ID, but a response */
+    g_byte_array_append (buffer, nas_message, sizeof (nas_message));
+    buffer->data[6] = 0x02;
+    qmi_message_unref (message);
+    message = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    tlv_exists = qmi_indication_nas_signal_info_output_peek_lte_signal_strength (message, &rssi, &rsrq, &rsrp, &snr, &error);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_MESSAGE);
+    g_assert (!tlv_exists);
+}
+
+#endif
+
+#if defined HAVE_QMI_MESSAGE_WDS_GET_PACKET_STATISTICS
+
+static void
+test_message_peek_result_prerequisite_common (guint8    error_status,
+                                              gboolean  expected_found)
+{
+    g_autoptr(GByteArray) buffer = NULL;
+    g_autoptr(QmiMessage) message = NULL;
+    g_autoptr(GError)     error = NULL;
+    gboolean              tlv_exists;
+    guint32               tx_packets_ok = 0;
+
+    guint8 wds_message[] = {
+        0x01,       /* marker */
+        0x1A, 0x00, /* qmux length: 26 bytes */
+        0x80,       /* qmux flags */
+        0x01,       /* service: WDS */
+        0x02,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x24, 0x00, /* message: Get Packet Statistics */
+        0x0E, 0x00, /* all tlvs length: 14 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, /* error status, set below */
+        0x0F, 0x00, /* error code */
+        /* TLV */
+        0x10,       /* type: Tx Packets Ok */
+        0x04, 0x00, /* length: 4 bytes */
+        0x2A, 0x00, 0x00, 0x00
+    };
+
+    wds_message[16] = error_status;
+    buffer = g_byte_array_append (g_byte_array_sized_new (sizeof (wds_message)), wds_message, sizeof (wds_message));
+    message = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (message);
+
+    tlv_exists = qmi_message_wds_get_packet_statistics_output_peek_tx_packets_ok (message, &tx_packets_ok, &error);
+    if (expected_found) {
+        g_assert_no_error (error);
+        g_assert (tlv_exists);
+        g_assert_cmpuint (tx_packets_ok, ==, 42);
+    } else {
+        /* Reported as not found, the same as the getter of the output bundle */
+        g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_NOT_FOUND);
+        g_assert (!tlv_exists);
+        g_assert_cmpuint (tx_packets_ok, ==, 0);
+    }
+}
+
+static void
+test_message_peek_result_success (void)
+{
+    test_message_peek_result_prerequisite_common (0x00 /* success */, TRUE);
+}
+
+static void
+test_message_peek_result_failure (void)
+{
+    test_message_peek_result_prerequisite_common (0x01 /* failure */, FALSE);
+}
+
+#endif
+
+/*****************************************************************************/
+
+#if defined HAVE_QMI_INDICATION_NAS_SIGNAL_INFO
+
+static void
+test_message_append_json (void)
+{
+    g_autoptr(GByteArray) buffer = NULL;
+    g_autoptr(QmiMessage) message = NULL;
+    g_autoptr(GError)     error = NULL;
+    g_autoptr(GString)    json = NULL;
+
+    const guint8 nas_message[] = {
+        0x01,       /* marker */
+        0x1A, 0x00, /* qmux length: 26 bytes */
+        0x80,       /* qmux flags */
+        0x03,       /* service: NAS */
+        0x02,       /* client */
+        0x04,       /* service flags: Indication */
+        0x01, 0x00, /* transaction */
+        0x51, 0x00, /* message: Signal Info */
+        0x0E, 0x00, /* all tlvs length: 14 bytes */
+        /* TLV */
+        0x14,       /* type: LTE signal strength */
+        0x06, 0x00, /* length: 6 bytes */
+        0xC0,       /* rssi: -64 */
+        0xF6,       /* rsrq: -10 */
+        0xA6, 0xFF, /* rsrp: -90 */
+        0x50, 0x00, /* snr: 80 */
+        /* TLV */
+        0x70,       /* type: unknown */
+        0x02, 0x00, /* length: 2 bytes */
+        0xAB, 0xCD,
+    };
+
+    buffer = g_byte_array_append (g_byte_array_sized_new (sizeof (nas_message)), nas_message, sizeof (nas_message));
+    message = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (message);
+
+    /* Contents are appended to whatever the buffer already has */
+    json = g_string_new ("[");
+    qmi_message_append_json (message, NULL, json);
+    g_assert_cmpstr (json->str, ==,
+                     "[{\"service\":\"nas\",\"client\":2,\"transaction\":1,\"kind\":\"indication\",\"message-id\":81,"
+                     "\"message\":\"Signal Info\","
+                     "\"tlvs\":[{\"type\":20,\"name\":\"LTE Signal Strength\",\"value\":{\"rssi\":-64,\"rsrq\":-10,\"rsrp\":-90,\"snr\":80}},"
+                     "{\"type\":112,\"raw\":\"ab:cd\"}]}");
+}
+
+#endif
+
+/*****************************************************************************/
+
+#if defined MESSAGE_VISITORS_ENABLED && defined HAVE_QMI_MESSAGE_WDS_GET_PACKET_SERVICE_STATUS
+
+typedef struct {
+    guint                  n_result;
+    guint16                error_status;
+    guint                  n_connection_status;
+    QmiWdsConnectionStatus connection_status;
+} PacketServiceStatusVisit;
+
+static void
+visit_packet_service_status_result (guint16  error_status,
+                                     guint16  error_code,
+                                     gpointer user_data)
+{
+    PacketServiceStatusVisit *visit = user_data;
+
+    visit->n_result++;
+    visit->error_status = error_status;
+}
+
+static void
+visit_packet_service_status_connection_status (QmiWdsConnectionStatus connection_status,
+                                               gpointer               user_data)
+{
+    PacketServiceStatusVisit *visit = user_data;
+
+    visit->n_connection_status++;
+    visit->connection_status = connection_status;
+}
+
+static const QmiMessageWdsGetPacketServiceStatusOutputVisitor packet_service_status_visitor = {
+    .visit_result            = visit_packet_service_status_result,
+    .visit_connection_status = visit_packet_service_status_connection_status,
+};
+
+static QmiMessage *
+build_packet_service_status_response (guint8  error_status,
+                                      guint16 message_id)
+{
+    g_autoptr(GByteArray) buffer = NULL;
+    g_autoptr(GError)     error = NULL;
+    QmiMessage           *message;
+
+    guint8 wds_message[] = {
+        0x01,       /* marker */
+        0x17, 0x00, /* qmux length: 23 bytes */
+        0x80,       /* qmux flags */
+        0x01,       /* service: WDS */
+        0x02,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x00, 0x00, /* message, set below */
+        0x0B, 0x00, /* all tlvs length: 11 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, /* error status, set below */
+        0x0F, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Connection Status */
+        0x01, 0x00, /* length: 1 byte */
+        0x02        /* connected */
+    };
+
+    wds_message[9]  = message_id & 0xFF;
+    wds_message[10] = message_id >> 8;
+    wds_message[16] = error_status;
+    buffer = g_byte_array_append (g_byte_array_sized_new (sizeof (wds_message)), wds_message, sizeof (wds_message));
+    message = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (message);
+    return message;
+}
+
+static void
+test_message_visitor_result_success (void)
+{
+    g_autoptr(QmiMessage)    message = NULL;
+    g_autoptr(GError)        error = NULL;
+    PacketServiceStatusVisit visit = { 0 };
+
+    message = build_packet_service_status_response (0x00 /* success */, QMI_MESSAGE_WDS_GET_PACKET_SERVICE_STATUS);
+    g_assert (qmi_message_wds_get_packet_service_status_response_visit (message, &packet_service_status_visitor, &visit, &error));
+    g_assert_no_error (error);
+
+    g_assert_cmpuint (visit.n_result, ==, 1);
+    g_assert_cmpuint (visit.error_status, ==, 0x00);
+    g_assert_cmpuint (visit.n_connection_status, ==, 1);
+    g_assert_cmpuint (visit.connection_status, ==, QMI_WDS_CONNECTION_STATUS_CONNECTED);
+}
+
+static void
+test_message_visitor_result_failure (void)
+{
+    g_autoptr(QmiMessage)    message = NULL;
+    g_autoptr(GError)        error = NULL;
+    PacketServiceStatusVisit visit = { 0 };
+
+    /* The Connection Status TLV is only given in successful responses */
+    message = build_packet_service_status_response (0x01 /* failure */, QMI_MESSAGE_WDS_GET_PACKET_SERVICE_STATUS);
+    g_assert (qmi_message_wds_get_packet_service_status_response_visit (message, &packet_service_status_visitor, &visit, &error));
+    g_assert_no_error (error);
+
+    g_assert_cmpuint (visit.n_result, ==, 1);
+    g_assert_cmpuint (visit.error_status, ==, 0x01);
+    g_assert_cmpuint (visit.n_connection_status, ==, 0);
+}
+
+static void
+test_message_visitor_wrong_message (void)
+{
+    g_autoptr(QmiMessage)    message = NULL;
+    g_autoptr(GError)        error = NULL;
+    PacketServiceStatusVisit visit = { 0 };
+
+    /* Get Packet Statistics */
+    message = build_packet_service_status_response (0x00 /* success */, 0x0024);
+    g_assert (!qmi_message_wds_get_packet_service_status_response_visit (message, &packet_service_status_visitor, &visit, &error));
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_MESSAGE);
+
+    g_assert_cmpuint (visit.n_result, ==, 0);
+    g_assert_cmpuint (visit.n_connection_status, ==, 0);
+}
+
+#endif
+
+#if defined MESSAGE_VISITORS_ENABLED && defined HAVE_QMI_MESSAGE_WDS_GET_PROFILE_LIST
+
+static void
+visit_profile_list (const guint8 *profile_list,
+                    guint         profile_list_n_items,
+                    gsize         profile_list_length,
+                    gpointer      user_data)
+{
+    static const guint8  expected[] = {
+        0x00, 0x01, 0x08, 'i', 'n', 't', 'e', 'r', 'n', 'e', 't',
+        0x00, 0x02, 0x03, 'i', 'm', 's'
+    };
+    guint               *n_calls = user_data;
+
+    (*n_calls)++;
+
+    /* Items as found in the message, after the number of items */
+    g_assert (profile_list);
+    g_assert_cmpuint (profile_list_n_items, ==, 2);
+    _g_assert_cmpmem (profile_list, profile_list_length, expected, sizeof (expected));
+}
+
+static void
+test_message_visitor_array (void)
+{
+    g_autoptr(GByteArray) buffer = NULL;
+    g_autoptr(QmiMessage) message = NULL;
+    g_autoptr(GError)     error = NULL;
+    guint                 n_calls = 0;
+
+    const QmiMessageWdsGetProfileListOutputVisitor visitor = {
+        .visit_profile_list = visit_profile_list,
+    };
+
+    const guint8 wds_message[] = {
+        0x01,       /* marker */
+        0x28, 0x00, /* qmux length: 40 bytes */
+        0x80,       /* qmux flags */
+        0x01,       /* service: WDS */
+        0x02,       /* client */
+        0x02,       /* service flags: Response */
+        0x01, 0x00, /* transaction */
+        0x2A, 0x00, /* message: Get Profile List */
+        0x1C, 0x00, /* all tlvs length: 28 bytes */
+        /* TLV */
+        0x02,       /* type: Result */
+        0x04, 0x00, /* length: 4 bytes */
+        0x00, 0x00, /* error status: success */
+        0x00, 0x00, /* error code */
+        /* TLV */
+        0x01,       /* type: Profile List */
+        0x12, 0x00, /* length: 18 bytes */
+        0x02,       /* n items */
+        0x00,       /* profile type: 3gpp */
+        0x01,       /* profile index */
+        0x08,       /* profile name length */
+        'i', 'n', 't', 'e', 'r', 'n', 'e', 't',
+        0x00,       /* profile type: 3gpp */
+        0x02,       /* profile index */
+        0x03,       /* profile name length */
+        'i', 'm', 's'
+    };
+
+    buffer = g_byte_array_append (g_byte_array_sized_new (sizeof (wds_message)), wds_message, sizeof (wds_message));
+    message = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (message);
+
+    /* The array is given as found in the message, without being decoded */
+    g_assert (qmi_message_wds_get_profile_list_response_visit (message, &visitor, &n_calls, &error));
+    g_assert_no_error (error);
+    g_assert_cmpuint (n_calls, ==, 1);
+}
+
+#endif
+
+/*****************************************************************************/
+
 int main (int argc, char **argv)
 {
     g_test_init (&argc, &argv, NULL);
@@ -1884,11 +2495,27 @@ int main (int argc, char **argv)
 #endif
 #if defined HAVE_QMI_MESSAGE_DMS_GET_MODEL
     g_test_add_func ("/libqmi-glib/message/parse/string-with-trailing-tab", test_message_parse_string_with_trailing_tab);
+    g_test_add_func ("/libqmi-glib/message/parse/string-with-utf8",         test_message_parse_string_with_utf8);
 #endif
 #if defined HAVE_QMI_MESSAGE_NAS_SWI_GET_STATUS
     g_test_add_func ("/libqmi-glib/message/parse/signed-int", test_message_parse_signed_int);
 #endif
     g_test_add_func ("/libqmi-glib/message/parse/empty-fixed-string", test_message_parse_empty_fixed_string);
+#if defined HAVE_QMI_MESSAGE_NAS_GET_TECHNOLOGY_PREFERENCE
+    g_test_add_func ("/libqmi-glib/message/printable/flags-and-enum", test_message_printable_flags_and_enum);
+#endif
+#if defined HAVE_QMI_MESSAGE_DMS_GET_BAND_CAPABILITIES
+    g_test_add_func ("/libqmi-glib/message/printable/flags64", test_message_printable_flags64);
+#endif
+#if defined HAVE_QMI_MESSAGE_NAS_GET_SIGNAL_STRENGTH
+    g_test_add_func ("/libqmi-glib/message/printable/signed-enum", test_message_printable_signed_enum);
+#endif
+#if defined HAVE_QMI_MESSAGE_SAR_RF_GET_STATE
+    g_test_add_func ("/libqmi-glib/message/printable/sar", test_message_printable_sar);
+#endif
+#if defined HAVE_QMI_INDICATION_IMSDCM_PDP_ACTIVATE
+    g_test_add_func ("/libqmi-glib/message/printable/imsdcm", test_message_printable_imsdcm);
+#endif
 
     g_test_add_func ("/libqmi-glib/message/new/request",           test_message_new_request);
     g_test_add_func ("/libqmi-glib/message/new/request-from-data", test_message_new_request_from_data);
@@ -1917,5 +2544,23 @@ int main (int argc, char **argv)
 
     g_test_add_func ("/libqmi-glib/message/16bit-service/indication", test_message_16bit_service_indication);
 
+#if defined HAVE_QMI_INDICATION_NAS_SIGNAL_INFO
+    g_test_add_func ("/libqmi-glib/message/peek/fixed-layout-tlv", test_message_peek_fixed_layout_tlv);
+    g_test_add_func ("/libqmi-glib/message/json",                   test_message_append_json);
+#endif
+#if defined HAVE_QMI_MESSAGE_WDS_GET_PACKET_STATISTICS
+    g_test_add_func ("/libqmi-glib/message/peek/result-success", test_message_peek_result_success);
+    g_test_add_func ("/libqmi-glib/message/peek/result-failure", test_message_peek_result_failure);
+#endif
+
+#if defined MESSAGE_VISITORS_ENABLED && defined HAVE_QMI_MESSAGE_WDS_GET_PACKET_SERVICE_STATUS
+    g_test_add_func ("/libqmi-glib/message/visitor/result-success", test_message_visitor_result_success);
+    g_test_add_func ("/libqmi-glib/message/visitor/result-failure", test_message_visitor_result_failure);
+    g_test_add_func ("/libqmi-glib/message/visitor/wrong-message",  test_message_visitor_wrong_message);
+#endif
+#if defined MESSAGE_VISITORS_ENABLED && defined HAVE_QMI_MESSAGE_WDS_GET_PROFILE_LIST
+    g_test_add_func ("/libqmi-glib/message/visitor/array", test_message_visitor_array);
+#endif
+
     return g_test_run ();
 }
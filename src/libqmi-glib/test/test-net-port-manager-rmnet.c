@@ -0,0 +1,127 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <unistd.h>
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "qmi-net-port-manager-rmnet.h"
+#include "test-netlink.h"
+
+/*****************************************************************************/
+
+static void
+async_result_ready (GObject       *source,
+                    GAsyncResult  *res,
+                    GAsyncResult **out_res)
+{
+    *out_res = g_object_ref (res);
+}
+
+/* rmnet links need CAP_NET_ADMIN and the rmnet kernel driver */
+static gboolean
+skip_if_unsupported (GError *error)
+{
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED) ||
+        g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED)) {
+        g_test_skip (error->message);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+test_add_link_concurrent (void)
+{
+    g_autoptr(QmiNetPortManagerRmnet)  manager = NULL;
+    g_autoptr(GAsyncResult)            first_res = NULL;
+    g_autoptr(GAsyncResult)            second_res = NULL;
+    g_autoptr(GAsyncResult)            links_res = NULL;
+    g_autofree gchar                  *first_ifname = NULL;
+    g_autofree gchar                  *second_ifname = NULL;
+    g_autoptr(GPtrArray)               ifnames = NULL;
+    g_autoptr(GArray)                  mux_ids = NULL;
+    g_autofree gchar                  *prefix = NULL;
+    GError                            *error = NULL;
+    guint                              first_mux_id = 0;
+    guint                              second_mux_id = 0;
+    gchar                              ifname[16];
+    gchar                              peer_ifname[16];
+
+    g_snprintf (ifname, sizeof (ifname), "qmirm%ua", (guint) getpid ());
+    g_snprintf (peer_ifname, sizeof (peer_ifname), "qmirm%ub", (guint) getpid ());
+    prefix = g_strdup_printf ("rmt%u.", (guint) getpid ());
+
+    if (!test_netlink_add_veth (ifname, peer_ifname, &error)) {
+        g_test_skip (error->message);
+        g_error_free (error);
+        return;
+    }
+
+    manager = qmi_net_port_manager_rmnet_new (&error);
+    g_assert_no_error (error);
+
+    /* All additions overlap: each one must select its mux ids only after the
+     * previous ones have created their links */
+    qmi_net_port_manager_add_link (QMI_NET_PORT_MANAGER (manager),
+                                   QMI_DEVICE_MUX_ID_AUTOMATIC, 1, ifname, prefix,
+                                   QMI_DEVICE_ADD_LINK_FLAGS_NONE, 5, NULL,
+                                   (GAsyncReadyCallback) async_result_ready, &first_res);
+    qmi_net_port_manager_add_link (QMI_NET_PORT_MANAGER (manager),
+                                   QMI_DEVICE_MUX_ID_AUTOMATIC, 1, ifname, prefix,
+                                   QMI_DEVICE_ADD_LINK_FLAGS_NONE, 5, NULL,
+                                   (GAsyncReadyCallback) async_result_ready, &second_res);
+    qmi_net_port_manager_add_links (QMI_NET_PORT_MANAGER (manager),
+                                    2, 1, ifname, prefix,
+                                    QMI_DEVICE_ADD_LINK_FLAGS_NONE, 5, NULL,
+                                    (GAsyncReadyCallback) async_result_ready, &links_res);
+    while (!first_res || !second_res || !links_res)
+        g_main_context_iteration (NULL, TRUE);
+
+    first_ifname = qmi_net_port_manager_add_link_finish (QMI_NET_PORT_MANAGER (manager), &first_mux_id, first_res, &error);
+    if (!first_ifname && skip_if_unsupported (error)) {
+        g_error_free (error);
+        test_netlink_del (ifname, NULL);
+        return;
+    }
+    g_assert_no_error (error);
+    second_ifname = qmi_net_port_manager_add_link_finish (QMI_NET_PORT_MANAGER (manager), &second_mux_id, second_res, &error);
+    g_assert_no_error (error);
+    ifnames = qmi_net_port_manager_add_links_finish (QMI_NET_PORT_MANAGER (manager), &mux_ids, links_res, &error);
+    g_assert_no_error (error);
+
+    /* Run in the order requested */
+    g_assert_cmpuint (first_mux_id, ==, 1);
+    g_assert_cmpuint (second_mux_id, ==, 2);
+    g_assert_cmpuint (mux_ids->len, ==, 2);
+    g_assert_cmpuint (g_array_index (mux_ids, guint, 0), ==, 3);
+    g_assert_cmpuint (g_array_index (mux_ids, guint, 1), ==, 4);
+    g_assert_cmpstr (first_ifname, !=, second_ifname);
+
+    /* Deleting the base interface deletes the rmnet links on top */
+    test_netlink_del (ifname, &error);
+    g_assert_no_error (error);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/libqmi-glib/net-port-manager-rmnet/add-link/concurrent", test_add_link_concurrent);
+
+    return g_test_run ();
+}
@@ -0,0 +1,388 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "qmi-net-port-manager.h"
+#include "qmi-errors.h"
+#include "qmi-error-types.h"
+
+/******************************************************************************/
+/* Fake net port manager, keeping the links in memory */
+
+#define TEST_TYPE_NET_PORT_MANAGER (test_net_port_manager_get_type ())
+#define TEST_NET_PORT_MANAGER(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), TEST_TYPE_NET_PORT_MANAGER, TestNetPortManager))
+
+typedef struct {
+    QmiNetPortManager parent;
+    /* mux ids of the existing links */
+    GArray *links;
+    /* mux id of the link whose creation fails, 0 if none */
+    guint   fail_add_mux_id;
+    /* mux id of the link whose deletion fails, 0 if none */
+    guint   fail_del_mux_id;
+    guint   n_del_pending;
+} TestNetPortManager;
+
+typedef struct {
+    QmiNetPortManagerClass parent;
+} TestNetPortManagerClass;
+
+static GType test_net_port_manager_get_type (void);
+
+G_DEFINE_TYPE (TestNetPortManager, test_net_port_manager, QMI_TYPE_NET_PORT_MANAGER)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (TestNetPortManager, g_object_unref)
+
+static gboolean
+test_net_port_manager_has_link (TestNetPortManager *self,
+                                guint               mux_id)
+{
+    guint i;
+
+    for (i = 0; i < self->links->len; i++) {
+        if (g_array_index (self->links, guint, i) == mux_id)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gchar *
+test_add_link_finish (QmiNetPortManager  *self,
+                      guint              *mux_id,
+                      GAsyncResult       *res,
+                      GError            **error)
+{
+    gchar *ifname;
+
+    ifname = g_task_propagate_pointer (G_TASK (res), error);
+    if (ifname && mux_id)
+        *mux_id = GPOINTER_TO_UINT (g_task_get_task_data (G_TASK (res)));
+    return ifname;
+}
+
+static void
+test_add_link (QmiNetPortManager     *_self,
+               guint                  mux_id,
+               guint                  initial_mux_id,
+               const gchar           *base_ifname,
+               const gchar           *ifname_prefix,
+               QmiDeviceAddLinkFlags  flags,
+               guint                  timeout,
+               GCancellable          *cancellable,
+               GAsyncReadyCallback    callback,
+               gpointer               user_data)
+{
+    TestNetPortManager *self = TEST_NET_PORT_MANAGER (_self);
+    GTask              *task;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    if (mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC) {
+        for (mux_id = initial_mux_id; test_net_port_manager_has_link (self, mux_id); mux_id++);
+    }
+
+    if (mux_id == self->fail_add_mux_id) {
+        g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED, "add failure");
+        g_object_unref (task);
+        return;
+    }
+
+    g_array_append_val (self->links, mux_id);
+    g_task_set_task_data (task, GUINT_TO_POINTER (mux_id), NULL);
+    g_task_return_pointer (task, g_strdup_printf ("%s%u", ifname_prefix, mux_id), g_free);
+    g_object_unref (task);
+}
+
+static gboolean
+test_del_link_finish (QmiNetPortManager  *self,
+                      GAsyncResult       *res,
+                      GError            **error)
+{
+    return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+static gboolean
+test_del_link_complete (GTask *task)
+{
+    TestNetPortManager *self;
+    guint               mux_id;
+    guint               i;
+
+    self = g_task_get_source_object (task);
+    mux_id = GPOINTER_TO_UINT (g_task_get_task_data (task));
+
+    g_assert_cmpuint (self->n_del_pending, >, 0);
+    self->n_del_pending--;
+
+    if (mux_id == self->fail_del_mux_id) {
+        g_task_return_new_error (task, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED, "del failure");
+        return G_SOURCE_REMOVE;
+    }
+
+    for (i = 0; i < self->links->len; i++) {
+        if (g_array_index (self->links, guint, i) == mux_id) {
+            g_array_remove_index (self->links, i);
+            break;
+        }
+    }
+    g_task_return_boolean (task, TRUE);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+test_del_link (QmiNetPortManager   *_self,
+               const gchar         *ifname,
+               guint                mux_id,
+               guint                timeout,
+               GCancellable        *cancellable,
+               GAsyncReadyCallback  callback,
+               gpointer             user_data)
+{
+    TestNetPortManager *self = TEST_NET_PORT_MANAGER (_self);
+    GTask              *task;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_task_data (task, GUINT_TO_POINTER (mux_id), NULL);
+
+    /* Deletions complete asynchronously, so that the callers are forced to
+     * wait for them */
+    self->n_del_pending++;
+    g_timeout_add_full (G_PRIORITY_DEFAULT, 10,
+                        (GSourceFunc) test_del_link_complete,
+                        task,
+                        g_object_unref);
+}
+
+static void
+test_net_port_manager_init (TestNetPortManager *self)
+{
+    self->links = g_array_new (FALSE, FALSE, sizeof (guint));
+}
+
+static void
+test_net_port_manager_finalize (GObject *object)
+{
+    TestNetPortManager *self = TEST_NET_PORT_MANAGER (object);
+
+    g_array_unref (self->links);
+
+    G_OBJECT_CLASS (test_net_port_manager_parent_class)->finalize (object);
+}
+
+static void
+test_net_port_manager_class_init (TestNetPortManagerClass *klass)
+{
+    GObjectClass           *object_class = G_OBJECT_CLASS (klass);
+    QmiNetPortManagerClass *net_port_manager_class = QMI_NET_PORT_MANAGER_CLASS (klass);
+
+    object_class->finalize = test_net_port_manager_finalize;
+
+    net_port_manager_class->add_link = test_add_link;
+    net_port_manager_class->add_link_finish = test_add_link_finish;
+    net_port_manager_class->del_link = test_del_link;
+    net_port_manager_class->del_link_finish = test_del_link_finish;
+}
+
+/******************************************************************************/
+
+static void
+async_result_ready (GObject       *source,
+                    GAsyncResult  *res,
+                    GAsyncResult **out_res)
+{
+    *out_res = g_object_ref (res);
+}
+
+static GPtrArray *
+add_links_sync (QmiNetPortManager  *manager,
+                guint               n_links,
+                guint               initial_mux_id,
+                GArray            **mux_ids,
+                GError            **error)
+{
+    g_autoptr(GAsyncResult) res = NULL;
+
+    qmi_net_port_manager_add_links (manager,
+                                    n_links,
+                                    initial_mux_id,
+                                    "wwan0",
+                                    "qmapmux0.",
+                                    QMI_DEVICE_ADD_LINK_FLAGS_NONE,
+                                    5,
+                                    NULL,
+                                    (GAsyncReadyCallback) async_result_ready,
+                                    &res);
+    while (!res)
+        g_main_context_iteration (NULL, TRUE);
+
+    return qmi_net_port_manager_add_links_finish (manager, mux_ids, res, error);
+}
+
+static void
+test_add_links (void)
+{
+    g_autoptr(TestNetPortManager)  manager = NULL;
+    g_autoptr(GPtrArray)           ifnames = NULL;
+    g_autoptr(GArray)              mux_ids = NULL;
+    g_autoptr(GError)              error = NULL;
+    guint                          existing = 2;
+
+    manager = g_object_new (TEST_TYPE_NET_PORT_MANAGER, NULL);
+    g_array_append_val (manager->links, existing);
+
+    ifnames = add_links_sync (QMI_NET_PORT_MANAGER (manager), 3, 1, &mux_ids, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (ifnames);
+    g_assert_nonnull (mux_ids);
+
+    /* Mux ids already in use are skipped */
+    g_assert_cmpuint (ifnames->len, ==, 3);
+    g_assert_cmpuint (mux_ids->len, ==, 3);
+    g_assert_cmpuint (g_array_index (mux_ids, guint, 0), ==, 1);
+    g_assert_cmpuint (g_array_index (mux_ids, guint, 1), ==, 3);
+    g_assert_cmpuint (g_array_index (mux_ids, guint, 2), ==, 4);
+    g_assert_cmpstr (g_ptr_array_index (ifnames, 0), ==, "qmapmux0.1");
+    g_assert_cmpstr (g_ptr_array_index (ifnames, 1), ==, "qmapmux0.3");
+    g_assert_cmpstr (g_ptr_array_index (ifnames, 2), ==, "qmapmux0.4");
+    g_assert_cmpuint (manager->links->len, ==, 4);
+}
+
+static void
+test_add_links_rollback (void)
+{
+    g_autoptr(TestNetPortManager)  manager = NULL;
+    g_autoptr(GPtrArray)           ifnames = NULL;
+    g_autoptr(GError)              error = NULL;
+    guint                          existing = 10;
+
+    manager = g_object_new (TEST_TYPE_NET_PORT_MANAGER, NULL);
+    g_array_append_val (manager->links, existing);
+    manager->fail_add_mux_id = 3;
+
+    ifnames = add_links_sync (QMI_NET_PORT_MANAGER (manager), 4, 1, NULL, &error);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED);
+    g_assert_null (ifnames);
+    g_assert_null (strstr (error->message, "rollback failed"));
+
+    /* The operation only finishes once the links created are removed; the
+     * link that existed before is left untouched */
+    g_assert_cmpuint (manager->n_del_pending, ==, 0);
+    g_assert_cmpuint (manager->links->len, ==, 1);
+    g_assert_cmpuint (g_array_index (manager->links, guint, 0), ==, 10);
+}
+
+static void
+test_add_links_rollback_failure (void)
+{
+    g_autoptr(TestNetPortManager)  manager = NULL;
+    g_autoptr(GPtrArray)           ifnames = NULL;
+    g_autoptr(GError)              error = NULL;
+
+    manager = g_object_new (TEST_TYPE_NET_PORT_MANAGER, NULL);
+    manager->fail_add_mux_id = 3;
+    manager->fail_del_mux_id = 1;
+
+    ifnames = add_links_sync (QMI_NET_PORT_MANAGER (manager), 4, 1, NULL, &error);
+    g_assert_null (ifnames);
+
+    /* The original error is kept, with the rollback failure appended */
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED);
+    g_assert (g_str_has_prefix (error->message, "add failure"));
+    g_assert_nonnull (strstr (error->message, "rollback failed"));
+    g_assert_nonnull (strstr (error->message, "qmapmux0.1"));
+    g_assert_nonnull (strstr (error->message, "del failure"));
+
+    g_assert_cmpuint (manager->n_del_pending, ==, 0);
+    g_assert_cmpuint (manager->links->len, ==, 1);
+    g_assert_cmpuint (g_array_index (manager->links, guint, 0), ==, 1);
+}
+
+static GError *
+build_del_links_error (guint n_links,
+                       ...)
+{
+    g_autoptr(GPtrArray) errors = NULL;
+    va_list              args;
+    GError              *error;
+
+    /* NULL-terminated list of GErrors, owned */
+    errors = g_ptr_array_new_with_free_func ((GDestroyNotify) g_error_free);
+    va_start (args, n_links);
+    while ((error = va_arg (args, GError *)) != NULL)
+        g_ptr_array_add (errors, error);
+    va_end (args);
+
+    return qmi_net_port_manager_build_del_links_error (errors, n_links);
+}
+
+static void
+test_build_del_links_error (void)
+{
+    GError *error;
+
+    error = build_del_links_error (2, NULL);
+    g_assert_no_error (error);
+
+    /* All failures agree */
+    error = build_del_links_error (3,
+                                   g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "a: not found"),
+                                   g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "b: not found"),
+                                   NULL);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+    g_assert_cmpstr (error->message, ==, "Couldn't delete 2 of 3 links: a: not found; b: not found");
+    g_error_free (error);
+
+    /* Mixed failures */
+    error = build_del_links_error (2,
+                                   g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "a: not found"),
+                                   g_error_new_literal (QMI_CORE_ERROR, QMI_CORE_ERROR_TIMEOUT, "b: timeout"),
+                                   NULL);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED);
+    g_error_free (error);
+
+    /* Mixed failures, any of them unsupported, in any order */
+    error = build_del_links_error (3,
+                                   g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "a: not found"),
+                                   g_error_new_literal (QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED, "b: unknown mux id"),
+                                   g_error_new_literal (QMI_CORE_ERROR, QMI_CORE_ERROR_TIMEOUT, "c: timeout"),
+                                   NULL);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED);
+    g_assert_cmpstr (error->message, ==, "Couldn't delete 3 of 3 links: a: not found; b: unknown mux id; c: timeout");
+    g_error_free (error);
+
+    error = build_del_links_error (2,
+                                   g_error_new_literal (QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED, "a: unknown mux id"),
+                                   g_error_new_literal (QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED, "b: failed"),
+                                   NULL);
+    g_assert_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED);
+    g_error_free (error);
+}
+
+/******************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/libqmi-glib/net-port-manager/add-links",                  test_add_links);
+    g_test_add_func ("/libqmi-glib/net-port-manager/add-links/rollback",         test_add_links_rollback);
+    g_test_add_func ("/libqmi-glib/net-port-manager/add-links/rollback-failure", test_add_links_rollback_failure);
+    g_test_add_func ("/libqmi-glib/net-port-manager/build-del-links-error",      test_build_del_links_error);
+
+    return g_test_run ();
+}
@@ -0,0 +1,185 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <linux/veth.h>
+
+#include <net/if.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gio/gio.h>
+
+#include "test-netlink.h"
+
+typedef struct {
+    struct nlmsghdr  msghdr;
+    struct ifinfomsg ifreq;
+    guint32          attrs[64];
+} Request;
+
+/* Appends an attribute; nested attributes may be appended right after it,
+ * as long as request_attr_end() is called once done */
+static struct rtattr *
+request_attr_start (Request       *request,
+                    gushort        type,
+                    gconstpointer  data,
+                    gsize          data_len)
+{
+    struct rtattr *attr;
+
+    g_assert (NLMSG_ALIGN (request->msghdr.nlmsg_len) + RTA_SPACE (data_len) <= sizeof (Request));
+    attr = (struct rtattr *) (gpointer) (((guint8 *) request) + NLMSG_ALIGN (request->msghdr.nlmsg_len));
+    attr->rta_type = type;
+    attr->rta_len = RTA_LENGTH (data_len);
+    if (data_len)
+        memcpy (RTA_DATA (attr), data, data_len);
+    request->msghdr.nlmsg_len = NLMSG_ALIGN (request->msghdr.nlmsg_len) + RTA_SPACE (data_len);
+    return attr;
+}
+
+static void
+request_attr_end (Request       *request,
+                  struct rtattr *attr)
+{
+    attr->rta_len = (gushort) (((guint8 *) request) + request->msghdr.nlmsg_len - (guint8 *) attr);
+}
+
+static void
+request_init (Request     *request,
+              gushort      type,
+              gushort      flags,
+              const gchar *ifname)
+{
+    memset (request, 0, sizeof (Request));
+    request->msghdr.nlmsg_len = NLMSG_LENGTH (sizeof (struct ifinfomsg));
+    request->msghdr.nlmsg_type = type;
+    request->msghdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+    request->msghdr.nlmsg_seq = 1;
+    request->ifreq.ifi_family = AF_UNSPEC;
+    request_attr_start (request, IFLA_IFNAME, ifname, strlen (ifname) + 1);
+}
+
+static gboolean
+request_run (Request  *request,
+             GError  **error)
+{
+    struct sockaddr_nl  addr;
+    struct nlmsghdr    *hdr;
+    struct nlmsgerr    *err;
+    guint32             buffer[128];
+    gssize              bytes;
+    gint                fd;
+
+    fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "Couldn't create netlink socket: %s", g_strerror (errno));
+        return FALSE;
+    }
+
+    memset (&addr, 0, sizeof (addr));
+    addr.nl_family = AF_NETLINK;
+    if (sendto (fd, request, request->msghdr.nlmsg_len, 0, (struct sockaddr *) &addr, sizeof (addr)) < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "Couldn't send netlink request: %s", g_strerror (errno));
+        close (fd);
+        return FALSE;
+    }
+
+    bytes = recv (fd, buffer, sizeof (buffer), 0);
+    close (fd);
+    if (bytes < (gssize) NLMSG_LENGTH (sizeof (struct nlmsgerr))) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                     "Couldn't receive netlink response");
+        return FALSE;
+    }
+
+    hdr = (struct nlmsghdr *) buffer;
+    g_assert_cmpuint (hdr->nlmsg_type, ==, NLMSG_ERROR);
+    err = NLMSG_DATA (hdr);
+    if (err->error < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-err->error),
+                     "Netlink request failed: %s", g_strerror (-err->error));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+gboolean
+test_netlink_add_veth (const gchar  *ifname,
+                       const gchar  *peer_ifname,
+                       GError      **error)
+{
+    Request           request;
+    struct ifinfomsg  peer_ifreq;
+    struct rtattr    *linkinfo;
+    struct rtattr    *data;
+    struct rtattr    *peer;
+
+    request_init (&request, RTM_NEWLINK, NLM_F_CREATE | NLM_F_EXCL, ifname);
+
+    linkinfo = request_attr_start (&request, IFLA_LINKINFO, NULL, 0);
+    request_attr_start (&request, IFLA_INFO_KIND, "veth", strlen ("veth"));
+    data = request_attr_start (&request, IFLA_INFO_DATA, NULL, 0);
+    memset (&peer_ifreq, 0, sizeof (peer_ifreq));
+    peer_ifreq.ifi_family = AF_UNSPEC;
+    peer = request_attr_start (&request, VETH_INFO_PEER, &peer_ifreq, sizeof (peer_ifreq));
+    request_attr_start (&request, IFLA_IFNAME, peer_ifname, strlen (peer_ifname) + 1);
+    request_attr_end (&request, peer);
+    request_attr_end (&request, data);
+    request_attr_end (&request, linkinfo);
+
+    return request_run (&request, error);
+}
+
+gboolean
+test_netlink_add_macvlan (const gchar  *ifname,
+                          const gchar  *base_ifname,
+                          GError      **error)
+{
+    Request        request;
+    struct rtattr *linkinfo;
+    guint32        base_ifindex;
+
+    base_ifindex = if_nametoindex (base_ifname);
+    if (!base_ifindex) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "Couldn't find base interface: %s", g_strerror (errno));
+        return FALSE;
+    }
+
+    request_init (&request, RTM_NEWLINK, NLM_F_CREATE | NLM_F_EXCL, ifname);
+    request_attr_start (&request, IFLA_LINK, &base_ifindex, sizeof (base_ifindex));
+    linkinfo = request_attr_start (&request, IFLA_LINKINFO, NULL, 0);
+    request_attr_start (&request, IFLA_INFO_KIND, "macvlan", strlen ("macvlan"));
+    request_attr_end (&request, linkinfo);
+
+    return request_run (&request, error);
+}
+
+gboolean
+test_netlink_del (const gchar  *ifname,
+                  GError      **error)
+{
+    Request request;
+
+    request_init (&request, RTM_DELLINK, 0, ifname);
+    return request_run (&request, error);
+}
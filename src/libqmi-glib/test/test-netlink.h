@@ -0,0 +1,38 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#ifndef TEST_NETLINK_H
+#define TEST_NETLINK_H
+
+#include <glib.h>
+
+/*
+ * Network links created and deleted through rtnetlink. Creating links
+ * requires CAP_NET_ADMIN, so tests using them should be skipped when
+ * creating them fails.
+ */
+
+/* Deleting either link of the pair deletes both */
+gboolean test_netlink_add_veth    (const gchar  *ifname,
+                                   const gchar  *peer_ifname,
+                                   GError      **error);
+/* Shows up as an upper link of @base_ifname in sysfs */
+gboolean test_netlink_add_macvlan (const gchar  *ifname,
+                                   const gchar  *base_ifname,
+                                   GError      **error);
+gboolean test_netlink_del         (const gchar  *ifname,
+                                   GError      **error);
+
+#endif /* TEST_NETLINK_H */
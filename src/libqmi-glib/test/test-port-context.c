@@ -38,9 +38,23 @@ struct _TestPortContext {
     GSocketService *socket_service;
     GList *clients;
     GMutex command_mutex;
+    GCond command_cond;
+    GQueue *commands;
+};
+
+/* Expected command and the response to send back */
+typedef struct {
     GByteArray *command;
     GByteArray *response;
-};
+} ExpectedCommand;
+
+static void
+expected_command_free (ExpectedCommand *expected)
+{
+    g_byte_array_unref (expected->command);
+    g_byte_array_unref (expected->response);
+    g_slice_free (ExpectedCommand, expected);
+}
 
 /*****************************************************************************/
 /* Helpers */
@@ -89,15 +103,32 @@ test_port_context_set_command (TestPortContext *ctx,
                                gsize            response_size,
                                guint16          transaction_id)
 {
+    ExpectedCommand *expected;
+
+    expected = g_slice_new0 (ExpectedCommand);
+    expected->command = g_byte_array_append (g_byte_array_sized_new (command_size), command, command_size);
+    qmi_message_set_transaction_id ((QmiMessage *)expected->command, transaction_id);
+
+    /* An empty response means the command is never replied */
+    expected->response = g_byte_array_append (g_byte_array_sized_new (response_size), response, response_size);
+    if (response_size > 0)
+        qmi_message_set_transaction_id ((QmiMessage *)expected->response, transaction_id);
+
+    /* Commands are expected in the same order they're set */
     g_mutex_lock (&ctx->command_mutex);
     {
-        g_assert (!ctx->command);
-        ctx->command = g_byte_array_append (g_byte_array_sized_new (command_size), command, command_size);
-        qmi_message_set_transaction_id ((QmiMessage *)ctx->command, transaction_id);
+        g_queue_push_tail (ctx->commands, expected);
+    }
+    g_mutex_unlock (&ctx->command_mutex);
+}
 
-        g_assert (!ctx->response);
-        ctx->response = g_byte_array_append (g_byte_array_sized_new (response_size), response, response_size);
-        qmi_message_set_transaction_id ((QmiMessage *)ctx->response, transaction_id);
+void
+test_port_context_wait_commands (TestPortContext *ctx)
+{
+    g_mutex_lock (&ctx->command_mutex);
+    {
+        while (!g_queue_is_empty (ctx->commands))
+            g_cond_wait (&ctx->command_cond, &ctx->command_mutex);
     }
     g_mutex_unlock (&ctx->command_mutex);
 }
@@ -106,13 +137,14 @@ static GByteArray *
 process_next_command (TestPortContext *ctx,
                       GByteArray      *buffer)
 {
-    QmiMessage   *message;
-    GError       *error = NULL;
-    const guint8 *message_raw;
-    gsize         message_raw_length;
-    gchar        *expected;
-    gchar        *received;
-    GByteArray   *response;
+    QmiMessage      *message;
+    GError          *error = NULL;
+    const guint8    *message_raw;
+    gsize            message_raw_length;
+    ExpectedCommand *next;
+    gchar           *expected;
+    gchar           *received;
+    GByteArray      *response;
 
     /* Every message received must start with the QMUX or QRTR marker.
      * If it doesn't, we broke framing :-/
@@ -141,26 +173,22 @@ process_next_command (TestPortContext *ctx,
      * different), compared to a simple memcmp(). */
     g_mutex_lock (&ctx->command_mutex);
     {
-        g_assert (ctx->command);
-        expected = str_hex (ctx->command->data, ctx->command->len, ':');
+        next = g_queue_pop_head (ctx->commands);
+        g_cond_broadcast (&ctx->command_cond);
     }
     g_mutex_unlock (&ctx->command_mutex);
 
+    g_assert (next);
+    expected = str_hex (next->command->data, next->command->len, ':');
     received = str_hex (message_raw, message_raw_length, ':');
     g_assert_cmpstr (expected, ==, received);
     g_free (expected);
     g_free (received);
     qmi_message_unref (message);
-    g_byte_array_unref (ctx->command);
-    ctx->command = NULL;
 
     /* Command Expected == Received, so now return the Response */
-    g_mutex_lock (&ctx->command_mutex);
-    {
-        response = ctx->response;
-        ctx->response = NULL;
-    }
-    g_mutex_unlock (&ctx->command_mutex);
+    response = g_byte_array_ref (next->response);
+    expected_command_free (next);
 
     return response;
 }
@@ -203,12 +231,13 @@ client_parse_request (Client *client)
         if (response) {
             GError *error = NULL;
 
-            if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
-                                            response->data,
-                                            response->len,
-                                            NULL, /* bytes_written */
-                                            NULL, /* cancellable */
-                                            &error)) {
+            if (response->len > 0 &&
+                !g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
+                                             response->data,
+                                             response->len,
+                                             NULL, /* bytes_written */
+                                             NULL, /* cancellable */
+                                             &error)) {
                 g_warning ("Cannot send response to client: %s", error->message);
                 g_error_free (error);
             }
@@ -415,6 +444,7 @@ test_port_context_free (TestPortContext *ctx)
     g_cond_clear (&ctx->ready_cond);
     g_mutex_clear (&ctx->ready_mutex);
     g_mutex_clear (&ctx->command_mutex);
+    g_cond_clear (&ctx->command_cond);
 
     g_list_free_full (ctx->clients, (GDestroyNotify)client_free);
     if (ctx->socket_service) {
@@ -423,10 +453,7 @@ test_port_context_free (TestPortContext *ctx)
         g_object_unref (ctx->socket_service);
     }
     g_free (ctx->name);
-    if (ctx->command)
-        g_byte_array_unref (ctx->command);
-    if (ctx->response)
-        g_byte_array_unref (ctx->response);
+    g_queue_free_full (ctx->commands, (GDestroyNotify)expected_command_free);
     g_slice_free (TestPortContext, ctx);
 }
 
@@ -440,5 +467,7 @@ test_port_context_new (const gchar *name)
     g_cond_init (&ctx->ready_cond);
     g_mutex_init (&ctx->ready_mutex);
     g_mutex_init (&ctx->command_mutex);
+    g_cond_init (&ctx->command_cond);
+    ctx->commands = g_queue_new ();
     return ctx;
 }
@@ -33,5 +33,6 @@ void             test_port_context_set_command   (TestPortContext *ctx,
                                                   const guint8    *response,
                                                   gsize            response_size,
                                                   guint16          transaction_id);
+void             test_port_context_wait_commands (TestPortContext *ctx);
 
 #endif /* TEST_PORT_CONTEXT_H */
@@ -0,0 +1,241 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2026 libqmi contributors
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "qmi-sysfs-attribute.h"
+#include "test-netlink.h"
+
+/*****************************************************************************/
+/* Regular files, accessed at offset 0 as sysfs attributes are */
+
+static gchar *
+temp_file_new (const gchar *contents)
+{
+    gchar  *path = NULL;
+    GError *error = NULL;
+    gint    fd;
+
+    fd = g_file_open_tmp ("test-sysfs-attribute-XXXXXX", &path, &error);
+    g_assert_no_error (error);
+    close (fd);
+    if (contents) {
+        g_file_set_contents (path, contents, -1, &error);
+        g_assert_no_error (error);
+    }
+    return path;
+}
+
+static void
+assert_read (QmiSysfsAttribute *attribute,
+             const gchar       *expected)
+{
+    gchar   value[32] = { 0 };
+    GError *error = NULL;
+
+    g_assert (qmi_sysfs_attribute_read (attribute, value, sizeof (value) - 1, &error));
+    g_assert_no_error (error);
+    g_assert_cmpstr (value, ==, expected);
+}
+
+static void
+test_read_write (void)
+{
+    g_autoptr(QmiSysfsAttribute)  attribute = NULL;
+    g_autofree gchar             *path = NULL;
+    g_autofree gchar             *contents = NULL;
+    GError                       *error = NULL;
+
+    path = temp_file_new ("N\n");
+    attribute = qmi_sysfs_attribute_new (path);
+    g_assert_cmpstr (qmi_sysfs_attribute_get_path (attribute), ==, path);
+
+    assert_read (attribute, "N\n");
+
+    g_assert (qmi_sysfs_attribute_write (attribute, "Y", &error));
+    g_assert_no_error (error);
+    g_file_get_contents (path, &contents, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpstr (contents, ==, "Y\n");
+
+    g_unlink (path);
+}
+
+static void
+test_repeated (void)
+{
+    g_autoptr(QmiSysfsAttribute)  attribute = NULL;
+    g_autofree gchar             *path = NULL;
+    guint                         i;
+
+    path = temp_file_new ("0");
+    attribute = qmi_sysfs_attribute_new (path);
+
+    /* Every access starts at offset 0 of the same open files */
+    for (i = 0; i < 10; i++) {
+        gchar   value[2] = { 0 };
+        GError *error = NULL;
+
+        value[0] = (gchar) ('0' + i);
+        g_assert (qmi_sysfs_attribute_write (attribute, value, &error));
+        g_assert_no_error (error);
+        assert_read (attribute, value);
+        assert_read (attribute, value);
+    }
+
+    g_unlink (path);
+}
+
+static void
+test_errors (void)
+{
+    g_autoptr(QmiSysfsAttribute)  attribute = NULL;
+    g_autofree gchar             *path = NULL;
+    gchar                         value[32];
+    GError                       *error = NULL;
+
+    path = temp_file_new (NULL);
+    attribute = qmi_sysfs_attribute_new (path);
+
+    g_assert (!qmi_sysfs_attribute_read (attribute, value, sizeof (value), &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_FAILED);
+    g_assert (strstr (error->message, "unexpected EOF"));
+    g_clear_error (&error);
+
+    /* Failures to open aren't cached, the file is opened on demand */
+    g_unlink (path);
+    qmi_sysfs_attribute_unref (g_steal_pointer (&attribute));
+    attribute = qmi_sysfs_attribute_new (path);
+    g_assert (!qmi_sysfs_attribute_read (attribute, value, sizeof (value), &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+    g_clear_error (&error);
+    g_assert (!qmi_sysfs_attribute_write (attribute, "1", &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+    g_clear_error (&error);
+
+    g_file_set_contents (path, "1", -1, &error);
+    g_assert_no_error (error);
+    assert_read (attribute, "1");
+
+    g_unlink (path);
+}
+
+/*****************************************************************************/
+
+static void
+read_ready (QmiSysfsAttribute  *attribute,
+            GAsyncResult       *res,
+            gchar             **out_value)
+{
+    GError *error = NULL;
+
+    *out_value = qmi_sysfs_attribute_read_finish (attribute, res, &error);
+    g_assert_no_error (error);
+}
+
+static void
+write_ready (QmiSysfsAttribute *attribute,
+             GAsyncResult      *res,
+             gboolean          *out_done)
+{
+    GError *error = NULL;
+
+    g_assert (qmi_sysfs_attribute_write_finish (attribute, res, &error));
+    g_assert_no_error (error);
+    *out_done = TRUE;
+}
+
+static void
+test_async (void)
+{
+    g_autoptr(QmiSysfsAttribute)  attribute = NULL;
+    g_autofree gchar             *path = NULL;
+    g_autofree gchar             *value = NULL;
+    gboolean                      done = FALSE;
+
+    path = temp_file_new ("N");
+    attribute = qmi_sysfs_attribute_new (path);
+
+    qmi_sysfs_attribute_write_async (attribute, "Y", NULL, (GAsyncReadyCallback) write_ready, &done);
+    while (!done)
+        g_main_context_iteration (NULL, TRUE);
+
+    qmi_sysfs_attribute_read_async (attribute, 16, NULL, (GAsyncReadyCallback) read_ready, &value);
+    while (!value)
+        g_main_context_iteration (NULL, TRUE);
+    g_assert_cmpstr (value, ==, "Y");
+
+    g_unlink (path);
+}
+
+/*****************************************************************************/
+/* Real sysfs attribute of an interface deleted and created back */
+
+static void
+test_reopen (void)
+{
+    g_autoptr(QmiSysfsAttribute)  attribute = NULL;
+    g_autofree gchar             *path = NULL;
+    GError                       *error = NULL;
+    gchar                         ifname[16];
+    gchar                         peer_ifname[16];
+
+    g_snprintf (ifname, sizeof (ifname), "qmisa%ua", (guint) getpid ());
+    g_snprintf (peer_ifname, sizeof (peer_ifname), "qmisa%ub", (guint) getpid ());
+
+    if (!test_netlink_add_veth (ifname, peer_ifname, &error)) {
+        g_test_skip (error->message);
+        g_error_free (error);
+        return;
+    }
+
+    path = g_strdup_printf ("/sys/class/net/%s/mtu", ifname);
+    attribute = qmi_sysfs_attribute_new (path);
+    g_assert (qmi_sysfs_attribute_write (attribute, "1400", &error));
+    g_assert_no_error (error);
+    assert_read (attribute, "1400\n");
+
+    /* The open files fail with ENODEV from now on, and the same access
+     * opens them again */
+    test_netlink_del (ifname, &error);
+    g_assert_no_error (error);
+    test_netlink_add_veth (ifname, peer_ifname, &error);
+    g_assert_no_error (error);
+    assert_read (attribute, "1500\n");
+    g_assert (qmi_sysfs_attribute_write (attribute, "1300", &error));
+    g_assert_no_error (error);
+    assert_read (attribute, "1300\n");
+
+    test_netlink_del (ifname, &error);
+    g_assert_no_error (error);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/libqmi-glib/sysfs-attribute/read-write", test_read_write);
+    g_test_add_func ("/libqmi-glib/sysfs-attribute/repeated",   test_repeated);
+    g_test_add_func ("/libqmi-glib/sysfs-attribute/errors",     test_errors);
+    g_test_add_func ("/libqmi-glib/sysfs-attribute/async",      test_async);
+    g_test_add_func ("/libqmi-glib/sysfs-attribute/reopen",     test_reopen);
+
+    return g_test_run ();
+}
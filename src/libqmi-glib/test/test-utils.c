@@ -93,6 +93,18 @@ test_read_string_from_plmn_encoded_array_gsm7_mixed_chars (void)
     common_test_read_string_from_plmn_encoded_array (QMI_NAS_PLMN_ENCODING_SCHEME_GSM, gsm, G_N_ELEMENTS (gsm), expected_utf8);
 }
 
+static void
+test_read_string_from_plmn_encoded_array_gsm7_trailing_padding (void)
+{
+    /* Leading '@' must be kept, trailing ones are padding */
+    const guint8 gsm[] = {
+        0x00, 0x64, 0x1A, 0x00, 0x00, 0x00, 0x00
+    };
+    const gchar *expected_utf8 = "@Hi";
+
+    common_test_read_string_from_plmn_encoded_array (QMI_NAS_PLMN_ENCODING_SCHEME_GSM, gsm, G_N_ELEMENTS (gsm), expected_utf8);
+}
+
 static void
 test_read_string_from_plmn_encoded_array_ucs2le (void)
 {
@@ -105,6 +117,18 @@ test_read_string_from_plmn_encoded_array_ucs2le (void)
     common_test_read_string_from_plmn_encoded_array (QMI_NAS_PLMN_ENCODING_SCHEME_UCS2LE, ucs2le, G_N_ELEMENTS (ucs2le), expected_utf8);
 }
 
+static void
+test_read_string_from_plmn_encoded_array_ucs2le_multibyte (void)
+{
+    const guint8 ucs2le[] = {
+        0x41, 0x00, 0xF1, 0x00, 0xAC, 0x20, 0x3D, 0xD8,
+        0x00, 0xDE
+    };
+    const gchar *expected_utf8 = "Añ€😀";
+
+    common_test_read_string_from_plmn_encoded_array (QMI_NAS_PLMN_ENCODING_SCHEME_UCS2LE, ucs2le, G_N_ELEMENTS (ucs2le), expected_utf8);
+}
+
 /******************************************************************************/
 
 static void
@@ -244,7 +268,9 @@ int main (int argc, char **argv)
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/gsm7-default-chars",  test_read_string_from_plmn_encoded_array_gsm7_default_chars);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/gsm7-extended-chars", test_read_string_from_plmn_encoded_array_gsm7_extended_chars);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/gsm7-mixed-chars",    test_read_string_from_plmn_encoded_array_gsm7_mixed_chars);
+    g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/gsm7-trailing-padding", test_read_string_from_plmn_encoded_array_gsm7_trailing_padding);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/ucs2le",              test_read_string_from_plmn_encoded_array_ucs2le);
+    g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/ucs2le-multibyte",    test_read_string_from_plmn_encoded_array_ucs2le_multibyte);
 
     g_test_add_func ("/libqmi-glib/utils/read-string-from-network-description-encoded-array/gsm7-default-chars",  test_read_string_from_network_description_encoded_array_gsm7_default_chars);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-network-description-encoded-array/gsm7-extended-chars", test_read_string_from_network_description_encoded_array_gsm7_extended_chars);
@@ -30,6 +30,7 @@
 
 #include <glib-object.h>
 #include <gio/gio.h>
+#include <qmi-common.h>
 
 #include "qfu-log.h"
 #include "qfu-qdl-message.h"
@@ -251,7 +252,7 @@ send_request (QfuQdlDevice  *self,
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (request, printable_size, ':');
+        printable = qmi_common_str_hex (request, printable_size, ':');
         g_debug ("[qfu-qdl-device] >> %s%s [%" G_GSIZE_FORMAT "]", printable, shorted ? "..." : "", request_size);
         g_free (printable);
     }
@@ -297,7 +298,7 @@ send_framed_request (QfuQdlDevice  *self,
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (request, printable_size, ':');
+        printable = qmi_common_str_hex (request, printable_size, ':');
         g_debug ("[qfu-qdl-device] >> %s%s [%" G_GSIZE_FORMAT ", unframed]", printable, shorted ? "..." : "", request_size);
         g_free (printable);
     }
@@ -382,7 +383,7 @@ receive_response (QfuQdlDevice  *self,
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (self->priv->buffer->data, printable_size, ':');
+        printable = qmi_common_str_hex (self->priv->buffer->data, printable_size, ':');
         g_debug ("[qfu-qdl-device] << %s%s [%" G_GSIZE_FORMAT "]", printable, shorted ? "..." : "", rlen);
         g_free (printable);
     }
@@ -428,7 +429,7 @@ receive_response (QfuQdlDevice  *self,
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (self->priv->secondary_buffer->data, printable_size, ':');
+        printable = qmi_common_str_hex (self->priv->secondary_buffer->data, printable_size, ':');
         g_debug ("[qfu-qdl-device] << %s%s [%" G_GSIZE_FORMAT ", unframed]", printable, shorted ? "..." : "", unframed_size);
         g_free (printable);
     }
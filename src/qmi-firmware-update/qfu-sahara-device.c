@@ -29,6 +29,7 @@
 
 #include <glib-object.h>
 #include <gio/gio.h>
+#include <qmi-common.h>
 
 #include "qfu-log.h"
 #include "qfu-firehose-message.h"
@@ -155,7 +156,7 @@ send_request (QfuSaharaDevice  *self,
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (request, printable_size, ':');
+        printable = qmi_common_str_hex (request, printable_size, ':');
         g_debug ("[qfu-sahara-device] >> %s%s [%" G_GSIZE_FORMAT "]", printable, shorted ? "..." : "", request_size);
         g_free (printable);
 
@@ -256,7 +257,7 @@ receive_response (QfuSaharaDevice  *self,
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (self->priv->buffer->data, printable_size, ':');
+        printable = qmi_common_str_hex (self->priv->buffer->data, printable_size, ':');
         g_debug ("[qfu-sahara-device] << %s%s [%" G_GSIZE_FORMAT "]", printable, shorted ? "..." : "", rlen);
         g_free (printable);
 
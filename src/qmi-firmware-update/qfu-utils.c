@@ -29,43 +29,9 @@
 #include <glib.h>
 #include <gio/gio.h>
 
-#include "qfu-utils.h"
-
-/******************************************************************************/
+#include <qmi-common.h>
 
-gchar *
-qfu_utils_str_hex (gconstpointer mem,
-                   gsize         size,
-                   gchar         delimiter)
-{
-    const guint8 *data = mem;
-    gsize         i;
-    gsize         j;
-    gsize         new_str_length;
-    gchar        *new_str;
-
-    /* Get new string length. If input string has N bytes, we need:
-     * - 1 byte for last NUL char
-     * - 2N bytes for hexadecimal char representation of each byte...
-     * - N-1 bytes for the separator ':'
-     * So... a total of (1+2N+N-1) = 3N bytes are needed... */
-    new_str_length =  3 * size;
-
-    /* Allocate memory for new array and initialize contents to NUL */
-    new_str = g_malloc0 (new_str_length);
-
-    /* Print hexadecimal representation of each byte... */
-    for (i = 0, j = 0; i < size; i++, j += 3) {
-        /* Print character in output string... */
-        snprintf (&new_str[j], 3, "%02X", data[i]);
-        /* And if needed, add separator */
-        if (i != (size - 1) )
-            new_str[j + 2] = delimiter;
-    }
-
-    /* Set output string */
-    return new_str;
-}
+#include "qfu-utils.h"
 
 /******************************************************************************/
 
@@ -112,7 +78,7 @@ qfu_utils_get_firmware_image_unique_id_printable (const GArray *unique_id)
     g_free (unique_id_str);
 
     /* Get a raw hex string otherwise */
-    unique_id_str = qfu_utils_str_hex (unique_id->data, unique_id->len, ':');
+    unique_id_str = qmi_common_str_hex (unique_id->data, unique_id->len, ':');
 
     return unique_id_str;
 }
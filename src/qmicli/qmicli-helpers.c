@@ -24,6 +24,8 @@
 #include <string.h>
 #include <errno.h>
 
+#include <qmi-common.h>
+
 #include "qmicli-helpers.h"
 
 #define QMICLI_ENUM_LIST_ITEM(TYPE,TYPE_UNDERSCORE,DESCR)                     \
@@ -138,12 +140,11 @@ qmicli_get_raw_data_printable (const GArray *data,
 {
     gsize i;
     gsize j;
-    gsize k;
     gsize new_str_length;
     gchar *new_str;
     gsize prefix_len;
     guint n_lines;
-    gboolean is_new_line;
+    gsize bytes_per_line;
 
     g_return_val_if_fail (max_line_length >= 3, NULL);
 
@@ -177,32 +178,22 @@ qmicli_get_raw_data_printable (const GArray *data,
     /* Allocate memory for new array and initialize contents to NUL */
     new_str = g_malloc0 (new_str_length);
 
-    /* Print hexadecimal representation of each byte... */
-    is_new_line = TRUE;
-    for (i = 0, j = 0, k = 0; i < data->len; i++) {
-        if (is_new_line) {
-            strcpy (&new_str[j], line_prefix);
-            j += strlen (line_prefix);
-            is_new_line = FALSE;
-        }
+    /* Print hexadecimal representation of each line... */
+    bytes_per_line = max_line_length / 3;
+    for (i = 0, j = 0; i < data->len; i += bytes_per_line) {
+        gsize n_bytes;
 
-        /* Print character in output string... */
-        snprintf (&new_str[j], 3, "%02X", g_array_index (data, guint8, i));
-        j+=2;
-        k+=2;
+        n_bytes = MIN (bytes_per_line, data->len - i);
 
-        if (i != (data->len - 1) ) {
-            new_str[j] = ':';
-            j++;
-            k++;
-        }
+        strcpy (&new_str[j], line_prefix);
+        j += prefix_len - 1;
 
-        if (k % max_line_length == 0 ||
-            i == (data->len -1)) {
-            new_str[j] = '\n';
-            j++;
-            is_new_line = TRUE;
-        }
+        j += qmi_common_str_hex_to_buffer (&g_array_index (data, guint8, i), n_bytes, ':', &new_str[j]);
+
+        /* Separator also at the end of the line, unless it's the last one */
+        if (i + n_bytes < data->len)
+            new_str[j++] = ':';
+        new_str[j++] = '\n';
     }
 
     /* Set output string */
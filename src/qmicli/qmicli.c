@@ -63,6 +63,7 @@ static gboolean device_open_version_info_flag;
 static gboolean device_open_sync_flag;
 static gchar *device_open_net_str;
 static gboolean device_open_proxy_flag;
+static gchar *device_version_info_cache_dir_str;
 #if QMI_MBIM_QMUX_SUPPORTED
 static gboolean device_open_qmi_flag;
 static gboolean device_open_mbim_flag;
@@ -105,6 +106,10 @@ static GOptionEntry main_entries[] = {
       "Request to use the 'qmi-proxy' proxy",
       NULL
     },
+    { "device-version-info-cache-dir", 0, 0, G_OPTION_ARG_FILENAME, &device_version_info_cache_dir_str,
+      "Cache the service version info in the given directory",
+      "[PATH]"
+    },
 #if QMI_MBIM_QMUX_SUPPORTED
     { "device-open-qmi", 0, 0, G_OPTION_ARG_NONE, &device_open_qmi_flag,
       "Open a cdc-wdm device explicitly in QMI mode",
@@ -729,6 +734,11 @@ device_new_ready (GObject *unused,
     }
 #endif
 
+    if (device_version_info_cache_dir_str)
+        g_object_set (device,
+                      QMI_DEVICE_VERSION_INFO_CACHE_DIR, device_version_info_cache_dir_str,
+                      NULL);
+
     /* Setup device open flags */
     if (device_open_version_info_flag)
         open_flags |= QMI_DEVICE_OPEN_FLAGS_VERSION_INFO;